@@ -775,10 +775,10 @@ public:
             unsigned int id     = atoi(tokens.at(0).c_str());
             std::string name    = tokens.at(1);
 
-            // The enitites are stores in std::map, id based, the id
+            // The enitites are stored in the entity registry, id based, the id
             // is the Entity ID you refer accross the whole application
-            // We get a reference to the entity
-            OpenIG::Base::ImageGenerator::Entity& entity = _ig->getEntityMap()[id];
+            // We get the entity, NULL if there is no such entity
+            OpenIG::Base::ImageGenerator::Entity entity = _ig->getEntityMap().get(id);
             if (entity.valid())
             {
                 // We have this one if we have
@@ -937,7 +937,7 @@ struct FindSubEntitiesNodeVisitor : public osg::NodeVisitor
                     unsigned int ID = 0;
                     if (node.getUserValue("ID", ID) && ID != 0)
                     {
-                        OpenIG::Base::ImageGenerator::Entity entity = imageGenerator->getEntityMap()[ID];
+                        OpenIG::Base::ImageGenerator::Entity entity = imageGenerator->getEntityMap().get(ID);
                         if (entity.valid())
                         {
                             // We save it in the map
@@ -1010,7 +1010,7 @@ struct UpdateAileronsNodeCallback : public osg::NodeCallback
         // We get its current matrix
         osg::Matrixd aileronMx;
 
-        OpenIG::Base::ImageGenerator::Entity aileron = imageGenerator->getEntityMap()[ID];
+        OpenIG::Base::ImageGenerator::Entity aileron = imageGenerator->getEntityMap().get(ID);
         if (aileron.valid())
         {
             aileronMx = aileron->getMatrix();
@@ -1408,7 +1408,7 @@ struct HatIntersectionCallback : public OpenIG::Base::ImageGenerator::Intersecti
 		hat.clear();
 		hat.addPoint(start);
 
-		OpenIG::Base::ImageGenerator::Entity terrain = imageGenerator->getEntityMap()[TERRAIN_ENTITY_ID];
+		OpenIG::Base::ImageGenerator::Entity terrain = imageGenerator->getEntityMap().get(TERRAIN_ENTITY_ID);
 		if (terrain.valid())
 		{
 			hat.computeIntersections(terrain);
@@ -1595,7 +1595,7 @@ int main(int argc, char** argv)
     FindSubEntitiesNodeVisitor nv(names, ig);
 
     // We lookup for the a320 Entity based on the ID
-    OpenIG::Base::ImageGenerator::Entity a320 = ig->getEntityMap()[MODEL_ENTITY_ID];
+    OpenIG::Base::ImageGenerator::Entity a320 = ig->getEntityMap().get(MODEL_ENTITY_ID);
     if (a320.valid())
     {
         a320->accept(nv);
@@ -2406,7 +2406,7 @@ int main(int argc, char** argv)
                 ig->setRain(0);
                 if (trackball.valid())
                 {
-                    OpenIG::Base::ImageGenerator::Entity& entity = ig->getEntityMap()[1];
+                    OpenIG::Base::ImageGenerator::Entity entity = ig->getEntityMap().get(1);
                     if (entity.valid())
                     {
                         double radius = entity->getChild(0)->getBound().radius();
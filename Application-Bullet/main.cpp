@@ -284,7 +284,7 @@ public:
             // The enitites are stores in std::map, id based, the id
             // is the Entity ID you refer accross the whole application
             // We get a reference to the entity
-            OpenIG::Base::ImageGenerator::Entity& entity = _ig->getEntityMap()[id];
+            OpenIG::Base::ImageGenerator::Entity entity = _ig->getEntityMap().get(id);
             if (entity.valid())
             {
                 // We have this one if we have
@@ -87,7 +87,7 @@ void Animations::resetAnimation( OpenIG::Base::ImageGenerator* ig, unsigned int
         }
     }
 
-    ImageGenerator::Entity& entity = ig->getEntityMap()[entityId];
+    ImageGenerator::Entity entity = ig->getEntityMap().get(entityId);
     if (!entity.valid()) return;
 
     AnimationContainer* ac = dynamic_cast<AnimationContainer*>(entity->getUserData());
@@ -102,7 +102,7 @@ void Animations::resetAnimation( OpenIG::Base::ImageGenerator* ig, unsigned int
         Animation::Sequence* sequence = sitr->second;
         if (!sequence) continue;
 
-        ImageGenerator::Entity& submodel = ig->getEntityMap()[sequence->_playerId];
+        ImageGenerator::Entity submodel = ig->getEntityMap().get(sequence->_playerId);
         if (submodel.valid())
         {
             osg::Matrixd mx = submodel->getMatrix();
@@ -207,7 +207,7 @@ void Animations::playAnimation(OpenIG::Base::ImageGenerator* ig, unsigned int en
 		++itr;
 	}
 
-    ImageGenerator::Entity& entity = ig->getEntityMap()[entityId];
+    ImageGenerator::Entity entity = ig->getEntityMap().get(entityId);
     if (!entity.valid()) return;
 
     AnimationContainer* ac = dynamic_cast<AnimationContainer*>(entity->getUserData());
@@ -373,7 +373,7 @@ void Animations::updateAnimations(OpenIG::Base::ImageGenerator* ig)
 
 			osg::Vec3d xyz = actualPosition;
 
-            ImageGenerator::Entity& submodel = ig->getEntityMap()[sequence->_playerId];
+            ImageGenerator::Entity submodel = ig->getEntityMap().get(sequence->_playerId);
             if (submodel.valid())
             {
                 osg::Matrixd mx = submodel->getMatrix();
@@ -32,9 +32,14 @@
 //#*****************************************************************************
 
 #include "Configuration.h"
+#include "FileWatcher.h"
 
 #include <osgDB/XmlParser>
 
+#include <boost/bind.hpp>
+
+#include <algorithm>
+
 using namespace OpenIG::Base;
 
 Configuration* Configuration::instance()
@@ -56,18 +61,96 @@ bool Configuration::readFromXML(const std::string& fileName, const std::string&
     osgDB::XmlNode* config = root->children.at(0);
     if (config->name != section) return false;
 
-    osgDB::XmlNode::Children::iterator itr = config->children.begin();
-    for ( ; itr != config->children.end(); ++itr)
     {
-        osgDB::XmlNode* child = *itr;
-        _configuration[child->name] = child->contents;
+        boost::mutex::scoped_lock lock(_mutex);
+
+        osgDB::XmlNode::Children::iterator itr = config->children.begin();
+        for ( ; itr != config->children.end(); ++itr)
+        {
+            osgDB::XmlNode* child = *itr;
+            _configuration[child->name] = child->contents;
+        }
+
+        ++_revision;
+
+        Sources::value_type source(fileName, section);
+        if (std::find(_sources.begin(), _sources.end(), source) == _sources.end())
+        {
+            _sources.push_back(source);
+        }
     }
+    if (_hotReload) watch(fileName);
 
     return true;
 }
 
+void Configuration::setHotReload(bool enable)
+{
+    if (_hotReload == enable) return;
+    _hotReload = enable;
+
+    if (_hotReload)
+    {
+        Sources sources;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            sources = _sources;
+        }
+
+        Sources::iterator itr = sources.begin();
+        for ( ; itr != sources.end(); ++itr)
+        {
+            watch(itr->first);
+        }
+    }
+    else
+    {
+        Subscriptions::iterator itr = _subscriptions.begin();
+        for ( ; itr != _subscriptions.end(); ++itr)
+        {
+            FileWatcher::instance()->unsubscribe(itr->second);
+        }
+        _subscriptions.clear();
+    }
+}
+
+void Configuration::watch(const std::string& fileName)
+{
+    if (_subscriptions.count(fileName)) return;
+
+    unsigned int id = FileWatcher::instance()->subscribe(fileName, boost::bind(&Configuration::reload, this, _1));
+    if (id) _subscriptions[fileName] = id;
+}
+
+void Configuration::reload(const std::string& fileName)
+{
+    // Copied since the read can add to the sources
+    Sources sources;
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        sources = _sources;
+    }
+
+    Sources::iterator itr = sources.begin();
+    for ( ; itr != sources.end(); ++itr)
+    {
+        if (itr->first != fileName) continue;
+
+        osg::notify(osg::NOTICE) << "OpenIG: config file changed: " << fileName << std::endl;
+        readFromXML(itr->first, itr->second);
+    }
+}
+
+unsigned int Configuration::getRevision() const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _revision;
+}
+
 const std::string Configuration::getConfig(const std::string& token, const std::string value)
 {
+    boost::mutex::scoped_lock lock(_mutex);
+
     ConfigMapIterator itr = _configuration.find(token);
     if (itr != _configuration.end() && !itr->second.empty())
         return itr->second;
@@ -77,6 +160,8 @@ const std::string Configuration::getConfig(const std::string& token, const std::
 
 double Configuration::getConfig(const std::string& token, double value)
 {
+    boost::mutex::scoped_lock lock(_mutex);
+
     ConfigMapIterator itr = _configuration.find(token);
     if (itr != _configuration.end())
         return atof(itr->second.c_str());
@@ -86,6 +171,8 @@ double Configuration::getConfig(const std::string& token, double value)
 
 int Configuration::getConfig(const std::string& token, int value)
 {
+    boost::mutex::scoped_lock lock(_mutex);
+
     ConfigMapIterator itr = _configuration.find(token);
     if (itr != _configuration.end())
         return atoi(itr->second.c_str());
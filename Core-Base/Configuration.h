@@ -42,6 +42,9 @@
 
 #include <string>
 #include <map>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
 
 namespace OpenIG {
 	namespace Base {
@@ -104,10 +107,38 @@ namespace OpenIG {
 			 */
 			int                         getConfig(const std::string& token, int value = 0);
 
+			/*! When on, the files read by \ref readFromXML are watched by
+			 *  \ref OpenIG::Base::FileWatcher and their sections are read again
+			 *  on change, from the thread calling \ref OpenIG::Base::FileWatcher::dispatch.
+			 *  \ref OpenIG::Engine turns it on with Config-Hot-Reload set to yes
+			 * \brief Turns the re-reading of the changed configuration files on or off
+			 * \param enable true to turn it on
+			 */
+			void                        setHotReload(bool enable);
+
+			/*!
+			 * \brief Tells if the changed configuration files are read again
+			 * \return true if on
+			 */
+			bool                        getHotReload() const { return _hotReload; }
+
+			/*! Incremented on every successful read, so the users caching
+			 *  values can tell when to get them again
+			 * \brief The revision of the configuration
+			 * \return The revision
+			 */
+			unsigned int                getRevision() const;
+
 		protected:
-			Configuration() {}
+			Configuration() : _hotReload(false), _revision(0) {}
 			~Configuration() {}
 
+			/*! \brief Reads again the sections read from a changed file */
+			void                        reload(const std::string& fileName);
+
+			/*! \brief Watches a file read, if on */
+			void                        watch(const std::string& fileName);
+
 			typedef std::map< std::string, std::string >                    ConfigMap;
 			typedef std::map< std::string, std::string >::iterator          ConfigMapIterator;
 			typedef std::map< std::string, std::string >::const_iterator    ConfigMapConstIterator;
@@ -115,6 +146,20 @@ namespace OpenIG {
 			/*! \brief token based std::map of tag values */
 			ConfigMap   _configuration;
 
+			typedef std::vector< std::pair<std::string, std::string> >     Sources;
+			typedef std::map< std::string, unsigned int >                   Subscriptions;
+
+			/*! \brief The file and section pairs read so far */
+			Sources         _sources;
+			/*! \brief The file watch subscriptions of the files read, by file name */
+			Subscriptions   _subscriptions;
+			bool            _hotReload;
+			unsigned int    _revision;
+
+			/*! \brief Guards the values and the sources, the values are read from the
+			 *  pager and decode threads while a reload replaces them on the update */
+			mutable boost::mutex    _mutex;
+
 		};
 	} // namespace
 } // openig
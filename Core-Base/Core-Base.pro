@@ -16,11 +16,16 @@ SOURCES += \
     Animation.cpp\
     Commands.cpp\
     Configuration.cpp\
+    EntityRegistry.cpp\
+    EntityRoot.cpp\
     FileSystem.cpp\
+    FileWatcher.cpp\
     IDPool.cpp\
     ImageGenerator.cpp\
     Mathematics.cpp\
-    StringUtils.cpp
+    SceneSnapshot.cpp\
+    StringUtils.cpp\
+    ThreadPool.cpp
 
 HEADERS += \
     Animation.h\
@@ -28,13 +33,18 @@ HEADERS += \
     Commands.h\
     Config.h\
     Configuration.h\
+    EntityRegistry.h\
+    EntityRoot.h\
     Export.h\
     FileSystem.h\
+    FileWatcher.h\
     IDPool.h\
     IGCore.h\
     ImageGenerator.h\
     Mathematics.h\
-    StringUtils.h
+    SceneSnapshot.h\
+    StringUtils.h\
+    ThreadPool.h
 
 INCLUDEPATH += ../
 DEPENDPATH += ../
@@ -64,11 +74,11 @@ unix {
     BOOSTROOT = $$(BOOST_ROOT)
     isEmpty(BOOSTROOT) {
         message($$TARGET -- \"BOOST_ROOT env var\" not set...using system default paths to look for boost )
-        LIBS +=  -lboost_system -lboost_filesystem -lboost_regex
+        LIBS +=  -lboost_system -lboost_filesystem -lboost_regex -lboost_thread
     }
     else {
         message($$TARGET -- \"BOOST_ROOT env var\" detected - set to: \"$$BOOSTROOT\")
-        LIBS += -L$$BOOSTROOT/stage/lib -lboost_system -lboost_filesystem -lboost_regex
+        LIBS += -L$$BOOSTROOT/stage/lib -lboost_system -lboost_filesystem -lboost_regex -lboost_thread
         INCLUDEPATH += $$BOOSTROOT
         DEPENDPATH  += $$BOOSTROOT
     }
@@ -0,0 +1,175 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include "EntityRegistry.h"
+
+using namespace OpenIG::Base;
+
+EntityRegistry::EntityRegistry()
+{
+}
+
+EntityRegistry::Slot* EntityRegistry::findSlot(unsigned int id)
+{
+	Slot* s = 0;
+	if (id < DirectLimit)
+	{
+		if (id < _slots.size()) s = &_slots[id];
+	}
+	else
+	{
+		SparseSlots::iterator itr = _sparseSlots.find(id);
+		if (itr != _sparseSlots.end()) s = &itr->second;
+	}
+	return s && s->dense != InvalidIndex ? s : 0;
+}
+
+const EntityRegistry::Slot* EntityRegistry::findSlot(unsigned int id) const
+{
+	return const_cast<EntityRegistry*>(this)->findSlot(id);
+}
+
+EntityRegistry::Slot& EntityRegistry::slot(unsigned int id)
+{
+	if (id < DirectLimit)
+	{
+		if (id >= _slots.size()) _slots.resize(id + 1);
+		return _slots[id];
+	}
+	return _sparseSlots[id];
+}
+
+EntityRegistry::Handle EntityRegistry::insert(unsigned int id, const Entity& entity)
+{
+	Slot& s = slot(id);
+	++s.generation;
+
+	if (s.dense != InvalidIndex)
+	{
+		_entries[s.dense].second = entity;
+	}
+	else
+	{
+		s.dense = (unsigned int)_entries.size();
+		_entries.push_back(value_type(id, entity));
+	}
+
+	return Handle(id, s.generation);
+}
+
+void EntityRegistry::removeAt(Slot& s)
+{
+	unsigned int dense = s.dense;
+	unsigned int last = (unsigned int)_entries.size() - 1;
+
+	if (dense != last)
+	{
+		_entries[dense] = _entries[last];
+
+		Slot* moved = findSlot(_entries[dense].first);
+		if (moved) moved->dense = dense;
+	}
+	_entries.pop_back();
+
+	s.dense = InvalidIndex;
+	++s.generation;
+}
+
+bool EntityRegistry::remove(unsigned int id)
+{
+	Slot* s = findSlot(id);
+	if (!s) return false;
+
+	removeAt(*s);
+	return true;
+}
+
+osg::MatrixTransform* EntityRegistry::get(unsigned int id) const
+{
+	const Slot* s = findSlot(id);
+	return s ? _entries[s->dense].second.get() : 0;
+}
+
+osg::MatrixTransform* EntityRegistry::get(const Handle& handle) const
+{
+	const Slot* s = findSlot(handle.id);
+	if (!s || s->generation != handle.generation) return 0;
+
+	return _entries[s->dense].second.get();
+}
+
+EntityRegistry::Handle EntityRegistry::getHandle(unsigned int id) const
+{
+	const Slot* s = findSlot(id);
+	return s ? Handle(id, s->generation) : Handle(id, 0);
+}
+
+bool EntityRegistry::isValid(const Handle& handle) const
+{
+	const Slot* s = findSlot(handle.id);
+	return s && s->generation == handle.generation;
+}
+
+EntityRegistry::iterator EntityRegistry::find(unsigned int id)
+{
+	const Slot* s = findSlot(id);
+	return s ? _entries.begin() + s->dense : _entries.end();
+}
+
+EntityRegistry::const_iterator EntityRegistry::find(unsigned int id) const
+{
+	const Slot* s = findSlot(id);
+	return s ? _entries.begin() + s->dense : _entries.end();
+}
+
+EntityRegistry::iterator EntityRegistry::erase(iterator itr)
+{
+	size_t dense = itr - _entries.begin();
+
+	Slot* s = findSlot(itr->first);
+	if (s) removeAt(*s);
+
+	return _entries.begin() + dense;
+}
+
+void EntityRegistry::clear()
+{
+	for (Entries::iterator itr = _entries.begin(); itr != _entries.end(); ++itr)
+	{
+		Slot* s = findSlot(itr->first);
+		if (s)
+		{
+			s->dense = InvalidIndex;
+			++s->generation;
+		}
+	}
+	_entries.clear();
+}
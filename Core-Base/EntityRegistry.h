@@ -0,0 +1,188 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#ifndef ENTITYREGISTRY_H
+#define ENTITYREGISTRY_H
+
+#if defined(OPENIG_SDK)
+	#include <OpenIG-Base/Export.h>
+#else
+	#include <Core-Base/Export.h>
+#endif
+
+#include <osg/ref_ptr>
+#include <osg/MatrixTransform>
+
+#include <boost/unordered_map.hpp>
+
+#include <vector>
+#include <utility>
+
+namespace OpenIG {
+	namespace Base {
+
+		/*! Registry of the entities keyed by their ID. The entities are kept
+		 *  in a dense array for fast iteration, and the IDs are mapped to their
+		 *  place in the array through a sparse slot table, so lookups, inserts
+		 *  and removals are O(1). Every slot carries a generation that is bumped
+		 *  each time the ID is added or removed, so a \ref Handle taken earlier
+		 *  can be checked for staleness.
+		 *
+		 *  The interface mimics the std::map it replaces: the iterators point to
+		 *  std::pair<unsigned int, Entity> so itr->first and itr->second work as
+		 *  before. Differences to be aware of: the iteration order is NOT sorted
+		 *  by ID (removal moves the last entity in the removed place), and
+		 *  operator[] returns a copy and never inserts
+		 * \brief Dense, generation checked registry of entities
+		 */
+		class IGCORE_EXPORT EntityRegistry
+		{
+		public:
+			typedef osg::ref_ptr<osg::MatrixTransform>		Entity;
+			typedef std::pair<unsigned int, Entity>			value_type;
+			typedef std::vector<value_type>					Entries;
+			typedef Entries::iterator						iterator;
+			typedef Entries::const_iterator					const_iterator;
+			typedef Entries::size_type						size_type;
+
+			/*! An ID and the generation of its slot at the time the handle
+			 *  was taken. Stays cheap to resolve and detects removed or
+			 *  replaced entities
+			 * \brief Generation checked entity handle
+			 */
+			struct Handle
+			{
+				unsigned int	id;
+				unsigned int	generation;
+
+				Handle() : id(0), generation(0) {}
+				Handle(unsigned int i, unsigned int g) : id(i), generation(g) {}
+			};
+
+			EntityRegistry();
+
+			/*!
+			 * \brief Adds an entity, or replaces the one with the same ID
+			 * \param id		The entity ID
+			 * \param entity	The entity
+			 * \return			Handle to the entity
+			 */
+			Handle insert(unsigned int id, const Entity& entity);
+
+			/*!
+			 * \brief Removes an entity
+			 * \param id		The entity ID
+			 * \return			true if there was an entity with this ID
+			 */
+			bool remove(unsigned int id);
+
+			/*!
+			 * \brief Finds an entity
+			 * \param id		The entity ID
+			 * \return			The entity, NULL if there is no entity with this ID
+			 */
+			osg::MatrixTransform* get(unsigned int id) const;
+
+			/*!
+			 * \brief Resolves a handle
+			 * \param handle	The handle
+			 * \return			The entity, NULL if the entity was removed or replaced since the handle was taken
+			 */
+			osg::MatrixTransform* get(const Handle& handle) const;
+
+			/*!
+			 * \brief Gets a handle to an entity
+			 * \param id		The entity ID
+			 * \return			The handle. Invalid one (see \ref isValid) if there is no entity with this ID
+			 */
+			Handle getHandle(unsigned int id) const;
+
+			/*!
+			 * \brief Checks if a handle still points to the same entity
+			 * \param handle	The handle
+			 * \return			true if the handle is valid
+			 */
+			bool isValid(const Handle& handle) const;
+
+			// std::map like interface
+			iterator		begin()			{ return _entries.begin(); }
+			iterator		end()			{ return _entries.end(); }
+			const_iterator	begin() const	{ return _entries.begin(); }
+			const_iterator	end() const		{ return _entries.end(); }
+
+			size_type		size() const	{ return _entries.size(); }
+			bool			empty() const	{ return _entries.empty(); }
+			size_type		count(unsigned int id) const { return findSlot(id) ? 1 : 0; }
+
+			iterator		find(unsigned int id);
+			const_iterator	find(unsigned int id) const;
+
+			/*! Removes the entity the iterator points to. The last entity is
+			 *  moved in its place, so the returned iterator (same position)
+			 *  points to the next entity to visit
+			 */
+			iterator		erase(iterator itr);
+			size_type		erase(unsigned int id) { return remove(id) ? 1 : 0; }
+			void			clear();
+
+			/*! Returns the entity or NULL. Unlike std::map it does not insert */
+			Entity			operator[](unsigned int id) const { return get(id); }
+
+		protected:
+			struct Slot
+			{
+				unsigned int	dense;
+				unsigned int	generation;
+
+				Slot() : dense(InvalidIndex), generation(0) {}
+			};
+
+			typedef std::vector<Slot>								Slots;
+			typedef boost::unordered_map<unsigned int, Slot>		SparseSlots;
+
+			// IDs below this go in the direct table, the rest in the hash map
+			static const unsigned int DirectLimit = 1 << 20;
+			static const unsigned int InvalidIndex = 0xFFFFFFFF;
+
+			Slot*		findSlot(unsigned int id);
+			const Slot*	findSlot(unsigned int id) const;
+			Slot&		slot(unsigned int id);
+
+			void		removeAt(Slot& s);
+
+			Entries		_entries;
+			Slots		_slots;
+			SparseSlots	_sparseSlots;
+		};
+	} // namespace
+} // namespace
+
+#endif // ENTITYREGISTRY_H
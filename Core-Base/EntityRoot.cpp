@@ -0,0 +1,558 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include "EntityRoot.h"
+
+#include <osg/Notify>
+#include <osg/CullingSet>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace OpenIG::Base;
+
+EntityRoot::EntityRoot(double halfSize, unsigned int maxDepth)
+	: osg::Group()
+	, _halfSize(halfSize)
+	, _maxDepth(maxDepth)
+	, _cellCullingEnabled(true)
+{
+	rebuild();
+}
+
+EntityRoot::EntityRoot(const EntityRoot& root, const osg::CopyOp& copyop)
+	: osg::Group(root, copyop)
+	, _halfSize(root._halfSize)
+	, _maxDepth(root._maxDepth)
+	, _cellCullingEnabled(root._cellCullingEnabled)
+{
+	// osg::Group copied the children with its own addChild,
+	// so build the octree now
+	rebuild();
+}
+
+EntityRoot::~EntityRoot()
+{
+}
+
+void EntityRoot::rebuild()
+{
+	_items.clear();
+	_freeItems.clear();
+	_lookup.clear();
+	_movedItems.clear();
+	_cells.clear();
+	_freeCells.clear();
+	_alwaysVisited.clear();
+
+	allocateCell(osg::Vec3d(0.0, 0.0, 0.0), _halfSize, 0, InvalidIndex);
+
+	for (unsigned int i = 0; i < _children.size(); ++i)
+	{
+		addItem(_children.at(i).get(), i);
+	}
+}
+
+unsigned int EntityRoot::allocateCell(const osg::Vec3d& center, double halfSize, unsigned int depth, unsigned int parent)
+{
+	unsigned int index = 0;
+	if (_freeCells.size())
+	{
+		index = _freeCells.back();
+		_freeCells.pop_back();
+	}
+	else
+	{
+		index = (unsigned int)_cells.size();
+		_cells.push_back(Cell());
+	}
+
+	// Loose cell, twice the size of the cell. Anything
+	// centered in the cell and with radius up to the
+	// cell half size fits in it
+	Cell& cell = _cells.at(index);
+	cell.center = center;
+	cell.halfSize = halfSize;
+	cell.looseBox.set(
+		center - osg::Vec3d(halfSize, halfSize, halfSize) * 2.0,
+		center + osg::Vec3d(halfSize, halfSize, halfSize) * 2.0
+	);
+	cell.depth = depth;
+	cell.parent = parent;
+	cell.count = 0;
+	cell.items.clear();
+	for (unsigned int i = 0; i < 8; ++i)
+	{
+		cell.children[i] = InvalidIndex;
+	}
+
+	return index;
+}
+
+void EntityRoot::freeCell(unsigned int index)
+{
+	for (unsigned int i = 0; i < 8; ++i)
+	{
+		unsigned int child = _cells.at(index).children[i];
+		if (child != InvalidIndex)
+		{
+			freeCell(child);
+		}
+	}
+	_freeCells.push_back(index);
+}
+
+void EntityRoot::addItem(osg::Node* node, unsigned int childIndex)
+{
+	unsigned int index = 0;
+	if (_freeItems.size())
+	{
+		index = _freeItems.back();
+		_freeItems.pop_back();
+	}
+	else
+	{
+		index = (unsigned int)_items.size();
+		_items.push_back(Item());
+	}
+
+	Item& item = _items.at(index);
+	item.node = node;
+	item.childIndex = childIndex;
+	item.bound = node->getBound();
+	item.moved = false;
+
+	_lookup[node] = index;
+
+	link(index);
+}
+
+void EntityRoot::removeItem(const osg::Node* node)
+{
+	ItemLookup::iterator itr = _lookup.find(node);
+	if (itr == _lookup.end()) return;
+
+	unsigned int index = itr->second;
+	_lookup.erase(itr);
+
+	unlink(index);
+
+	Item& item = _items.at(index);
+	item.node = 0;
+	item.moved = false;
+
+	_freeItems.push_back(index);
+}
+
+void EntityRoot::reindexChildren(unsigned int from)
+{
+	for (unsigned int i = from; i < _children.size(); ++i)
+	{
+		ItemLookup::iterator itr = _lookup.find(_children.at(i).get());
+		if (itr != _lookup.end())
+		{
+			_items.at(itr->second).childIndex = i;
+		}
+	}
+}
+
+void EntityRoot::link(unsigned int index)
+{
+	Item& item = _items.at(index);
+	const osg::BoundingSphere& bs = item.bound;
+
+	const Cell& root = _cells.at(0);
+	const osg::Vec3d d = bs.center() - root.center;
+
+	if (!bs.valid() || bs.radius() > root.halfSize ||
+		fabs(d.x()) > root.halfSize || fabs(d.y()) > root.halfSize || fabs(d.z()) > root.halfSize)
+	{
+		item.cell = InvalidIndex;
+		item.slot = (unsigned int)_alwaysVisited.size();
+		_alwaysVisited.push_back(index);
+		return;
+	}
+
+	// Go down the existing cells as long as the bound fits in the
+	// loose child cell. New cells are made only when a cell gets
+	// crowded, so sparse entities do not end up at the bottom of
+	// long chains of cells
+	unsigned int cell = 0;
+	while (_cells.at(cell).depth < _maxDepth && bs.radius() <= _cells.at(cell).halfSize * 0.5)
+	{
+		unsigned int child = childCell(cell, bs.center(), false);
+		if (child == InvalidIndex) break;
+
+		cell = child;
+	}
+
+	item.cell = cell;
+	item.slot = (unsigned int)_cells.at(cell).items.size();
+	_cells.at(cell).items.push_back(index);
+
+	for (unsigned int c = cell; c != InvalidIndex; c = _cells.at(c).parent)
+	{
+		++_cells.at(c).count;
+	}
+
+	if (_cells.at(cell).items.size() > SplitThreshold)
+	{
+		split(cell);
+	}
+}
+
+unsigned int EntityRoot::childCell(unsigned int cell, const osg::Vec3d& position, bool create)
+{
+	const osg::Vec3d center = _cells.at(cell).center;
+	const double childHalfSize = _cells.at(cell).halfSize * 0.5;
+
+	unsigned int octant = 0;
+	osg::Vec3d offset(-childHalfSize, -childHalfSize, -childHalfSize);
+	if (position.x() >= center.x()) { octant |= 1; offset.x() = childHalfSize; }
+	if (position.y() >= center.y()) { octant |= 2; offset.y() = childHalfSize; }
+	if (position.z() >= center.z()) { octant |= 4; offset.z() = childHalfSize; }
+
+	unsigned int child = _cells.at(cell).children[octant];
+	if (child == InvalidIndex && create)
+	{
+		child = allocateCell(center + offset, childHalfSize, _cells.at(cell).depth + 1, cell);
+		_cells.at(cell).children[octant] = child;
+	}
+	return child;
+}
+
+void EntityRoot::split(unsigned int cell)
+{
+	if (_cells.at(cell).depth >= _maxDepth) return;
+
+	// Push down the items that fit in the child cells. The count
+	// of this cell and above does not change
+	const double childHalfSize = _cells.at(cell).halfSize * 0.5;
+
+	size_t i = 0;
+	while (i < _cells.at(cell).items.size())
+	{
+		unsigned int index = _cells.at(cell).items.at(i);
+		if (_items.at(index).bound.radius() > childHalfSize)
+		{
+			++i;
+			continue;
+		}
+
+		unsigned int last = _cells.at(cell).items.back();
+		_cells.at(cell).items.at(i) = last;
+		_items.at(last).slot = (unsigned int)i;
+		_cells.at(cell).items.pop_back();
+
+		unsigned int child = childCell(cell, _items.at(index).bound.center(), true);
+
+		Item& item = _items.at(index);
+		item.cell = child;
+		item.slot = (unsigned int)_cells.at(child).items.size();
+		_cells.at(child).items.push_back(index);
+		++_cells.at(child).count;
+	}
+
+	for (unsigned int c = 0; c < 8; ++c)
+	{
+		unsigned int child = _cells.at(cell).children[c];
+		if (child != InvalidIndex && _cells.at(child).items.size() > SplitThreshold)
+		{
+			split(child);
+		}
+	}
+}
+
+void EntityRoot::unlink(unsigned int index)
+{
+	Item& item = _items.at(index);
+
+	std::vector<unsigned int>& list = item.cell != InvalidIndex ? _cells.at(item.cell).items : _alwaysVisited;
+
+	unsigned int last = list.back();
+	list.at(item.slot) = last;
+	_items.at(last).slot = item.slot;
+	list.pop_back();
+
+	if (item.cell == InvalidIndex) return;
+
+	// The counts only grow towards the root, so the empty
+	// cells are all below the top most empty one
+	unsigned int topEmpty = InvalidIndex;
+	for (unsigned int cell = item.cell; cell != InvalidIndex; cell = _cells.at(cell).parent)
+	{
+		if (--_cells.at(cell).count == 0 && cell != 0)
+		{
+			topEmpty = cell;
+		}
+	}
+
+	if (topEmpty != InvalidIndex)
+	{
+		Cell& parent = _cells.at(_cells.at(topEmpty).parent);
+		for (unsigned int i = 0; i < 8; ++i)
+		{
+			if (parent.children[i] == topEmpty) parent.children[i] = InvalidIndex;
+		}
+		freeCell(topEmpty);
+	}
+
+	item.cell = InvalidIndex;
+}
+
+bool EntityRoot::isPlacementValid(const Item& item) const
+{
+	const osg::BoundingSphere& bs = item.bound;
+	if (item.cell == InvalidIndex || !bs.valid()) return false;
+
+	// Still in the loose cell. It might fit deeper now,
+	// which costs a bit of culling but saves re-binning
+	const Cell& cell = _cells.at(item.cell);
+	if (bs.radius() > cell.halfSize) return false;
+
+	const osg::Vec3d d = bs.center() - cell.center;
+	return fabs(d.x()) <= cell.halfSize && fabs(d.y()) <= cell.halfSize && fabs(d.z()) <= cell.halfSize;
+}
+
+osg::BoundingSphere EntityRoot::computeBound() const
+{
+	// osg calls this once a child bound got dirty, and it
+	// has to walk all the children anyway. We note here
+	// the children that moved and re-bin them in commit
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		for (size_t i = 0; i < _items.size(); ++i)
+		{
+			Item& item = _items.at(i);
+			if (!item.node) continue;
+
+			const osg::BoundingSphere& bs = item.node->getBound();
+			if (bs != item.bound)
+			{
+				item.bound = bs;
+				if (!item.moved)
+				{
+					item.moved = true;
+					_movedItems.push_back((unsigned int)i);
+				}
+			}
+		}
+	}
+
+	return osg::Group::computeBound();
+}
+
+void EntityRoot::commit()
+{
+	getBound();
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	for (size_t i = 0; i < _movedItems.size(); ++i)
+	{
+		unsigned int index = _movedItems.at(i);
+
+		Item& item = _items.at(index);
+		if (!item.node || !item.moved) continue;
+
+		item.moved = false;
+
+		// Items in the always visited list are re-linked
+		// too in case they fit in the octree now
+		if (!isPlacementValid(item))
+		{
+			unlink(index);
+			link(index);
+		}
+	}
+	_movedItems.clear();
+}
+
+void EntityRoot::cull(osg::NodeVisitor& nv, osg::CullStack& cs, unsigned int index)
+{
+	const Cell& cell = _cells.at(index);
+	if (cell.count == 0) return;
+
+	osg::CullingSet& cullingSet = cs.getCurrentCullingSet();
+	if (cullingSet.isCulled(cell.looseBox)) return;
+
+	// The planes the cell is fully inside are
+	// not tested again for the cell content
+	cullingSet.pushCurrentMask();
+
+	for (size_t i = 0; i < cell.items.size(); ++i)
+	{
+		_items[cell.items[i]].node->accept(nv);
+	}
+
+	for (unsigned int i = 0; i < 8; ++i)
+	{
+		if (cell.children[i] != InvalidIndex)
+		{
+			cull(nv, cs, cell.children[i]);
+		}
+	}
+
+	cullingSet.popCurrentMask();
+}
+
+void EntityRoot::traverse(osg::NodeVisitor& nv)
+{
+	if (_cellCullingEnabled && nv.getVisitorType() == osg::NodeVisitor::CULL_VISITOR)
+	{
+		// The octree is only changed from the update, in commit. Several cull
+		// threads may read it at once, so with children moved since the last
+		// commit the cull does not re-bin them but visits all the children
+		bool committed = false;
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+			committed = _movedItems.empty();
+		}
+
+		osg::CullStack* cs = dynamic_cast<osg::CullStack*>(&nv);
+		if (cs && committed)
+		{
+			for (size_t i = 0; i < _alwaysVisited.size(); ++i)
+			{
+				_items[_alwaysVisited[i]].node->accept(nv);
+			}
+
+			cull(nv, *cs, 0);
+			return;
+		}
+	}
+
+	osg::Group::traverse(nv);
+}
+
+bool EntityRoot::addChild(osg::Node* child)
+{
+	return insertChild((unsigned int)_children.size(), child);
+}
+
+bool EntityRoot::insertChild(unsigned int index, osg::Node* child)
+{
+	if (!child) return false;
+
+	if (_lookup.count(child))
+	{
+		osg::notify(osg::NOTICE) << "OpenIG: EntityRoot: " << child->getName() << " is already a child" << std::endl;
+		return false;
+	}
+
+	if (index > _children.size()) index = (unsigned int)_children.size();
+
+	if (!osg::Group::insertChild(index, child)) return false;
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	reindexChildren(index + 1);
+	addItem(child, index);
+
+	return true;
+}
+
+bool EntityRoot::removeChild(osg::Node* child)
+{
+	ItemLookup::iterator itr = _lookup.find(child);
+	if (itr == _lookup.end()) return false;
+
+	// Swap it with the last child so osg::Group
+	// removes from the back and nothing moves
+	unsigned int pos = _items.at(itr->second).childIndex;
+	unsigned int last = (unsigned int)_children.size() - 1;
+	if (pos != last)
+	{
+		std::swap(_children[pos], _children[last]);
+
+		_items.at(_lookup[_children[pos].get()]).childIndex = pos;
+		_items.at(itr->second).childIndex = last;
+	}
+
+	return removeChildren(last, 1);
+}
+
+bool EntityRoot::removeChildren(unsigned int pos, unsigned int numChildrenToRemove)
+{
+	if (pos >= _children.size() || numChildrenToRemove == 0) return false;
+
+	unsigned int end = osg::minimum(pos + numChildrenToRemove, (unsigned int)_children.size());
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		for (unsigned int i = pos; i < end; ++i)
+		{
+			removeItem(_children.at(i).get());
+		}
+	}
+
+	bool result = osg::Group::removeChildren(pos, numChildrenToRemove);
+
+	boost::mutex::scoped_lock lock(_mutex);
+	reindexChildren(pos);
+
+	return result;
+}
+
+bool EntityRoot::replaceChild(osg::Node* origChild, osg::Node* newChild)
+{
+	if (!newChild || origChild == newChild) return false;
+
+	ItemLookup::iterator itr = _lookup.find(origChild);
+	if (itr == _lookup.end()) return false;
+
+	return setChild(_items.at(itr->second).childIndex, newChild);
+}
+
+bool EntityRoot::setChild(unsigned int i, osg::Node* node)
+{
+	if (i >= _children.size() || !node) return false;
+	if (_children.at(i).get() == node) return true;
+
+	if (_lookup.count(node))
+	{
+		osg::notify(osg::NOTICE) << "OpenIG: EntityRoot: " << node->getName() << " is already a child" << std::endl;
+		return false;
+	}
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		removeItem(_children.at(i).get());
+	}
+
+	osg::Group::setChild(i, node);
+
+	boost::mutex::scoped_lock lock(_mutex);
+	addItem(node, i);
+
+	return true;
+}
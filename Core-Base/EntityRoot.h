@@ -0,0 +1,181 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#ifndef ENTITYROOT_H
+#define ENTITYROOT_H
+
+#if defined(OPENIG_SDK)
+	#include <OpenIG-Base/Export.h>
+#else
+	#include <Core-Base/Export.h>
+#endif
+
+#include <osg/Group>
+#include <osg/BoundingBox>
+#include <osg/BoundingSphere>
+#include <osg/CullStack>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <vector>
+
+namespace OpenIG {
+	namespace Base {
+
+		/*! Group for the top level entities that keeps its children in a loose
+		 *  octree. The cull traversal tests the octree cells against the view
+		 *  frustum and skips the whole cell, with all the entities in it, when the
+		 *  cell is out. All other traversals visit the children as osg::Group does.
+		 *
+		 *  The children are still regular osg::Group children, so the parent lists,
+		 *  node paths and visitors keep working. Removing a child is O(1): the
+		 *  child is swapped with the last one before it is removed, so the order
+		 *  of the children is not preserved.
+		 *
+		 *  Moving entities are picked up in \ref computeBound, which osg calls
+		 *  anyway once a child bound gets dirty (ex. setMatrix on the entity). The
+		 *  children with changed bound are re-binned in \ref commit, which the
+		 *  Engine calls once the update is done. Until then the cull traversal
+		 *  visits all the children, as osg::Group does
+		 * \brief Spatially partitioned root for the entities
+		 */
+		class IGCORE_EXPORT EntityRoot : public osg::Group
+		{
+		public:
+			/*!
+			 * \brief Constructor
+			 * \param halfSize	Half size of the root cell. The default covers the whole earth in geocentric coordinates
+			 * \param maxDepth	Maximum depth of the octree. The cells at the maximum depth have a half size of halfSize / 2^maxDepth
+			 */
+			EntityRoot(double halfSize = 8388608.0, unsigned int maxDepth = 20);
+			EntityRoot(const EntityRoot& root, const osg::CopyOp& copyop = osg::CopyOp::SHALLOW_COPY);
+
+			META_Node(OpenIG, EntityRoot);
+
+			virtual void traverse(osg::NodeVisitor& nv);
+
+			using osg::Group::insertChild;
+			using osg::Group::removeChild;
+			using osg::Group::setChild;
+
+			virtual bool addChild(osg::Node* child);
+			virtual bool insertChild(unsigned int index, osg::Node* child);
+			virtual bool removeChild(osg::Node* child);
+			virtual bool removeChildren(unsigned int pos, unsigned int numChildrenToRemove);
+			virtual bool replaceChild(osg::Node* origChild, osg::Node* newChild);
+			virtual bool setChild(unsigned int i, osg::Node* node);
+
+			virtual osg::BoundingSphere computeBound() const;
+
+			/*!
+			 * \brief Re-bins the children that have moved since the last call. Call it from the
+			 *		  update, never while the scene is culled. The Engine calls it every frame
+			 */
+			void commit();
+
+			/*!
+			 * \brief Turns the cell culling on/off. When off the cull traversal is the same as osg::Group's
+			 * \param enabled	On/off
+			 */
+			void setCellCullingEnabled(bool enabled) { _cellCullingEnabled = enabled; }
+			bool getCellCullingEnabled() const { return _cellCullingEnabled; }
+
+			/*! Number of octree cells in use, for stats */
+			unsigned int getNumCells() const { return (unsigned int)(_cells.size() - _freeCells.size()); }
+
+		protected:
+			virtual ~EntityRoot();
+
+			static const unsigned int InvalidIndex = 0xFFFFFFFF;
+			// Items a cell takes before it gets child cells
+			static const unsigned int SplitThreshold = 8;
+
+			struct Item
+			{
+				osg::Node*				node;		// owned by _children
+				unsigned int			childIndex;
+				unsigned int			cell;		// InvalidIndex means it is in _alwaysVisited
+				unsigned int			slot;		// position in the cell item list
+				osg::BoundingSphere		bound;
+				bool					moved;
+			};
+
+			struct Cell
+			{
+				osg::Vec3d					center;
+				double						halfSize;
+				osg::BoundingBox			looseBox;
+				unsigned int				depth;
+				unsigned int				parent;
+				unsigned int				children[8];
+				unsigned int				count;		// items in this cell and below
+				std::vector<unsigned int>	items;
+			};
+
+			typedef boost::unordered_map<const osg::Node*, unsigned int>	ItemLookup;
+
+			void			rebuild();
+			void			addItem(osg::Node* node, unsigned int childIndex);
+			void			removeItem(const osg::Node* node);
+			void			reindexChildren(unsigned int from);
+
+			void			link(unsigned int item);
+			void			unlink(unsigned int item);
+			bool			isPlacementValid(const Item& item) const;
+
+			unsigned int	childCell(unsigned int cell, const osg::Vec3d& position, bool create);
+			void			split(unsigned int cell);
+
+			unsigned int	allocateCell(const osg::Vec3d& center, double halfSize, unsigned int depth, unsigned int parent);
+			void			freeCell(unsigned int cell);
+
+			void			cull(osg::NodeVisitor& nv, osg::CullStack& cs, unsigned int cell);
+
+			double							_halfSize;
+			unsigned int					_maxDepth;
+			bool							_cellCullingEnabled;
+
+			mutable std::vector<Item>		_items;
+			std::vector<unsigned int>		_freeItems;
+			ItemLookup						_lookup;
+			mutable std::vector<unsigned int> _movedItems;
+
+			std::vector<Cell>				_cells;
+			std::vector<unsigned int>		_freeCells;
+			std::vector<unsigned int>		_alwaysVisited;	// no valid bound, or out of the root cell
+
+			mutable boost::mutex			_mutex;
+		};
+	} // namespace
+} // namespace
+
+#endif // ENTITYROOT_H
@@ -0,0 +1,382 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#include "FileWatcher.h"
+
+#include <osg/Notify>
+
+#include <osgDB/FileNameUtils>
+#include <osgDB/FileUtils>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include <vector>
+
+#if defined(__linux)
+	#include <sys/inotify.h>
+	#include <poll.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+#endif
+
+using namespace OpenIG::Base;
+
+namespace
+{
+	std::time_t lastWriteTimeOf(const std::string& path)
+	{
+		boost::system::error_code ec;
+		std::time_t t = boost::filesystem::last_write_time(path, ec);
+		return ec ? 0 : t;
+	}
+
+	std::string directoryOf(const std::string& fileName)
+	{
+		std::string directory = osgDB::getFilePath(fileName);
+		if (directory.empty()) directory = ".";
+
+		return osgDB::getRealPath(directory);
+	}
+}
+
+FileWatcher* FileWatcher::instance()
+{
+	static FileWatcher s_watcher;
+	return &s_watcher;
+}
+
+FileWatcher::FileWatcher()
+	: _done(false)
+	, _nextID(1)
+	, _inotifyFd(-1)
+{
+	_wakeFds[0] = _wakeFds[1] = -1;
+
+#if defined(__linux)
+	_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (_inotifyFd >= 0 && pipe2(_wakeFds, O_NONBLOCK | O_CLOEXEC) != 0)
+	{
+		close(_inotifyFd);
+		_inotifyFd = -1;
+	}
+	if (_inotifyFd < 0)
+	{
+		osg::notify(osg::NOTICE) << "OpenIG: FileWatcher: inotify not available, polling the files" << std::endl;
+	}
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_done = true;
+	}
+	_condition.notify_all();
+
+#if defined(__linux)
+	if (_wakeFds[1] >= 0)
+	{
+		char c = 0;
+		if (write(_wakeFds[1], &c, 1) < 0) {}
+	}
+#endif
+
+	if (_thread.get())
+	{
+		_thread->join();
+		_thread.reset();
+	}
+
+#if defined(__linux)
+	if (_inotifyFd >= 0) close(_inotifyFd);
+	if (_wakeFds[0] >= 0) close(_wakeFds[0]);
+	if (_wakeFds[1] >= 0) close(_wakeFds[1]);
+#endif
+}
+
+void FileWatcher::startThread()
+{
+	if (_thread.get()) return;
+
+	if (usesInotify())
+		_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&FileWatcher::inotifyWatcher, this)));
+	else
+		_thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&FileWatcher::pollingWatcher, this)));
+}
+
+FileWatcher::SubscriptionID FileWatcher::subscribe(const std::string& fileName, const Callback& callback)
+{
+	if (fileName.empty() || !callback) return 0;
+
+	std::string directory = directoryOf(fileName);
+	std::string path = osgDB::concatPaths(directory, osgDB::getSimpleFileName(fileName));
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	if (_done) return 0;
+
+	if (usesInotify())
+	{
+		addDirectory(directory);
+	}
+
+	WatchedFiles::iterator itr = _files.find(path);
+	if (itr == _files.end())
+	{
+		WatchedFile file;
+		file.refCount = 0;
+		file.lastWriteTime = usesInotify() ? 0 : lastWriteTimeOf(path);
+
+		itr = _files.insert(std::make_pair(path, file)).first;
+	}
+	++itr->second.refCount;
+
+	SubscriptionID id = _nextID++;
+
+	Subscription& subscription = _subscriptions[id];
+	subscription.fileName = fileName;
+	subscription.path = path;
+	subscription.callback = callback;
+
+	startThread();
+
+	return id;
+}
+
+void FileWatcher::unsubscribe(SubscriptionID id)
+{
+	boost::mutex::scoped_lock lock(_mutex);
+
+	Subscriptions::iterator itr = _subscriptions.find(id);
+	if (itr == _subscriptions.end()) return;
+
+	WatchedFiles::iterator fitr = _files.find(itr->second.path);
+	if (fitr != _files.end() && --fitr->second.refCount == 0)
+	{
+		_files.erase(fitr);
+		_changed.erase(itr->second.path);
+
+		if (usesInotify())
+		{
+			removeDirectory(directoryOf(itr->second.path));
+		}
+	}
+
+	_subscriptions.erase(itr);
+}
+
+unsigned int FileWatcher::dispatch()
+{
+	std::vector<SubscriptionID> ids;
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		if (_changed.empty()) return 0;
+
+		Subscriptions::iterator itr = _subscriptions.begin();
+		for (; itr != _subscriptions.end(); ++itr)
+		{
+			if (_changed.count(itr->second.path)) ids.push_back(itr->first);
+		}
+		_changed.clear();
+	}
+
+	unsigned int numCalled = 0;
+
+	// The callbacks are called without the lock held so they can
+	// subscribe and unsubscribe. A subscription removed by one of
+	// them is looked up again and skipped
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		std::string fileName;
+		Callback callback;
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+
+			Subscriptions::iterator itr = _subscriptions.find(ids[i]);
+			if (itr == _subscriptions.end()) continue;
+
+			fileName = itr->second.fileName;
+			callback = itr->second.callback;
+		}
+
+		try
+		{
+			callback(fileName);
+			++numCalled;
+		}
+		catch (const std::exception& e)
+		{
+			osg::notify(osg::NOTICE) << "OpenIG: FileWatcher: exception while handling the change of " << fileName << ": " << e.what() << std::endl;
+		}
+	}
+
+	return numCalled;
+}
+
+void FileWatcher::addDirectory(const std::string& directory)
+{
+#if defined(__linux)
+	WatchedDirectories::iterator itr = _directories.find(directory);
+	if (itr != _directories.end())
+	{
+		++itr->second.refCount;
+		return;
+	}
+
+	int wd = inotify_add_watch(_inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (wd < 0)
+	{
+		osg::notify(osg::NOTICE) << "OpenIG: FileWatcher: failed to watch " << directory << std::endl;
+	}
+
+	WatchedDirectory watched;
+	watched.refCount = 1;
+	watched.wd = wd;
+
+	_directories[directory] = watched;
+	if (wd >= 0) _watchDescriptors[wd] = directory;
+#endif
+}
+
+void FileWatcher::removeDirectory(const std::string& directory)
+{
+#if defined(__linux)
+	WatchedDirectories::iterator itr = _directories.find(directory);
+	if (itr == _directories.end() || --itr->second.refCount > 0) return;
+
+	if (itr->second.wd >= 0)
+	{
+		inotify_rm_watch(_inotifyFd, itr->second.wd);
+		_watchDescriptors.erase(itr->second.wd);
+	}
+	_directories.erase(itr);
+#endif
+}
+
+void FileWatcher::inotifyWatcher()
+{
+#if defined(__linux)
+	// Big enough for a good number of events at once,
+	// aligned as the kernel writes inotify_event records
+	union
+	{
+		char			bytes[16 * 1024];
+		inotify_event	event;
+	} buffer;
+
+	while (true)
+	{
+		pollfd fds[2];
+		fds[0].fd = _inotifyFd;
+		fds[0].events = POLLIN;
+		fds[0].revents = 0;
+		fds[1].fd = _wakeFds[0];
+		fds[1].events = POLLIN;
+		fds[1].revents = 0;
+
+		int result = poll(fds, 2, -1);
+		if (result < 0 && errno != EINTR) break;
+
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+			if (_done) break;
+		}
+
+		if (result <= 0 || (fds[0].revents & POLLIN) == 0) continue;
+
+		ssize_t length = 0;
+		while ((length = read(_inotifyFd, buffer.bytes, sizeof(buffer.bytes))) > 0)
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+
+			for (char* ptr = buffer.bytes; ptr < buffer.bytes + length; )
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+				ptr += sizeof(inotify_event) + event->len;
+
+				if (event->mask & IN_IGNORED)
+				{
+					// The directory went away
+					_watchDescriptors.erase(event->wd);
+					continue;
+				}
+
+				if (event->len == 0) continue;
+
+				WatchDescriptors::iterator itr = _watchDescriptors.find(event->wd);
+				if (itr == _watchDescriptors.end()) continue;
+
+				std::string path = osgDB::concatPaths(itr->second, event->name);
+				if (_files.count(path)) _changed.insert(path);
+			}
+		}
+	}
+#endif
+}
+
+void FileWatcher::pollingWatcher()
+{
+	boost::mutex::scoped_lock lock(_mutex);
+
+	while (!_done)
+	{
+		_condition.timed_wait(lock, boost::posix_time::milliseconds(500));
+		if (_done) break;
+
+		std::vector<std::string> paths;
+		for (WatchedFiles::iterator itr = _files.begin(); itr != _files.end(); ++itr)
+		{
+			paths.push_back(itr->first);
+		}
+
+		// Stat the files without holding the lock
+		std::vector<std::time_t> times(paths.size());
+		lock.unlock();
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			times[i] = lastWriteTimeOf(paths[i]);
+		}
+		lock.lock();
+
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			WatchedFiles::iterator itr = _files.find(paths[i]);
+			if (itr == _files.end() || itr->second.lastWriteTime == times[i]) continue;
+
+			itr->second.lastWriteTime = times[i];
+			_changed.insert(paths[i]);
+		}
+	}
+}
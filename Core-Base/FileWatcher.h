@@ -0,0 +1,159 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#if defined(OPENIG_SDK)
+	#include <OpenIG-Base/Export.h>
+#else
+	#include <Core-Base/Export.h>
+#endif
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <ctime>
+#include <map>
+#include <set>
+#include <string>
+
+namespace OpenIG {
+	namespace Base {
+
+		/*! Watches files for changes on a single thread shared by the whole
+		 *  process. On Linux it is built on inotify and watches the directories
+		 *  of the subscribed files, elsewhere (or if inotify is not available) it
+		 *  polls the last write time of the files twice a second. The changes are
+		 *  coalesced and the callbacks are called from \ref dispatch, which
+		 *  \ref OpenIG::Engine calls once per frame before the plugins update
+		 * \brief Shared file change notification service
+		 */
+		class IGCORE_EXPORT FileWatcher
+		{
+		public:
+			typedef boost::function<void(const std::string&)>	Callback;
+			typedef unsigned int								SubscriptionID;
+
+			/*!
+			 * \brief The singleton
+			 * \return The singleton
+			 */
+			static FileWatcher* instance();
+
+			FileWatcher();
+			~FileWatcher();
+
+			/*! Subscribes for changes of a file. The file does not have to
+			 *  exist yet, but its directory does. Safe to call from any thread,
+			 *  the watching thread is started on the first subscription
+			 * \brief Subscribes for changes of a file
+			 * \param fileName	The file to watch
+			 * \param callback	Called from \ref dispatch with the given file name when it has changed
+			 * \return The subscription ID, 0 on failure
+			 */
+			SubscriptionID subscribe(const std::string& fileName, const Callback& callback);
+
+			/*! Removes a subscription. The callback is not called after this
+			 *  returns, even for a change already seen by the watching thread
+			 * \brief Removes a subscription
+			 * \param id	The subscription ID returned by \ref subscribe
+			 */
+			void unsubscribe(SubscriptionID id);
+
+			/*! Calls the callbacks of the files changed since the last call,
+			 *  once per subscription no matter how many times the file was
+			 *  written in between. Meant to be called from the update thread
+			 * \brief Calls the callbacks of the changed files
+			 * \return Number of callbacks called
+			 */
+			unsigned int dispatch();
+
+			/*!
+			 * \brief Tells if the changes are notified by inotify or by polling
+			 * \return true if inotify is used
+			 */
+			bool usesInotify() const { return _inotifyFd >= 0; }
+
+		protected:
+			struct Subscription
+			{
+				std::string		fileName;
+				std::string		path;
+				Callback		callback;
+			};
+			typedef std::map<SubscriptionID, Subscription>	Subscriptions;
+
+			// A watched file, shared by the subscriptions on it
+			struct WatchedFile
+			{
+				unsigned int	refCount;
+				std::time_t		lastWriteTime;
+			};
+			typedef std::map<std::string, WatchedFile>		WatchedFiles;
+
+			// A directory watched by inotify
+			struct WatchedDirectory
+			{
+				unsigned int	refCount;
+				int				wd;
+			};
+			typedef std::map<std::string, WatchedDirectory>	WatchedDirectories;
+			typedef std::map<int, std::string>				WatchDescriptors;
+
+			void startThread();
+			void inotifyWatcher();
+			void pollingWatcher();
+
+			void addDirectory(const std::string& directory);
+			void removeDirectory(const std::string& directory);
+
+			boost::shared_ptr<boost::thread>	_thread;
+			boost::mutex						_mutex;
+			boost::condition_variable			_condition;
+			bool								_done;
+
+			SubscriptionID						_nextID;
+			Subscriptions						_subscriptions;
+			WatchedFiles						_files;
+			WatchedDirectories					_directories;
+			WatchDescriptors					_watchDescriptors;
+			std::set<std::string>				_changed;
+
+			int									_inotifyFd;
+			int									_wakeFds[2];
+		};
+	} // namespace
+} // namespace
+
+#endif // FILEWATCHER_H
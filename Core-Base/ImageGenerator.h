@@ -38,10 +38,12 @@
     #include <OpenIG-Base/Export.h>
     #include <OpenIG-Base/Types.h>
     #include <OpenIG-Base/StringUtils.h>
+    #include <OpenIG-Base/EntityRegistry.h>
 #else
     #include <Core-Base/Export.h>
     #include <Core-Base/Types.h>
     #include <Core-Base/StringUtils.h>
+    #include <Core-Base/EntityRegistry.h>
 #endif
 
 #include <osg/ref_ptr>
@@ -57,6 +59,7 @@
 #include <osgViewer/CompositeViewer>
 
 #include <map>
+#include <vector>
 #include <string>
 
 namespace OpenIG {
@@ -296,6 +299,39 @@ namespace OpenIG {
              */
             virtual void updateEntity(unsigned int id, const osg::Matrixd& mx) = 0;
 
+            /*! One \ref Entity update for \ref updateEntities
+             *  \brief One \ref Entity update
+             */
+            struct EntityUpdate
+            {
+                unsigned int    id;
+                osg::Matrixd    mx;
+
+                EntityUpdate() : id(0) {}
+                EntityUpdate(unsigned int i, const osg::Matrixd& m) : id(i), mx(m) {}
+            };
+            typedef std::vector<EntityUpdate>                               EntityUpdates;
+
+            /*! Updates many \ref Entity at once, as received in one frame from the host. It
+             *  is the same as calling \ref updateEntity for each of them but the scene
+             *  is touched once. Updates for unknown IDs are ignored
+             *  \brief Updates many \ref Entity at once
+             *  \param updates  Pointer to the first update
+             *  \param count    Number of updates
+             *  \return         Nothing
+             */
+            virtual void updateEntities(const EntityUpdate* updates, size_t count) = 0;
+
+            /*! Same as above, for a std::vector of updates
+             *  \brief Updates many \ref Entity at once
+             *  \param updates  The updates
+             *  \return         Nothing
+             */
+            void updateEntities(const EntityUpdates& updates)
+            {
+                if (!updates.empty()) updateEntities(&updates.front(), updates.size());
+            }
+
             /*! Show/Hide Entity
              *  \brief Show/Hide Entity
              *  \param id       The id of the \ref Entity. This is the id you have used with \ref addEntity
@@ -389,6 +425,17 @@ namespace OpenIG {
             */
             virtual void addEffect(unsigned int id, const std::string& name, const osg::Matrixd& mx, const std::string& attributes) = 0;
 
+            /*! Adds effect to the scene with already parsed, typed attributes. Use this one when
+            *	spawning many effects with the same attributes, the attributes object is passed
+            *	as is to the implementation and it is expected to be treated as read-only
+            *  \brief Adds effect to the scene with typed attributes
+            *  \param id	Unique effect to the scene
+            *  \param name	Name of the effect
+            *  \param mx	The initial position/orientation of the effect
+            *  \param attributes The typed attributes, can be NULL
+            */
+            virtual void addEffect(unsigned int id, const std::string& name, const osg::Matrixd& mx, EffectAttributes* attributes) = 0;
+
             /*! Removes effect from the scene
             *  \brief Removes effect from the scene
             *  \param id	Unique effect to the scene
@@ -1038,13 +1085,14 @@ namespace OpenIG {
              * \date      Sun Jan 11 2015
              */
             typedef osg::ref_ptr<osg::MatrixTransform>                      Entity;
-            typedef std::map< unsigned int, Entity >                        EntityMap;
-            typedef std::map< unsigned int, Entity >::iterator              EntityMapIterator;
-            typedef std::map< unsigned int, Entity >::const_iterator        EntityMapConstIterator;
+            typedef OpenIG::Base::EntityRegistry                            EntityMap;
+            typedef OpenIG::Base::EntityRegistry::iterator                  EntityMapIterator;
+            typedef OpenIG::Base::EntityRegistry::const_iterator            EntityMapConstIterator;
 
-            /*! The ID based \ref Entity std::map. Inheritants are expected to maintain this map along
+            /*! The ID based \ref Entity registry. Inheritants are expected to maintain it along
              *  with all the scene management methods, as \ref addEntuty etc ... \ref openig::OpenIG is
-             *  doing so
+             *  doing so. It has a std::map like interface, but the iteration order is not sorted
+             *  by ID and operator[] does not insert, use get(id) instead. See \ref OpenIG::Base::EntityRegistry
              * \brief The ID based \ref Entity std::map
              * \return  The recent ID based \ref Entity std::map
              * \author    Trajce Nikolov Nick openig@compro.net
@@ -0,0 +1,708 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#include "SceneSnapshot.h"
+
+#include <boost/cstdint.hpp>
+
+#include <osg/Notify>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace OpenIG::Base;
+
+const unsigned int SceneSnapshot::Version;
+
+namespace
+{
+	const char			Magic[4] = { 'O', 'I', 'G', 'S' };
+
+	// The section tags. New sections get new tags, the
+	// readers that do not know them skip them. The end
+	// section tells a complete snapshot from a truncated one
+	enum SectionTag
+	{
+		EndSection = 0,
+		EntitiesSection = 1,
+		LightsSection = 2,
+		EffectsSection = 3,
+		AnimationsSection = 4,
+		CamerasSection = 5,
+		CloudLayersSection = 6,
+		EnvironmentSection = 7
+	};
+
+	// Little endian, whatever the host is
+	class Writer
+	{
+	public:
+		void u8(unsigned char value)
+		{
+			_data.push_back((char)value);
+		}
+
+		void u32(boost::uint32_t value)
+		{
+			for (unsigned int i = 0; i < 4; ++i) u8((unsigned char)(value >> (i * 8)));
+		}
+
+		void u64(boost::uint64_t value)
+		{
+			for (unsigned int i = 0; i < 8; ++i) u8((unsigned char)(value >> (i * 8)));
+		}
+
+		void i32(int value)		{ u32((boost::uint32_t)value); }
+		void boolean(bool value)	{ u8(value ? 1 : 0); }
+
+		void f32(float value)
+		{
+			boost::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			u32(bits);
+		}
+
+		void f64(double value)
+		{
+			boost::uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			u64(bits);
+		}
+
+		void string(const std::string& value)
+		{
+			u32((boost::uint32_t)value.size());
+			_data.append(value);
+		}
+
+		void vec4(const osg::Vec4& value)
+		{
+			for (unsigned int i = 0; i < 4; ++i) f32(value[i]);
+		}
+
+		void matrix(const osg::Matrixd& value)
+		{
+			for (unsigned int i = 0; i < 16; ++i) f64(value.ptr()[i]);
+		}
+
+		// A size prefixed block. The size is patched in by endBlock
+		size_t beginBlock()
+		{
+			size_t position = _data.size();
+			u32(0);
+			return position;
+		}
+
+		void endBlock(size_t position)
+		{
+			boost::uint32_t size = (boost::uint32_t)(_data.size() - position - 4);
+			for (unsigned int i = 0; i < 4; ++i) _data[position + i] = (char)(unsigned char)(size >> (i * 8));
+		}
+
+		size_t beginSection(SectionTag tag, size_t count)
+		{
+			u32(tag);
+			size_t position = beginBlock();
+			u32((boost::uint32_t)count);
+			return position;
+		}
+
+		const std::string& data() const { return _data; }
+
+	protected:
+		std::string	_data;
+	};
+
+	// Reads what Writer wrote. A read past the end marks the reader
+	// failed and returns zero, so the values can be read unchecked
+	// and the result checked once with ok()
+	class Reader
+	{
+	public:
+		Reader(const char* data, size_t size)
+			: _data(data), _size(size), _position(0), _ok(true)
+		{
+		}
+
+		bool ok() const		{ return _ok; }
+		bool atEnd() const	{ return _position >= _size; }
+
+		unsigned char u8()
+		{
+			if (!need(1)) return 0;
+			return (unsigned char)_data[_position++];
+		}
+
+		boost::uint32_t u32()
+		{
+			boost::uint32_t value = 0;
+			for (unsigned int i = 0; i < 4; ++i) value |= (boost::uint32_t)u8() << (i * 8);
+			return value;
+		}
+
+		boost::uint64_t u64()
+		{
+			boost::uint64_t value = 0;
+			for (unsigned int i = 0; i < 8; ++i) value |= (boost::uint64_t)u8() << (i * 8);
+			return value;
+		}
+
+		int i32()			{ return (int)u32(); }
+		bool boolean()		{ return u8() != 0; }
+
+		float f32()
+		{
+			boost::uint32_t bits = u32();
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		double f64()
+		{
+			boost::uint64_t bits = u64();
+			double value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		std::string string()
+		{
+			boost::uint32_t size = u32();
+			if (!need(size)) return std::string();
+
+			std::string value(_data + _position, size);
+			_position += size;
+			return value;
+		}
+
+		osg::Vec4 vec4()
+		{
+			osg::Vec4 value;
+			for (unsigned int i = 0; i < 4; ++i) value[i] = f32();
+			return value;
+		}
+
+		osg::Matrixd matrix()
+		{
+			double values[16];
+			for (unsigned int i = 0; i < 16; ++i) values[i] = f64();
+			return osg::Matrixd(values);
+		}
+
+		// The next size prefixed block as a reader of its own. It is
+		// skipped whole here, whatever is read from it
+		Reader block()
+		{
+			boost::uint32_t size = u32();
+			if (!need(size)) return Reader(0, 0, false);
+
+			Reader reader(_data + _position, size);
+			_position += size;
+			return reader;
+		}
+
+	protected:
+		Reader(const char* data, size_t size, bool ok)
+			: _data(data), _size(size), _position(0), _ok(ok)
+		{
+		}
+
+		bool need(size_t size)
+		{
+			if (_ok && _size - _position >= size) return true;
+
+			_ok = false;
+			return false;
+		}
+
+		const char*	_data;
+		size_t		_size;
+		size_t		_position;
+		bool		_ok;
+	};
+
+	void writeLightAttributes(Writer& writer, const LightAttributes& attributes)
+	{
+		writer.vec4(attributes.ambient);
+		writer.vec4(attributes.diffuse);
+		writer.vec4(attributes.specular);
+		writer.f32(attributes.brightness);
+		writer.f32(attributes.constantAttenuation);
+		writer.f32(attributes.spotCutoff);
+		writer.boolean(attributes.enabled);
+		writer.f32(attributes.cloudBrightness);
+		writer.f32(attributes.waterBrightness);
+		writer.f64(attributes.lod);
+		writer.f64(attributes.realLightLOD);
+		writer.u32(attributes.dirtyMask);
+		writer.f32(attributes.fStartRange);
+		writer.f32(attributes.fEndRange);
+		writer.f32(attributes.fSpotInnerAngle);
+		writer.f32(attributes.fSpotOuterAngle);
+		writer.u32(attributes.lightType);
+		writer.u32(attributes.dataVariance);
+		writer.boolean(attributes.cullingActive);
+	}
+
+	void readLightAttributes(Reader& reader, LightAttributes& attributes)
+	{
+		attributes.ambient = reader.vec4();
+		attributes.diffuse = reader.vec4();
+		attributes.specular = reader.vec4();
+		attributes.brightness = reader.f32();
+		attributes.constantAttenuation = reader.f32();
+		attributes.spotCutoff = reader.f32();
+		attributes.enabled = reader.boolean();
+		attributes.cloudBrightness = reader.f32();
+		attributes.waterBrightness = reader.f32();
+		attributes.lod = reader.f64();
+		attributes.realLightLOD = reader.f64();
+		attributes.dirtyMask = reader.u32();
+		attributes.fStartRange = reader.f32();
+		attributes.fEndRange = reader.f32();
+		attributes.fSpotInnerAngle = reader.f32();
+		attributes.fSpotOuterAngle = reader.f32();
+		attributes.lightType = (LightType)reader.u32();
+		attributes.dataVariance = (osg::Object::DataVariance)reader.u32();
+		attributes.cullingActive = reader.boolean();
+	}
+
+	void writeEffectAttributes(Writer& writer, const EffectAttributes* attributes)
+	{
+		writer.boolean(attributes != 0);
+		if (!attributes) return;
+
+		writer.u32((boost::uint32_t)attributes->floats.size());
+		EffectAttributes::FloatAttributes::const_iterator fitr = attributes->floats.begin();
+		for (; fitr != attributes->floats.end(); ++fitr)
+		{
+			writer.string(fitr->first);
+			writer.f32(fitr->second);
+		}
+
+		writer.u32((boost::uint32_t)attributes->ints.size());
+		EffectAttributes::IntAttributes::const_iterator iitr = attributes->ints.begin();
+		for (; iitr != attributes->ints.end(); ++iitr)
+		{
+			writer.string(iitr->first);
+			writer.i32(iitr->second);
+		}
+
+		writer.u32((boost::uint32_t)attributes->strings.size());
+		EffectAttributes::StringAttributes::const_iterator sitr = attributes->strings.begin();
+		for (; sitr != attributes->strings.end(); ++sitr)
+		{
+			writer.string(sitr->first);
+			writer.string(sitr->second);
+		}
+	}
+
+	EffectAttributes* readEffectAttributes(Reader& reader)
+	{
+		if (!reader.boolean()) return 0;
+
+		osg::ref_ptr<EffectAttributes> attributes = new EffectAttributes;
+
+		boost::uint32_t count = reader.u32();
+		for (boost::uint32_t i = 0; i < count && reader.ok(); ++i)
+		{
+			std::string name = reader.string();
+			attributes->setFloat(name, reader.f32());
+		}
+
+		count = reader.u32();
+		for (boost::uint32_t i = 0; i < count && reader.ok(); ++i)
+		{
+			std::string name = reader.string();
+			attributes->setInt(name, reader.i32());
+		}
+
+		count = reader.u32();
+		for (boost::uint32_t i = 0; i < count && reader.ok(); ++i)
+		{
+			std::string name = reader.string();
+			attributes->setString(name, reader.string());
+		}
+
+		return attributes.release();
+	}
+
+	// The records of a section, each a block of its own
+	// so the fields newer writers append are skipped
+	template<typename T>
+	bool readRecords(Reader& section, std::vector<T>& records, void (*readRecord)(Reader&, T&))
+	{
+		boost::uint32_t count = section.u32();
+		for (boost::uint32_t i = 0; i < count && section.ok(); ++i)
+		{
+			Reader record = section.block();
+
+			T value;
+			readRecord(record, value);
+
+			if (!record.ok()) return false;
+			records.push_back(value);
+		}
+		return section.ok();
+	}
+
+	void readEntity(Reader& reader, SceneSnapshot::Entity& entity)
+	{
+		entity.id = reader.u32();
+		entity.parentID = reader.u32();
+		entity.fileName = reader.string();
+		entity.name = reader.string();
+		entity.mx = reader.matrix();
+		entity.visible = reader.boolean();
+
+		// Appended later, missing in older snapshots
+		if (!reader.atEnd()) entity.options = reader.string();
+	}
+
+	void readLight(Reader& reader, SceneSnapshot::Light& light)
+	{
+		light.id = reader.u32();
+		light.entityID = reader.u32();
+		light.mx = reader.matrix();
+		readLightAttributes(reader, light.attributes);
+		light.enabled = reader.boolean();
+		light.cameraBound = reader.boolean();
+		light.cameraOffset = reader.matrix();
+	}
+
+	void readEffect(Reader& reader, SceneSnapshot::Effect& effect)
+	{
+		effect.id = reader.u32();
+		effect.entityID = reader.u32();
+		effect.name = reader.string();
+		effect.mx = reader.matrix();
+		effect.attributes = readEffectAttributes(reader);
+	}
+
+	void readAnimation(Reader& reader, SceneSnapshot::Animation& animation)
+	{
+		animation.entityID = reader.u32();
+		animation.name = reader.string();
+		animation.status = reader.u32();
+	}
+
+	void readCamera(Reader& reader, SceneSnapshot::Camera& camera)
+	{
+		camera.id = reader.u32();
+		camera.viewMatrix = reader.matrix();
+		camera.bound = reader.boolean();
+		camera.entityID = reader.u32();
+		camera.offset = reader.matrix();
+		camera.fixedUp = reader.boolean();
+		camera.freeze = reader.boolean();
+
+		boost::uint32_t count = reader.u32();
+		for (boost::uint32_t i = 0; i < count && reader.ok(); ++i)
+		{
+			unsigned int id = reader.u32();
+			camera.entities.push_back(SceneSnapshot::CameraBoundEntity(id, reader.matrix()));
+		}
+	}
+
+	void readCloudLayer(Reader& reader, SceneSnapshot::CloudLayer& layer)
+	{
+		layer.id = reader.u32();
+		layer.type = reader.i32();
+		layer.altitude = reader.f64();
+		layer.thickness = reader.f64();
+		layer.density = reader.f64();
+		layer.enabled = reader.boolean();
+	}
+
+	void readEnvironment(Reader& reader, SceneSnapshot::Environment& environment)
+	{
+		environment.hasTimeOfDay = reader.boolean();
+		environment.hour = reader.u32();
+		environment.minutes = reader.u32();
+		environment.hasDate = reader.boolean();
+		environment.month = reader.u32();
+		environment.day = reader.i32();
+		environment.year = reader.i32();
+		environment.hasFog = reader.boolean();
+		environment.visibility = reader.f64();
+		environment.hasRain = reader.boolean();
+		environment.rain = reader.f64();
+		environment.hasSnow = reader.boolean();
+		environment.snow = reader.f64();
+		environment.hasWind = reader.boolean();
+		environment.windSpeed = reader.f32();
+		environment.windDirection = reader.f32();
+	}
+}
+
+void SceneSnapshot::clear()
+{
+	entities.clear();
+	lights.clear();
+	effects.clear();
+	animations.clear();
+	cameras.clear();
+	cloudLayers.clear();
+	environment = Environment();
+}
+
+bool SceneSnapshot::write(std::ostream& out) const
+{
+	Writer writer;
+
+	for (unsigned int i = 0; i < 4; ++i) writer.u8((unsigned char)Magic[i]);
+	writer.u32(Version);
+
+	size_t section = writer.beginSection(EntitiesSection, entities.size());
+	for (Entities::const_iterator itr = entities.begin(); itr != entities.end(); ++itr)
+	{
+		size_t record = writer.beginBlock();
+		writer.u32(itr->id);
+		writer.u32(itr->parentID);
+		writer.string(itr->fileName);
+		writer.string(itr->name);
+		writer.matrix(itr->mx);
+		writer.boolean(itr->visible);
+		writer.string(itr->options);
+		writer.endBlock(record);
+	}
+	writer.endBlock(section);
+
+	section = writer.beginSection(LightsSection, lights.size());
+	for (Lights::const_iterator itr = lights.begin(); itr != lights.end(); ++itr)
+	{
+		size_t record = writer.beginBlock();
+		writer.u32(itr->id);
+		writer.u32(itr->entityID);
+		writer.matrix(itr->mx);
+		writeLightAttributes(writer, itr->attributes);
+		writer.boolean(itr->enabled);
+		writer.boolean(itr->cameraBound);
+		writer.matrix(itr->cameraOffset);
+		writer.endBlock(record);
+	}
+	writer.endBlock(section);
+
+	section = writer.beginSection(EffectsSection, effects.size());
+	for (Effects::const_iterator itr = effects.begin(); itr != effects.end(); ++itr)
+	{
+		size_t record = writer.beginBlock();
+		writer.u32(itr->id);
+		writer.u32(itr->entityID);
+		writer.string(itr->name);
+		writer.matrix(itr->mx);
+		writeEffectAttributes(writer, itr->attributes.get());
+		writer.endBlock(record);
+	}
+	writer.endBlock(section);
+
+	section = writer.beginSection(AnimationsSection, animations.size());
+	for (Animations::const_iterator itr = animations.begin(); itr != animations.end(); ++itr)
+	{
+		size_t record = writer.beginBlock();
+		writer.u32(itr->entityID);
+		writer.string(itr->name);
+		writer.u32(itr->status);
+		writer.endBlock(record);
+	}
+	writer.endBlock(section);
+
+	section = writer.beginSection(CamerasSection, cameras.size());
+	for (Cameras::const_iterator itr = cameras.begin(); itr != cameras.end(); ++itr)
+	{
+		size_t record = writer.beginBlock();
+		writer.u32(itr->id);
+		writer.matrix(itr->viewMatrix);
+		writer.boolean(itr->bound);
+		writer.u32(itr->entityID);
+		writer.matrix(itr->offset);
+		writer.boolean(itr->fixedUp);
+		writer.boolean(itr->freeze);
+
+		writer.u32((boost::uint32_t)itr->entities.size());
+		for (CameraBoundEntities::const_iterator eitr = itr->entities.begin(); eitr != itr->entities.end(); ++eitr)
+		{
+			writer.u32(eitr->first);
+			writer.matrix(eitr->second);
+		}
+		writer.endBlock(record);
+	}
+	writer.endBlock(section);
+
+	section = writer.beginSection(CloudLayersSection, cloudLayers.size());
+	for (CloudLayers::const_iterator itr = cloudLayers.begin(); itr != cloudLayers.end(); ++itr)
+	{
+		size_t record = writer.beginBlock();
+		writer.u32(itr->id);
+		writer.i32(itr->type);
+		writer.f64(itr->altitude);
+		writer.f64(itr->thickness);
+		writer.f64(itr->density);
+		writer.boolean(itr->enabled);
+		writer.endBlock(record);
+	}
+	writer.endBlock(section);
+
+	section = writer.beginSection(EnvironmentSection, 1);
+	{
+		size_t record = writer.beginBlock();
+		writer.boolean(environment.hasTimeOfDay);
+		writer.u32(environment.hour);
+		writer.u32(environment.minutes);
+		writer.boolean(environment.hasDate);
+		writer.u32(environment.month);
+		writer.i32(environment.day);
+		writer.i32(environment.year);
+		writer.boolean(environment.hasFog);
+		writer.f64(environment.visibility);
+		writer.boolean(environment.hasRain);
+		writer.f64(environment.rain);
+		writer.boolean(environment.hasSnow);
+		writer.f64(environment.snow);
+		writer.boolean(environment.hasWind);
+		writer.f32(environment.windSpeed);
+		writer.f32(environment.windDirection);
+		writer.endBlock(record);
+	}
+	writer.endBlock(section);
+
+	section = writer.beginSection(EndSection, 0);
+	writer.endBlock(section);
+
+	out.write(writer.data().data(), writer.data().size());
+	return out.good();
+}
+
+bool SceneSnapshot::read(std::istream& in)
+{
+	clear();
+
+	std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	Reader reader(data.data(), data.size());
+
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		if (reader.u8() != (unsigned char)Magic[i])
+		{
+			osg::notify(osg::NOTICE) << "SceneSnapshot: not a snapshot" << std::endl;
+			return false;
+		}
+	}
+
+	unsigned int version = reader.u32();
+	if (!reader.ok() || version > Version)
+	{
+		osg::notify(osg::NOTICE) << "SceneSnapshot: unsupported version " << version << std::endl;
+		return false;
+	}
+
+	bool ok = true;
+	bool complete = false;
+	while (ok && !complete && !reader.atEnd())
+	{
+		boost::uint32_t tag = reader.u32();
+		Reader section = reader.block();
+
+		switch (tag)
+		{
+		case EndSection:
+			complete = true;
+			break;
+		case EntitiesSection:
+			ok = readRecords(section, entities, &readEntity);
+			break;
+		case LightsSection:
+			ok = readRecords(section, lights, &readLight);
+			break;
+		case EffectsSection:
+			ok = readRecords(section, effects, &readEffect);
+			break;
+		case AnimationsSection:
+			ok = readRecords(section, animations, &readAnimation);
+			break;
+		case CamerasSection:
+			ok = readRecords(section, cameras, &readCamera);
+			break;
+		case CloudLayersSection:
+			ok = readRecords(section, cloudLayers, &readCloudLayer);
+			break;
+		case EnvironmentSection:
+			{
+				std::vector<Environment> environments;
+				ok = readRecords(section, environments, &readEnvironment);
+				if (ok && !environments.empty()) environment = environments.front();
+			}
+			break;
+		default:
+			// From a newer writer
+			break;
+		}
+
+		ok = ok && reader.ok() && section.ok();
+	}
+
+	if (!ok || !complete)
+	{
+		osg::notify(osg::NOTICE) << "SceneSnapshot: truncated or corrupted snapshot" << std::endl;
+		clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool SceneSnapshot::write(const std::string& fileName) const
+{
+	std::ofstream out(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+	{
+		osg::notify(osg::NOTICE) << "SceneSnapshot: failed to open for writing: " << fileName << std::endl;
+		return false;
+	}
+
+	return write(out);
+}
+
+bool SceneSnapshot::read(const std::string& fileName)
+{
+	std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!in.is_open())
+	{
+		clear();
+		osg::notify(osg::NOTICE) << "SceneSnapshot: failed to open: " << fileName << std::endl;
+		return false;
+	}
+
+	return read(in);
+}
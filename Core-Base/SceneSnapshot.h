@@ -0,0 +1,247 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#ifndef SCENESNAPSHOT_H
+#define SCENESNAPSHOT_H
+
+#if defined(OPENIG_SDK)
+	#include <OpenIG-Base/Export.h>
+	#include <OpenIG-Base/Types.h>
+#else
+	#include <Core-Base/Export.h>
+	#include <Core-Base/Types.h>
+#endif
+
+#include <osg/Matrixd>
+#include <osg/ref_ptr>
+
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace OpenIG {
+	namespace Base {
+
+		/*! The runtime state of the scene as plain data: entities with their transforms
+		 *  and bindings, lights and their attributes, effects, animations, cameras and
+		 *  the environment. It is written to and read from a versioned binary format. The
+		 *  file starts with a magic and a version, followed by tagged sections, each with
+		 *  its size, and each record in a section carries its size as well. Readers skip
+		 *  the sections they do not know and the trailing fields of records written by
+		 *  newer versions, so fields and sections can be added without a version change.
+		 *  The version changes only when the layout of the existing fields does
+		 *  \brief Versioned binary snapshot of the scene
+		 */
+		class IGCORE_EXPORT SceneSnapshot
+		{
+		public:
+			/*! \brief The version written, and the newest one read */
+			static const unsigned int Version = 1;
+
+			/*! An entity. The entities loaded from a file have a file name, the
+			 *  rest are parts of other entities, like the sub-entities of a
+			 *  composed model, and only their state is restored
+			 * \brief An entity
+			 */
+			struct Entity
+			{
+				Entity() : id(0), parentID(0), visible(true) {}
+
+				unsigned int	id;
+				unsigned int	parentID;		/*! \brief The entity it is bound to, 0 for none */
+				std::string		fileName;
+				std::string		name;
+				osg::Matrixd	mx;
+				bool			visible;
+				std::string		options;		/*! \brief The osgDB option string the model was read with */
+			};
+			typedef std::vector<Entity>			Entities;
+
+			/*! \brief A light */
+			struct Light
+			{
+				Light() : id(0), entityID(0), enabled(true), cameraBound(false) {}
+
+				unsigned int	id;
+				unsigned int	entityID;		/*! \brief The entity it is bound to, 0 for none */
+				osg::Matrixd	mx;
+				LightAttributes	attributes;
+				bool			enabled;
+				bool			cameraBound;
+				osg::Matrixd	cameraOffset;
+			};
+			typedef std::vector<Light>			Lights;
+
+			/*! \brief An effect */
+			struct Effect
+			{
+				Effect() : id(0), entityID(0) {}
+
+				unsigned int						id;
+				unsigned int						entityID;	/*! \brief The entity it is bound to, 0 for none */
+				std::string							name;
+				osg::Matrixd						mx;
+				osg::ref_ptr<EffectAttributes>		attributes;
+			};
+			typedef std::vector<Effect>			Effects;
+
+			/*! \brief An animation that is playing or paused */
+			struct Animation
+			{
+				Animation() : entityID(0), status(0) {}
+
+				unsigned int	entityID;
+				std::string		name;
+				unsigned int	status;		/*! \brief One of ImageGenerator::AnimationStatus */
+			};
+			typedef std::vector<Animation>		Animations;
+
+			/*! \brief An entity bound to a camera, with its offset */
+			typedef std::pair<unsigned int, osg::Matrixd>	CameraBoundEntity;
+			typedef std::vector<CameraBoundEntity>			CameraBoundEntities;
+
+			/*! \brief A camera, with its binding to an entity if any */
+			struct Camera
+			{
+				Camera() : id(0), bound(false), entityID(0), fixedUp(false), freeze(false) {}
+
+				unsigned int			id;
+				osg::Matrixd			viewMatrix;
+				bool					bound;
+				unsigned int			entityID;
+				osg::Matrixd			offset;
+				bool					fixedUp;
+				bool					freeze;
+				CameraBoundEntities		entities;
+			};
+			typedef std::vector<Camera>			Cameras;
+
+			/*! \brief A cloud layer */
+			struct CloudLayer
+			{
+				CloudLayer() : id(0), type(0), altitude(0), thickness(0), density(0), enabled(true) {}
+
+				unsigned int	id;
+				int				type;
+				double			altitude;
+				double			thickness;
+				double			density;
+				bool			enabled;
+			};
+			typedef std::vector<CloudLayer>		CloudLayers;
+
+			/*! The environment as last set. Only what was set
+			 *  is restored, the has flags tell which
+			 * \brief The environment
+			 */
+			struct Environment
+			{
+				Environment()
+					: hasTimeOfDay(false), hour(0), minutes(0)
+					, hasDate(false), month(0), day(0), year(0)
+					, hasFog(false), visibility(0)
+					, hasRain(false), rain(0)
+					, hasSnow(false), snow(0)
+					, hasWind(false), windSpeed(0), windDirection(0)
+				{
+				}
+
+				bool			hasTimeOfDay;
+				unsigned int	hour;
+				unsigned int	minutes;
+
+				bool			hasDate;
+				unsigned int	month;
+				int				day;
+				int				year;
+
+				bool			hasFog;
+				double			visibility;
+
+				bool			hasRain;
+				double			rain;
+
+				bool			hasSnow;
+				double			snow;
+
+				bool			hasWind;
+				float			windSpeed;
+				float			windDirection;
+			};
+
+			Entities		entities;
+			Lights			lights;
+			Effects			effects;
+			Animations		animations;
+			Cameras			cameras;
+			CloudLayers		cloudLayers;
+			Environment		environment;
+
+			/*!
+			 * \brief Empties the snapshot
+			 */
+			void clear();
+
+			/*!
+			 * \brief Writes the snapshot to a binary stream
+			 * \param out	The stream
+			 * \return		true on success
+			 */
+			bool write(std::ostream& out) const;
+
+			/*! Reads the snapshot from a binary stream. On failure the
+			 *  snapshot is left empty
+			 * \brief Reads the snapshot from a binary stream
+			 * \param in	The stream
+			 * \return		true on success, false on a bad magic, a newer version or truncated data
+			 */
+			bool read(std::istream& in);
+
+			/*!
+			 * \brief Writes the snapshot to a file
+			 * \param fileName	The file name
+			 * \return			true on success
+			 */
+			bool write(const std::string& fileName) const;
+
+			/*!
+			 * \brief Reads the snapshot from a file
+			 * \param fileName	The file name
+			 * \return			true on success
+			 */
+			bool read(const std::string& fileName);
+		};
+	} // namespace
+} // namespace
+
+#endif // SCENESNAPSHOT_H
@@ -0,0 +1,215 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#include "ThreadPool.h"
+
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+
+#include <algorithm>
+
+using namespace OpenIG::Base;
+
+namespace
+{
+	struct RangeCounter
+	{
+		boost::mutex				mutex;
+		boost::condition_variable	condition;
+		size_t						remaining;
+		boost::exception_ptr		error;		// the first one a chunk threw
+
+		RangeCounter(size_t count) : remaining(count) {}
+	};
+
+	void runChunk(const ThreadPool::RangeTask& task, size_t begin, size_t num, RangeCounter* counter)
+	{
+		// The caller waits for all the chunks, so one that throws is
+		// still counted and the exception is handed to the caller
+		boost::exception_ptr error;
+		try
+		{
+			task(begin, num);
+		}
+		catch (...)
+		{
+			error = boost::current_exception();
+		}
+
+		boost::mutex::scoped_lock lock(counter->mutex);
+		if (error && !counter->error) counter->error = error;
+		if (--counter->remaining == 0)
+		{
+			counter->condition.notify_all();
+		}
+	}
+}
+
+ThreadPool* ThreadPool::instance()
+{
+	static ThreadPool s_pool;
+	return &s_pool;
+}
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+	: _numThreads(numThreads)
+	, _done(false)
+{
+	if (_numThreads == 0)
+	{
+		unsigned int cores = boost::thread::hardware_concurrency();
+		_numThreads = cores > 1 ? cores - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < _numThreads; ++i)
+	{
+		_threads.create_thread(boost::bind(&ThreadPool::worker, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_done = true;
+	}
+	_condition.notify_all();
+
+	_threads.join_all();
+}
+
+void ThreadPool::post(const Task& task)
+{
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_tasks.push_back(task);
+	}
+	_condition.notify_one();
+}
+
+bool ThreadPool::runPendingTask()
+{
+	Task task;
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		if (_tasks.empty()) return false;
+
+		task = _tasks.front();
+		_tasks.pop_front();
+	}
+
+	task();
+
+	return true;
+}
+
+void ThreadPool::parallelFor(size_t count, const RangeTask& task, size_t minChunk)
+{
+	if (count == 0) return;
+
+	size_t maxChunks = _numThreads + 1;
+	size_t chunk = std::max(minChunk, (count + maxChunks - 1) / maxChunks);
+	size_t numChunks = (count + chunk - 1) / chunk;
+
+	if (numChunks < 2)
+	{
+		task(0, count);
+		return;
+	}
+
+	RangeCounter counter(numChunks - 1);
+
+	for (size_t i = 1; i < numChunks; ++i)
+	{
+		size_t begin = i * chunk;
+		size_t num = std::min(chunk, count - begin);
+
+		post(boost::bind(&runChunk, boost::cref(task), begin, num, &counter));
+	}
+
+	// the caller does the first chunk and then helps
+	// with whatever is still queued, so nested calls
+	// from within the pool do not deadlock. It waits
+	// for the rest even if its chunk throws, they
+	// refer to the task and the counter
+	boost::exception_ptr error;
+	try
+	{
+		task(0, std::min(chunk, count));
+	}
+	catch (...)
+	{
+		error = boost::current_exception();
+	}
+
+	while (true)
+	{
+		{
+			boost::mutex::scoped_lock lock(counter.mutex);
+			if (counter.remaining == 0) break;
+		}
+
+		if (!runPendingTask())
+		{
+			boost::mutex::scoped_lock lock(counter.mutex);
+			if (counter.remaining != 0)
+			{
+				counter.condition.wait(lock);
+			}
+		}
+	}
+
+	if (!error) error = counter.error;
+	if (error) boost::rethrow_exception(error);
+}
+
+void ThreadPool::worker()
+{
+	while (true)
+	{
+		Task task;
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+			while (_tasks.empty() && !_done)
+			{
+				_condition.wait(lock);
+			}
+
+			if (_done && _tasks.empty()) return;
+
+			task = _tasks.front();
+			_tasks.pop_front();
+		}
+
+		task();
+	}
+}
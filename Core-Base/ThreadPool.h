@@ -0,0 +1,114 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#if defined(OPENIG_SDK)
+	#include <OpenIG-Base/Export.h>
+#else
+	#include <Core-Base/Export.h>
+#endif
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+#include <deque>
+
+namespace OpenIG {
+	namespace Base {
+
+		/*! Small pool of worker threads for CPU bound work that is split
+		 *  across cores, like particle updates or light binning. The calling
+		 *  thread takes part in \ref parallelFor so it is safe to use it from
+		 *  tasks already running on the pool
+		 * \brief Pool of worker threads
+		 */
+		class IGCORE_EXPORT ThreadPool
+		{
+		public:
+			typedef boost::function<void()>					Task;
+			typedef boost::function<void(size_t, size_t)>	RangeTask;
+
+			/*!
+			 * \brief The singleton, sized to the number of cores
+			 * \return The singleton
+			 */
+			static ThreadPool* instance();
+
+			/*!
+			 * \brief Constructor
+			 * \param numThreads	Number of worker threads. 0 means one less than the number of cores
+			 */
+			explicit ThreadPool(unsigned int numThreads = 0);
+			~ThreadPool();
+
+			/*!
+			 * \brief Number of worker threads, not counting the caller
+			 * \return Number of worker threads
+			 */
+			unsigned int getNumThreads() const { return _numThreads; }
+
+			/*!
+			 * \brief Queues a task to be run on a worker thread
+			 * \param task	The task
+			 */
+			void post(const Task& task);
+
+			/*! Splits [0,count) in chunks of at least minChunk elements and
+			 *  runs task(begin, numElements) on them in parallel. Returns when all
+			 *  the chunks are done. If chunks throw, the first exception caught is
+			 *  thrown again from here once the others are done
+			 * \brief Parallel for over a range
+			 * \param count		Number of elements
+			 * \param task		Called with the start and the number of elements of a chunk
+			 * \param minChunk	Minimum number of elements in a chunk
+			 */
+			void parallelFor(size_t count, const RangeTask& task, size_t minChunk = 1);
+
+		protected:
+			void worker();
+
+			/*! Runs one queued task if there is any. Returns false if the queue was empty */
+			bool runPendingTask();
+
+			unsigned int				_numThreads;
+			boost::thread_group			_threads;
+			boost::mutex				_mutex;
+			boost::condition_variable	_condition;
+			std::deque<Task>			_tasks;
+			bool						_done;
+		};
+	} // namespace
+} // namespace
+
+#endif // THREADPOOL_H
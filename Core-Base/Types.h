@@ -38,6 +38,9 @@
 #include <osg/Group>
 #include <osg/ValueObject>
 
+#include <map>
+#include <string>
+
 namespace OpenIG {
     namespace Base {
 
@@ -704,6 +707,69 @@ namespace OpenIG {
 
         };
 
+        /*! Typed, pre-parsed attributes of an effect. \ref OpenIG::Base::ImageGenerator::addEffect
+        *	parses the token=attr;token=attr string into this once and the result is shared
+        *	between all the effects spawned with the same attribute string. The values are
+        *	mirrored as user values as well so implementations that read them through
+        *	getUserValue keep working
+        * \brief	Typed, pre-parsed attributes of an effect
+        */
+        struct EffectAttributes : public GenericAttribute
+        {
+            typedef std::map< std::string, float >			FloatAttributes;
+            typedef std::map< std::string, int >			IntAttributes;
+            typedef std::map< std::string, std::string >	StringAttributes;
+
+            FloatAttributes		floats;
+            IntAttributes		ints;
+            StringAttributes	strings;
+
+            void setFloat(const std::string& name, float value)
+            {
+                floats[name] = value;
+                setUserValue(name, value);
+            }
+
+            void setInt(const std::string& name, int value)
+            {
+                ints[name] = value;
+                setUserValue(name, value);
+            }
+
+            void setString(const std::string& name, const std::string& value)
+            {
+                strings[name] = value;
+                setUserValue(name, value);
+            }
+
+            bool getFloat(const std::string& name, float& value) const
+            {
+                FloatAttributes::const_iterator itr = floats.find(name);
+                if (itr == floats.end()) return false;
+
+                value = itr->second;
+                return true;
+            }
+
+            bool getInt(const std::string& name, int& value) const
+            {
+                IntAttributes::const_iterator itr = ints.find(name);
+                if (itr == ints.end()) return false;
+
+                value = itr->second;
+                return true;
+            }
+
+            bool getString(const std::string& name, std::string& value) const
+            {
+                StringAttributes::const_iterator itr = strings.find(name);
+                if (itr == strings.end()) return false;
+
+                value = itr->second;
+                return true;
+            }
+        };
+
         /*! This class is general purpose class for creating and managing
         *	custom implementation of entities. As an example can be Effect
         *	Entity that is implemented in a plugin.
@@ -1624,7 +1624,7 @@ public:
         {
             unsigned int id     = atoi(tokens.at(0).c_str());
 
-            OpenIG::Base::ImageGenerator::Entity& entity = _ig->getEntityMap()[id];
+            OpenIG::Base::ImageGenerator::Entity entity = _ig->getEntityMap().get(id);
             if (entity.valid())
             {
                 std::string fileName;
@@ -1916,6 +1916,76 @@ public:
 
 };
 
+class SnapshotCommand : public OpenIG::Base::Commands::Command
+{
+public:
+    SnapshotCommand(Engine* ig)
+        : _ig(ig) {}
+
+    virtual const std::string getUsage() const
+    {
+        return "filename";
+    }
+
+    virtual const std::string getArgumentsFormat() const
+    {
+        return "S";
+    }
+
+    virtual const std::string getDescription() const
+    {
+        return  "writes a binary snapshot of the scene\n"
+            "     filename - the file name of the snapshot";
+    }
+
+    virtual int exec(const OpenIG::Base::StringUtils::Tokens& tokens)
+    {
+        if (tokens.size() == 1)
+        {
+            return _ig->writeSnapshot(tokens.at(0)) ? 0 : -1;
+        }
+
+        return -1;
+    }
+protected:
+    Engine* _ig;
+};
+
+class RestoreSnapshotCommand : public OpenIG::Base::Commands::Command
+{
+public:
+    RestoreSnapshotCommand(Engine* ig)
+        : _ig(ig) {}
+
+    virtual const std::string getUsage() const
+    {
+        return "filename";
+    }
+
+    virtual const std::string getArgumentsFormat() const
+    {
+        return "F";
+    }
+
+    virtual const std::string getDescription() const
+    {
+        return  "restores a binary snapshot of the scene written with snapshot\n"
+            "     filename - the file name of the snapshot";
+    }
+
+    virtual int exec(const OpenIG::Base::StringUtils::Tokens& tokens)
+    {
+        if (tokens.size() == 1)
+        {
+            return _ig->readSnapshot(tokens.at(0)) ? 0 : -1;
+        }
+
+        return -1;
+    }
+protected:
+    Engine* _ig;
+};
+
 class TurnOnCrashScreenCommand : public OpenIG::Base::Commands::Command
 {
 public:
@@ -2112,4 +2182,6 @@ void Engine::initCommands()
     Commands::instance()->addCommand("turnoncrashscreen", new TurnOnCrashScreenCommand(this));
     Commands::instance()->addCommand("turnoffscreenmessage", new TurnOffScreenMessageCommand(this));
     Commands::instance()->addCommand("turnonscreenmessage", new TurnOnScreenMessageCommand(this));
+    Commands::instance()->addCommand("snapshot", new SnapshotCommand(this));
+    Commands::instance()->addCommand("restoresnapshot", new RestoreSnapshotCommand(this));
 }
@@ -21,6 +21,7 @@ SOURCES +=  Commands.cpp\
             Splash.cpp\
             Terminal.cpp\
             Effects.cpp \
+            Snapshot.cpp \
     OnScreenMessages.cpp
 
 HEADERS +=  Config.h\
@@ -34,7 +35,8 @@ INCLUDEPATH += ../
 DEPENDPATH += ../
 
 LIBS += -losg -losgDB -losgViewer -lOpenThreads -losgGA -losgText -losgUtil\
-        -losgShadow -losgSim -losgParticle -lOpenIG-Base -lOpenIG-PluginBase
+        -losgShadow -losgSim -losgParticle -lOpenIG-Base -lOpenIG-PluginBase\
+        -lboost_system -lboost_thread
 
 OTHER_FILES += CMakeLists.txt
 DISTFILES += CMakeLists.txt
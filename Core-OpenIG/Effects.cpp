@@ -51,18 +51,64 @@ void Engine::initEffects()
 
 void Engine::addEffect(unsigned int id, const std::string& name, const osg::Matrixd& mx, const std::string& attributes)
 {
+	finishRenderingTraversals();
+
+	if (!_effectsImplementationCallback.valid()) return;
+
+	osg::ref_ptr<EffectAttributes> attr = parseEffectAttributes(name, attributes);
+
+	addEffect(id, name, mx, attr.get());
+}
+
+void Engine::addEffect(unsigned int id, const std::string& name, const osg::Matrixd& mx, EffectAttributes* attributes)
+{
+	finishRenderingTraversals();
+
 	if (!_effectsImplementationCallback.valid()) return;
 
 	removeEffect(id);
 
-	osg::ref_ptr<GenericAttribute> attr(new GenericAttribute);
-	attr->setUserValue("name", name);
+	osg::ref_ptr<osg::Node> effectImplementation = _effectsImplementationCallback->create(id, name, attributes);
+	if (!effectImplementation.valid()) return;
+
+	Effect effect = new osg::MatrixTransform;
+	effect->setMatrix(mx);
+	effect->addChild(effectImplementation);
+
+	// Kept for the snapshots
+	effect->setName(name);
+	effect->setUserData(attributes);
+
+	_effects[id] = effect;
+
+	_effectsRoot->addChild(effect);
+}
+
+EffectAttributes* Engine::parseEffectAttributes(const std::string& name, const std::string& attributes)
+{
+	// The parsed attributes are shared between effects, and
+	// the name is part of them, so it is part of the key too
+	std::string key = name + '\n' + attributes;
+
+	EffectAttributesCache::iterator itr = _effectAttributesCache.find(key);
+	if (itr != _effectAttributesCache.end()) return itr->second.get();
+
+	// Attribute strings can come from the network with
+	// arbitrary values, keep the cache bounded
+	static const size_t maxCachedAttributes = 256;
+	if (_effectAttributesCache.size() >= maxCachedAttributes)
+	{
+		_effectAttributesCache.clear();
+	}
+
+	osg::ref_ptr<EffectAttributes> attr(new EffectAttributes);
+	attr->setString("name", name);
 
 	StringUtils::Tokens tokens = StringUtils::instance()->tokenize(attributes, ";");
-	StringUtils::Tokens::iterator itr = tokens.begin();
-	for (; itr != tokens.end(); ++itr)
+	StringUtils::Tokens::iterator titr = tokens.begin();
+	for (; titr != tokens.end(); ++titr)
 	{
-		std::string attribute = *itr;
+		std::string attribute = *titr;
 
 		StringUtils::Tokens t = StringUtils::instance()->tokenize(attribute, "=");
 		if (t.size() != 2) continue;
@@ -76,31 +122,26 @@ void Engine::addEffect(unsigned int id, const std::string& name, const osg::Matr
 		switch (ch)
 		{
 		case 'F':
-			attr->setUserValue(attributeName, (float)atof(attributeValue.c_str()));
+			attr->setFloat(attributeName, (float)atof(attributeValue.c_str()));
 			break;
 		case 'S':
-			attr->setUserValue(attributeName, attributeValue);
+			attr->setString(attributeName, attributeValue);
 			break;
 		case 'I':
-			attr->setUserValue(attributeName, (int)atoi(attributeValue.c_str()));
+			attr->setInt(attributeName, (int)atoi(attributeValue.c_str()));
 			break;
 		}
 	}
 
-	osg::ref_ptr<osg::Node> effectImplementation = _effectsImplementationCallback->create(id, name, attr);
-	if (!effectImplementation.valid()) return;
-	
-	Effect effect = new osg::MatrixTransform;
-	effect->setMatrix(mx);
-	effect->addChild(effectImplementation);
-
-	_effects[id] = effect;
+	_effectAttributesCache[key] = attr;
 
-	_effectsRoot->addChild(effect);
+	return attr.get();
 }
 
 void Engine::removeEffect(unsigned int id)
 {
+	finishRenderingTraversals();
+
 	EffectMap::iterator itr = _effects.find(id);
 	if (itr == _effects.end()) return;
 
@@ -115,10 +156,12 @@ void Engine::removeEffect(unsigned int id)
 
 void Engine::bindEffect(unsigned int id, unsigned int entityID, const osg::Matrixd& mx)
 {
+	finishRenderingTraversals();
+
 	if (_entities.count(entityID) == 0) return;
 	if (_effects.count(id) == 0) return;
 
-	Entity entity = _entities[entityID];
+	Entity entity = _entities.get(entityID);
 	Effect effect = _effects[id];
 
 	if (!entity.valid() || !effect.valid()) return;
@@ -133,6 +176,8 @@ void Engine::bindEffect(unsigned int id, unsigned int entityID, const osg::Matri
 
 void Engine::unbindEffect(unsigned int id)
 {
+	finishRenderingTraversals();
+
 	if (_effects.count(id) == 0) return;
 	Effect effect = _effects[id];
 	if (!effect.valid()) return;
@@ -141,8 +186,7 @@ void Engine::unbindEffect(unsigned int id)
 	if (!effect->getUserValue("boundTo", entityID)) return;
 	if (entityID == 0) return;
 
-	if (_entities.count(entityID) == 0) return;
-	Entity entity = _entities[entityID];
+	Entity entity = _entities.get(entityID);
 	if (!entity.valid()) return;
 
 	effect->setUserValue("boundTo", 0);
@@ -172,6 +216,8 @@ void Engine::unbindEffect(unsigned int id)
 
 void Engine::updateEffect(unsigned int id, const osg::Matrixd& mx)
 {
+	finishRenderingTraversals();
+
 	EffectMap::iterator itr = _effects.find(id);
 	if (itr == _effects.end()) return;
 
@@ -41,6 +41,7 @@
 #include <Core-Base/Configuration.h>
 #include <Core-Base/Animation.h>
 #include <Core-Base/FileSystem.h>
+#include <Core-Base/FileWatcher.h>
 
 #include <osgDB/ReadFile>
 #include <osgDB/FileNameUtils>
@@ -55,6 +56,9 @@
 #include <osg/Notify>
 #include <osg/io_utils>
 
+#include <OpenThreads/Thread>
+#include <OpenThreads/Condition>
+
 #include <osgShadow/ShadowedScene>
 #include <osgShadow/LightSpacePerspectiveShadowMap>
 #include <osgShadow/ViewDependentShadowMap>
@@ -62,7 +66,11 @@
 
 #include <Library-Graphics/OIGMath.h>
 
+#include <boost/bind.hpp>
+#include <boost/thread/tss.hpp>
+
 #include <sstream>
+#include <algorithm>
 
 using namespace OpenIG;
 using namespace OpenIG::Base;
@@ -72,10 +80,14 @@ static int ReceivesShadowTraversalMask = 0x10;
 static int CastsShadowTraversalMask = 0x20;
 
 Engine::Engine()
-    : _sceneCreatedByOpenIG(false)
+    : _hierarchyRevision(0)
+    , _sceneCreatedByOpenIG(false)
     , _updateViewerCameraMainpulator(false)
     , _splashOn(true)
     , _setupMask(Standard)
+    , _renderThread(0)
+    , _pipelinedFrame(false)
+    , _renderingTraversalsPending(false)
 {
 }
 
@@ -123,6 +135,37 @@ public:
     }
 };
 
+// Configures the plugins again when their config
+// changes, with Config-Hot-Reload on. Only the ones
+// that tell they can take it, most set up their
+// state once from the config
+class WatchPluginConfigOperation : public PluginOperation
+{
+public:
+    WatchPluginConfigOperation(std::vector<unsigned int>& subscriptions)
+        : _subscriptions(subscriptions)
+    {
+
+    }
+
+    virtual void apply(OpenIG::PluginBase::Plugin* plugin)
+    {
+        if (plugin && plugin->isConfigReloadable())
+        {
+            std::string configFileName = plugin->getLibrary()+".xml";
+            if (!osgDB::fileExists(configFileName)) return;
+
+            unsigned int id = FileWatcher::instance()->subscribe(
+                configFileName,
+                boost::bind(&OpenIG::PluginBase::Plugin::config, plugin, _1)
+                );
+            if (id) _subscriptions.push_back(id);
+        }
+    }
+protected:
+    std::vector<unsigned int>&  _subscriptions;
+};
+
 class PreFramePluginOperation : public PluginOperation
 {
 public:
@@ -224,6 +267,99 @@ protected:
     OpenIG::Engine* _ig;
 };
 
+// Applies an operation only to the plugins that are, or are
+// not, pipeline safe. See Engine::setPipelinedFrame
+class PipelineSafePluginOperation : public PluginOperation
+{
+public:
+    PipelineSafePluginOperation(PluginOperation* operation, bool pipelineSafe)
+        : PluginOperation()
+        , _operation(operation)
+        , _pipelineSafe(pipelineSafe)
+    {
+
+    }
+
+    virtual void apply(OpenIG::PluginBase::Plugin* plugin)
+    {
+        if (plugin && plugin->isUpdatePipelineSafe() == _pipelineSafe) _operation->apply(plugin);
+    }
+
+protected:
+    osg::ref_ptr<PluginOperation>   _operation;
+    bool                            _pipelineSafe;
+};
+
+namespace OpenIG
+{
+    // Runs the rendering traversals of the viewer when asked, so the
+    // main thread can go on with the update of the next frame meanwhile
+    class RenderThread : public OpenThreads::Thread
+    {
+    public:
+        RenderThread(osgViewer::ViewerBase* viewer)
+            : _viewer(viewer)
+            , _requested(false)
+            , _busy(false)
+            , _done(false)
+        {
+
+        }
+
+        void request()
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+            _requested = true;
+            _busy = true;
+            _condition.broadcast();
+        }
+
+        void wait()
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+            while (_busy) _condition.wait(&_mutex);
+        }
+
+        void quit()
+        {
+            wait();
+            {
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+                _done = true;
+                _condition.broadcast();
+            }
+            join();
+        }
+
+        virtual void run()
+        {
+            while (true)
+            {
+                {
+                    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+                    while (!_requested && !_done) _condition.wait(&_mutex);
+                    if (_done) break;
+                    _requested = false;
+                }
+
+                _viewer->renderingTraversals();
+
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+                _busy = false;
+                _condition.broadcast();
+            }
+        }
+
+    protected:
+        osgViewer::ViewerBase*      _viewer;
+        OpenThreads::Mutex          _mutex;
+        OpenThreads::Condition      _condition;
+        bool                        _requested;
+        bool                        _busy;
+        bool                        _done;
+    };
+}
+
 class DatabaseReadPluginOperation : public PluginOperation
 {
 public:
@@ -386,18 +522,7 @@ public:
         }
         if (result.getNode())
         {
-            osg::ref_ptr<DatabaseReadPluginOperation> po(
-                new DatabaseReadPluginOperation(filename,result.getNode(),options)
-            );
-
-            Engine* openIG = dynamic_cast<Engine*>(_ig);
-            if (openIG)
-            {
-                openIG->applyPluginOperation(po.get());
-            }
-
-            DatabaseReadNodeVisitor nv(_ig, const_cast<osgDB::Options*>(options));
-            result.getNode()->accept(nv);
+            _ig->databaseRead(filename, result.getNode(), options);
         }
         return result;
     }
@@ -406,6 +531,43 @@ protected:
     Engine* _ig;
 };
 
+namespace
+{
+    void keepDatabaseReads(Engine::DatabaseReads*)
+    {
+        // Owned by the one setting them
+    }
+
+    boost::thread_specific_ptr<Engine::DatabaseReads> s_deferredDatabaseReads(&keepDatabaseReads);
+}
+
+void Engine::setDeferredDatabaseReads(DatabaseReads* reads)
+{
+    s_deferredDatabaseReads.reset(reads);
+}
+
+void Engine::databaseRead(const std::string& fileName, osg::Node* node, const osgDB::Options* options)
+{
+    DatabaseReads* deferred = s_deferredDatabaseReads.get();
+    if (deferred)
+    {
+        DatabaseRead read;
+        read.fileName = fileName;
+        read.node = node;
+        read.options = options;
+        deferred->push_back(read);
+        return;
+    }
+
+    osg::ref_ptr<DatabaseReadPluginOperation> po(
+        new DatabaseReadPluginOperation(fileName,node,options)
+    );
+    applyPluginOperation(po.get());
+
+    DatabaseReadNodeVisitor nv(this, const_cast<osgDB::Options*>(options));
+    node->accept(nv);
+}
+
 class PrintLoadedPluginsPluginOperation : public OpenIG::PluginBase::PluginOperation
 {
 public:
@@ -504,11 +666,26 @@ void Engine::init(osgViewer::CompositeViewer* viewer, const std::string& xmlFile
     osg::ref_ptr<ConfigPluginOperation> configPluginOperation(new ConfigPluginOperation);
     PluginHost::applyPluginOperation(configPluginOperation.get());
 
+    if (Configuration::instance()->getConfig("Config-Hot-Reload", "no") == "yes")
+    {
+        Configuration::instance()->setHotReload(true);
+
+        osg::ref_ptr<WatchPluginConfigOperation> watchPluginConfigOperation(new WatchPluginConfigOperation(_pluginConfigSubscriptions));
+        PluginHost::applyPluginOperation(watchPluginConfigOperation.get());
+    }
+
     osg::ref_ptr<InitPluginOperation> initPluginOperation(new InitPluginOperation(this));
     PluginHost::applyPluginOperation(initPluginOperation.get());
 
     createSunMoonLight();
 
+    setPipelinedFrame(Configuration::instance()->getConfig("Pipelined-Frame", "no") == "yes");
+
+    std::string startupSnapshot = Configuration::instance()->getConfig("Startup-Snapshot", "");
+    if (!startupSnapshot.empty())
+    {
+        readSnapshot(startupSnapshot);
+    }
 }
 
 void Engine::loadScript(const std::string& fileName)
@@ -534,6 +711,8 @@ protected:
 
 void Engine::cleanup()
 {
+    setPipelinedFrame(false);
+
     if (_viewer.valid())
     {
         _viewer->stopThreading();
@@ -558,6 +737,7 @@ void Engine::cleanup()
     _context.setValueObject(0);
     _context.getAttributes().clear();
     _entities.clear();
+    _cameraBindings.clear();
     _lights.clear();
     _effects.clear();
     _lightAttributes.clear();
@@ -566,6 +746,7 @@ void Engine::cleanup()
     _sunOrMoonLight					= NULL;
     _fog							= NULL;
     _scene							= NULL;
+    _entityRoot						= NULL;
     _lightImplementationCallback	= NULL;
     _lightsGroup					= NULL;
     _keypad							= NULL;
@@ -581,6 +762,14 @@ void Engine::cleanup()
 
     Commands::instance()->clear();
 
+    for (size_t i = 0; i < _pluginConfigSubscriptions.size(); ++i)
+    {
+        FileWatcher::instance()->unsubscribe(_pluginConfigSubscriptions[i]);
+    }
+    _pluginConfigSubscriptions.clear();
+
+    Configuration::instance()->setHotReload(false);
+
     osg::ref_ptr<CleanPluginOperation> operation(new CleanPluginOperation(this));
     PluginHost::applyPluginOperation(operation.get());
 
@@ -608,8 +797,14 @@ void Engine::frame(bool usePlugins)
 
             firstFrimeTimeTick = osg::Timer::instance()->tick();
         }
+        else if (_pipelinedFrame && usePlugins)
+        {
+            pipelinedFrame();
+        }
         else
         {
+            finishRenderingTraversals();
+
             if (usePlugins)
             {
                 osg::ref_ptr<BeginningOfFramePluginOperation> pluginOperation(new BeginningOfFramePluginOperation(this));
@@ -620,6 +815,10 @@ void Engine::frame(bool usePlugins)
             _viewer->eventTraversal();
             _viewer->updateTraversal();
 
+            // The file changes seen since the last frame, coalesced
+            // so the reloads run here and never on the watching thread
+            FileWatcher::instance()->dispatch();
+
             if (usePlugins)
             {
                 osg::ref_ptr<UpdatePluginOperation> updatePluginOperation(new UpdatePluginOperation(this));
@@ -636,6 +835,10 @@ void Engine::frame(bool usePlugins)
                 PluginHost::applyPluginOperation(preFramePluginOperation.get());
             }
 
+            // Re-bin the entities moved by the plugins
+            // before the cull traversals use the octree
+            if (_entityRoot.valid()) _entityRoot->commit();
+
             _viewer->renderingTraversals();
 
             if (usePlugins)
@@ -659,6 +862,8 @@ void Engine::frame(bool usePlugins)
     osg::Timer_t now = osg::Timer::instance()->tick();
     if (_splashOn && osg::Timer::instance()->delta_s(firstFrimeTimeTick,now) > 5.0)
     {
+        finishRenderingTraversals();
+
         _splashOn = false;
         for (size_t i = 0; i < _viewer->getNumViews(); ++i)
         {
@@ -671,89 +876,256 @@ void Engine::frame(bool usePlugins)
     }
 }
 
-void Engine::preRender()
+void Engine::pipelinedFrame()
 {
-    if (_viewer->getNumViews() != 0)
+    if (!_renderThread)
     {
-        for (unsigned int cameraID = 0; cameraID < _viewer->getNumViews(); ++cameraID)
-        {
-            osg::ref_ptr<osg::Camera> camera = _viewer->getView(cameraID)->getCamera();
+        _renderThread = new RenderThread(_viewer.get());
+        _renderThread->startThread();
+    }
 
-            unsigned int    id = 0;
-            osg::Matrixd    offset;
-            bool            bind = false;
+    // The end of the previous frame, once it is rendered
+    bool previousFrame = _renderingTraversalsPending;
+    finishRenderingTraversals();
 
-            if (camera->getUserValue("bindOffset", offset) &&
-                camera->getUserValue("bindTo", id) &&
-                camera->getUserValue("bindToEntity", bind))
-            {
-                if (bind)
-                {
-                    EntityMapIterator itr = _entities.find(id);
-                    if (itr == _entities.end())
-                        return;
+    if (previousFrame)
+    {
+        osg::ref_ptr<PostFramePluginOperation> postFramePluginOperation(
+            new PostFramePluginOperation(this, _viewer->getFrameStamp()->getSimulationTime())
+            );
+        PluginHost::applyPluginOperation(postFramePluginOperation.get());
 
-                    bool freezeOrientation = false;
-                    camera->getUserValue("freeze", freezeOrientation);
+        osg::ref_ptr<EndOfFramePluginOperation> endOfFramePluginOperation(
+            new EndOfFramePluginOperation(this)
+            );
+        PluginHost::applyPluginOperation(endOfFramePluginOperation.get());
+    }
 
-                    osg::NodePath np;
+    _viewer->advance();
+    _viewer->eventTraversal();
+    _viewer->updateTraversal();
 
-                    osg::ref_ptr<osg::MatrixTransform> e = new osg::MatrixTransform;
-                    if (freezeOrientation)
-                    {
-                        e->setMatrix(osg::Matrixd::translate(itr->second->getMatrix().getTrans()));
-                        np.push_back(e);
-                    }
-                    else
-                    {
-                        np.push_back(itr->second);
-                    }
+    FileWatcher::instance()->dispatch();
 
-                    osg::ref_ptr<osg::Group> parent = itr->second->getNumParents() ? itr->second->getParent(0) : 0;
-                    while (parent)
-                    {
-                        np.insert(np.begin(), parent);
-                        parent = parent->getNumParents() ? parent->getParent(0) : 0;
-                    }
+    // The plugins that change the scene in their update run in sequence
+    osg::ref_ptr<PipelineSafePluginOperation> beginningOfFrameOperation(
+        new PipelineSafePluginOperation(new BeginningOfFramePluginOperation(this), false)
+        );
+    PluginHost::applyPluginOperation(beginningOfFrameOperation.get());
 
-                    osg::Matrixd wmx = osg::computeLocalToWorld(np);
+    osg::ref_ptr<PipelineSafePluginOperation> updateOperation(
+        new PipelineSafePluginOperation(new UpdatePluginOperation(this), false)
+        );
+    PluginHost::applyPluginOperation(updateOperation.get());
 
-                    osg::Matrixd final = offset * wmx;
+    preRender();
 
-                    bool fixedUp = false;
-                    if (camera->getUserValue("fixedUp", fixedUp) && fixedUp)
-                    {
-                        osg::Vec3d  scale = wmx.getScale();
-                        osg::Quat   rotation = wmx.getRotate();
-                        osg::Vec3d  translate = wmx.getTrans();
+    osg::ref_ptr<PreFramePluginOperation> preFramePluginOperation(
+        new PreFramePluginOperation(this, _viewer->getFrameStamp()->getSimulationTime())
+        );
+    PluginHost::applyPluginOperation(preFramePluginOperation.get());
 
-                        OpenIG::Base::Math::instance()->fixVerticalAxis(translate, rotation, false);
+    if (_entityRoot.valid()) _entityRoot->commit();
 
-                        wmx = osg::Matrixd::scale(scale)*osg::Matrixd::rotate(rotation)*osg::Matrixd::translate(translate);
-                        final = offset * wmx;
-                    }
+    _renderingTraversalsPending = true;
+    _renderThread->request();
 
-                    setCameraPosition(final,false,cameraID);
+    // Cleared before the pipeline safe plugins set
+    // the attributes for the next frame
+    postRender();
 
-                }
+    // Overlapped with the rendering: the update of the pipeline safe
+    // plugins for the next frame, with their entity, light and camera
+    // updates buffered till then
+    osg::ref_ptr<PipelineSafePluginOperation> pipelinedBeginningOfFrameOperation(
+        new PipelineSafePluginOperation(new BeginningOfFramePluginOperation(this), true)
+        );
+    PluginHost::applyPluginOperation(pipelinedBeginningOfFrameOperation.get());
+
+    osg::ref_ptr<PipelineSafePluginOperation> pipelinedUpdateOperation(
+        new PipelineSafePluginOperation(new UpdatePluginOperation(this), true)
+        );
+    PluginHost::applyPluginOperation(pipelinedUpdateOperation.get());
+}
+
+void Engine::setPipelinedFrame(bool pipelined)
+{
+    if (_pipelinedFrame == pipelined) return;
+
+    finishRenderingTraversals();
+
+    if (!pipelined && _renderThread)
+    {
+        _renderThread->quit();
+        delete _renderThread;
+        _renderThread = 0;
+    }
+
+    // The rendering traversals move between threads, so
+    // the contexts are to be released at the end of each frame
+    if (pipelined && _viewer.valid()) _viewer->setReleaseContextAtEndOfFrameHint(true);
+
+    _pipelinedFrame = pipelined;
+}
+
+void Engine::finishRenderingTraversals()
+{
+    if (!_renderingTraversalsPending) return;
+
+    _renderThread->wait();
+    _renderingTraversalsPending = false;
+
+    applyBufferedUpdates();
+}
+
+void Engine::applyBufferedUpdates()
+{
+    if (!_bufferedEntityUpdates.empty())
+    {
+        updateEntities(&_bufferedEntityUpdates.front(), _bufferedEntityUpdates.size());
+        _bufferedEntityUpdates.clear();
+    }
+
+    for (size_t i = 0; i < _bufferedLightUpdates.size(); ++i)
+    {
+        updateLight(_bufferedLightUpdates[i].id, _bufferedLightUpdates[i].mx);
+    }
+    _bufferedLightUpdates.clear();
+
+    for (size_t i = 0; i < _bufferedLightAttributes.size(); ++i)
+    {
+        updateLightAttributes(_bufferedLightAttributes[i].first, _bufferedLightAttributes[i].second);
+    }
+    _bufferedLightAttributes.clear();
+
+    BufferedCameraMatrices::iterator itr = _bufferedCameraMatrices.begin();
+    for (; itr != _bufferedCameraMatrices.end(); ++itr)
+    {
+        setCameraPosition(itr->second, true, itr->first);
+    }
+    _bufferedCameraMatrices.clear();
+}
+
+Engine::CameraBinding& Engine::getCameraBinding(unsigned int cameraID)
+{
+    if (cameraID >= _cameraBindings.size())
+    {
+        _cameraBindings.resize(cameraID + 1);
+    }
+    return _cameraBindings.at(cameraID);
+}
+
+const osg::Matrixd& Engine::getBindParentWorldMatrix(CameraBinding& binding, osg::MatrixTransform* entity)
+{
+    bool rebuild = !binding.chainValid || binding.chainRevision != _hierarchyRevision || binding.entity.get() != entity;
+    for (size_t i = 0; !rebuild && i < binding.chain.size(); ++i)
+    {
+        rebuild = !binding.chain.at(i).valid();
+    }
+
+    if (rebuild)
+    {
+        // The transforms from the root down to the parent of the entity.
+        // Only the transforms contribute to the world matrix
+        binding.chain.clear();
+        binding.chainMatrices.clear();
+
+        osg::Group* parent = entity->getNumParents() ? entity->getParent(0) : 0;
+        while (parent)
+        {
+            osg::Transform* transform = parent->asTransform();
+            if (transform)
+            {
+                binding.chain.push_back(transform);
             }
+            parent = parent->getNumParents() ? parent->getParent(0) : 0;
+        }
+        std::reverse(binding.chain.begin(), binding.chain.end());
+        binding.chainMatrices.resize(binding.chain.size());
 
-            osg::ref_ptr<osg::UserDataContainer> container = camera->getUserDataContainer();
-            if (!container.valid()) continue;
+        binding.entity = entity;
+        binding.chainRevision = _hierarchyRevision;
+    }
+
+    // Recompute only if one of the matrices changed. Transforms
+    // other than MatrixTransform are always recomputed
+    bool changed = rebuild;
+    for (size_t i = 0; i < binding.chain.size(); ++i)
+    {
+        osg::MatrixTransform* mxt = binding.chain.at(i)->asMatrixTransform();
+        if (!mxt || mxt->getMatrix() != binding.chainMatrices.at(i))
+        {
+            if (mxt) binding.chainMatrices.at(i) = mxt->getMatrix();
+            changed = true;
+        }
+    }
 
-            for (size_t i = 0; i < container->getNumUserObjects(); ++i)
+    if (changed)
+    {
+        binding.parentWorld.makeIdentity();
+        for (size_t i = 0; i < binding.chain.size(); ++i)
+        {
+            binding.chain.at(i)->computeLocalToWorldMatrix(binding.parentWorld, 0);
+        }
+        binding.chainValid = true;
+    }
+
+    return binding.parentWorld;
+}
+
+void Engine::preRender()
+{
+    const unsigned int numViews = osg::minimum(_viewer->getNumViews(), (unsigned int)_cameraBindings.size());
+    for (unsigned int cameraID = 0; cameraID < numViews; ++cameraID)
+    {
+        CameraBinding& binding = _cameraBindings.at(cameraID);
+        osg::Camera* camera = _viewer->getView(cameraID)->getCamera();
+
+        if (binding.bound)
+        {
+            // A missing entity skips this view only
+            osg::MatrixTransform* entity = _entities.get(binding.entityID);
+            if (entity)
             {
-                osg::ref_ptr<osg::MatrixTransform> entity = dynamic_cast<osg::MatrixTransform*>(container->getUserObject(i));
-                if (!entity.valid()) continue;
+                const osg::Matrixd& parentWorld = getBindParentWorldMatrix(binding, entity);
 
-                osg::Matrixd mx;
-                entity->getUserValue("BindToCameraOffset", mx);
+                osg::Matrixd wmx = binding.freeze ?
+                    osg::Matrixd::translate(entity->getMatrix().getTrans()) * parentWorld :
+                    entity->getMatrix() * parentWorld;
 
-                osg::Matrixd wmx = mx * camera->getInverseViewMatrix();
+                if (binding.fixedUp)
+                {
+                    osg::Vec3d  scale = wmx.getScale();
+                    osg::Quat   rotation = wmx.getRotate();
+                    osg::Vec3d  translate = wmx.getTrans();
 
-                entity->setMatrix(wmx);
+                    OpenIG::Base::Math::instance()->fixVerticalAxis(translate, rotation, false);
+
+                    wmx = osg::Matrixd::scale(scale)*osg::Matrixd::rotate(rotation)*osg::Matrixd::translate(translate);
+                }
+
+                setCameraPosition(binding.offset * wmx, false, cameraID);
             }
         }
+
+        if (binding.entities.empty()) continue;
+
+        const osg::Matrixd inverseViewMatrix = camera->getInverseViewMatrix();
+
+        CameraBoundEntities::iterator itr = binding.entities.begin();
+        while (itr != binding.entities.end())
+        {
+            osg::MatrixTransform* entity = _entities.get(itr->handle);
+            if (!entity)
+            {
+                // Removed or replaced since it was bound
+                itr = binding.entities.erase(itr);
+                continue;
+            }
+
+            entity->setMatrix(itr->offset * inverseViewMatrix);
+            ++itr;
+        }
     }
 }
 
@@ -766,6 +1138,8 @@ void Engine::postRender()
 
 void Engine::addEntity(unsigned int id, const std::string& fileName, const osg::Matrixd& mx, const osgDB::Options* options)
 {
+    finishRenderingTraversals();
+
     osgDB::getDataFilePathList().push_back(osgDB::getFilePath(fileName));
 
     if (options != 0 && !options->getOptionString().empty())
@@ -809,6 +1183,11 @@ void Engine::addEntity(unsigned int id, const std::string& fileName, const osg::
         return;
     }
 
+    addEntityNode(id, model.get(), mx, fileName, options != 0 ? options->getOptionString() : std::string());
+}
+
+void Engine::addEntityNode(unsigned int id, osg::Node* model, const osg::Matrixd& mx, const std::string& fileName, const std::string& optionString)
+{
     osg::ref_ptr<osg::MatrixTransform> mxt = new osg::MatrixTransform;
     mxt->addChild(model);
     mxt->setMatrix(mx);
@@ -818,9 +1197,11 @@ void Engine::addEntity(unsigned int id, const std::string& fileName, const osg::
     mxt->setName(oss.str());
     mxt->setUserValue("fileName",fileName);
     mxt->setUserValue("ID",id);
+    if (!optionString.empty()) mxt->setUserValue("optionString",optionString);
 
-    _entities[id] = mxt;
-    getScene()->asGroup()->addChild(mxt);
+    _entities.insert(id, mxt);
+    _entityRoot->addChild(mxt);
+    ++_hierarchyRevision;
 
     osg::ref_ptr<AddEntityPluginOperation> pluginOperation(new AddEntityPluginOperation(this,mxt,id,fileName));
     this->applyPluginOperation(pluginOperation.get());
@@ -828,6 +1209,8 @@ void Engine::addEntity(unsigned int id, const std::string& fileName, const osg::
 
 void Engine::addEntity(unsigned int id, const osg::Node* node, const osg::Matrixd& mx, const osgDB::Options* options)
 {
+    finishRenderingTraversals();
+
     osg::ref_ptr<osg::Node> model = const_cast<osg::Node*>(node);
 
     if (options != 0 && !options->getOptionString().empty())
@@ -854,8 +1237,9 @@ void Engine::addEntity(unsigned int id, const osg::Node* node, const osg::Matrix
     mxt->setName(oss.str());
     mxt->setUserValue("ID", id);
 
-    _entities[id] = mxt;
-    getScene()->asGroup()->addChild(mxt);
+    _entities.insert(id, mxt);
+    _entityRoot->addChild(mxt);
+    ++_hierarchyRevision;
 
     osg::ref_ptr<AddEntityPluginOperation> pluginOperation(new AddEntityPluginOperation(this, mxt, id, "fromNode"));
     this->applyPluginOperation(pluginOperation.get());
@@ -863,6 +1247,8 @@ void Engine::addEntity(unsigned int id, const osg::Node* node, const osg::Matrix
 
 void Engine::reloadEntity(unsigned int id, const std::string& fileName, const osgDB::Options* options)
 {
+    finishRenderingTraversals();
+
     EntityMapIterator itr = _entities.find(id);
     if (itr == _entities.end())
         return;
@@ -881,6 +1267,7 @@ void Engine::reloadEntity(unsigned int id, const std::string& fileName, const os
     osg::notify(osg::NOTICE) << "OpenIG: reloading :" << fileName << std::endl;
 
     itr->second->setUserValue("fileName", fileName);
+    itr->second->setUserValue("optionString", options != 0 ? options->getOptionString() : std::string());
     itr->second->replaceChild(itr->second->getChild(0), model);
 
     osg::notify(osg::NOTICE) << "OpenIG: reloading done:" << fileName << std::endl;
@@ -947,28 +1334,60 @@ unsigned int Engine::getEntityId(unsigned int parentEntityId, const std::string&
 
 void Engine::removeEntity(unsigned int id)
 {
+    finishRenderingTraversals();
+
     EntityMapIterator itr = _entities.find(id);
     if (itr == _entities.end())
         return;
 
-    getScene()->asGroup()->removeChild(itr->second);
+    _entityRoot->removeChild(itr->second);
     _entities.erase(itr);
+    ++_hierarchyRevision;
+
+    AnimationStatusMap::iterator aitr = _animationStatus.lower_bound(AnimationKey(id, std::string()));
+    while (aitr != _animationStatus.end() && aitr->first.first == id)
+    {
+        _animationStatus.erase(aitr++);
+    }
 }
 
 void Engine::updateEntity(unsigned int id, const osg::Matrixd& mx)
 {
-    EntityMapIterator itr = _entities.find(id);
-    if (itr == _entities.end())
+    if (_renderingTraversalsPending)
+    {
+        _bufferedEntityUpdates.push_back(EntityUpdate(id, mx));
+        return;
+    }
+
+    osg::MatrixTransform* entity = _entities.get(id);
+    if (entity)
+    {
+        entity->setMatrix(mx);
+    }
+}
+
+void Engine::updateEntities(const EntityUpdate* updates, size_t count)
+{
+    if (_renderingTraversalsPending)
+    {
+        _bufferedEntityUpdates.insert(_bufferedEntityUpdates.end(), updates, updates + count);
         return;
+    }
 
-    if (itr->second.valid())
+    for (size_t i = 0; i < count; ++i)
     {
-        itr->second->setMatrix(mx);
+        osg::MatrixTransform* entity = _entities.get(updates[i].id);
+        if (entity)
+        {
+            entity->setMatrix(updates[i].mx);
+        }
     }
 }
 
 void Engine::showEntity(unsigned int id, bool show)
 {
+    finishRenderingTraversals();
+
     EntityMapIterator itr = _entities.find(id);
     if (itr == _entities.end())
         return;
@@ -989,6 +1408,8 @@ void Engine::showEntity(unsigned int id, bool show)
 
 void Engine::bindToEntity(unsigned int id, unsigned int toEntityId)
 {
+    finishRenderingTraversals();
+
     EntityMapIterator itr = _entities.find(id);
     if (itr == _entities.end())
         return;
@@ -1006,11 +1427,13 @@ void Engine::bindToEntity(unsigned int id, unsigned int toEntityId)
     }
 
     titr->second->addChild(entity);
-
+    ++_hierarchyRevision;
 }
 
 void Engine::unbindFromEntity(unsigned int id)
 {
+    finishRenderingTraversals();
+
     EntityMapIterator itr = _entities.find(id);
     if (itr == _entities.end())
         return;
@@ -1036,100 +1459,62 @@ void Engine::unbindFromEntity(unsigned int id)
     }
 
     entity->setMatrix(wmx);
-	getScene()->asGroup()->addChild(entity);
+	_entityRoot->addChild(entity);
+    ++_hierarchyRevision;
 }
 
 void Engine::bindEntityToCamera(unsigned int id, const osg::Matrixd& mx, unsigned int cameraID)
 {
-    if (cameraID >= _viewer->getNumViews()) return;
-
-    EntityMapIterator itr = _entities.find(id);
-    if (itr == _entities.end()) return;
+    finishRenderingTraversals();
 
-    osg::ref_ptr<osg::MatrixTransform> entity = itr->second;
-    if (!entity.valid()) return;
-
-    osg::ref_ptr<osg::Camera> camera = _viewer->getView(cameraID)->getCamera();
+    if (cameraID >= _viewer->getNumViews()) return;
 
-    osg::ref_ptr<osg::UserDataContainer> container = camera->getOrCreateUserDataContainer();
-    if (!container.valid()) return;
+    if (!_entities.get(id)) return;
 
-    container->addUserObject(entity);
-    entity->setUserValue("BindToCameraOffset", mx);
+    CameraBinding& binding = getCameraBinding(cameraID);
 
-    std::string cameras;
-    entity->getUserValue("BindCameras", cameras);
+    CameraBoundEntities::iterator itr = binding.entities.begin();
+    for (; itr != binding.entities.end(); ++itr)
+    {
+        if (itr->handle.id == id) break;
+    }
+    if (itr == binding.entities.end())
+    {
+        itr = binding.entities.insert(binding.entities.end(), CameraBoundEntity());
+    }
 
-    std::ostringstream oss;
-    oss << cameras << ":" << cameraID;
-    entity->setUserValue("BindCameras", oss.str());
+    itr->handle = _entities.getHandle(id);
+    itr->offset = mx;
 }
 
 void Engine::bindEntityToCameraUpdate(unsigned int id, const osg::Matrixd& mx)
 {
-    EntityMapIterator itr = _entities.find(id);
-    if (itr == _entities.end()) return;
-
-    osg::ref_ptr<osg::MatrixTransform> entity = itr->second;
-    if (!entity.valid()) return;
-
-    entity->setUserValue("BindToCameraOffset", mx);
-}
-
-void Engine::unbindEntityFromCamera(unsigned int id)
-{
-    EntityMapIterator itr = _entities.find(id);
-    if (itr == _entities.end()) return;
-
-    osg::ref_ptr<osg::MatrixTransform> entity = itr->second;
-    if (!entity.valid()) return;
-
-    std::string cameras;
-    entity->getUserValue("BindCameras", cameras);
-
-    unsigned int cameraID = 0;
-
-    StringUtils::Tokens tokens = StringUtils::instance()->tokenize(cameras, ":");
-    StringUtils::TokensIterator titr = tokens.begin();
-    for (; titr != tokens.end(); ++titr)
+    for (CameraBindings::iterator bitr = _cameraBindings.begin(); bitr != _cameraBindings.end(); ++bitr)
     {
-        cameraID = atoi(titr->c_str());
-
-        if (cameraID >= _viewer->getNumViews()) continue;
-
-        osg::ref_ptr<osg::Camera> camera = _viewer->getView(cameraID)->getCamera();
-
-        osg::ref_ptr<osg::UserDataContainer> container = camera->getUserDataContainer();
-        if (!container.valid()) continue;
-
-        bool removed = false;
-        for (size_t i = 0; i < container->getNumUserObjects(); ++i)
+        CameraBoundEntities::iterator itr = bitr->entities.begin();
+        for (; itr != bitr->entities.end(); ++itr)
         {
-            osg::ref_ptr<osg::MatrixTransform> object = dynamic_cast<osg::MatrixTransform*>(container->getUserObject(i));
-            if (!object.valid()) continue;
-
-            if (object == entity)
+            if (itr->handle.id == id)
             {
-                container->removeUserObject(i);
-                removed = true;
-                break;
+                itr->offset = mx;
             }
         }
-        if (removed) break;
     }
+}
 
-    std::ostringstream oss;
+void Engine::unbindEntityFromCamera(unsigned int id)
+{
+    finishRenderingTraversals();
 
-    titr = tokens.begin();
-    for (; titr != tokens.end(); ++titr)
+    for (CameraBindings::iterator bitr = _cameraBindings.begin(); bitr != _cameraBindings.end(); ++bitr)
     {
-        if (atoi(titr->c_str()) != cameraID)
+        CameraBoundEntities::iterator itr = bitr->entities.begin();
+        while (itr != bitr->entities.end())
         {
-            oss << ":" << *titr;
+            if (itr->handle.id == id) itr = bitr->entities.erase(itr);
+            else ++itr;
         }
     }
-
-    entity->setUserValue("BindCameras", oss.str());
 }
 
 
@@ -1247,6 +1632,10 @@ void Engine::initScene()
             _scene = new osg::Group;
         }
 
+        _entityRoot = new OpenIG::Base::EntityRoot;
+        _entityRoot->setName("Entities");
+        _scene->addChild(_entityRoot);
+
         _lightsGroup = new osg::Group;
 
         _fog = new osg::Fog;
@@ -1362,6 +1751,12 @@ void Engine::setCameraPosition(const osg::Matrixd& mx, bool viewMatrix, unsigned
     if (_viewer->getNumViews()==0) return;
     if (cameraID >= _viewer->getNumViews()) return;
 
+    if (_renderingTraversalsPending)
+    {
+        _bufferedCameraMatrices[cameraID] = viewMatrix ? mx : osg::Matrixd::inverse(mx);
+        return;
+    }
+
     switch (viewMatrix)
     {
     case true:
@@ -1387,6 +1782,12 @@ void Engine::bindCameraToEntity(unsigned int id, const osg::Matrixd& mx, unsigne
         camera->setUserValue("bindOffset",mx);
         camera->setUserValue("bindTo",id);
         camera->setUserValue("bindToEntity",(bool)true);
+
+        CameraBinding& binding = getCameraBinding(cameraID);
+        binding.bound = true;
+        binding.entityID = id;
+        binding.offset = mx;
+        binding.chainValid = false;
     }
 }
 
@@ -1398,6 +1799,10 @@ void Engine::bindCameraSetFixedUp(bool fixedUp, bool freezeOrientation, unsigned
         camera->setUserValue("fixedUp",(bool)fixedUp);
         camera->setUserValue("freeze", (bool)freezeOrientation);
 
+        CameraBinding& binding = getCameraBinding(cameraID);
+        binding.fixedUp = fixedUp;
+        binding.freeze = freezeOrientation;
+
     }
 }
 
@@ -1407,19 +1812,19 @@ void Engine::bindCameraUpdate(const osg::Matrixd& mx, unsigned int cameraID)
     {
         osg::ref_ptr<osg::Camera> camera = _viewer->getView(cameraID)->getCamera();
         camera->setUserValue("bindOffset",mx);
+
+        getCameraBinding(cameraID).offset = mx;
     }
 }
 
 bool Engine::isCameraBoundToEntity(unsigned int cameraID)
 {
-    bool bound = false;
-    if (_viewer.valid() && _viewer->getNumViews() != 0 && cameraID < _viewer->getNumViews())
+    if (_viewer.valid() && cameraID < _viewer->getNumViews() && cameraID < _cameraBindings.size())
     {
-        osg::ref_ptr<osg::Camera> camera = _viewer->getView(cameraID)->getCamera();
-        camera->getUserValue("bindToEntity",bound);
+        return _cameraBindings.at(cameraID).bound;
     }
 
-    return bound;
+    return false;
 }
 
 void Engine::unbindCameraFromEntity(unsigned int cameraID)
@@ -1429,23 +1834,34 @@ void Engine::unbindCameraFromEntity(unsigned int cameraID)
         osg::ref_ptr<osg::Camera> camera = _viewer->getView(cameraID)->getCamera();
 
         camera->setUserValue("bindToEntity",(bool)false);
+
+        getCameraBinding(cameraID).bound = false;
     }
 }
 
 void Engine::setFog(double visibility)
 {
+    finishRenderingTraversals();
+
     if (_fog.valid())
     {
         _fog->setDensity(3.912/visibility);
         _fog->setColor(osg::Vec4(0.9,0.9,0.9,1.0));
     }
 
+    _environment.hasFog = true;
+    _environment.visibility = visibility;
+
     OpenIG::Base::FogAttributes fog(visibility);
     _context.addAttribute("Fog", new PluginContext::Attribute<OpenIG::Base::FogAttributes>(fog));
 }
 
 void Engine::setWind(float speed, float direction)
 {
+    _environment.hasWind = true;
+    _environment.windSpeed = speed;
+    _environment.windDirection = direction;
+
     OpenIG::Base::WindAttributes attr(speed,direction);
     _context.addAttribute("Wind", new PluginContext::Attribute<OpenIG::Base::WindAttributes>(attr));
 }
@@ -1454,6 +1870,10 @@ void Engine::setTimeOfDay(unsigned int hour, unsigned int minutes)
 {
     if (hour < 24)
     {
+        _environment.hasTimeOfDay = true;
+        _environment.hour = hour;
+        _environment.minutes = minutes;
+
         OpenIG::Base::TimeOfDayAttributes tod((hour ? hour : 1),minutes);
         _context.addAttribute("TOD", new PluginContext::Attribute<OpenIG::Base::TimeOfDayAttributes>(tod));
     }
@@ -1461,18 +1881,29 @@ void Engine::setTimeOfDay(unsigned int hour, unsigned int minutes)
 
 void Engine::setDate(unsigned int month, int day, int year)
 {
+    _environment.hasDate = true;
+    _environment.month = month;
+    _environment.day = day;
+    _environment.year = year;
+
     OpenIG::Base::DateAttributes date(month,day,year);
     _context.addAttribute("Date", new PluginContext::Attribute<OpenIG::Base::DateAttributes>(date));
 }
 
 void Engine::setRain(double factor)
 {
+    _environment.hasRain = true;
+    _environment.rain = factor;
+
     OpenIG::Base::RainSnowAttributes rain(factor);
     _context.addAttribute("Rain", new PluginContext::Attribute<OpenIG::Base::RainSnowAttributes>(rain));
 }
 
 void Engine::setSnow(double factor)
 {
+    _environment.hasSnow = true;
+    _environment.snow = factor;
+
     OpenIG::Base::RainSnowAttributes snow(factor);
     _context.addAttribute("Snow", new PluginContext::Attribute<OpenIG::Base::RainSnowAttributes>(snow));
 }
@@ -1489,6 +1920,14 @@ void Engine::addCloudLayer(unsigned int id, int type, double altitude, double th
     attr.setIsDirty(true);
     attr.setThickness(thickness);
 
+    SceneSnapshot::CloudLayer& layer = _cloudLayers[id];
+    layer.id = id;
+    layer.type = type;
+    layer.altitude = altitude;
+    layer.thickness = thickness;
+    layer.density = density;
+    layer.enabled = enable;
+
     _context.addAttribute("CloudLayer", new PluginContext::Attribute<OpenIG::Base::CLoudLayerAttributes>(attr));
 }
 
@@ -1498,6 +1937,9 @@ void Engine::enableCloudLayer(unsigned int id, bool enableIn)
     attr.setId(id);
     attr.setFlags(false, false, enableIn);
 
+    CloudLayers::iterator itr = _cloudLayers.find(id);
+    if (itr != _cloudLayers.end()) itr->second.enabled = enableIn;
+
     //osg::notify(osg::NOTICE) << "Engine::enableCloudLayerFile( " << id << ", " << enableIn << ")" << std::endl;
     _context.addAttribute("EnableCloudLayer", new PluginContext::Attribute<OpenIG::Base::CLoudLayerAttributes>(attr));
 }
@@ -1509,11 +1951,15 @@ void Engine::removeCloudLayer(unsigned int id)
     attr.setFlags(false,true);
     attr.setIsDirty(true);
 
+    _cloudLayers.erase(id);
+
     _context.addAttribute("CloudLayer", new PluginContext::Attribute<OpenIG::Base::CLoudLayerAttributes>(attr));
 }
 
 void Engine::removeAllCloudlayers()
 {
+    _cloudLayers.clear();
+
     _context.addAttribute("RemoveAllCloudLayers", new osg::Referenced);
 }
 
@@ -1526,6 +1972,14 @@ void Engine::updateCloudLayer(unsigned int id, double altitude, double thickness
     attr.setThickness(thickness);
     attr.setIsDirty(true);
 
+    CloudLayers::iterator itr = _cloudLayers.find(id);
+    if (itr != _cloudLayers.end())
+    {
+        itr->second.altitude = altitude;
+        itr->second.thickness = thickness;
+        itr->second.density = density;
+    }
+
     _context.addAttribute("CloudLayer", new PluginContext::Attribute<OpenIG::Base::CLoudLayerAttributes>(attr));
 }
 
@@ -1576,6 +2030,8 @@ void Engine::resetAnimation(unsigned int entityId, const std::string& animationN
     attr.playback = false;
     attr.reset = true;
 
+    _animationStatus.erase(AnimationKey(entityId, animationName));
+
     _context.addAttribute("Animation", new PluginContext::Attribute<OpenIG::Base::AnimationAttributes>(attr));
 }
 
@@ -1595,6 +2051,8 @@ void Engine::stopAnimation(unsigned int entityId, const std::string& animationNa
     attr.animationName = animationName;
     attr.playback = false;
 
+    _animationStatus.erase(AnimationKey(entityId, animationName));
+
     _context.addAttribute("Animation", new PluginContext::Attribute<OpenIG::Base::AnimationAttributes>(attr));
 }
 
@@ -1613,6 +2071,8 @@ void Engine::playAnimation(unsigned int entityId, const std::string& animationNa
     attr.entityId = entityId;
     attr.animationName = animationName;
 
+    _animationStatus[AnimationKey(entityId, animationName)] = Play;
+
     _context.addAttribute("Animation", new PluginContext::Attribute<OpenIG::Base::AnimationAttributes>(attr));
 
 }
@@ -1640,6 +2100,9 @@ void Engine::changeAnimationStatus(unsigned int entityId, ImageGenerator::Animat
                 attr.animationName = *itr;
                 attr.pause = true;
 
+                AnimationStatusMap::iterator aitr = _animationStatus.find(AnimationKey(entityId, *itr));
+                if (aitr != _animationStatus.end()) aitr->second = Pause;
+
                 _context.addAttribute("Animation", new PluginContext::Attribute<OpenIG::Base::AnimationAttributes>(attr));
             }
         }
@@ -1654,6 +2117,9 @@ void Engine::changeAnimationStatus(unsigned int entityId, ImageGenerator::Animat
             attr.animationName = *itr;
             attr.restore = true;
 
+            AnimationStatusMap::iterator aitr = _animationStatus.find(AnimationKey(entityId, *itr));
+            if (aitr != _animationStatus.end()) aitr->second = Play;
+
             _context.addAttribute("Animation", new PluginContext::Attribute<OpenIG::Base::AnimationAttributes>(attr));
         }
     }
@@ -1677,6 +2143,8 @@ void Engine::playAnimation(unsigned int entityId, const std::string& animationNa
     attr.animationName = animationName;
     attr.sequenceCallbacks = cbs;
 
+    _animationStatus[AnimationKey(entityId, animationName)] = Play;
+
     _context.addAttribute("Animation", new PluginContext::Attribute<OpenIG::Base::AnimationAttributes>(attr));
 }
 
@@ -39,6 +39,8 @@
 
     #include <OpenIG-Base/ImageGenerator.h>
     #include <OpenIG-Base/Types.h>
+    #include <OpenIG-Base/EntityRoot.h>
+    #include <OpenIG-Base/SceneSnapshot.h>
 
     #include <OpenIG-PluginBase/PluginHost.h>
     #include <OpenIG-PluginBase/PluginContext.h>
@@ -48,6 +50,8 @@
 
     #include <Core-Base/ImageGenerator.h>
     #include <Core-Base/Types.h>
+    #include <Core-Base/EntityRoot.h>
+    #include <Core-Base/SceneSnapshot.h>
 
     #include <Core-PluginBase/PluginHost.h>
     #include <Core-PluginBase/PluginContext.h>
@@ -56,9 +60,17 @@
 #include <OpenThreads/Mutex>
 #include <OpenThreads/ScopedLock>
 
+#include <osg/Transform>
+#include <osg/observer_ptr>
+
+#include <vector>
+
 namespace OpenIG
 {
 
+/*! \brief Runs the rendering traversals of the pipelined frame, see \ref Engine::setPipelinedFrame */
+class RenderThread;
+
 /*! Implementation of \ref OpenIG::Base::ImageGenerator
  * \brief The OpenIG class
  * \author    Trajce Nikolov Nick openig@compro.net
@@ -95,6 +107,45 @@ public:
      */
     virtual void loadScript(const std::string& fileName);
 
+    /*! Captures the runtime state of the scene: the entities with their transforms
+     *  and bindings, the lights and their attributes, the effects, the animations
+     *  being played, the cameras and the environment as last set
+     * \brief Captures the runtime state of the scene
+     * \param snapshot    The snapshot to fill, cleared first
+     */
+    virtual void takeSnapshot(OpenIG::Base::SceneSnapshot& snapshot);
+
+    /*! Restores the state captured with \ref takeSnapshot. The models of the
+     *  entities are read in parallel, with the osgDB options they were added with,
+     *  and added to the scene in one go, then the
+     *  bindings, transforms, lights, effects, animations, cameras and the
+     *  environment are applied. Entities, lights and effects already in the
+     *  scene with the same ID are updated rather than created again, the rest
+     *  of the scene is left as it is. Animations restart from their beginning
+     * \brief Restores a snapshot of the scene
+     * \param snapshot    The snapshot
+     */
+    virtual void restoreSnapshot(const OpenIG::Base::SceneSnapshot& snapshot);
+
+    /*! Captures the state of the scene and writes it to a binary file,
+     *  see \ref takeSnapshot and \ref OpenIG::Base::SceneSnapshot
+     * \brief Writes a snapshot of the scene to a file
+     * \param fileName    The file name
+     * \return            true on success
+     */
+    virtual bool writeSnapshot(const std::string& fileName);
+
+    /*! Reads a snapshot written with \ref writeSnapshot and restores it, see
+     *  \ref restoreSnapshot. It is a faster alternative to replaying the startup
+     *  scripts, and the way for a restarted channel to get back in sync. With
+     *  Startup-Snapshot set in the OpenIG config the snapshot is restored at the
+     *  end of \ref init
+     * \brief Reads and restores a snapshot of the scene from a file
+     * \param fileName    The file name
+     * \return            true on success, false if the file is not a valid snapshot
+     */
+    virtual bool readSnapshot(const std::string& fileName);
+
     /*!
      * \brief Gets the version
      * \return The version
@@ -237,6 +288,26 @@ public:
      */
     virtual void frame(bool usePlugins = true);
 
+    /*! Turns the pipelined frame on or off. With it on, \ref frame hands the rendering
+     *  traversals of the frame to a render thread and returns while they run, after
+     *  calling the update of the plugins that are pipeline safe (see
+     *  \ref OpenIG::PluginBase::Plugin::isUpdatePipelineSafe) for the next frame. The
+     *  entity, light and camera updates made while the frame is rendered, by these plugins
+     *  or by the application between the calls to \ref frame, are double buffered and
+     *  applied to the scene when the next frame starts. Any other change of the scene
+     *  waits for the rendering first. The rest of the plugins update in sequence as before.
+     *  It can be set with Pipelined-Frame in the OpenIG config as well
+     *  \brief Turns the pipelined frame on or off
+     *  \param pipelined true for on
+     */
+    virtual void setPipelinedFrame(bool pipelined);
+
+    /*! Tells if the pipelined frame is on, see \ref setPipelinedFrame
+     *  \brief Tells if the pipelined frame is on
+     *  \return true if on
+     */
+    bool getPipelinedFrame() const { return _pipelinedFrame; }
+
     /*! Sets the Read node callback. Some might want to change how the file
     *	is read, like osgEarth for example. You have an option
     *	to read files differently then with osgDB::readNodeFile(...)
@@ -277,6 +348,33 @@ public:
     */
     virtual osgDB::Registry::ReadFileCallback* getReadFileCallback();
 
+    /*! A read model whose \ref OpenIG::PluginBase::Plugin::databaseRead hooks are still to run */
+    struct DatabaseRead
+    {
+        std::string                         fileName;
+        osg::ref_ptr<osg::Node>             node;
+        osg::ref_ptr<const osgDB::Options>  options;
+    };
+    typedef std::vector<DatabaseRead>       DatabaseReads;
+
+    /*! Runs the databaseRead hooks of the plugins on a read model, called by the
+     *  internal ReadFileCallback. With a list set by \ref setDeferredDatabaseReads on
+     *  the calling thread the read is added to it instead, for the hooks to be run
+     *  later on one thread
+     * \brief Runs the databaseRead hooks of the plugins on a read model
+     * \param fileName    The file name of the model
+     * \param node        The model
+     * \param options     The options it was read with
+     */
+    void databaseRead(const std::string& fileName, osg::Node* node, const osgDB::Options* options);
+
+    /*! The hooks of the plugins are not thread safe, so the threads reading in
+     *  parallel keep their reads there, in the order they completed
+     * \brief Sets the list the reads on the calling thread are deferred to, NULL for none
+     * \param reads       The list
+     */
+    static void setDeferredDatabaseReads(DatabaseReads* reads);
+
 
     /*! \ref OpenIG is using IDs for everything in the
      *  scene management. The IDs are mainly up to the user to maintain. However
@@ -339,6 +437,15 @@ public:
      */
     virtual void updateEntity(unsigned int id, const osg::Matrixd& mx);
 
+    /*! Updates many \ref Entity at once. See \ref OpenIG::Base::ImageGenerator::updateEntities
+     *  \brief Updates many \ref Entity at once
+     *  \param updates  Pointer to the first update
+     *  \param count    Number of updates
+     *  \return         Nothing
+     */
+    virtual void updateEntities(const EntityUpdate* updates, size_t count);
+    using OpenIG::Base::ImageGenerator::updateEntities;
+
     /*! Show/Hide Entity
      *  \brief Show/Hide Entity
      *  \param id       The id of the \ref Entity. This is the id you have used with \ref addEntity
@@ -566,6 +673,15 @@ public:
     */
     virtual void addEffect(unsigned int id, const std::string& name, const osg::Matrixd& mx, const std::string& attributes);
 
+    /*! Adds effect to the scene with already parsed, typed attributes. See \ref OpenIG::Base::EffectAttributes
+    *  \brief Adds effect to the scene with typed attributes
+    *  \param id	Unique effect to the scene
+    *  \param name	Name of the effect
+    *  \param mx	The initial position/orientation of the effect
+    *  \param attributes The typed attributes, can be NULL
+    */
+    virtual void addEffect(unsigned int id, const std::string& name, const osg::Matrixd& mx, OpenIG::Base::EffectAttributes* attributes);
+
     /*! Removes effect from the scene
     *  \brief Removes effect from the scene
     *  \param id	Unique effect to the scene
@@ -1245,6 +1361,76 @@ protected:
     /*! \brief  The current added in the scene \ref Entity es, ID based std::map */
     EntityMap                                       _entities;
 
+    /*! \brief  \ref Entity bound to a camera, see \ref bindEntityToCamera */
+    struct CameraBoundEntity
+    {
+        OpenIG::Base::EntityRegistry::Handle        handle;
+        osg::Matrixd                                offset;
+    };
+    typedef std::vector<CameraBoundEntity>          CameraBoundEntities;
+
+    /*! \brief  The bindings of a camera. Replaces the string keyed user values preRender used to
+     *          read every frame. The transforms above the bound entity are cached and their world
+     *          matrix is recomputed only when one of them has changed */
+    struct CameraBinding
+    {
+        CameraBinding()
+            : bound(false), entityID(0), fixedUp(false), freeze(false), chainRevision(0), chainValid(false) {}
+
+        bool                                        bound;
+        unsigned int                                entityID;
+        osg::Matrixd                                offset;
+        bool                                        fixedUp;
+        bool                                        freeze;
+
+        osg::observer_ptr<osg::MatrixTransform>     entity;
+        std::vector< osg::observer_ptr<osg::Transform> > chain;
+        std::vector<osg::Matrixd>                   chainMatrices;
+        osg::Matrixd                                parentWorld;
+        unsigned int                                chainRevision;
+        bool                                        chainValid;
+
+        CameraBoundEntities                         entities;
+    };
+    typedef std::vector<CameraBinding>              CameraBindings;
+
+    /*! \brief  The camera bindings, indexed by camera ID */
+    CameraBindings                                  _cameraBindings;
+    /*! \brief  Bumped on any change of the entity hierarchy, invalidates the cached chains */
+    unsigned int                                    _hierarchyRevision;
+
+    /*! \brief  Gets the binding of a camera, grows the table if needed */
+    CameraBinding& getCameraBinding(unsigned int cameraID);
+
+    /*! \brief  The render thread of the pipelined frame, created on the first pipelined frame */
+    RenderThread*                                   _renderThread;
+    /*! \brief  See \ref setPipelinedFrame */
+    bool                                            _pipelinedFrame;
+    /*! \brief  Set while the render thread may be traversing the scene, the updates are buffered meanwhile */
+    bool                                            _renderingTraversalsPending;
+
+    typedef std::pair<unsigned int, OpenIG::Base::LightAttributes>     BufferedLightAttributes;
+    typedef std::map<unsigned int, osg::Matrixd>                        BufferedCameraMatrices;
+
+    /*! \brief  The back buffer of the entity transforms, applied on the next frame */
+    EntityUpdates                                   _bufferedEntityUpdates;
+    /*! \brief  The back buffer of the light transforms, applied on the next frame */
+    EntityUpdates                                   _bufferedLightUpdates;
+    /*! \brief  The light attribute updates, applied in order on the next frame */
+    std::vector<BufferedLightAttributes>            _bufferedLightAttributes;
+    /*! \brief  The latest view matrix per camera, applied on the next frame */
+    BufferedCameraMatrices                          _bufferedCameraMatrices;
+
+    /*! \brief  The frame with the rendering overlapped, see \ref setPipelinedFrame */
+    void pipelinedFrame();
+    /*! \brief  Waits for the rendering traversals in flight, if any, and applies the buffered updates */
+    void finishRenderingTraversals();
+    /*! \brief  Applies the updates buffered while the previous frame was rendered */
+    void applyBufferedUpdates();
+
+    /*! \brief  The world matrix of the parent of the bound entity, from the cached chain */
+    const osg::Matrixd& getBindParentWorldMatrix(CameraBinding& binding, osg::MatrixTransform* entity);
+
     /*! \brief  Handle of the viewer you have passed in \ref init */
     osg::observer_ptr<osgViewer::CompositeViewer>        _viewer;
     /*! \brief  Handle of the sun/moon light source with reserved ID of 0*/
@@ -1253,6 +1439,8 @@ protected:
     osg::ref_ptr<osg::Fog>                          _fog;
     /*! \brief  The managed scene, which is osgShadow::Shadowed scene */
     osg::ref_ptr<osg::Group>                        _scene;
+    /*! \brief  The root of the top level entities, child of \ref _scene. Culls the entities per octree cell */
+    osg::ref_ptr<OpenIG::Base::EntityRoot>          _entityRoot;
     /*! \brief  Handle of the light implementation callback. See \ref setLightImplementationCallback */
     osg::observer_ptr<OpenIG::Base::LightImplementationCallback>  _lightImplementationCallback;
     /*! \brief  The \ref OpenIG::PluginBase::PluginContext to pass Attributes, ex: OpenIG::Base::FogAttributes
@@ -1288,6 +1476,10 @@ protected:
     typedef std::map< unsigned int, Effect >			EffectMap;
     EffectMap											_effects;
 
+    /*! \brief	Parsed effect attributes, keyed by the effect name and attribute string */
+    typedef std::map< std::string, osg::ref_ptr<OpenIG::Base::EffectAttributes> >	EffectAttributesCache;
+    EffectAttributesCache								_effectAttributesCache;
+
     /*! \brief The Light Attributes */
     LightAttributesMap								_lightAttributes;
 
@@ -1307,6 +1499,25 @@ protected:
     /*! \brief user ReadFileCallback*/
     osg::ref_ptr<osgDB::Registry::ReadFileCallback>				_userReadFileCallback;
 
+    /*! \brief FileWatcher subscriptions of the plugin configs, with Config-Hot-Reload on*/
+    std::vector<unsigned int>									_pluginConfigSubscriptions;
+
+    /*! \brief The environment as last set, kept for the snapshots */
+    OpenIG::Base::SceneSnapshot::Environment					_environment;
+
+    typedef std::map<unsigned int, OpenIG::Base::SceneSnapshot::CloudLayer>		CloudLayers;
+    /*! \brief The cloud layers as last set, kept for the snapshots */
+    CloudLayers													_cloudLayers;
+
+    typedef std::pair<unsigned int, std::string>				AnimationKey;
+    typedef std::map<AnimationKey, unsigned int>				AnimationStatusMap;
+    /*! \brief The animations played or paused, by entity and name, kept for the snapshots */
+    AnimationStatusMap											_animationStatus;
+
+    /*! \brief Adds a loaded model as an entity, the common part of \ref addEntity and \ref restoreSnapshot.
+     *  The option string the model was read with is kept for the snapshots */
+    void addEntityNode(unsigned int id, osg::Node* model, const osg::Matrixd& mx, const std::string& fileName, const std::string& optionString);
+
     /*!
      * \brief Init the viewer. It calls \ref initScene and add the
      * ViewerOperation for managing the Entity maps. See \ref OpenIG::Base::ImageGenerator::addEntity
@@ -1380,6 +1591,16 @@ protected:
     */
     void initEffects();
 
+    /*! Parses the token=attr;token=attr effect attribute string into typed
+    *	attributes. The result is cached by name and string so bursts of effects
+    *	with the same attributes are parsed only once
+    * \brief Parses effect attributes string
+    * \param name		The effect name
+    * \param attributes	The attribute string
+    * \return The parsed attributes
+    */
+    OpenIG::Base::EffectAttributes* parseEffectAttributes(const std::string& name, const std::string& attributes);
+
     /*! Creates sun/moon light with the reserved ID 0
     * \brief Creates sun/moon light with the reserved ID 0
     * \author    Trajce Nikolov Nick openig@compro.net
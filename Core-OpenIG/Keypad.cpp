@@ -212,7 +212,7 @@ osg::Vec3d KeyPadEventHandler::getHPRfromQuat(osg::Quat quat)
 
 void KeyPadEventHandler::bindToEntity(unsigned int id)
 {
-    _entity = _ig->getEntityMap()[id];
+    _entity = _ig->getEntityMap().get(id);
     if (_entity.valid())
     {
         setByMatrix(_entity->getMatrix());
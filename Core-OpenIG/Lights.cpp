@@ -55,12 +55,16 @@ void Engine::createSunMoonLight()
 
 void Engine::addLight(unsigned int id, const LightAttributes& lightAttributes, const osg::Matrixd& mx)
 {
+    finishRenderingTraversals();
+
     osg::ref_ptr<osg::MatrixTransform> mxt = new osg::MatrixTransform;
     mxt->setMatrix(mx);
 
     _lights[id] = mxt;
     _lightsGroup->insertChild(0,mxt);
 
+    _lightAttributes[id] = lightAttributes;
+
     if (_lightImplementationCallback.valid())
     {
         osg::ref_ptr<osg::Node> light = dynamic_cast<osg::Node*>(_lightImplementationCallback->createLight(id,lightAttributes,_lightsGroup));
@@ -90,6 +94,12 @@ void Engine::setLightUserData(unsigned int id, osg::Referenced* data)
 
 void Engine::updateLightAttributes(unsigned int id, const LightAttributes& definition)
 {
+    if (_renderingTraversalsPending)
+    {
+        _bufferedLightAttributes.push_back(BufferedLightAttributes(id, definition));
+        return;
+    }
+
     LightsMapIterator itr = _lights.find(id);
     if ( itr != _lights.end() && _lightImplementationCallback.valid())
     {
@@ -138,6 +148,8 @@ OpenIG::Base::LightAttributes Engine::getLightAttributes(unsigned int id)
 
 void Engine::removeLight(unsigned int id)
 {
+    finishRenderingTraversals();
+
     LightsMapIterator itr = _lights.find(id);
     if ( itr != _lights.end())
     {
@@ -157,11 +169,19 @@ void Engine::removeLight(unsigned int id)
 
         _lightsGroup->removeChild(light);
         _lights.erase(itr);
+
+        _lightAttributes.erase(id);
     }
 }
 
 void Engine::updateLight(unsigned int id, const osg::Matrixd& mx)
 {
+    if (_renderingTraversalsPending)
+    {
+        _bufferedLightUpdates.push_back(EntityUpdate(id, mx));
+        return;
+    }
+
     LightsMapIterator itr = _lights.find(id);
     if ( itr != _lights.end())
     {
@@ -171,6 +191,8 @@ void Engine::updateLight(unsigned int id, const osg::Matrixd& mx)
 
 void Engine::bindLightToEntity(unsigned int id, unsigned int entityId)
 {
+    finishRenderingTraversals();
+
     LightsMapIterator itr = _lights.find(id);
     if ( itr != _lights.end())
     {
@@ -198,6 +220,8 @@ void Engine::bindLightToEntity(unsigned int id, unsigned int entityId)
 
 void Engine::unbindLightFromEntity(unsigned int id)
 {
+    finishRenderingTraversals();
+
     LightsMapIterator itr = _lights.find(id);
     if ( itr != _lights.end())
     {
@@ -276,6 +300,8 @@ protected:
 
 void Engine::enableLight(unsigned int id, bool enable, bool hard)
 {
+    finishRenderingTraversals();
+
     LightsMapIterator itr = _lights.find(id);
     if ( itr != _lights.end())
     {
@@ -377,6 +403,8 @@ protected:
 
 void Engine::bindLightToCamera(unsigned int id, const osg::Matrixd& offset)
 {
+    finishRenderingTraversals();
+
     unbindLightFromEntity(id);
 
     LightsMapIterator itr = _lights.find(id);
@@ -389,6 +417,8 @@ void Engine::bindLightToCamera(unsigned int id, const osg::Matrixd& offset)
 
 void Engine::unbindLightFromcamera(unsigned int id)
 {
+    finishRenderingTraversals();
+
     LightsMapIterator itr = _lights.find(id);
     if ( itr != _lights.end())
     {
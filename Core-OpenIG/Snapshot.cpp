@@ -0,0 +1,523 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#include "Engine.h"
+
+#include <Core-Base/ThreadPool.h>
+
+#include <osgDB/ReadFile>
+#include <osgDB/FileNameUtils>
+#include <osgDB/FileUtils>
+#include <osgDB/Registry>
+
+#include <osg/ValueObject>
+#include <osg/Timer>
+#include <osg/Notify>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+
+using namespace OpenIG;
+using namespace OpenIG::Base;
+
+namespace
+{
+    // A model to read for the restore. The entities using the file
+    // cache share one, the rest get one each, like with addEntity
+    struct ModelRead
+    {
+        std::string                     fileName;
+        osg::ref_ptr<osgDB::Options>    options;
+        osg::ref_ptr<osg::Node>         model;
+        Engine::DatabaseReads           hooks;
+    };
+    typedef std::vector<ModelRead>  ModelReads;
+
+    // Models differ a lot in their read time, so each worker
+    // takes the next model to read rather than a fixed range
+    class ModelReader
+    {
+    public:
+        ModelReader(ModelReads& reads)
+            : _reads(reads)
+            , _next(0)
+        {
+
+        }
+
+        void read(size_t, size_t)
+        {
+            while (true)
+            {
+                size_t index = 0;
+                {
+                    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+                    if (_next >= _reads.size()) return;
+                    index = _next++;
+                }
+
+                ModelRead& read = _reads.at(index);
+                if (!read.model.valid())
+                {
+                    // Only the file reading is done here, the hooks of the
+                    // plugins run later on the calling thread
+                    Engine::setDeferredDatabaseReads(&read.hooks);
+                    read.model = osgDB::readNodeFile(read.fileName, read.options.get());
+                    Engine::setDeferredDatabaseReads(0);
+                }
+            }
+        }
+
+    protected:
+        ModelReads&         _reads;
+        size_t              _next;
+        OpenThreads::Mutex  _mutex;
+    };
+
+    // The reads are mostly waiting on the disk, and the shared pool runs
+    // the cull and the particles, where a worker stuck in a read would
+    // hold up the frame. So they get their own threads
+    ThreadPool* modelReadThreads()
+    {
+        static ThreadPool s_pool(4);
+        return &s_pool;
+    }
+
+    // The ID of the entity the node is bound to, 0 if none
+    unsigned int getParentEntityID(ImageGenerator::EntityMap& entities, osg::Node* node)
+    {
+        if (!node || node->getNumParents() == 0) return 0;
+
+        osg::Group* parent = node->getParent(0);
+
+        unsigned int id = 0;
+        if (parent->getUserValue("ID", id) && entities.get(id) == parent) return id;
+
+        return 0;
+    }
+}
+
+void Engine::takeSnapshot(SceneSnapshot& snapshot)
+{
+    finishRenderingTraversals();
+
+    snapshot.clear();
+
+    EntityMapIterator eitr = _entities.begin();
+    for (; eitr != _entities.end(); ++eitr)
+    {
+        osg::MatrixTransform* mxt = eitr->second.get();
+        if (!mxt) continue;
+
+        SceneSnapshot::Entity entity;
+        entity.id = eitr->first;
+        entity.parentID = getParentEntityID(_entities, mxt);
+        entity.mx = mxt->getMatrix();
+        entity.visible = mxt->getNumChildren() == 0 || mxt->getChild(0)->getNodeMask() != 0x0;
+
+        mxt->getUserValue("fileName", entity.fileName);
+        mxt->getUserValue("Name", entity.name);
+        mxt->getUserValue("optionString", entity.options);
+
+        snapshot.entities.push_back(entity);
+    }
+
+    LightsMapIterator litr = _lights.begin();
+    for (; litr != _lights.end(); ++litr)
+    {
+        osg::MatrixTransform* mxt = litr->second.get();
+        if (!mxt) continue;
+
+        SceneSnapshot::Light light;
+        light.id = litr->first;
+        light.entityID = getParentEntityID(_entities, mxt);
+        light.mx = mxt->getMatrix();
+        light.attributes = getLightAttributes(light.id);
+        light.enabled = isLightEnabled(light.id);
+
+        // See bindLightToCamera
+        osg::RefMatrixd* offset = dynamic_cast<osg::RefMatrixd*>(mxt->getUserData());
+        if (offset && mxt->getUpdateCallback())
+        {
+            light.cameraBound = true;
+            light.cameraOffset = *offset;
+        }
+
+        snapshot.lights.push_back(light);
+    }
+
+    EffectMap::iterator fitr = _effects.begin();
+    for (; fitr != _effects.end(); ++fitr)
+    {
+        Effect mxt = fitr->second;
+        if (!mxt.valid()) continue;
+
+        SceneSnapshot::Effect effect;
+        effect.id = fitr->first;
+        effect.name = mxt->getName();
+        effect.mx = mxt->getMatrix();
+        effect.attributes = dynamic_cast<EffectAttributes*>(mxt->getUserData());
+
+        mxt->getUserValue("boundTo", effect.entityID);
+
+        snapshot.effects.push_back(effect);
+    }
+
+    AnimationStatusMap::iterator aitr = _animationStatus.begin();
+    for (; aitr != _animationStatus.end(); ++aitr)
+    {
+        SceneSnapshot::Animation animation;
+        animation.entityID = aitr->first.first;
+        animation.name = aitr->first.second;
+        animation.status = aitr->second;
+
+        snapshot.animations.push_back(animation);
+    }
+
+    const unsigned int numViews = _viewer.valid() ? _viewer->getNumViews() : 0;
+    for (unsigned int cameraID = 0; cameraID < numViews; ++cameraID)
+    {
+        SceneSnapshot::Camera camera;
+        camera.id = cameraID;
+        camera.viewMatrix = _viewer->getView(cameraID)->getCamera()->getViewMatrix();
+
+        if (cameraID < _cameraBindings.size())
+        {
+            const CameraBinding& binding = _cameraBindings.at(cameraID);
+            camera.bound = binding.bound;
+            camera.entityID = binding.entityID;
+            camera.offset = binding.offset;
+            camera.fixedUp = binding.fixedUp;
+            camera.freeze = binding.freeze;
+
+            CameraBoundEntities::const_iterator citr = binding.entities.begin();
+            for (; citr != binding.entities.end(); ++citr)
+            {
+                if (_entities.get(citr->handle))
+                {
+                    camera.entities.push_back(SceneSnapshot::CameraBoundEntity(citr->handle.id, citr->offset));
+                }
+            }
+        }
+
+        snapshot.cameras.push_back(camera);
+    }
+
+    CloudLayers::iterator citr = _cloudLayers.begin();
+    for (; citr != _cloudLayers.end(); ++citr)
+    {
+        snapshot.cloudLayers.push_back(citr->second);
+    }
+
+    snapshot.environment = _environment;
+}
+
+void Engine::restoreSnapshot(const SceneSnapshot& snapshot)
+{
+    finishRenderingTraversals();
+
+    osg::Timer_t start = osg::Timer::instance()->tick();
+
+    // The models of the entities that are not in the scene yet
+    const size_t noRead = ~(size_t)0;
+    std::vector<size_t> entityReads(snapshot.entities.size(), noRead);
+
+    ModelReads reads;
+    std::map<std::string, size_t> cachedReads;
+
+    for (size_t i = 0; i < snapshot.entities.size(); ++i)
+    {
+        const SceneSnapshot::Entity& entity = snapshot.entities.at(i);
+        if (entity.fileName.empty()) continue;
+
+        osg::MatrixTransform* existing = _entities.get(entity.id);
+        if (existing)
+        {
+            std::string fileName;
+            existing->getUserValue("fileName", fileName);
+            if (fileName == entity.fileName) continue;
+
+            removeEntity(entity.id);
+        }
+
+        osgDB::FilePathList& paths = osgDB::getDataFilePathList();
+        std::string path = osgDB::getFilePath(entity.fileName);
+        if (std::find(paths.begin(), paths.end(), path) == paths.end())
+        {
+            paths.push_back(path);
+        }
+
+        bool cached = isFileCached(entity.fileName);
+        if (cached)
+        {
+            std::map<std::string, size_t>::iterator ritr = cachedReads.find(entity.fileName);
+            if (ritr != cachedReads.end())
+            {
+                entityReads[i] = ritr->second;
+                continue;
+            }
+            cachedReads[entity.fileName] = reads.size();
+        }
+
+        ModelRead read;
+        read.fileName = entity.fileName;
+
+        // As addEntity reads it
+        if (!entity.options.empty())
+        {
+            read.options = new osgDB::Options(entity.options);
+        }
+
+        if (cached)
+        {
+            EntityCache::iterator citr = _entityCache.find(entity.fileName);
+            if (citr != _entityCache.end()) read.model = citr->second;
+        }
+
+        entityReads[i] = reads.size();
+        reads.push_back(read);
+    }
+
+    // The files are read on the pool threads. The databaseRead hooks of
+    // the plugins change plugin state without locking, so they are
+    // deferred and run here one model after the other, in their order
+    ModelReader reader(reads);
+    modelReadThreads()->parallelFor(
+        std::min(reads.size(), (size_t)modelReadThreads()->getNumThreads() + 1),
+        boost::bind(&ModelReader::read, &reader, _1, _2),
+        1);
+
+    for (ModelReads::iterator itr = reads.begin(); itr != reads.end(); ++itr)
+    {
+        Engine::DatabaseReads::iterator hitr = itr->hooks.begin();
+        for (; hitr != itr->hooks.end(); ++hitr)
+        {
+            databaseRead(hitr->fileName, hitr->node.get(), hitr->options.get());
+        }
+        itr->hooks.clear();
+    }
+
+    std::map<std::string, size_t>::iterator ritr = cachedReads.begin();
+    for (; ritr != cachedReads.end(); ++ritr)
+    {
+        const ModelRead& read = reads.at(ritr->second);
+        if (read.model.valid()) _entityCache[read.fileName] = read.model;
+    }
+
+    std::string lastOptions;
+    for (size_t i = 0; i < snapshot.entities.size(); ++i)
+    {
+        if (entityReads[i] == noRead) continue;
+
+        const SceneSnapshot::Entity& entity = snapshot.entities.at(i);
+        const ModelRead& read = reads.at(entityReads[i]);
+
+        if (!read.model.valid())
+        {
+            osg::notify(osg::NOTICE) << "OpenIG: failed to restore entity: " << entity.fileName << std::endl;
+            continue;
+        }
+
+        addEntityNode(entity.id, read.model.get(), entity.mx, entity.fileName, entity.options);
+        lastOptions = entity.options;
+    }
+
+    // The pager reads the tiles with the options of the entity
+    // added last, as after a sequence of addEntity calls
+    if (!lastOptions.empty())
+    {
+        osgDB::Registry::instance()->setOptions(new osgDB::Options(lastOptions));
+    }
+    else
+    {
+        osgDB::Registry::instance()->setOptions(0);
+    }
+
+    // The bindings, once all the entities are there. The
+    // sub-entities of the models keep theirs
+    for (size_t i = 0; i < snapshot.entities.size(); ++i)
+    {
+        const SceneSnapshot::Entity& entity = snapshot.entities.at(i);
+        if (entity.fileName.empty()) continue;
+
+        osg::MatrixTransform* mxt = _entities.get(entity.id);
+        if (!mxt) continue;
+
+        unsigned int parentID = getParentEntityID(_entities, mxt);
+        if (parentID == entity.parentID) continue;
+
+        if (entity.parentID != 0) bindToEntity(entity.id, entity.parentID);
+        else unbindFromEntity(entity.id);
+    }
+
+    EntityUpdates updates;
+    updates.reserve(snapshot.entities.size());
+
+    for (size_t i = 0; i < snapshot.entities.size(); ++i)
+    {
+        const SceneSnapshot::Entity& entity = snapshot.entities.at(i);
+        if (!_entities.get(entity.id)) continue;
+
+        if (!entity.name.empty()) setEntityName(entity.id, entity.name);
+        showEntity(entity.id, entity.visible);
+
+        updates.push_back(EntityUpdate(entity.id, entity.mx));
+    }
+    updateEntities(updates);
+
+    for (size_t i = 0; i < snapshot.lights.size(); ++i)
+    {
+        const SceneSnapshot::Light& light = snapshot.lights.at(i);
+
+        if (_lights.find(light.id) == _lights.end())
+        {
+            addLight(light.id, light.attributes, light.mx);
+        }
+        else
+        {
+            LightAttributes attributes = light.attributes;
+            attributes.dirtyMask = LightAttributes::ALL;
+
+            updateLightAttributes(light.id, attributes);
+        }
+
+        unsigned int entityID = getParentEntityID(_entities, _lights[light.id].get());
+        if (entityID != light.entityID)
+        {
+            if (entityID != 0) unbindLightFromEntity(light.id);
+            if (light.entityID != 0) bindLightToEntity(light.id, light.entityID);
+        }
+
+        if (light.cameraBound)
+        {
+            bindLightToCamera(light.id, light.cameraOffset);
+        }
+        else if (_lights[light.id]->getUpdateCallback())
+        {
+            unbindLightFromcamera(light.id);
+        }
+
+        updateLight(light.id, light.mx);
+        enableLight(light.id, light.enabled);
+    }
+
+    for (size_t i = 0; i < snapshot.effects.size(); ++i)
+    {
+        const SceneSnapshot::Effect& effect = snapshot.effects.at(i);
+
+        addEffect(effect.id, effect.name, effect.mx, effect.attributes.get());
+        if (effect.entityID != 0) bindEffect(effect.id, effect.entityID, effect.mx);
+    }
+
+    for (size_t i = 0; i < snapshot.animations.size(); ++i)
+    {
+        const SceneSnapshot::Animation& animation = snapshot.animations.at(i);
+
+        playAnimation(animation.entityID, animation.name);
+
+        if (animation.status == Pause)
+        {
+            StringUtils::StringList animations;
+            animations.push_back(animation.name);
+
+            changeAnimationStatus(animation.entityID, Pause, animations);
+        }
+    }
+
+    const unsigned int numViews = _viewer.valid() ? _viewer->getNumViews() : 0;
+    for (size_t i = 0; i < snapshot.cameras.size(); ++i)
+    {
+        const SceneSnapshot::Camera& camera = snapshot.cameras.at(i);
+        if (camera.id >= numViews) continue;
+
+        setCameraPosition(camera.viewMatrix, true, camera.id);
+
+        if (camera.bound)
+        {
+            bindCameraToEntity(camera.entityID, camera.offset, camera.id);
+            bindCameraSetFixedUp(camera.fixedUp, camera.freeze, camera.id);
+        }
+        else if (isCameraBoundToEntity(camera.id))
+        {
+            unbindCameraFromEntity(camera.id);
+        }
+
+        SceneSnapshot::CameraBoundEntities::const_iterator citr = camera.entities.begin();
+        for (; citr != camera.entities.end(); ++citr)
+        {
+            bindEntityToCamera(citr->first, citr->second, camera.id);
+        }
+    }
+
+    for (size_t i = 0; i < snapshot.cloudLayers.size(); ++i)
+    {
+        const SceneSnapshot::CloudLayer& layer = snapshot.cloudLayers.at(i);
+
+        addCloudLayer(layer.id, layer.type, layer.altitude, layer.thickness, layer.density, layer.enabled);
+    }
+
+    const SceneSnapshot::Environment& environment = snapshot.environment;
+    if (environment.hasDate) setDate(environment.month, environment.day, environment.year);
+    if (environment.hasTimeOfDay) setTimeOfDay(environment.hour, environment.minutes);
+    if (environment.hasFog) setFog(environment.visibility);
+    if (environment.hasRain) setRain(environment.rain);
+    if (environment.hasSnow) setSnow(environment.snow);
+    if (environment.hasWind) setWind(environment.windSpeed, environment.windDirection);
+
+    osg::notify(osg::NOTICE) << "OpenIG: snapshot restored, " << reads.size() << " models read in "
+        << osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick()) << " s" << std::endl;
+}
+
+bool Engine::writeSnapshot(const std::string& fileName)
+{
+    SceneSnapshot snapshot;
+    takeSnapshot(snapshot);
+
+    return snapshot.write(fileName);
+}
+
+bool Engine::readSnapshot(const std::string& fileName)
+{
+    SceneSnapshot snapshot;
+    if (!snapshot.read(fileName))
+    {
+        osg::notify(osg::NOTICE) << "OpenIG: failed to read snapshot: " << fileName << std::endl;
+        return false;
+    }
+
+    restoreSnapshot(snapshot);
+    return true;
+}
@@ -261,6 +261,15 @@ namespace OpenIG {
 			 */
 			virtual void config(const std::string&) {}
 
+			/*! Tells if \ref config can be called again on the running plugin when its XML
+			 *  changes, with Config-Hot-Reload on. Such a plugin must apply the new values by
+			 *  itself, \ref init is not called again. The default is false, the changes then
+			 *  take effect on the next start
+			 * \brief Tells if the plugin can be configured again while running
+			 * \return true if it can
+			 */
+			virtual bool isConfigReloadable() { return false; }
+
 			/*! Method to init the plugin with a given \ref igplugincore::PluginContext. The
 			 * \ref igplugincore::PluginHost is calling this once to give the user to perform
 			 * initialization of the plugin
@@ -281,6 +290,16 @@ namespace OpenIG {
 			 */
 			virtual void update(PluginContext&) {}
 
+			/*! Tells if the update of the plugin, and its \ref beginningOfFrame, can run while the
+			 *  previous frame is culled and drawn, with the pipelined frame of \ref OpenIG::Engine on.
+			 *  Such an update must change the scene only through the entity, light and camera
+			 *  updates of \ref OpenIG::Base::ImageGenerator, which are buffered until the next frame.
+			 *  The default is false, the update then runs in sequence with the rest of the frame
+			 * \brief Tells if the update can overlap the rendering of the previous frame
+			 * \return true if it can
+			 */
+			virtual bool isUpdatePipelineSafe() { return false; }
+
 			/*! preFrame hook. This is called in a frame with a given \ref igplugincore::PluginContext.\
 			 *  See \ref OpenIG::Base::ImageGenerator::frame for more info
 			 * \brief Preframe hook
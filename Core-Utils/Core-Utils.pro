@@ -16,7 +16,8 @@ DEFINES += IGCOREUTILS_LIBRARY
 SOURCES +=  GLErrorUtils.cpp\
             ShaderUtils.cpp\
             TBO.cpp\
-            TextureCache.cpp
+            TextureCache.cpp\
+            LightAssignment.cpp
 
 HEADERS +=  Config.h\
             Export.h\
@@ -24,7 +25,8 @@ HEADERS +=  Config.h\
             TBO.h\
             FrameLogging.h\
             ShaderUtils.h\
-            TextureCache.h
+            TextureCache.h\
+            LightAssignment.h
 
 INCLUDEPATH += ../
 DEPENDPATH += ../
@@ -0,0 +1,554 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#include "LightAssignment.h"
+
+#include <osg/Geode>
+#include <osg/Transform>
+#include <osg/Math>
+#include <osg/NodeVisitor>
+#include <osg/Uniform>
+#include <osg/ValueObject>
+#include <osg/observer_ptr>
+
+#include <osgUtil/CullVisitor>
+
+#include <OpenThreads/ScopedLock>
+
+#include <algorithm>
+#include <cfloat>
+
+using namespace OpenIG::Library::Graphics;
+
+namespace osg
+{
+   // Frames of light changes kept to validate the assignments against.
+   // Assignments older than that are redone
+   static const size_t s_MaxChangeHistory = 16;
+
+   // Assignments of geode instances not culled for this many frames are dropped
+   static const unsigned int s_MaxUnusedFrames = 120;
+
+   // Range of the lights that come without one
+   static const double s_DefaultEndRange = 100.0;
+
+   static bool intersects(const osg::BoundingBoxd& box, const osg::BoundingSphered& sphere)
+   {
+      osg::Vec3d closest(
+         osg::clampBetween(sphere.center().x(), box.xMin(), box.xMax()),
+         osg::clampBetween(sphere.center().y(), box.yMin(), box.yMax()),
+         osg::clampBetween(sphere.center().z(), box.zMin(), box.zMax()));
+      return (closest - sphere.center()).length2() <= sphere.radius2();
+   }
+
+   class LightAssignment::TrackLightCallback : public osg::NodeCallback
+   {
+   public:
+      TrackLightCallback(LightAssignment* assignment, unsigned int id)
+         : _assignment(assignment)
+         , _id(id)
+      {
+      }
+
+      virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+      {
+         osg::ref_ptr<LightAssignment> assignment;
+         if (_assignment.lock(assignment) && nv->getFrameStamp())
+         {
+            osg::MatrixList matrices = node->getWorldMatrices();
+            assignment->updateLightTransform(_id, matrices.empty() ? osg::Matrixd::identity() : matrices.front(), nv->getFrameStamp()->getFrameNumber());
+         }
+         traverse(node, nv);
+      }
+
+   protected:
+      osg::observer_ptr<LightAssignment>  _assignment;
+      unsigned int                        _id;
+   };
+
+   class LightAssignment::AssignLightsCallback : public osg::NodeCallback
+   {
+   public:
+      AssignLightsCallback(LightAssignment* assignment)
+         : _assignment(assignment)
+      {
+      }
+
+      virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+      {
+         osg::ref_ptr<osg::StateSet> stateSet;
+
+         osgUtil::CullVisitor* cv = dynamic_cast<osgUtil::CullVisitor*>(nv);
+         osg::ref_ptr<LightAssignment> assignment;
+         if (cv && _assignment.lock(assignment))
+         {
+            stateSet = assignment->getStateSet(*this, *node, *cv);
+         }
+
+         if (stateSet.valid())
+         {
+            cv->pushStateSet(stateSet.get());
+            traverse(node, nv);
+            cv->popStateSet();
+         }
+         else
+         {
+            traverse(node, nv);
+         }
+      }
+
+      // One per instance of the geode, told apart by the world matrix
+      struct Entry
+      {
+         osg::Matrixd                  localToWorld;
+         unsigned int                  assignedFrame;
+         unsigned int                  usedFrame;
+         osg::ref_ptr<osg::StateSet>   stateSet;
+      };
+      typedef std::vector<Entry>       Entries;
+
+      Entries                          _entries;
+      OpenThreads::Mutex               _mutex;
+
+   protected:
+      osg::observer_ptr<LightAssignment>  _assignment;
+   };
+
+   class LightAssignment::InstallVisitor : public osg::NodeVisitor
+   {
+   public:
+      InstallVisitor(LightAssignment* assignment)
+         : osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+         , _assignment(assignment)
+      {
+      }
+
+      virtual void apply(osg::Geode& geode)
+      {
+         osg::NodeCallback* callback = dynamic_cast<osg::NodeCallback*>(geode.getCullCallback());
+         for (; callback; callback = dynamic_cast<osg::NodeCallback*>(callback->getNestedCallback()))
+         {
+            if (dynamic_cast<AssignLightsCallback*>(callback)) return;
+         }
+
+         // Every geode gets its own, the callback keeps the assignments
+         geode.addCullCallback(new AssignLightsCallback(_assignment));
+      }
+
+   protected:
+      LightAssignment*  _assignment;
+   };
+
+   LightAssignment::LightAssignment(unsigned int firstLightNum, unsigned int numLightNums)
+      : _committedFrame(0)
+      , _committed(false)
+      , _forgottenFrame(0)
+      , _forgotten(false)
+      , _firstLightNum(firstLightNum)
+      , _numLightNums(numLightNums)
+   {
+   }
+
+   LightAssignment::~LightAssignment()
+   {
+      for (LightRecords::iterator itr = _lights.begin(); itr != _lights.end(); ++itr)
+      {
+         delete itr->second;
+      }
+      _lights.clear();
+   }
+
+   const char* LightAssignment::lightsEnabledUniformName()
+   {
+      return "lightsEnabled";
+   }
+
+   size_t LightAssignment::getNumLights() const
+   {
+      return _lights.size();
+   }
+
+   osg::Node* LightAssignment::addLight(unsigned int id, osg::Light* light)
+   {
+      if (!light) return 0;
+
+      removeLight(id);
+
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+      LightRecord* record = new LightRecord;
+      record->id = id;
+      record->light = light;
+      record->fpLight = _lightManager.CreateLight(LT_POINT);
+      record->fpLight->SetUserID(id);
+      // Off until the update traversal places it
+      record->fpLight->SetOn(false);
+      record->endRange = s_DefaultEndRange;
+      record->brightness = 0.0;
+      record->enabled = true;
+      record->placed = false;
+      record->updatedFrame = ~0u;
+      updateLight(*record);
+
+      _lights[id] = record;
+
+      osg::Node* node = new osg::Node;
+      node->setName("LightAssignment-Light");
+      node->setUpdateCallback(new TrackLightCallback(this, id));
+      return node;
+   }
+
+   void LightAssignment::removeLight(unsigned int id)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+      LightRecords::iterator itr = _lights.find(id);
+      if (itr == _lights.end()) return;
+
+      LightRecord* record = itr->second;
+      addChange(*record);
+      _lightManager.DestroyLight(record->fpLight);
+
+      delete record;
+      _lights.erase(itr);
+   }
+
+   void LightAssignment::lightChanged(unsigned int id)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+      LightRecords::iterator itr = _lights.find(id);
+      if (itr == _lights.end()) return;
+
+      LightRecord& record = *itr->second;
+      addChange(record);
+      updateLight(record);
+      addChange(record);
+   }
+
+   void LightAssignment::install(osg::Node& node)
+   {
+      InstallVisitor nv(this);
+      node.accept(nv);
+   }
+
+   void LightAssignment::updateLightTransform(unsigned int id, const osg::Matrixd& worldMatrix, unsigned int frameNumber)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+      LightRecords::iterator itr = _lights.find(id);
+      if (itr == _lights.end()) return;
+
+      LightRecord& record = *itr->second;
+      record.updatedFrame = frameNumber;
+
+      if (record.placed && record.worldMatrix == worldMatrix) return;
+
+      addChange(record);
+      record.worldMatrix = worldMatrix;
+      record.placed = true;
+      updateLight(record);
+      addChange(record);
+   }
+
+   void LightAssignment::updateLight(LightRecord& record)
+   {
+      osg::Light* light = record.light.get();
+
+      double startRange = 0.0;
+      double endRange = 0.0;
+      light->getUserValue("fStartRange", startRange);
+      light->getUserValue("fEndRange", endRange);
+      record.endRange = endRange > 0.0 ? endRange : s_DefaultEndRange;
+
+      bool enabled = true;
+      light->getUserValue("enabled", enabled);
+      record.enabled = enabled;
+
+      const osg::Vec4& diffuse = light->getDiffuse();
+      record.brightness = osg::maximum(diffuse.x(), osg::maximum(diffuse.y(), diffuse.z()));
+
+      record.worldPosition = osg::Vec4d(light->getPosition()) * record.worldMatrix;
+      record.worldDirection = osg::Matrixd::transform3x3(osg::Vec3d(light->getDirection()), record.worldMatrix);
+      record.worldDirection.normalize();
+
+      if (record.worldPosition.w() == 0.0)
+      {
+         record.fpLight->SetLightType(LT_DIRECTIONAL);
+         return;
+      }
+
+      osg::Vec3d position(
+         record.worldPosition.x() / record.worldPosition.w(),
+         record.worldPosition.y() / record.worldPosition.w(),
+         record.worldPosition.z() / record.worldPosition.w());
+
+      record.fpLight->SetLightType(light->getSpotCutoff() < 180.f ? LT_SPOT : LT_POINT);
+      record.fpLight->SetPosition(Vector3_64(position.x(), position.y(), position.z()));
+      record.fpLight->SetRanges((float)startRange, (float)record.endRange);
+   }
+
+   void LightAssignment::addChange(const LightRecord& record)
+   {
+      if (!record.placed) return;
+
+      osg::BoundingBoxd box;
+      if (record.worldPosition.w() == 0.0)
+      {
+         box.set(-DBL_MAX, -DBL_MAX, -DBL_MAX, DBL_MAX, DBL_MAX, DBL_MAX);
+      }
+      else
+      {
+         osg::Vec3d center(
+            record.worldPosition.x() / record.worldPosition.w(),
+            record.worldPosition.y() / record.worldPosition.w(),
+            record.worldPosition.z() / record.worldPosition.w());
+         osg::Vec3d extent(record.endRange, record.endRange, record.endRange);
+         box.set(center - extent, center + extent);
+      }
+      _pendingChanges.boxes.push_back(box);
+   }
+
+   void LightAssignment::commit(unsigned int frameNumber)
+   {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+      if (_committed && _committedFrame == frameNumber) return;
+
+      // Lights whose node was not traversed in the update are
+      // disabled, or their transform is switched off
+      for (LightRecords::iterator itr = _lights.begin(); itr != _lights.end(); ++itr)
+      {
+         LightRecord& record = *itr->second;
+
+         bool on = record.placed && record.enabled && record.updatedFrame == frameNumber;
+         if (record.fpLight->IsOn() != on)
+         {
+            record.fpLight->SetOn(on);
+            addChange(record);
+         }
+      }
+
+      _lightManager.Commit();
+
+      if (!_pendingChanges.boxes.empty())
+      {
+         _pendingChanges.frameNumber = frameNumber;
+         _history.push_back(_pendingChanges);
+         _pendingChanges.boxes.clear();
+
+         while (_history.size() > s_MaxChangeHistory)
+         {
+            _forgottenFrame = _history.front().frameNumber;
+            _forgotten = true;
+            _history.pop_front();
+         }
+      }
+
+      _committedFrame = frameNumber;
+      _committed = true;
+   }
+
+   bool LightAssignment::isValid(unsigned int assignedFrame, const osg::BoundingSphered& bound) const
+   {
+      if (_forgotten && assignedFrame < _forgottenFrame) return false;
+
+      for (ChangeHistory::const_reverse_iterator itr = _history.rbegin(); itr != _history.rend() && itr->frameNumber > assignedFrame; ++itr)
+      {
+         for (size_t i = 0; i < itr->boxes.size(); ++i)
+         {
+            if (intersects(itr->boxes[i], bound)) return false;
+         }
+      }
+      return true;
+   }
+
+   struct AssignedLightLess
+   {
+      typedef std::pair<double, unsigned int> Key;
+      bool operator()(const std::pair<Key, void*>& lhs, const std::pair<Key, void*>& rhs) const
+      {
+         if (lhs.first.first != rhs.first.first) return lhs.first.first > rhs.first.first;
+         return lhs.first.second < rhs.first.second;
+      }
+   };
+
+   void LightAssignment::assign(const osg::BoundingSphered& bound, AssignedLights& lights)
+   {
+      lights.clear();
+
+      AxisAlignedBoundingBox_64 box;
+      box.SetMinMax(
+         Vector3_64(bound.center().x() - bound.radius(), bound.center().y() - bound.radius(), bound.center().z() - bound.radius()),
+         Vector3_64(bound.center().x() + bound.radius(), bound.center().y() + bound.radius(), bound.center().z() + bound.radius()));
+
+      _candidates.clear();
+      _lightManager.FindLightsAffecting(box, _candidates);
+
+      // Influence at the closest point of the bound: the brightness,
+      // falling off quadratically to nothing at the end of the range.
+      // Directional lights reach everything at full strength
+      typedef std::pair<AssignedLightLess::Key, void*> ScoredLight;
+      std::vector<ScoredLight> scored;
+      scored.reserve(_candidates.size());
+
+      for (size_t i = 0; i < _candidates.size(); ++i)
+      {
+         LightRecords::iterator itr = _lights.find(_candidates[i]->GetUserID());
+         if (itr == _lights.end()) continue;
+
+         LightRecord* record = itr->second;
+
+         double score = record->brightness;
+         if (record->worldPosition.w() != 0.0)
+         {
+            osg::Vec3d position(
+               record->worldPosition.x() / record->worldPosition.w(),
+               record->worldPosition.y() / record->worldPosition.w(),
+               record->worldPosition.z() / record->worldPosition.w());
+
+            double distance = osg::maximum(0.0, (position - bound.center()).length() - bound.radius());
+            if (distance >= record->endRange) continue;
+
+            double falloff = 1.0 - distance / record->endRange;
+            score *= falloff * falloff;
+         }
+         if (score <= 0.0) continue;
+
+         scored.push_back(ScoredLight(AssignedLightLess::Key(score, record->id), record));
+      }
+
+      size_t numLights = osg::minimum(scored.size(), (size_t)_numLightNums);
+      std::partial_sort(scored.begin(), scored.begin() + numLights, scored.end(), AssignedLightLess());
+
+      for (size_t i = 0; i < numLights; ++i)
+      {
+         lights.push_back(static_cast<LightRecord*>(scored[i].second));
+      }
+   }
+
+   osg::StateSet* LightAssignment::createStateSet(const AssignedLights& lights, const osg::Matrixd& localToWorld) const
+   {
+      osg::Matrixd worldToLocal = osg::Matrixd::inverse(localToWorld);
+
+      osg::StateSet* stateSet = new osg::StateSet;
+
+      // The light attributes are applied with the model view of the
+      // drawables, so they are given in the local frame of the geode
+      for (size_t i = 0; i < lights.size(); ++i)
+      {
+         const LightRecord& record = *lights[i];
+
+         osg::Light* light = new osg::Light(*record.light);
+         light->setLightNum(_firstLightNum + i);
+         light->setPosition(osg::Vec4(record.worldPosition * worldToLocal));
+         light->setDirection(osg::Vec3(osg::Matrixd::transform3x3(record.worldDirection, worldToLocal)));
+
+         stateSet->setAttribute(light);
+      }
+
+      osg::Uniform* enabled = new osg::Uniform(osg::Uniform::BOOL, lightsEnabledUniformName(), 8);
+      for (unsigned int i = 0; i < 8; ++i)
+      {
+         enabled->setElement(i, i >= _firstLightNum && i < _firstLightNum + lights.size());
+      }
+      stateSet->addUniform(enabled);
+
+      return stateSet;
+   }
+
+   osg::ref_ptr<osg::StateSet> LightAssignment::getStateSet(AssignLightsCallback& callback, osg::Node& node, osgUtil::CullVisitor& cv)
+   {
+      const osg::BoundingSphere& localBound = node.getBound();
+      if (!localBound.valid() || !cv.getFrameStamp() || !cv.getModelViewMatrix() || !cv.getCurrentCamera()) return 0;
+
+      unsigned int frameNumber = cv.getFrameStamp()->getFrameNumber();
+      commit(frameNumber);
+
+      // From the transforms on the path rather than the model view of the
+      // cull, which is rounded differently whenever the camera moves and
+      // would never match the cached assignments
+      osg::Matrixd localToWorld = osg::computeLocalToWorld(cv.getNodePath());
+
+      osg::Vec3d scale = localToWorld.getScale();
+      osg::BoundingSphered bound(
+         osg::Vec3d(localBound.center()) * localToWorld,
+         localBound.radius() * osg::maximum(scale.x(), osg::maximum(scale.y(), scale.z())));
+
+      OpenThreads::ScopedLock<OpenThreads::Mutex> callbackLock(callback._mutex);
+
+      AssignLightsCallback::Entry* entry = 0;
+      for (size_t i = 0; i < callback._entries.size();)
+      {
+         AssignLightsCallback::Entry& candidate = callback._entries[i];
+         if (candidate.localToWorld == localToWorld)
+         {
+            entry = &candidate;
+            break;
+         }
+
+         if (candidate.usedFrame + s_MaxUnusedFrames < frameNumber)
+         {
+            candidate = callback._entries.back();
+            callback._entries.pop_back();
+            continue;
+         }
+         ++i;
+      }
+
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+      if (entry && isValid(entry->assignedFrame, bound))
+      {
+         entry->usedFrame = frameNumber;
+         return entry->stateSet;
+      }
+
+      if (!entry)
+      {
+         callback._entries.push_back(AssignLightsCallback::Entry());
+         entry = &callback._entries.back();
+         entry->localToWorld = localToWorld;
+      }
+
+      // A new state set rather than changing the one the
+      // previous frame may still be drawing with
+      AssignedLights lights;
+      assign(bound, lights);
+
+      entry->assignedFrame = frameNumber;
+      entry->usedFrame = frameNumber;
+      entry->stateSet = createStateSet(lights, localToWorld);
+
+      return entry->stateSet;
+   }
+}
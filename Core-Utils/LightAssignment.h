@@ -0,0 +1,171 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#pragma once
+
+#if defined(OPENIG_SDK)
+	#include <OpenIG-Utils/Export.h>
+	#include <OpenIG-Graphics/LightManager.h>
+#else
+	#include <Core-Utils/Export.h>
+	#include <Library-Graphics/LightManager.h>
+#endif
+
+#include <deque>
+#include <vector>
+
+#include <osg/ref_ptr>
+#include <osg/Referenced>
+#include <osg/Light>
+#include <osg/Node>
+#include <osg/NodeCallback>
+#include <osg/StateSet>
+#include <osg/BoundingBox>
+#include <osg/BoundingSphere>
+
+#include <OpenThreads/Mutex>
+
+#include <boost/unordered_map.hpp>
+
+namespace osgUtil
+{
+   class CullVisitor;
+}
+
+namespace osg
+{
+   // Picks the lights for the few OpenGL light slots a drawable has.
+   // The lights are kept in the bounding volume hierarchy of a
+   // LightManager, and every geode the assignment is installed on is
+   // culled with the most influential lights around its bound as its
+   // own state. The assignments are kept across frames and only redone
+   // when the geode moved, or a light that changed reaches its bound
+   class IGCOREUTILS_EXPORT LightAssignment : public osg::Referenced
+   {
+   public:
+      LightAssignment(unsigned int firstLightNum = 1, unsigned int numLightNums = 7);
+
+      // The light attributes are taken in the local frame of the light,
+      // as with an osg::LightSource. Put the returned node where the light
+      // source would go, it tracks the light in the update traversal and
+      // the light is off whenever the node is not traversed
+      osg::Node* addLight(unsigned int id, osg::Light* light);
+      void removeLight(unsigned int id);
+
+      // Call after changing the attributes of the light. The ranges are
+      // read from the "fStartRange" and "fEndRange" user values of the
+      // light and the on state from its "enabled" user value
+      void lightChanged(unsigned int id);
+
+      // Adds the assignment to the geodes under the node
+      void install(osg::Node& node);
+
+      unsigned int getFirstLightNum() const { return _firstLightNum; }
+      unsigned int getNumLightNums() const { return _numLightNums; }
+      size_t getNumLights() const;
+
+      // Name of the bool[8] uniform the shaders test the lights with
+      static const char* lightsEnabledUniformName();
+
+   protected:
+      virtual ~LightAssignment();
+
+      class TrackLightCallback;
+      class AssignLightsCallback;
+      class InstallVisitor;
+
+      struct LightRecord
+      {
+         unsigned int                              id;
+         osg::ref_ptr<osg::Light>                  light;
+         OpenIG::Library::Graphics::Light*         fpLight;
+         osg::Matrixd                              worldMatrix;
+         osg::Vec4d                                worldPosition;
+         osg::Vec3d                                worldDirection;
+         double                                    endRange;
+         double                                    brightness;
+         bool                                      enabled;
+         bool                                      placed;
+         unsigned int                              updatedFrame;
+      };
+      typedef boost::unordered_map<unsigned int, LightRecord*>   LightRecords;
+
+      // The bounds the changed lights reach, per frame they changed in
+      struct Changes
+      {
+         unsigned int                              frameNumber;
+         std::vector<osg::BoundingBoxd>            boxes;
+      };
+      typedef std::deque<Changes>                  ChangeHistory;
+
+      typedef std::vector<LightRecord*>            AssignedLights;
+
+      OpenIG::Library::Graphics::LightManager      _lightManager;
+      LightRecords                                 _lights;
+
+      Changes                                      _pendingChanges;
+      ChangeHistory                                _history;
+      unsigned int                                 _committedFrame;
+      bool                                         _committed;
+
+      // Newest frame whose changes were dropped from the history
+      unsigned int                                 _forgottenFrame;
+      bool                                         _forgotten;
+
+      OpenIG::Library::Graphics::VectorLights      _candidates;
+
+      unsigned int                                 _firstLightNum;
+      unsigned int                                 _numLightNums;
+
+      OpenThreads::Mutex                           _mutex;
+
+      void updateLightTransform(unsigned int id, const osg::Matrixd& worldMatrix, unsigned int frameNumber);
+      void updateLight(LightRecord& record);
+      void addChange(const LightRecord& record);
+
+      // Once per frame, before the first assignment
+      void commit(unsigned int frameNumber);
+
+      // True when none of the lights changed since the frame
+      // reaches into the bound
+      bool isValid(unsigned int assignedFrame, const osg::BoundingSphered& bound) const;
+
+      void assign(const osg::BoundingSphered& bound, AssignedLights& lights);
+      osg::StateSet* createStateSet(const AssignedLights& lights, const osg::Matrixd& localToWorld) const;
+
+      osg::ref_ptr<osg::StateSet> getStateSet(AssignLightsCallback& callback, osg::Node& node, osgUtil::CullVisitor& cv);
+
+      friend class TrackLightCallback;
+      friend class AssignLightsCallback;
+      friend class InstallVisitor;
+   };
+}
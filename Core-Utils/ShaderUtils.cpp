@@ -3,6 +3,14 @@
 
 #include <Library-Graphics/OIGAssert.h>
 
+#include <Core-Base/Configuration.h>
+#include <Core-Base/FileSystem.h>
+
+#include <osg/Timer>
+#include <osg/buffered_value>
+
+#include <sstream>
+
 namespace osg
 {
     GLint ShaderUtils::compileShader(const std::string& strSource, osg::Shader::Type shaderType, osg::GLExtensions* ext)
@@ -59,5 +67,363 @@ namespace osg
         }
         return shaderID;
     }
-}
 
+    bool ShaderUtils::useLogZDepthBuffer()
+    {
+        std::string strLogZDepthBuffer = OpenIG::Base::Configuration::instance()->getConfig("LogZDepthBuffer", "yes");
+        return strLogZDepthBuffer.compare(0, 3, "yes") == 0;
+    }
+
+    // Times the first compile and link of the program in each context
+    class ShaderProgramRegistry::Program : public osg::Program
+    {
+    public:
+        Program(ShaderProgramRegistry* registry)
+            : _registry(registry)
+        {
+        }
+
+        virtual void apply(osg::State& state) const
+        {
+            unsigned int contextID = state.getContextID();
+            if (_compiled[contextID])
+            {
+                osg::Program::apply(state);
+                return;
+            }
+
+            osg::Timer_t start = osg::Timer::instance()->tick();
+            osg::Program::apply(state);
+            compiled(contextID, start);
+        }
+
+        virtual void compileGLObjects(osg::State& state) const
+        {
+            unsigned int contextID = state.getContextID();
+            if (_compiled[contextID])
+            {
+                osg::Program::compileGLObjects(state);
+                return;
+            }
+
+            osg::Timer_t start = osg::Timer::instance()->tick();
+            osg::Program::compileGLObjects(state);
+            compiled(contextID, start);
+        }
+
+        virtual void resizeGLObjectBuffers(unsigned int maxSize)
+        {
+            osg::Program::resizeGLObjectBuffers(maxSize);
+            _compiled.resize(maxSize);
+        }
+
+        virtual void releaseGLObjects(osg::State* state = 0) const
+        {
+            osg::Program::releaseGLObjects(state);
+            if (state)
+            {
+                _compiled[state->getContextID()] = 0;
+            }
+            else
+            {
+                _compiled.setAllElementsTo(0);
+            }
+        }
+
+    protected:
+        void compiled(unsigned int contextID, osg::Timer_t start) const
+        {
+            _compiled[contextID] = 1;
+            _registry->compiled(getName(), contextID, osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick()));
+        }
+
+        ShaderProgramRegistry*              _registry;
+        mutable osg::buffered_value<int>    _compiled;
+    };
+
+    ShaderProgramRegistry::Description::Description(const std::string& name)
+        : _name(name)
+    {
+    }
+
+    ShaderProgramRegistry::Description& ShaderProgramRegistry::Description::addShader(osg::Shader::Type type)
+    {
+        Shader shader;
+        shader.type = type;
+        _shaders.push_back(shader);
+        return *this;
+    }
+
+    ShaderProgramRegistry::Description& ShaderProgramRegistry::Description::addPart(PartType type, const std::string& text)
+    {
+        ASSERT_PREDICATE(!_shaders.empty());
+        if (!_shaders.empty())
+        {
+            Part part = { type, text };
+            _shaders.back().parts.push_back(part);
+        }
+        return *this;
+    }
+
+    ShaderProgramRegistry::Description& ShaderProgramRegistry::Description::addFile(const std::string& fileName)
+    {
+        return addPart(File, fileName);
+    }
+
+    ShaderProgramRegistry::Description& ShaderProgramRegistry::Description::addSource(const std::string& source)
+    {
+        return addPart(Source, source);
+    }
+
+    ShaderProgramRegistry::Description& ShaderProgramRegistry::Description::addSnippet(const std::string& snippetName)
+    {
+        return addPart(Snippet, snippetName);
+    }
+
+    ShaderProgramRegistry::Description& ShaderProgramRegistry::Description::addDefine(const std::string& name, const std::string& value)
+    {
+        _defines[name] = value;
+        return *this;
+    }
+
+    ShaderProgramRegistry::Description& ShaderProgramRegistry::Description::setParameter(GLenum pname, GLint value)
+    {
+        _parameters[pname] = value;
+        return *this;
+    }
+
+    ShaderProgramRegistry::Description& ShaderProgramRegistry::Description::addBindAttribLocation(const std::string& name, GLuint index)
+    {
+        _attribLocations[name] = index;
+        return *this;
+    }
+
+    ShaderProgramRegistry::ContextStats::ContextStats()
+        : compiles(0)
+        , compileTime(0.0)
+    {
+    }
+
+    ShaderProgramRegistry::Stats::Stats()
+        : requests(0)
+        , hits(0)
+        , numPrograms(0)
+        , numShaders(0)
+        , fileReads(0)
+        , failedRequests(0)
+    {
+    }
+
+    ShaderProgramRegistry* ShaderProgramRegistry::instance()
+    {
+        static ShaderProgramRegistry s_registry;
+        return &s_registry;
+    }
+
+    ShaderProgramRegistry::ShaderProgramRegistry()
+    {
+        // The log Z of the vertex and the exp2 fog, found inline in a few of the plugins
+        registerSnippet("log_depth_vs",
+            "uniform float Fcoef;                                                                   \n"
+            "vec4 logDepthPosition(in vec4 position)                                                \n"
+            "{                                                                                      \n"
+            "   if (Fcoef > 0.0)                                                                    \n"
+            "       position.z = (log2(max(1e-6, 1.0 + position.w)) * Fcoef - 1.0) * position.w;    \n"
+            "   return position;                                                                    \n"
+            "}                                                                                      \n"
+        );
+        registerSnippet("fog_exp2_ps",
+            "void computeFogColor(inout vec4 color)                                 \n"
+            "{                                                                      \n"
+            "   float fogExp = gl_Fog.density * length(eyeVec);                     \n"
+            "   float fogFactor = exp(-(fogExp * fogExp));                          \n"
+            "   fogFactor = clamp(fogFactor, 0.0, 1.0);                             \n"
+            "   vec4 clr = color;                                                   \n"
+            "   color = mix(gl_Fog.color, color, fogFactor);                        \n"
+            "   color.a = clr.a;                                                    \n"
+            "}                                                                      \n"
+        );
+    }
+
+    void ShaderProgramRegistry::registerSnippet(const std::string& name, const std::string& source)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _snippets[name] = source;
+        _snippetFiles.erase(name);
+    }
+
+    void ShaderProgramRegistry::registerSnippetFile(const std::string& name, const std::string& fileName)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _snippetFiles[name] = fileName;
+        _snippets.erase(name);
+    }
+
+    bool ShaderProgramRegistry::readFile(const std::string& fileName, std::string& source)
+    {
+        MapNamesToSources::iterator itr = _files.find(fileName);
+        if (itr == _files.end())
+        {
+            ++_stats.fileReads;
+            itr = _files.insert(std::make_pair(fileName, OpenIG::Base::FileSystem::readFileIntoString(fileName))).first;
+        }
+        if (itr->second.empty())
+        {
+            osg::notify(osg::NOTICE) << "ShaderProgramRegistry: could not read " << fileName << std::endl;
+            return false;
+        }
+        source += itr->second;
+        return true;
+    }
+
+    bool ShaderProgramRegistry::resolve(const Description::Part& part, std::string& source)
+    {
+        switch (part.type)
+        {
+        case Description::File:
+            return readFile(part.text, source);
+        case Description::Source:
+            source += part.text;
+            return true;
+        case Description::Snippet:
+            {
+                MapNamesToSources::iterator itr = _snippets.find(part.text);
+                if (itr != _snippets.end())
+                {
+                    source += itr->second;
+                    return true;
+                }
+                itr = _snippetFiles.find(part.text);
+                if (itr != _snippetFiles.end())
+                {
+                    return readFile(itr->second, source);
+                }
+                osg::notify(osg::NOTICE) << "ShaderProgramRegistry: unknown snippet " << part.text << std::endl;
+                return false;
+            }
+        }
+        return false;
+    }
+
+    osg::Program* ShaderProgramRegistry::getOrCreateProgram(const Description& description)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+
+        ++_stats.requests;
+
+        std::string strDefines;
+        for (Description::Defines::const_iterator itr = description._defines.begin(); itr != description._defines.end(); ++itr)
+        {
+            strDefines += "#define " + itr->first + (itr->second.empty() ? "" : " " + itr->second) + "\n";
+        }
+
+        // The key is made of the resolved sources of the shaders, the defines
+        // are in them already, and the parameters and the attribute bindings
+        std::ostringstream key;
+        std::vector<std::string> sources;
+        for (Description::Shaders::const_iterator itr = description._shaders.begin(); itr != description._shaders.end(); ++itr)
+        {
+            std::string source;
+            for (Description::Parts::const_iterator pitr = itr->parts.begin(); pitr != itr->parts.end(); ++pitr)
+            {
+                if (!resolve(*pitr, source))
+                {
+                    osg::notify(osg::NOTICE) << "ShaderProgramRegistry: could not create " << description._name << std::endl;
+                    ++_stats.failedRequests;
+                    return 0;
+                }
+            }
+
+            if (!strDefines.empty())
+            {
+                std::string::size_type pos = 0;
+                std::string::size_type version = source.find("#version");
+                if (version != std::string::npos)
+                {
+                    pos = source.find('\n', version);
+                    if (pos == std::string::npos)
+                    {
+                        source += "\n";
+                        pos = source.size();
+                    }
+                    else
+                    {
+                        ++pos;
+                    }
+                }
+                source.insert(pos, strDefines);
+            }
+
+            key << "shader " << (int)itr->type << " " << source.size() << "\n" << source;
+            sources.push_back(source);
+        }
+        for (Description::Parameters::const_iterator itr = description._parameters.begin(); itr != description._parameters.end(); ++itr)
+        {
+            key << "parameter " << itr->first << " " << itr->second << "\n";
+        }
+        for (Description::AttribLocations::const_iterator itr = description._attribLocations.begin(); itr != description._attribLocations.end(); ++itr)
+        {
+            key << "attrib " << itr->first << " " << itr->second << "\n";
+        }
+
+        MapKeysToPrograms::iterator pitr = _programs.find(key.str());
+        if (pitr != _programs.end())
+        {
+            ++_stats.hits;
+            return pitr->second.get();
+        }
+
+        osg::ref_ptr<osg::Program> program = new Program(this);
+        program->setName(description._name);
+
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            osg::Shader::Type type = description._shaders[i].type;
+
+            std::ostringstream shaderKey;
+            shaderKey << (int)type << "\n" << sources[i];
+
+            osg::ref_ptr<osg::Shader>& shader = _shaders[shaderKey.str()];
+            if (!shader.valid())
+            {
+                shader = new osg::Shader(type, sources[i]);
+                shader->setName(description._name);
+                ++_stats.numShaders;
+            }
+            program->addShader(shader.get());
+        }
+        for (Description::Parameters::const_iterator itr = description._parameters.begin(); itr != description._parameters.end(); ++itr)
+        {
+            program->setParameter(itr->first, itr->second);
+        }
+        for (Description::AttribLocations::const_iterator itr = description._attribLocations.begin(); itr != description._attribLocations.end(); ++itr)
+        {
+            program->addBindAttribLocation(itr->first, itr->second);
+        }
+
+        _programs[key.str()] = program;
+        ++_stats.numPrograms;
+
+        osg::notify(osg::INFO) << "ShaderProgramRegistry: created " << description._name << ", " << _stats.numPrograms << " programs" << std::endl;
+
+        return program.get();
+    }
+
+    void ShaderProgramRegistry::compiled(const std::string& name, unsigned int contextID, double seconds)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+
+        ContextStats& stats = _stats.contexts[contextID];
+        ++stats.compiles;
+        stats.compileTime += seconds;
+
+        osg::notify(osg::NOTICE) << "ShaderProgramRegistry: compiled " << name << " in context " << contextID << " in "
+            << seconds * 1000.0 << " ms, " << stats.compiles << " programs in " << stats.compileTime * 1000.0 << " ms" << std::endl;
+    }
+
+    ShaderProgramRegistry::Stats ShaderProgramRegistry::getStats() const
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _stats;
+    }
+}
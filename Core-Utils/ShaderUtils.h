@@ -43,6 +43,14 @@
 #include <osg/GLDefines>
 
 #include <osg/Shader>
+#include <osg/Program>
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
 
 namespace osg
 {
@@ -50,5 +58,135 @@ namespace osg
 	{
 	public:
 		static GLint compileShader(const std::string& strSource, osg::Shader::Type shaderType, osg::GLExtensions* ext);
+
+		// The LogZDepthBuffer setting from the configuration
+		static bool useLogZDepthBuffer();
+	};
+
+	// Shares the programs of the plugins. A program is put together from
+	// shader files, inline sources and named snippets, and the ones that end
+	// up with the same sources, defines, parameters and attribute bindings
+	// are the same program object, so they are compiled and linked once per
+	// graphics context. The files are read once
+	class IGCOREUTILS_EXPORT ShaderProgramRegistry
+	{
+	public:
+		class IGCOREUTILS_EXPORT Description
+		{
+		public:
+			Description(const std::string& name);
+
+			// Starts a new shader, the parts added next are appended to it in order
+			Description& addShader(osg::Shader::Type type);
+			Description& addFile(const std::string& fileName);
+			Description& addSource(const std::string& source);
+			Description& addSnippet(const std::string& snippetName);
+
+			// Inserted after the #version line of every shader of the program.
+			// Not for the defines set on the StateSets, these are done by osg
+			Description& addDefine(const std::string& name, const std::string& value = "");
+
+			Description& setParameter(GLenum pname, GLint value);
+			Description& addBindAttribLocation(const std::string& name, GLuint index);
+
+		protected:
+			friend class ShaderProgramRegistry;
+
+			enum PartType
+			{
+				File,
+				Source,
+				Snippet
+			};
+
+			struct Part
+			{
+				PartType	type;
+				std::string	text;
+			};
+			typedef std::vector<Part> Parts;
+
+			struct Shader
+			{
+				osg::Shader::Type	type;
+				Parts				parts;
+			};
+			typedef std::vector<Shader> Shaders;
+
+			Description& addPart(PartType type, const std::string& text);
+
+			typedef std::map<std::string, std::string>	Defines;
+			typedef std::map<GLenum, GLint>				Parameters;
+			typedef std::map<std::string, GLuint>		AttribLocations;
+
+			std::string		_name;
+			Shaders			_shaders;
+			Defines			_defines;
+			Parameters		_parameters;
+			AttribLocations	_attribLocations;
+		};
+
+		struct ContextStats
+		{
+			ContextStats();
+
+			unsigned long	compiles;		// programs compiled and linked
+			double			compileTime;	// seconds spent in them, as seen on the CPU
+		};
+		typedef std::map<unsigned int, ContextStats> ContextStatsMap;
+
+		struct Stats
+		{
+			Stats();
+
+			unsigned long	requests;
+			unsigned long	hits;			// served an existing program
+			unsigned long	numPrograms;
+			unsigned long	numShaders;		// shared between the programs too
+			unsigned long	fileReads;
+			unsigned long	failedRequests;	// a file or a snippet was missing
+			ContextStatsMap	contexts;
+		};
+
+		static ShaderProgramRegistry* instance();
+
+		// NULL if a file or a snippet of the description was not found
+		osg::Program* getOrCreateProgram(const Description& description);
+
+		// Snippets are referenced by name from the descriptions. The
+		// file of a file snippet is read the first time it is used
+		void registerSnippet(const std::string& name, const std::string& source);
+		void registerSnippetFile(const std::string& name, const std::string& fileName);
+
+		Stats getStats() const;
+
+	protected:
+		ShaderProgramRegistry();
+
+		class Program;
+		friend class Program;
+
+		bool resolve(const Description::Part& part, std::string& source);
+		bool readFile(const std::string& fileName, std::string& source);
+		void compiled(const std::string& name, unsigned int contextID, double seconds);
+
+		typedef boost::unordered_map< std::string, std::string > MapNamesToSources;
+		MapNamesToSources _files;
+		MapNamesToSources _snippets;
+		MapNamesToSources _snippetFiles;
+
+		typedef boost::unordered_map< std::string, osg::ref_ptr<osg::Shader> > MapSourcesToShaders;
+		MapSourcesToShaders _shaders;
+
+		typedef boost::unordered_map< std::string, osg::ref_ptr<osg::Program> > MapKeysToPrograms;
+		MapKeysToPrograms _programs;
+
+		Stats _stats;
+
+		mutable boost::mutex _mutex;
+
+	private:
+		ShaderProgramRegistry(const ShaderProgramRegistry&);
+		ShaderProgramRegistry& operator=(const ShaderProgramRegistry&);
 	};
-}
+}
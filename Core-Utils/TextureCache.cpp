@@ -1,44 +1,179 @@
 #include "TextureCache.h"
 #include <Core-Base/FileSystem.h>
+#include <Core-Base/Configuration.h>
+#include <Core-Base/ThreadPool.h>
 
 #include <osgDB/ReadFile>
+#include <osgDB/FileNameUtils>
 
+#include <boost/bind.hpp>
 #include <boost/unordered_map.hpp>
 
 namespace osg
 {
+   // The decoding is mostly waiting on the disk, so it gets
+   // its own threads instead of the ones for the frame work
+   static OpenIG::Base::ThreadPool* decodeThreads()
+   {
+      static OpenIG::Base::ThreadPool s_pool(2);
+      return &s_pool;
+   }
+
+   TextureCache::Request::Request()
+      : _ready(false)
+   {
+   }
+
+   bool TextureCache::Request::isReady() const
+   {
+      boost::mutex::scoped_lock lock(_mutex);
+      return _ready;
+   }
+
+   Texture2DPointer TextureCache::Request::get() const
+   {
+      boost::mutex::scoped_lock lock(_mutex);
+      while (!_ready)
+      {
+         _condition.wait(lock);
+      }
+      return _texture;
+   }
+
+   void TextureCache::Request::complete(Texture2DPointer texture)
+   {
+      {
+         boost::mutex::scoped_lock lock(_mutex);
+         _texture = texture;
+         _ready = true;
+      }
+      _condition.notify_all();
+   }
+
+   TextureCache::Stats::Stats()
+      : hits(0)
+      , misses(0)
+      , negativeHits(0)
+      , failedLoads(0)
+      , evictions(0)
+      , residentBytes(0)
+      , numResident(0)
+   {
+   }
+
+   TextureCache::TextureCache()
+      : _numLoading(0)
+   {
+      int budgetMB = OpenIG::Base::Configuration::instance()->getConfig("TextureCache-BudgetMB", 512);
+      _budget = budgetMB > 0 ? (size_t)budgetMB * 1024 * 1024 : 0;
+   }
+
+   TextureCache::~TextureCache()
+   {
+      // The loads still running refer to us
+      boost::mutex::scoped_lock lock(_mutex);
+      while (_numLoading)
+      {
+         _loadingDone.wait(lock);
+      }
+   }
+
    // These are search paths for the images
    void TextureCache::addPath(const std::string& path)
    {
-      bool not_found = true;
+      std::string normalized = osgDB::convertFileNameToUnixStyle(path);
+      while (normalized.size() > 1 && normalized[normalized.size() - 1] == '/')
+      {
+         normalized.erase(normalized.size() - 1);
+      }
+      if (normalized.empty()) return;
+
+      boost::mutex::scoped_lock lock(_mutex);
 
       // Dont add it multiple times
-      Paths::iterator itr = _paths.begin();
-      for (; itr != _paths.end(); ++itr)
+      if (!_pathSet.insert(normalized).second) return;
+      _paths.push_back(normalized);
+
+      // The new path might have what was missing
+      _missing.clear();
+   }
+
+   // Gets a texture from the cache
+   Texture2DPointer TextureCache::get(const std::string& name)
+   {
+      RequestPointer pending = request(name, false);
+      return pending.valid() ? pending->get() : Texture2DPointer();
+   }
+
+   TextureCache::RequestPointer TextureCache::getAsync(const std::string& name)
+   {
+      RequestPointer pending = request(name, true);
+      if (!pending.valid())
+      {
+         // Known to be missing, already done
+         pending = new Request;
+         pending->complete(Texture2DPointer());
+      }
+      return pending;
+   }
+
+   TextureCache::RequestPointer TextureCache::request(const std::string& name, bool async)
+   {
+      RequestPointer pending;
+      Paths paths;
       {
-         if (path == *itr)
+         boost::mutex::scoped_lock lock(_mutex);
+
+         if (_missing.count(name))
+         {
+            ++_stats.negativeHits;
+            return RequestPointer();
+         }
+
+         // If existing simply return
+         MapNamesToEntries::iterator itr = _cache.find(name);
+         if (itr != _cache.end())
          {
-            not_found = false;
-            break;
+            ++_stats.hits;
+            Entry& entry = itr->second;
+            if (entry.resident)
+            {
+               _lru.splice(_lru.begin(), _lru, entry.lru);
+            }
+            return entry.request;
          }
+
+         ++_stats.misses;
+
+         Entry& entry = _cache[name];
+         entry.request = pending = new Request;
+         entry.bytes = 0;
+         entry.resident = false;
+
+         paths = _paths;
+         ++_numLoading;
+      }
+
+      if (async)
+      {
+         decodeThreads()->post(boost::bind(&TextureCache::load, this, name, paths, pending));
       }
-      if (not_found) _paths.push_back(path);
+      else
+      {
+         load(name, paths, pending);
+      }
+      return pending;
    }
 
-   // Gets a texture from the cache
-   Texture2DPointer TextureCache::get(const std::string& name)
+   void TextureCache::load(const std::string& name, Paths paths, RequestPointer pending)
    {
-      // If existing simply return
-      MapNamesToTexture2DPointers::iterator itr = _cache.find(name);
-      if (itr != _cache.end()) return itr->second;
-
       // read the image from the given path
       osg::ref_ptr<osg::Image> image = osgDB::readImageFile(name);
       if (!image.valid())
       {
          // If failed, look into the search paths
-         Paths::iterator itr = _paths.begin();
-         for (; itr != _paths.end(); ++itr)
+         Paths::iterator itr = paths.begin();
+         for (; itr != paths.end(); ++itr)
          {
             const std::string path = *itr + "/" + name;
             image = osgDB::readImageFile(path);
@@ -49,15 +184,122 @@ namespace osg
       if (!image.valid())
       {
          osg::notify(osg::NOTICE) << "Texture cache: failed to load texture: " << name << std::endl;
-         return Texture2DPointer();
+         finish(name, pending, Texture2DPointer(), 0);
+         return;
       }
 
+      // Taken before the image data is released on apply,
+      // it stands for the texture memory from then on
+      size_t bytes = image->getTotalSizeInBytesIncludingMipmaps();
+
       osg::ref_ptr<osg::Texture2D> texture = new osg::Texture2D;
       texture->setImage(image);
       texture->setUnRefImageDataAfterApply(true);
 
-      _cache[name] = texture;
-      return texture;
+      finish(name, pending, texture, bytes);
+   }
+
+   void TextureCache::finish(const std::string& name, RequestPointer pending, Texture2DPointer texture, size_t bytes)
+   {
+      boost::mutex::scoped_lock lock(_mutex);
+
+      // Unless it was cleared meanwhile
+      MapNamesToEntries::iterator itr = _cache.find(name);
+      if (itr != _cache.end() && itr->second.request == pending)
+      {
+         if (texture.valid())
+         {
+            Entry& entry = itr->second;
+            entry.bytes = bytes;
+            entry.resident = true;
+            entry.lru = _lru.insert(_lru.begin(), name);
+
+            _stats.residentBytes += bytes;
+            ++_stats.numResident;
+
+            evict();
+         }
+         else
+         {
+            _cache.erase(itr);
+            _missing.insert(name);
+            ++_stats.failedLoads;
+         }
+      }
+
+      pending->complete(texture);
+
+      if (--_numLoading == 0)
+      {
+         _loadingDone.notify_all();
+      }
+   }
+
+   void TextureCache::evict()
+   {
+      if (!_budget || _stats.residentBytes <= _budget || _lru.size() < 2) return;
+
+      // The most recent one stays even if it is over the budget alone.
+      // The ones still in use are kept and tried again on the next eviction
+      LRUList::iterator itr = _lru.end();
+      --itr;
+      while (_stats.residentBytes > _budget && itr != _lru.begin())
+      {
+         LRUList::iterator current = itr--;
+
+         MapNamesToEntries::iterator entry = _cache.find(*current);
+         if (entry == _cache.end())
+         {
+            _lru.erase(current);
+            continue;
+         }
+
+         // Held by someone besides the cache, dropping it would not free
+         // anything and the next get would decode and upload a second copy.
+         // The request is completed under _mutex, so reading it here is safe
+         const Request* request = entry->second.request.get();
+         if (request->referenceCount() > 1 ||
+            (request->_texture.valid() && request->_texture->referenceCount() > 1)) continue;
+
+         _stats.residentBytes -= entry->second.bytes;
+         --_stats.numResident;
+         ++_stats.evictions;
+
+         _lru.erase(current);
+         _cache.erase(entry);
+      }
+   }
+
+   void TextureCache::setBudget(size_t bytes)
+   {
+      boost::mutex::scoped_lock lock(_mutex);
+      _budget = bytes;
+      evict();
+   }
+
+   size_t TextureCache::getBudget() const
+   {
+      boost::mutex::scoped_lock lock(_mutex);
+      return _budget;
+   }
+
+   TextureCache::Stats TextureCache::getStats() const
+   {
+      boost::mutex::scoped_lock lock(_mutex);
+      return _stats;
+   }
+
+   void TextureCache::clear()
+   {
+      boost::mutex::scoped_lock lock(_mutex);
+
+      // The loads running finish without inserting
+      _cache.clear();
+      _lru.clear();
+      _missing.clear();
+
+      _stats.residentBytes = 0;
+      _stats.numResident = 0;
    }
 
    // Gets unique ID from the
@@ -20,14 +20,14 @@
 //#*   You should have received a copy of the GNU Lesser General Public License
 //#*   along with this library; if not, write to the Free Software
 //#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
-//#*
-//#*    Please direct any questions or comments to the OpenIG Forums
-//#*    Email address: openig@compro.net
-//#*
-//#*
-//#*    Please direct any questions or comments to the OpenIG Forums
-//#*    Email address: openig@compro.net
-//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
 //#*
 //#*****************************************************************************
 #pragma once
@@ -42,27 +42,130 @@
 
 #include <string>
 #include <vector>
+#include <list>
 #include <map>
 
 #include <osg/ref_ptr>
+#include <osg/Referenced>
 #include <osg/Texture2D>
 #include <osg/TextureCubeMap>
 
+#include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
 namespace osg
 {
    typedef osg::ref_ptr<osg::Texture2D> Texture2DPointer;
 
+   // Shares the 2D textures by file name. Images that were not found
+   // are remembered, so they are not searched for again until a new
+   // search path is added. Images can be decoded in the background,
+   // and the resident textures are evicted in LRU order once their
+   // size goes over the budget
    class IGCOREUTILS_EXPORT TextureCache
    {
    public:
+      // A texture being loaded. The texture is NULL when
+      // the image was not found
+      class IGCOREUTILS_EXPORT Request : public osg::Referenced
+      {
+      public:
+         Request();
+
+         bool isReady() const;
+
+         // Waits for the load if it is still running
+         Texture2DPointer get() const;
+
+      protected:
+         friend class TextureCache;
+
+         void complete(Texture2DPointer texture);
+
+         mutable boost::mutex                _mutex;
+         mutable boost::condition_variable   _condition;
+         bool                                _ready;
+         Texture2DPointer                    _texture;
+      };
+      typedef osg::ref_ptr<Request> RequestPointer;
+
+      struct Stats
+      {
+         Stats();
+
+         unsigned long   hits;           // found resident or already loading
+         unsigned long   misses;         // had to be loaded
+         unsigned long   negativeHits;   // known to be missing, not searched for
+         unsigned long   failedLoads;
+         unsigned long   evictions;
+         size_t          residentBytes;
+         size_t          numResident;
+      };
+
+      TextureCache();
+      ~TextureCache();
+
       void addPath(const std::string& path);
+
+      // Loads on the calling thread if not resident
       Texture2DPointer get(const std::string& strFileName);
-   private: 
+
+      // Loads on the decode threads if not resident
+      RequestPointer getAsync(const std::string& strFileName);
+
+      // Budget in bytes of the resident textures, 0 for no limit.
+      // Textures still held outside of the cache are not evicted,
+      // so the resident size can stay over the budget while in use
+      void setBudget(size_t bytes);
+      size_t getBudget() const;
+
+      Stats getStats() const;
+
+      // Drops the resident textures and the remembered misses
+      void clear();
+
+   private:
       typedef std::vector< std::string > Paths;
       Paths	_paths;
 
-      typedef std::map< std::string, Texture2DPointer >	MapNamesToTexture2DPointers;
-      MapNamesToTexture2DPointers _cache;
+      typedef boost::unordered_set< std::string > PathSet;
+      PathSet _pathSet;
+
+      typedef std::list< std::string > LRUList;
+
+      struct Entry
+      {
+         RequestPointer      request;
+         size_t              bytes;
+         bool                resident;
+         LRUList::iterator   lru;
+      };
+      typedef boost::unordered_map< std::string, Entry > MapNamesToEntries;
+      MapNamesToEntries _cache;
+
+      // Most recently used first
+      LRUList _lru;
+
+      typedef boost::unordered_set< std::string > Names;
+      Names _missing;
+
+      size_t _budget;
+      Stats _stats;
+
+      mutable boost::mutex _mutex;
+
+      unsigned int _numLoading;
+      boost::condition_variable _loadingDone;
+
+      RequestPointer request(const std::string& name, bool async);
+      void load(const std::string& name, Paths paths, RequestPointer request);
+      void finish(const std::string& name, RequestPointer request, Texture2DPointer texture, size_t bytes);
+      void evict();
+
+      // Not copyable, the loads refer to the cache
+      TextureCache(const TextureCache&);
+      TextureCache& operator=(const TextureCache&);
    };
 
    typedef osg::ref_ptr<osg::TextureCubeMap> TextureCubeMapPointer;
@@ -83,4 +186,4 @@ namespace osg
 	   MapNamesToTextureCubeMapPointers	_cache;
 
    };
-}
+}
@@ -112,6 +112,9 @@ namespace OpenIG {
 				bool IsVisible(const AxisAlignedBoundingBox<T>& box) const;
 				VisibilityFromCamera GetVisibility(const AxisAlignedBoundingBox<T>& box) const;
 
+				// Normals point into the frustum
+				const Plane<T>& GetFrustumPlane(FrustumPlane plane) const;
+
 				// Normalized Device Coordinates (-1,1)
 				Vector2<T> Project(const Vector3<T>& vPosition) const;
 
@@ -274,6 +274,12 @@ namespace OpenIG {
 				}
 			}
 
+			template <class T>
+			const Plane<T>& Camera<T>::GetFrustumPlane(FrustumPlane plane) const
+			{
+				return m_FrustumPlanes[plane];
+			}
+
 			template <class T>
 			void Camera<T>::UpdateViewProjectionMatrix(void)
 			{
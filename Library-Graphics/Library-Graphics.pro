@@ -16,7 +16,10 @@ DEFINES += IGLIBGRAPHICS_LIBRARY
 SOURCES += 	ColorValue.cpp\
             DataFormat.cpp\
             Light.cpp\
+            LightActivation.cpp\
+            LightBVH.cpp\
             LightData.cpp\
+            LightJournal.cpp\
             LightManager.cpp\
             OIGMath.cpp\
             TileSpaceLightGrid.cpp\
@@ -36,7 +39,10 @@ HEADERS +=  AxisAlignedBoundingBox.h \
             ForwardDeclare.h\
             IntSize.h\
             Light.h\
+            LightActivation.h\
+            LightBVH.h\
             LightData.h\
+            LightJournal.h\
             LightManager.h\
             Matrix3.h\
             Matrix4.h\
@@ -28,6 +28,7 @@ THE SOFTWARE.
 */
 #include "CommonTypes.h"
 #include "Light.h"
+#include "LightJournal.h"
 
 using namespace OpenIG::Library::Graphics;
 
@@ -43,8 +44,12 @@ Light::Light()
     , m_fInnerAngle(30.0f)
     , m_fOuterAngle(60.0f)
     , m_fFallOff(1.0f)
+    , m_fLODRange(0.0f)
     , m_bIsOn(true)
-	, m_UpdateSignalEnabled(false)
+    , m_UserID(0)
+    , m_SpatialHandle(0xFFFFFFFF)
+	, m_pJournal(0)
+	, m_JournalEntry(0xFFFFFFFF)
 {
     UpdateBounds();
 
@@ -52,7 +57,7 @@ Light::Light()
 }
 Light::~Light()
 {
-    signal_LightDestroyed(this);
+    RecordChange(LCF_DESTROYED);
 }
 
 void Light::SetLightType(LightType lightType)
@@ -63,10 +68,7 @@ void Light::SetLightType(LightType lightType)
     }
     m_LightType = lightType;
     UpdateBounds();
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
+	RecordChange(LCF_DATA);
 }
 
 LightType Light::GetLightType(void) const
@@ -76,11 +78,9 @@ LightType Light::GetLightType(void) const
 
 void Light::SetOn(bool bOn)
 {
+    // The on state is resolved per frame by the LightManager and is not
+    // part of the packed light data, so it is not recorded as a change
     m_bIsOn = bOn;
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
 }
 bool Light::IsOn(void) const
 {
@@ -94,10 +94,7 @@ void Light::SetAmbientColor(const ColorValue& color)
         return;
     }
     m_AmbientColor = color;
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
+	RecordChange(LCF_DATA);
 }
 void Light::SetDiffuseColor(const ColorValue& color)
 {
@@ -106,10 +103,7 @@ void Light::SetDiffuseColor(const ColorValue& color)
         return;
     }
     m_DiffuseColor = color;
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
+	RecordChange(LCF_DATA);
 }
 void Light::SetSpecularColor(const ColorValue& color)
 {
@@ -118,10 +112,7 @@ void Light::SetSpecularColor(const ColorValue& color)
         return;
     }
     m_SpecularColor = color;
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
+	RecordChange(LCF_DATA);
 }
 
 const ColorValue& Light::GetAmbientColor(void) const
@@ -146,10 +137,7 @@ void Light::SetPosition(const Vector3_64& vPosition)
     }
     m_vPosition = vPosition;
     UpdateBounds();
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
+	RecordChange(LCF_DATA);
 }
 const Vector3_64& Light::GetPosition(void) const
 {
@@ -159,16 +147,14 @@ const Vector3_64& Light::GetPosition(void) const
 void Light::SetDirection(const Vector3_64& vDirection)
 {
     ASSERT_PREDICATE(m_LightType==LT_SPOT||m_LightType==LT_DIRECTIONAL);
-    if (memcmp(m_vDirection.ptr(), vDirection.ptr(), sizeof(Vector3_64))==0)
+    Vector3_64 vNormalizedDirection = vDirection;
+    vNormalizedDirection.Normalize();
+    if (memcmp(m_vDirection.ptr(), vNormalizedDirection.ptr(), sizeof(Vector3_64))==0)
     {
         return;
     }
-    m_vDirection = vDirection;
-    m_vDirection.Normalize();
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
+    m_vDirection = vNormalizedDirection;
+	RecordChange(LCF_DATA);
 }
 const Vector3_64& Light::GetDirection(void) const
 {
@@ -187,10 +173,7 @@ void Light::SetRanges(float32 fStart, float32 fEnd)
     m_fStartRange = fStart;
     m_fEndRange   = fEnd;
     UpdateBounds();
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
+	RecordChange(LCF_DATA);
 }
 void Light::GetRanges(float32& fStart, float32& fEnd) const
 {
@@ -204,8 +187,8 @@ void Light::SetSpotLightAngles(float32 fInnerAngleDegrees, float32 fOuterAngleDe
     ASSERT_PREDICATE(0.0f<=fInnerAngleDegrees&&fInnerAngleDegrees<=fOuterAngleDegrees);
     ASSERT_PREDICATE(fOuterAngleDegrees<=180.0f);
 
-    if (memcmp(&m_fStartRange, &fInnerAngleDegrees, sizeof(float32))==0 
-        && memcmp(&m_fEndRange, &fOuterAngleDegrees, sizeof(float32))==0
+    if (memcmp(&m_fInnerAngle, &fInnerAngleDegrees, sizeof(float32))==0 
+        && memcmp(&m_fOuterAngle, &fOuterAngleDegrees, sizeof(float32))==0
         )
     {
         return;
@@ -213,23 +196,18 @@ void Light::SetSpotLightAngles(float32 fInnerAngleDegrees, float32 fOuterAngleDe
 
     m_fInnerAngle = fInnerAngleDegrees;
     m_fOuterAngle = fOuterAngleDegrees;
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
+	RecordChange(LCF_DATA);
 }
 
 void Light::SetFalloff(float fFallOff)
 {
     ASSERT_PREDICATE(m_LightType==LT_SPOT);
-    if (memcmp(&m_fEndRange, &fFallOff, sizeof(float32))==0)
+    if (memcmp(&m_fFallOff, &fFallOff, sizeof(float32))==0)
     {
         return;
     }
-	if (m_UpdateSignalEnabled)
-	{
-		signal_LightUpdated(this);
-	}
+    m_fFallOff = fFallOff;
+	RecordChange(LCF_DATA);
 }
 void Light::GetSpotLightAngles(float32& fInnerAngleDegrees, float32& fOuterAngleDegrees) const
 {
@@ -256,14 +234,59 @@ float32 Light::GetFalloff(void) const
     return m_fFallOff;
 }
 
-UserObjectBindings& Light::GetUserObjectBindings(void)
+void Light::SetLODRange(float32 fRange)
+{
+    m_fLODRange = fRange;
+}
+float32 Light::GetLODRange(void) const
+{
+    return m_fLODRange;
+}
+
+void Light::_SetJournal(LightJournal* pJournal)
+{
+	m_pJournal = pJournal;
+}
+LightJournal* Light::_GetJournal(void) const
+{
+	return m_pJournal;
+}
+
+void Light::_SetJournalEntry(uint32 entry)
+{
+	m_JournalEntry = entry;
+}
+uint32 Light::_GetJournalEntry(void) const
+{
+	return m_JournalEntry;
+}
+
+void Light::RecordChange(uint32 flags)
+{
+	if (m_pJournal)
+	{
+		m_pJournal->Record(this, flags);
+	}
+}
+
+void Light::SetUserID(uint32 id)
+{
+    m_UserID = id;
+}
+
+uint32 Light::GetUserID(void) const
+{
+    return m_UserID;
+}
+
+void Light::_SetSpatialHandle(uint32 handle)
 {
-    return m_UserObjectBindings;
+    m_SpatialHandle = handle;
 }
 
-const UserObjectBindings& Light::GetUserObjectBindings(void) const
+uint32 Light::_GetSpatialHandle(void) const
 {
-    return m_UserObjectBindings;
+    return m_SpatialHandle;
 }
 
 void Light::UpdateBounds(void)
@@ -280,7 +303,7 @@ void Light::UpdateBounds(void)
 
         m_WorldAABB.SetMinMax(vMin, vMax);
     }
-    signal_LightBoundsUpdated(this);
+    RecordChange(LCF_BOUNDS);
 }
 
 const AxisAlignedBoundingBox_64& Light::_GetWorldAABB(void) const
@@ -290,7 +313,12 @@ const AxisAlignedBoundingBox_64& Light::_GetWorldAABB(void) const
 
 void Light::SetCustomFloats(float vals[3])
 {
+	if (memcmp(m_fCustomFloats, vals, 3*sizeof(float32))==0)
+	{
+		return;
+	}
 	memcpy(m_fCustomFloats, vals, 3*sizeof(float32));
+	RecordChange(LCF_DATA);
 }
 void Light::GetCustomFloats(float vals[3]) const
 {
@@ -34,8 +34,6 @@ THE SOFTWARE.
     #include <OpenIG-Graphics/VectorForwardDeclare.h>
     #include <OpenIG-Graphics/Vector3.h>
     #include <OpenIG-Graphics/AxisAlignedBoundingBox.h>
-    #include <OpenIG-Graphics/UserObjectBindings.h>
-    #include <OpenIG-Graphics/Signal.h>
     #include <OpenIG-Graphics/ForwardDeclare.h>
 #else
     #include <Library-Graphics/Export.h>
@@ -43,8 +41,6 @@ THE SOFTWARE.
     #include <Library-Graphics/VectorForwardDeclare.h>
     #include <Library-Graphics/Vector3.h>
     #include <Library-Graphics/AxisAlignedBoundingBox.h>
-    #include <Library-Graphics/UserObjectBindings.h>
-    #include <Library-Graphics/Signal.h>
     #include <Library-Graphics/ForwardDeclare.h>
 #endif
 
@@ -55,8 +51,7 @@ namespace OpenIG {
         namespace Graphics {
 
             class Light;
-
-            typedef signal1< const Light* > LightSignal;
+            class LightJournal;
 
             enum LightType
             {
@@ -108,30 +103,37 @@ namespace OpenIG {
                 void    SetFalloff(float fFallOff);
                 float32 GetFalloff(void) const;
 
-                UserObjectBindings& GetUserObjectBindings(void);
-                const UserObjectBindings& GetUserObjectBindings(void) const;
+                // Distance from the eye the light is active within, 0 for no
+                // limit. Read by LightActivation, it is not in the packed data
+                void    SetLODRange(float32 fRange);
+                float32 GetLODRange(void) const;
+
+                // Id of the light on the application side
+                void   SetUserID(uint32 id);
+                uint32 GetUserID(void) const;
 
-                LightSignal signal_LightUpdated;
-                LightSignal signal_LightBoundsUpdated;
-                LightSignal signal_LightDestroyed;
+                // The setters record their changes into the journal of the
+                // LightManager that created the light, see LightChangeFlags
+                void          _SetJournal(LightJournal* pJournal);
+                LightJournal* _GetJournal(void) const;
+
+                // Index of the pending journal entry of the light
+                void   _SetJournalEntry(uint32 entry);
+                uint32 _GetJournalEntry(void) const;
 
                 const AxisAlignedBoundingBox_64& _GetWorldAABB(void) const;
 
-                float64 fTempValue;
+                // Handle of the light in the LightManager bounding volume hierarchy
+                void   _SetSpatialHandle(uint32 handle);
+                uint32 _GetSpatialHandle(void) const;
 
-                void SetVec3_32_1(const Vector3_32& vec){ m_Vec1 = vec; }
-                void SetVec3_32_2(const Vector3_32& vec){ m_Vec2 = vec; }
-                const Vector3_32& GetVec1(void) const { return m_Vec1; }
-                const Vector3_32& GetVec2(void) const { return m_Vec2; }
+                float64 fTempValue;
 
                 // Up to 3 custom floats
                 void SetCustomFloats(float vals[3]);
                 void GetCustomFloats(float vals[3]) const;
             private:
 
-                Vector3_32 m_Vec1;
-                Vector3_32 m_Vec2;
-
                 LightType m_LightType;
 
                 ColorValue m_AmbientColor;
@@ -153,16 +155,22 @@ namespace OpenIG {
                 // Decrease in illumination between a spotlight's inner cone and the outer edge of the outer cone.
                 float32 m_fFallOff;
 
+                float32 m_fLODRange;
+
                 bool m_bIsOn;
 
-                UserObjectBindings m_UserObjectBindings;
+                uint32 m_UserID;
+                uint32 m_SpatialHandle;
 
                 void UpdateBounds(void);
                 AxisAlignedBoundingBox_64 m_WorldAABB;
 
                 float m_fCustomFloats[3];
 
-                bool m_UpdateSignalEnabled;
+                LightJournal* m_pJournal;
+                uint32        m_JournalEntry;
+
+                void RecordChange(uint32 flags);
             };
 
         }
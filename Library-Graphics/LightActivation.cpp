@@ -0,0 +1,422 @@
+/*
+-----------------------------------------------------------------------------
+File:        LightActivation.cpp
+Copyright:   Copyright (C) 2026 Compro Computer Services. All rights reserved.
+Created:     10/19/2026
+Last edit:   10/19/2026
+Author:      Compro Computer Services
+E-mail:      openig@compro.net
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "CommonUtils.h"
+#include "LightActivation.h"
+#include "Light.h"
+#include "Camera.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+	// Cells closer to the eye than this fraction of their edge are ranked
+	// as if they were this far, so the nearest cell does not take all
+	const double s_MinCellDistanceFraction = 0.5;
+
+}
+
+namespace OpenIG {
+	namespace Library {
+		namespace Graphics {
+
+			struct LightActivation::ScreenSizeGreater
+			{
+				bool operator()(const ActiveLight& lhs, const ActiveLight& rhs) const
+				{
+					return lhs.fScreenSize > rhs.fScreenSize;
+				}
+			};
+
+			struct LightActivation::PriorityGreater
+			{
+				bool operator()(const ProxyCell& lhs, const ProxyCell& rhs) const
+				{
+					return lhs.fPriority > rhs.fPriority;
+				}
+			};
+
+			struct LightActivation::KeyLess
+			{
+				bool operator()(const ProxyCell& lhs, const ProxyCell& rhs) const
+				{
+					if (lhs.key.x != rhs.key.x) return lhs.key.x < rhs.key.x;
+					if (lhs.key.y != rhs.key.y) return lhs.key.y < rhs.key.y;
+					return lhs.key.z < rhs.key.z;
+				}
+			};
+
+			LightActivation::LightActivation()
+				: m_fHysteresis(0.1f)
+				, m_fMinScreenSize(0.0f)
+				, m_MaxActiveLights(0)
+				, m_MaxProxyLights(0)
+				, m_fProxyCellSize(500.0)
+				, m_uApplied(0)
+				, m_NumActiveLights(0)
+				, m_NumProxyLights(0)
+				, m_NumMergedLights(0)
+			{
+			}
+			LightActivation::~LightActivation()
+			{
+				// The listeners may be gone already, the journaled
+				// destruction of the proxies is not handed out
+				for (VectorLights::iterator it = m_Proxies.begin(); it != m_Proxies.end(); ++it)
+				{
+					SAFE_DELETE(*it);
+				}
+				m_Proxies.clear();
+			}
+
+			void LightActivation::SetHysteresis(float32 fHysteresis)
+			{
+				m_fHysteresis = std::max(fHysteresis, 0.0f);
+			}
+			float32 LightActivation::GetHysteresis(void) const
+			{
+				return m_fHysteresis;
+			}
+
+			void LightActivation::SetMinScreenSize(float32 fPixels)
+			{
+				m_fMinScreenSize = std::max(fPixels, 0.0f);
+			}
+			float32 LightActivation::GetMinScreenSize(void) const
+			{
+				return m_fMinScreenSize;
+			}
+
+			void LightActivation::SetMaxActiveLights(size_t numLights)
+			{
+				m_MaxActiveLights = numLights;
+			}
+			size_t LightActivation::GetMaxActiveLights(void) const
+			{
+				return m_MaxActiveLights;
+			}
+
+			void LightActivation::SetMaxProxyLights(size_t numLights)
+			{
+				m_MaxProxyLights = numLights;
+
+				// The destruction of the proxies over the limit is
+				// handed to the listeners by the next Apply
+				while (m_Proxies.size() > m_MaxProxyLights)
+				{
+					delete m_Proxies.back();
+					m_Proxies.pop_back();
+				}
+			}
+			size_t LightActivation::GetMaxProxyLights(void) const
+			{
+				return m_MaxProxyLights;
+			}
+
+			void LightActivation::SetProxyCellSize(float64 fSize)
+			{
+				ASSERT_PREDICATE_RETURN(fSize > 0);
+				m_fProxyCellSize = fSize;
+			}
+			float64 LightActivation::GetProxyCellSize(void) const
+			{
+				return m_fProxyCellSize;
+			}
+
+			void LightActivation::Apply(const Camera_64* pCamera, const Vector2_uint32& viewport, const VectorLights& visibleLights, VectorLights& activeLights)
+			{
+				activeLights.clear();
+				m_ActiveLights.clear();
+				m_Cells.clear();
+				m_CellIndices.clear();
+				m_NumActiveLights = 0;
+				m_NumProxyLights = 0;
+				m_NumMergedLights = 0;
+
+				ASSERT_PREDICATE_RETURN(pCamera);
+
+				++m_uApplied;
+
+				const Vector3_64 vEye = pCamera->GetPosition();
+
+				// Pixels covered by a unit length seen from a unit distance
+				float64 fProjectionScale = 0;
+				float64 fTanHalfFovy = Math::Tan(pCamera->GetFieldOfView()*0.5);
+				if (fTanHalfFovy > 0)
+				{
+					fProjectionScale = viewport.y / (2.0*fTanHalfFovy);
+				}
+
+				const float64 fWidened = 1.0 + m_fHysteresis;
+
+				for (VectorLights::const_iterator it = visibleLights.begin(); it != visibleLights.end(); ++it)
+				{
+					Light* pLight = *it;
+					if (pLight->GetLightType() == LT_DIRECTIONAL)
+					{
+						activeLights.push_back(pLight);
+						continue;
+					}
+
+					LightState& state = m_States[pLight];
+					const bool bWasActive = state.bActive && state.uApplied + 1 == m_uApplied;
+					const float64 fScale = bWasActive ? fWidened : 1.0;
+					state.uApplied = m_uApplied;
+
+					float32 fStartRange, fEndRange;
+					pLight->GetRanges(fStartRange, fEndRange);
+
+					const float64 fDistance = pLight->GetPosition().GetDistance(vEye);
+
+					bool bActive = true;
+
+					const float32 fLODRange = pLight->GetLODRange();
+					if (fLODRange > 0 && fDistance > fLODRange*fScale)
+					{
+						bActive = false;
+					}
+
+					// Diameter of the range on screen, unbounded with the eye inside it
+					float64 fScreenSize = std::numeric_limits<float64>::max();
+					if (fDistance > fEndRange && fProjectionScale > 0)
+					{
+						fScreenSize = 2.0*fEndRange*fProjectionScale / fDistance;
+					}
+					if (bActive && fScreenSize*fScale < m_fMinScreenSize)
+					{
+						bActive = false;
+					}
+
+					state.bActive = bActive;
+					if (bActive)
+					{
+						ActiveLight activeLight;
+						activeLight.pLight = pLight;
+						activeLight.fScreenSize = fScreenSize;
+						m_ActiveLights.push_back(activeLight);
+					}
+					else
+					{
+						MergeIntoCell(pLight);
+					}
+				}
+
+				// Keep the largest on screen
+				if (m_MaxActiveLights > 0 && m_ActiveLights.size() > m_MaxActiveLights)
+				{
+					std::nth_element(m_ActiveLights.begin(), m_ActiveLights.begin() + m_MaxActiveLights, m_ActiveLights.end(), ScreenSizeGreater());
+					for (size_t i = m_MaxActiveLights; i < m_ActiveLights.size(); ++i)
+					{
+						m_States[m_ActiveLights[i].pLight].bActive = false;
+						MergeIntoCell(m_ActiveLights[i].pLight);
+					}
+					m_ActiveLights.resize(m_MaxActiveLights);
+				}
+
+				for (size_t i = 0; i < m_ActiveLights.size(); ++i)
+				{
+					activeLights.push_back(m_ActiveLights[i].pLight);
+				}
+				m_NumActiveLights = m_ActiveLights.size();
+
+				UpdateProxies(vEye, activeLights);
+
+				if (m_ProxyJournal.IsEmpty() == false)
+				{
+					m_ProxyJournal.Drain(m_ProxyChanges);
+					for (LightChangeListeners::const_iterator it = m_ChangeListeners.begin(); it != m_ChangeListeners.end(); ++it)
+					{
+						(*it)->LightsChanged(m_ProxyChanges);
+					}
+				}
+			}
+
+			void LightActivation::MergeIntoCell(Light* pLight)
+			{
+				if (m_MaxProxyLights == 0)
+				{
+					return;
+				}
+
+				const ColorValue& color = pLight->GetDiffuseColor();
+				const float64 fWeight = color.r + color.g + color.b;
+				if (fWeight <= 0)
+				{
+					return;
+				}
+
+				const Vector3_64& vPosition = pLight->GetPosition();
+
+				CellKey key;
+				key.x = static_cast<int32>(std::floor(vPosition.x / m_fProxyCellSize));
+				key.y = static_cast<int32>(std::floor(vPosition.y / m_fProxyCellSize));
+				key.z = static_cast<int32>(std::floor(vPosition.z / m_fProxyCellSize));
+
+				std::pair<CellIndices::iterator, bool> inserted = m_CellIndices.insert(std::make_pair(key, static_cast<uint32>(m_Cells.size())));
+				if (inserted.second)
+				{
+					ProxyCell cell;
+					cell.key = key;
+					cell.vWeightedPosition = Vector3_64::ZERO;
+					cell.vMin = vPosition;
+					cell.vMax = vPosition;
+					cell.fWeight = 0;
+					cell.fColor[0] = cell.fColor[1] = cell.fColor[2] = 0;
+					cell.fStartRange = 0;
+					cell.fEndRange = 0;
+					cell.uNumLights = 0;
+					cell.fPriority = 0;
+					m_Cells.push_back(cell);
+				}
+				ProxyCell& cell = m_Cells[inserted.first->second];
+
+				float32 fStartRange, fEndRange;
+				pLight->GetRanges(fStartRange, fEndRange);
+
+				cell.vWeightedPosition = cell.vWeightedPosition + vPosition*fWeight;
+				cell.fWeight += fWeight;
+				for (size_t i = 0; i < 3; ++i)
+				{
+					cell.vMin[i] = std::min(cell.vMin[i], vPosition[i]);
+					cell.vMax[i] = std::max(cell.vMax[i], vPosition[i]);
+				}
+				cell.fColor[0] += color.r;
+				cell.fColor[1] += color.g;
+				cell.fColor[2] += color.b;
+				cell.fStartRange = std::max(cell.fStartRange, fStartRange);
+				cell.fEndRange = std::max(cell.fEndRange, fEndRange);
+				++cell.uNumLights;
+
+				++m_NumMergedLights;
+			}
+
+			void LightActivation::UpdateProxies(const Vector3_64& vEye, VectorLights& activeLights)
+			{
+				if (m_Cells.empty())
+				{
+					return;
+				}
+
+				// Rank the cells by their summed intensity as seen from the eye
+				const float64 fMinDistance = m_fProxyCellSize*s_MinCellDistanceFraction;
+				for (size_t i = 0; i < m_Cells.size(); ++i)
+				{
+					ProxyCell& cell = m_Cells[i];
+					Vector3_64 vCenter = cell.vWeightedPosition / cell.fWeight;
+					cell.fPriority = cell.fWeight / std::max((vCenter - vEye).GetSquaredLength(), fMinDistance*fMinDistance);
+				}
+				if (m_Cells.size() > m_MaxProxyLights)
+				{
+					std::nth_element(m_Cells.begin(), m_Cells.begin() + m_MaxProxyLights, m_Cells.end(), PriorityGreater());
+					m_Cells.resize(m_MaxProxyLights);
+				}
+
+				// In cell order, so the proxies keep their cells while the
+				// ranking holds and only the moved records are repacked
+				std::sort(m_Cells.begin(), m_Cells.end(), KeyLess());
+
+				while (m_Proxies.size() < m_Cells.size())
+				{
+					Light* pProxy = new Light;
+					pProxy->_SetJournal(&m_ProxyJournal);
+					pProxy->SetLightType(LT_POINT);
+					pProxy->SetAmbientColor(ColorValue::BLACK);
+					m_Proxies.push_back(pProxy);
+				}
+
+				for (size_t i = 0; i < m_Cells.size(); ++i)
+				{
+					const ProxyCell& cell = m_Cells[i];
+					Light* pProxy = m_Proxies[i];
+
+					// The proxy is lit fully across the extent of the merged
+					// lights and its color is their sum, saturated
+					const float32 fExtent = static_cast<float32>((cell.vMax - cell.vMin).GetLength()*0.5);
+					ColorValue color(
+						std::min(cell.fColor[0], 1.0f),
+						std::min(cell.fColor[1], 1.0f),
+						std::min(cell.fColor[2], 1.0f),
+						1.0f);
+
+					pProxy->SetPosition(cell.vWeightedPosition / cell.fWeight);
+					pProxy->SetDiffuseColor(color);
+					pProxy->SetSpecularColor(color);
+					pProxy->SetRanges(fExtent + cell.fStartRange, fExtent + cell.fEndRange);
+
+					activeLights.push_back(pProxy);
+				}
+				m_NumProxyLights = m_Cells.size();
+			}
+
+			size_t LightActivation::GetNumActiveLights(void) const
+			{
+				return m_NumActiveLights;
+			}
+			size_t LightActivation::GetNumProxyLights(void) const
+			{
+				return m_NumProxyLights;
+			}
+			size_t LightActivation::GetNumMergedLights(void) const
+			{
+				return m_NumMergedLights;
+			}
+
+			void LightActivation::AddChangeListener(LightChangeListener* pListener)
+			{
+				ASSERT_PREDICATE_RETURN(pListener);
+				if (std::find(m_ChangeListeners.begin(), m_ChangeListeners.end(), pListener) == m_ChangeListeners.end())
+				{
+					m_ChangeListeners.push_back(pListener);
+				}
+			}
+			void LightActivation::RemoveChangeListener(LightChangeListener* pListener)
+			{
+				m_ChangeListeners.erase(std::remove(m_ChangeListeners.begin(), m_ChangeListeners.end(), pListener), m_ChangeListeners.end());
+			}
+
+			void LightActivation::LightsChanged(const LightChanges& changes)
+			{
+				if (m_States.empty())
+				{
+					return;
+				}
+
+				for (LightChanges::const_iterator it = changes.begin(); it != changes.end(); ++it)
+				{
+					if (it->flags & LCF_DESTROYED)
+					{
+						m_States.erase(it->pLight);
+					}
+				}
+			}
+
+		}
+	}
+}
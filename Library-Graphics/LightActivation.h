@@ -0,0 +1,194 @@
+/*
+-----------------------------------------------------------------------------
+File:        LightActivation.h
+Copyright:   Copyright (C) 2026 Compro Computer Services. All rights reserved.
+Created:     10/19/2026
+Last edit:   10/19/2026
+Author:      Compro Computer Services
+E-mail:      openig@compro.net
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Graphics/Export.h>
+    #include <OpenIG-Graphics/CommonTypes.h>
+    #include <OpenIG-Graphics/CameraFwdDeclare.h>
+    #include <OpenIG-Graphics/ForwardDeclare.h>
+    #include <OpenIG-Graphics/Vector2.h>
+    #include <OpenIG-Graphics/Vector3.h>
+    #include <OpenIG-Graphics/LightJournal.h>
+#else
+    #include <Library-Graphics/Export.h>
+    #include <Library-Graphics/CommonTypes.h>
+    #include <Library-Graphics/CameraFwdDeclare.h>
+    #include <Library-Graphics/ForwardDeclare.h>
+    #include <Library-Graphics/Vector2.h>
+    #include <Library-Graphics/Vector3.h>
+    #include <Library-Graphics/LightJournal.h>
+#endif
+
+FORWARD_DECLARE(Light)
+
+namespace OpenIG {
+    namespace Library {
+        namespace Graphics {
+
+            // Picks, per view, the visible lights worth packing and binning. A
+            // light is active while the eye is within its LOD range and its range
+            // projects to at least the minimum screen size, and both tests are
+            // widened by the hysteresis once it is active so the lights around a
+            // threshold do not flicker. The lights left out are merged per world
+            // grid cell into a bounded number of proxy point lights, so a field
+            // of distant lights still shows at a fixed cost. Register with
+            // LightManager::AddChangeListener to drop the state of the destroyed
+            // lights, and add the light data of the view as a listener of the
+            // activation to receive the changes of the proxies
+            class IGLIBGRAPHICS_EXPORT LightActivation : public LightChangeListener
+            {
+            public:
+                LightActivation();
+                virtual ~LightActivation();
+
+                // Fraction the LOD range and the screen size threshold of an
+                // active light are widened by before it is deactivated
+                void    SetHysteresis(float32 fHysteresis);
+                float32 GetHysteresis(void) const;
+
+                // Diameter in pixels the range of a light has to project to.
+                // Zero turns the test off
+                void    SetMinScreenSize(float32 fPixels);
+                float32 GetMinScreenSize(void) const;
+
+                // Above this the smallest lights on screen are demoted to the
+                // proxies. Zero is no limit
+                void   SetMaxActiveLights(size_t numLights);
+                size_t GetMaxActiveLights(void) const;
+
+                // Above this the dimmest proxies are dropped. Zero turns the proxies off
+                void   SetMaxProxyLights(size_t numLights);
+                size_t GetMaxProxyLights(void) const;
+
+                // Edge of the world grid cells the inactive lights are merged in
+                void    SetProxyCellSize(float64 fSize);
+                float64 GetProxyCellSize(void) const;
+
+                // Fills activeLights with the active ones of the visible lights,
+                // directional lights first, followed by the proxies. The changes
+                // of the proxies are handed to the listeners before it returns
+                void Apply(const Camera_64* pCamera, const Vector2_uint32& viewport, const VectorLights& visibleLights, VectorLights& activeLights);
+
+                // Counts of the last Apply
+                size_t GetNumActiveLights(void) const;
+                size_t GetNumProxyLights(void) const;
+                size_t GetNumMergedLights(void) const;
+
+                void AddChangeListener(LightChangeListener* pListener);
+                void RemoveChangeListener(LightChangeListener* pListener);
+
+                // LightChangeListener
+                virtual void LightsChanged(const LightChanges& changes);
+            private:
+                struct LightState
+                {
+                    // Apply the light was last seen in, the state of a light
+                    // that left the view in between is not kept
+                    uint32 uApplied;
+                    bool   bActive;
+                };
+                typedef boost::unordered_map<const Light*, LightState> LightStates;
+
+                struct CellKey
+                {
+                    int32 x, y, z;
+
+                    bool operator==(const CellKey& rhs) const { return x == rhs.x && y == rhs.y && z == rhs.z; }
+                    friend size_t hash_value(const CellKey& key)
+                    {
+                        size_t seed = 0;
+                        boost::hash_combine(seed, key.x);
+                        boost::hash_combine(seed, key.y);
+                        boost::hash_combine(seed, key.z);
+                        return seed;
+                    }
+                };
+
+                struct ProxyCell
+                {
+                    CellKey    key;
+                    Vector3_64 vWeightedPosition;
+                    Vector3_64 vMin;
+                    Vector3_64 vMax;
+                    float64    fWeight;
+                    float32    fColor[3];
+                    float32    fStartRange;
+                    float32    fEndRange;
+                    uint32     uNumLights;
+                    float64    fPriority;
+                };
+                typedef boost::unordered_map<CellKey, uint32> CellIndices;
+
+                struct ActiveLight
+                {
+                    Light*  pLight;
+                    float64 fScreenSize;
+                };
+
+                struct ScreenSizeGreater;
+                struct PriorityGreater;
+                struct KeyLess;
+
+                float32 m_fHysteresis;
+                float32 m_fMinScreenSize;
+                size_t  m_MaxActiveLights;
+                size_t  m_MaxProxyLights;
+                float64 m_fProxyCellSize;
+
+                LightStates m_States;
+                uint32      m_uApplied;
+
+                std::vector<ActiveLight> m_ActiveLights;
+                std::vector<ProxyCell>   m_Cells;
+                CellIndices              m_CellIndices;
+
+                // Owned, a proxy keeps its light data slot while it lives
+                VectorLights m_Proxies;
+                LightJournal m_ProxyJournal;
+                LightChanges m_ProxyChanges;
+
+                typedef std::vector<LightChangeListener*> LightChangeListeners;
+                LightChangeListeners m_ChangeListeners;
+
+                size_t m_NumActiveLights;
+                size_t m_NumProxyLights;
+                size_t m_NumMergedLights;
+
+                void MergeIntoCell(Light* pLight);
+                void UpdateProxies(const Vector3_64& vEye, VectorLights& activeLights);
+            };
+
+        }
+    }
+}
+
+#pragma warning( pop )
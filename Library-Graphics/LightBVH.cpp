@@ -0,0 +1,779 @@
+/*
+-----------------------------------------------------------------------------
+File:        LightBVH.cpp
+Copyright:   Copyright (C) 2026 Compro Computer Services. All rights reserved.
+Created:     10/19/2026
+Last edit:   10/19/2026
+Author:      Compro Computer Services
+E-mail:      openig@compro.net
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "CommonUtils.h"
+#include "LightBVH.h"
+#include "Light.h"
+#include "Camera.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENIG_LIGHTBVH_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+	const unsigned int s_MaxLeafSize = 4;
+
+	// uCount of the nodes that are not leaves
+	const unsigned int s_InnerNode = 0xFFFFFFFF;
+
+	// Rebuild once this many lights (and at least 1/8 of the tree) were inserted
+	// since the last build. Until then they are tested one by one
+	const size_t s_MinPendingForRebuild = 16;
+
+	// Or once the refits grew the top levels of the tree this much
+	const double s_MaxCostGrowth = 2.0;
+	const int    s_CostDepth = 3;
+
+	// The float boxes and planes are relative to the origin of the tree and
+	// rounded outwards by this much, so the culling stays conservative
+	const float s_RelativeSlop = 1e-6f;
+	const float s_AbsoluteSlop = 1e-4f;
+
+	enum BoxVisibility
+	{
+		BOX_OUTSIDE = 0
+		, BOX_PARTIAL = 1
+		, BOX_INSIDE = 2
+	};
+
+	// The 6 frustum planes in SoA, padded to 8 with planes nothing is outside of
+	struct FrustumPlanes
+	{
+		float nx[8];
+		float ny[8];
+		float nz[8];
+		float ax[8];
+		float ay[8];
+		float az[8];
+		float d[8];
+	};
+
+	BoxVisibility testBox(const FrustumPlanes& planes, const float* vMin, const float* vMax)
+	{
+#if OPENIG_LIGHTBVH_SSE
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 zero = _mm_setzero_ps();
+
+		const __m128 cx = _mm_set1_ps((vMin[0] + vMax[0])*0.5f);
+		const __m128 cy = _mm_set1_ps((vMin[1] + vMax[1])*0.5f);
+		const __m128 cz = _mm_set1_ps((vMin[2] + vMax[2])*0.5f);
+		const __m128 ex = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(vMax[0]), _mm_set1_ps(vMin[0])), half);
+		const __m128 ey = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(vMax[1]), _mm_set1_ps(vMin[1])), half);
+		const __m128 ez = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(vMax[2]), _mm_set1_ps(vMin[2])), half);
+
+		int outside = 0;
+		int partial = 0;
+		for (int i = 0; i < 8; i += 4)
+		{
+			__m128 dist = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(planes.nx + i), cx), _mm_mul_ps(_mm_loadu_ps(planes.ny + i), cy)),
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(planes.nz + i), cz), _mm_loadu_ps(planes.d + i)));
+			__m128 radius = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(planes.ax + i), ex), _mm_mul_ps(_mm_loadu_ps(planes.ay + i), ey)),
+				_mm_mul_ps(_mm_loadu_ps(planes.az + i), ez));
+
+			outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(dist, radius), zero));
+			partial |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(dist, radius), zero));
+		}
+		if (outside) return BOX_OUTSIDE;
+		return partial ? BOX_PARTIAL : BOX_INSIDE;
+#else
+		const float cx = (vMin[0] + vMax[0])*0.5f;
+		const float cy = (vMin[1] + vMax[1])*0.5f;
+		const float cz = (vMin[2] + vMax[2])*0.5f;
+		const float ex = (vMax[0] - vMin[0])*0.5f;
+		const float ey = (vMax[1] - vMin[1])*0.5f;
+		const float ez = (vMax[2] - vMin[2])*0.5f;
+
+		bool partial = false;
+		for (int i = 0; i < 6; ++i)
+		{
+			float dist = planes.nx[i] * cx + planes.ny[i] * cy + planes.nz[i] * cz + planes.d[i];
+			float radius = planes.ax[i] * ex + planes.ay[i] * ey + planes.az[i] * ez;
+			if (dist + radius < 0) return BOX_OUTSIDE;
+			if (dist - radius < 0) partial = true;
+		}
+		return partial ? BOX_PARTIAL : BOX_INSIDE;
+#endif
+	}
+
+	float roundDown(double value)
+	{
+		float f = (float)value;
+		return f - (fabsf(f)*s_RelativeSlop + s_AbsoluteSlop);
+	}
+
+	float roundUp(double value)
+	{
+		float f = (float)value;
+		return f + (fabsf(f)*s_RelativeSlop + s_AbsoluteSlop);
+	}
+
+	bool overlaps(const float* vMinA, const float* vMaxA, const float* vMinB, const float* vMaxB)
+	{
+		return vMinA[0] <= vMaxB[0] && vMaxA[0] >= vMinB[0]
+			&& vMinA[1] <= vMaxB[1] && vMaxA[1] >= vMinB[1]
+			&& vMinA[2] <= vMaxB[2] && vMaxA[2] >= vMinB[2];
+	}
+
+	template<class T>
+	double surfaceArea(const T& box)
+	{
+		double dx = std::max(0.f, box.vMax[0] - box.vMin[0]);
+		double dy = std::max(0.f, box.vMax[1] - box.vMin[1]);
+		double dz = std::max(0.f, box.vMax[2] - box.vMin[2]);
+		return 2.0*(dx*dy + dy*dz + dz*dx);
+	}
+}
+
+namespace OpenIG {
+	namespace Library {
+		namespace Graphics {
+
+			struct LightBVH::ItemCenterLess
+			{
+				ItemCenterLess(const Items& items, size_t axis) : m_Items(items), m_Axis(axis){}
+				bool operator()(uint32 lhs, uint32 rhs) const
+				{
+					// Twice the center, good enough to compare
+					return m_Items[lhs].vMin[m_Axis] + m_Items[lhs].vMax[m_Axis] < m_Items[rhs].vMin[m_Axis] + m_Items[rhs].vMax[m_Axis];
+				}
+				const Items& m_Items;
+				size_t m_Axis;
+			};
+
+			LightBVH::LightBVH()
+				: m_Origin(0, 0, 0)
+				, m_BuiltCost(0)
+				, m_bRebuild(false)
+				, m_NumLights(0)
+			{
+			}
+
+			LightBVH::~LightBVH()
+			{
+			}
+
+			uint32 LightBVH::Insert(Light* pLight)
+			{
+				ASSERT_PREDICATE(pLight);
+
+				uint32 handle = 0;
+				if (m_FreeHandles.empty())
+				{
+					handle = uint32(m_Items.size());
+					m_Items.push_back(Item());
+				}
+				else
+				{
+					handle = m_FreeHandles.back();
+					m_FreeHandles.pop_back();
+				}
+
+				Item& item = m_Items[handle];
+				item.pLight = pLight;
+				item.uPosition = 0;
+				item.uLeaf = InvalidHandle;
+				item.state = ITEM_FREE;
+
+				Attach(handle);
+				++m_NumLights;
+
+				return handle;
+			}
+
+			void LightBVH::Remove(uint32 handle)
+			{
+				ASSERT_PREDICATE_RETURN(handle < m_Items.size() && m_Items[handle].state != ITEM_FREE);
+
+				Detach(handle);
+
+				m_Items[handle].pLight = 0;
+				m_FreeHandles.push_back(handle);
+				--m_NumLights;
+			}
+
+			void LightBVH::Update(uint32 handle)
+			{
+				ASSERT_PREDICATE_RETURN(handle < m_Items.size() && m_Items[handle].state != ITEM_FREE);
+
+				Item& item = m_Items[handle];
+				const AxisAlignedBoundingBox_64& box = item.pLight->_GetWorldAABB();
+				bool bBounded = !box.IsNull() && !box.IsInfinite();
+
+				if (bBounded && item.state == ITEM_TREE)
+				{
+					item.vMin = box.GetMin();
+					item.vMax = box.GetMax();
+					PackBox(handle, m_LeafBoxes[item.uPosition]);
+
+					if (m_LeafDirty[item.uLeaf] == 0)
+					{
+						m_LeafDirty[item.uLeaf] = 1;
+						m_DirtyLeaves.push_back(item.uLeaf);
+					}
+				}
+				else if (bBounded && item.state == ITEM_PENDING)
+				{
+					item.vMin = box.GetMin();
+					item.vMax = box.GetMax();
+				}
+				else
+				{
+					Detach(handle);
+					Attach(handle);
+				}
+			}
+
+			size_t LightBVH::GetNumLights(void) const
+			{
+				return m_NumLights;
+			}
+
+			size_t LightBVH::GetNumNodes(void) const
+			{
+				return m_Nodes.size();
+			}
+
+			void LightBVH::Attach(uint32 handle)
+			{
+				Item& item = m_Items[handle];
+				const AxisAlignedBoundingBox_64& box = item.pLight->_GetWorldAABB();
+
+				if (box.IsNull())
+				{
+					item.state = ITEM_NULL;
+				}
+				else if (box.IsInfinite())
+				{
+					item.state = ITEM_UNBOUNDED;
+					item.uPosition = uint32(m_UnboundedItems.size());
+					m_UnboundedItems.push_back(handle);
+				}
+				else
+				{
+					item.vMin = box.GetMin();
+					item.vMax = box.GetMax();
+					item.state = ITEM_PENDING;
+					item.uPosition = uint32(m_PendingItems.size());
+					m_PendingItems.push_back(handle);
+				}
+			}
+
+			void LightBVH::Detach(uint32 handle)
+			{
+				Item& item = m_Items[handle];
+
+				switch (item.state)
+				{
+				case ITEM_PENDING:
+				case ITEM_UNBOUNDED:
+					{
+						VecUnsignedInt32s& items = item.state == ITEM_PENDING ? m_PendingItems : m_UnboundedItems;
+						uint32 last = items.back();
+						items[item.uPosition] = last;
+						m_Items[last].uPosition = item.uPosition;
+						items.pop_back();
+					}
+					break;
+				case ITEM_TREE:
+					{
+						// Swap with the last light of the leaf
+						Node& leaf = m_Nodes[item.uLeaf];
+						uint32 lastPosition = leaf.uFirst + leaf.uCount - 1;
+						uint32 last = m_LeafItems[lastPosition];
+
+						m_LeafItems[item.uPosition] = last;
+						m_LeafBoxes[item.uPosition] = m_LeafBoxes[lastPosition];
+						m_Items[last].uPosition = item.uPosition;
+						--leaf.uCount;
+
+						if (m_LeafDirty[item.uLeaf] == 0)
+						{
+							m_LeafDirty[item.uLeaf] = 1;
+							m_DirtyLeaves.push_back(item.uLeaf);
+						}
+						item.uLeaf = InvalidHandle;
+					}
+					break;
+				default:
+					break;
+				}
+
+				item.state = ITEM_FREE;
+			}
+
+			void LightBVH::PackBox(uint32 handle, PackedBox& box) const
+			{
+				const Item& item = m_Items[handle];
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					box.vMin[axis] = roundDown(item.vMin[axis] - m_Origin[axis]);
+					box.vMax[axis] = roundUp(item.vMax[axis] - m_Origin[axis]);
+				}
+				box.vMin[3] = box.vMax[3] = 0.f;
+			}
+
+			void LightBVH::Build(void)
+			{
+				m_LeafItems.clear();
+				for (uint32 handle = 0; handle < m_Items.size(); ++handle)
+				{
+					if (m_Items[handle].state == ITEM_TREE || m_Items[handle].state == ITEM_PENDING)
+					{
+						m_LeafItems.push_back(handle);
+					}
+				}
+
+				m_PendingItems.clear();
+				m_Nodes.clear();
+				m_Parents.clear();
+				m_DirtyLeaves.clear();
+				m_bRebuild = false;
+
+				if (m_LeafItems.empty())
+				{
+					m_LeafBoxes.clear();
+					m_LeafDirty.clear();
+					m_BuiltCost = 0;
+					return;
+				}
+
+				Vector3_64 vMin = m_Items[m_LeafItems[0]].vMin;
+				Vector3_64 vMax = m_Items[m_LeafItems[0]].vMax;
+				for (size_t i = 1; i < m_LeafItems.size(); ++i)
+				{
+					const Item& item = m_Items[m_LeafItems[i]];
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						vMin[axis] = std::min(vMin[axis], item.vMin[axis]);
+						vMax[axis] = std::max(vMax[axis], item.vMax[axis]);
+					}
+				}
+				m_Origin = vMin.MidPoint(vMax);
+
+				m_Nodes.reserve(2 * (m_LeafItems.size() / s_MaxLeafSize + 1));
+				m_Parents.reserve(m_Nodes.capacity());
+
+				BuildNode(0, uint32(m_LeafItems.size()), InvalidHandle);
+
+				m_LeafBoxes.resize(m_LeafItems.size());
+				for (uint32 i = 0; i < m_LeafItems.size(); ++i)
+				{
+					Item& item = m_Items[m_LeafItems[i]];
+					item.state = ITEM_TREE;
+					item.uPosition = i;
+					PackBox(m_LeafItems[i], m_LeafBoxes[i]);
+				}
+
+				m_LeafDirty.assign(m_Nodes.size(), 0);
+
+				RefitAll();
+				m_BuiltCost = ComputeTopLevelCost();
+			}
+
+			uint32 LightBVH::BuildNode(uint32 begin, uint32 end, uint32 parent)
+			{
+				uint32 index = uint32(m_Nodes.size());
+				m_Nodes.push_back(Node());
+				m_Parents.push_back(parent);
+
+				if (end - begin <= s_MaxLeafSize)
+				{
+					m_Nodes[index].uFirst = begin;
+					m_Nodes[index].uCount = end - begin;
+					for (uint32 i = begin; i < end; ++i)
+					{
+						m_Items[m_LeafItems[i]].uLeaf = index;
+					}
+					return index;
+				}
+
+				// Median split along the longest axis of the centers
+				Vector3_64 vMin(DBL_MAX, DBL_MAX, DBL_MAX);
+				Vector3_64 vMax(-DBL_MAX, -DBL_MAX, -DBL_MAX);
+				for (uint32 i = begin; i < end; ++i)
+				{
+					const Item& item = m_Items[m_LeafItems[i]];
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						float64 center = (item.vMin[axis] + item.vMax[axis])*0.5;
+						vMin[axis] = std::min(vMin[axis], center);
+						vMax[axis] = std::max(vMax[axis], center);
+					}
+				}
+
+				size_t splitAxis = 0;
+				for (size_t axis = 1; axis < 3; ++axis)
+				{
+					if (vMax[axis] - vMin[axis] > vMax[splitAxis] - vMin[splitAxis])
+					{
+						splitAxis = axis;
+					}
+				}
+
+				uint32 middle = begin + (end - begin) / 2;
+				std::nth_element(m_LeafItems.begin() + begin, m_LeafItems.begin() + middle, m_LeafItems.begin() + end
+					, ItemCenterLess(m_Items, splitAxis));
+
+				BuildNode(begin, middle, index);
+				uint32 right = BuildNode(middle, end, index);
+
+				m_Nodes[index].uFirst = right;
+				m_Nodes[index].uCount = s_InnerNode;
+
+				return index;
+			}
+
+			void LightBVH::RefitLeaf(uint32 node)
+			{
+				Node& leaf = m_Nodes[node];
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					leaf.vMin[axis] = FLT_MAX;
+					leaf.vMax[axis] = -FLT_MAX;
+				}
+				for (uint32 i = leaf.uFirst; i < leaf.uFirst + leaf.uCount; ++i)
+				{
+					const PackedBox& box = m_LeafBoxes[i];
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						leaf.vMin[axis] = std::min(leaf.vMin[axis], box.vMin[axis]);
+						leaf.vMax[axis] = std::max(leaf.vMax[axis], box.vMax[axis]);
+					}
+				}
+			}
+
+			void LightBVH::RefitNode(uint32 node)
+			{
+				const Node& left = m_Nodes[node + 1];
+				const Node& right = m_Nodes[m_Nodes[node].uFirst];
+				Node& inner = m_Nodes[node];
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					inner.vMin[axis] = std::min(left.vMin[axis], right.vMin[axis]);
+					inner.vMax[axis] = std::max(left.vMax[axis], right.vMax[axis]);
+				}
+			}
+
+			void LightBVH::RefitAll(void)
+			{
+				// Children come after their parent, so a reverse sweep sees them first
+				for (size_t i = m_Nodes.size(); i-- > 0;)
+				{
+					if (m_Nodes[i].uCount == s_InnerNode)
+					{
+						RefitNode(uint32(i));
+					}
+					else
+					{
+						RefitLeaf(uint32(i));
+					}
+				}
+			}
+
+			float64 LightBVH::ComputeTopLevelCost(void) const
+			{
+				if (m_Nodes.empty())
+				{
+					return 0;
+				}
+
+				float64 cost = 0;
+
+				uint32 stack[2 << s_CostDepth];
+				int    depths[2 << s_CostDepth];
+				int    top = 0;
+
+				stack[top] = 0; depths[top] = 0; ++top;
+				while (top > 0)
+				{
+					--top;
+					uint32 node = stack[top];
+					int depth = depths[top];
+
+					cost += surfaceArea(m_Nodes[node]);
+
+					if (m_Nodes[node].uCount == s_InnerNode && depth < s_CostDepth)
+					{
+						stack[top] = node + 1; depths[top] = depth + 1; ++top;
+						stack[top] = m_Nodes[node].uFirst; depths[top] = depth + 1; ++top;
+					}
+				}
+				return cost;
+			}
+
+			void LightBVH::Commit(void)
+			{
+				size_t numInTree = m_LeafItems.size();
+				if (m_bRebuild || m_PendingItems.size() >= std::max(s_MinPendingForRebuild, numInTree / 8))
+				{
+					Build();
+					return;
+				}
+
+				if (m_DirtyLeaves.empty())
+				{
+					return;
+				}
+
+				// Walking up from every dirty leaf costs about the depth of the
+				// tree each, past some point one sweep over all nodes is cheaper
+				if (m_DirtyLeaves.size() * 16 > m_Nodes.size())
+				{
+					RefitAll();
+				}
+				else
+				{
+					for (size_t i = 0; i < m_DirtyLeaves.size(); ++i)
+					{
+						uint32 node = m_DirtyLeaves[i];
+						RefitLeaf(node);
+						for (uint32 parent = m_Parents[node]; parent != InvalidHandle; parent = m_Parents[parent])
+						{
+							RefitNode(parent);
+						}
+					}
+				}
+
+				for (size_t i = 0; i < m_DirtyLeaves.size(); ++i)
+				{
+					m_LeafDirty[m_DirtyLeaves[i]] = 0;
+				}
+				m_DirtyLeaves.clear();
+
+				// Lights moved far from where the tree was built for them
+				if (ComputeTopLevelCost() > m_BuiltCost*s_MaxCostGrowth)
+				{
+					Build();
+				}
+			}
+
+			void LightBVH::FindVisibleLights(const Camera_64* pCamera, VectorLights& visibleLights) const
+			{
+				ASSERT_PREDICATE_RETURN(pCamera);
+
+				for (size_t i = 0; i < m_UnboundedItems.size(); ++i)
+				{
+					Light* pLight = m_Items[m_UnboundedItems[i]].pLight;
+					if (pLight->IsOn())
+					{
+						visibleLights.push_back(pLight);
+					}
+				}
+
+				FrustumPlanes planes;
+				for (int i = 0; i < 8; ++i)
+				{
+					bool bSkip = i >= 6 || (i == FRUSTUM_PLANE_FAR && pCamera->GetFarPlane() == 0);
+					if (bSkip)
+					{
+						planes.nx[i] = planes.ny[i] = planes.nz[i] = 0.f;
+						planes.ax[i] = planes.ay[i] = planes.az[i] = 0.f;
+						planes.d[i] = 1.f;
+						continue;
+					}
+
+					const Plane<float64>& plane = pCamera->GetFrustumPlane(FrustumPlane(i));
+					planes.nx[i] = (float)plane.vNormal.x;
+					planes.ny[i] = (float)plane.vNormal.y;
+					planes.nz[i] = (float)plane.vNormal.z;
+					planes.ax[i] = fabsf(planes.nx[i]);
+					planes.ay[i] = fabsf(planes.ny[i]);
+					planes.az[i] = fabsf(planes.nz[i]);
+					// Moving the plane outwards keeps it conservative
+					planes.d[i] = roundUp(plane.d + plane.vNormal.DotProduct(m_Origin));
+				}
+
+				for (size_t i = 0; i < m_PendingItems.size(); ++i)
+				{
+					PackedBox box;
+					PackBox(m_PendingItems[i], box);
+
+					Light* pLight = m_Items[m_PendingItems[i]].pLight;
+					if (pLight->IsOn() && testBox(planes, box.vMin, box.vMax) != BOX_OUTSIDE)
+					{
+						visibleLights.push_back(pLight);
+					}
+				}
+
+				if (m_Nodes.empty())
+				{
+					return;
+				}
+
+				// The top bit marks subtrees that are completely inside
+				const uint32 insideBit = 0x80000000;
+
+				uint32 stack[64];
+				int top = 0;
+				stack[top++] = 0;
+
+				while (top > 0)
+				{
+					uint32 entry = stack[--top];
+					uint32 index = entry & ~insideBit;
+					bool bInside = (entry & insideBit) != 0;
+
+					const Node& node = m_Nodes[index];
+					if (node.uCount == 0)
+					{
+						continue;
+					}
+
+					if (!bInside)
+					{
+						BoxVisibility visibility = testBox(planes, node.vMin, node.vMax);
+						if (visibility == BOX_OUTSIDE)
+						{
+							continue;
+						}
+						bInside = visibility == BOX_INSIDE;
+					}
+
+					if (node.uCount == s_InnerNode)
+					{
+						ASSERT_PREDICATE(top + 2 <= 64);
+						uint32 flag = bInside ? insideBit : 0;
+						stack[top++] = node.uFirst | flag;
+						stack[top++] = (index + 1) | flag;
+						continue;
+					}
+
+					for (uint32 i = node.uFirst; i < node.uFirst + node.uCount; ++i)
+					{
+						Light* pLight = m_Items[m_LeafItems[i]].pLight;
+						if (!pLight->IsOn())
+						{
+							continue;
+						}
+						if (bInside || testBox(planes, m_LeafBoxes[i].vMin, m_LeafBoxes[i].vMax) != BOX_OUTSIDE)
+						{
+							visibleLights.push_back(pLight);
+						}
+					}
+				}
+			}
+
+			void LightBVH::FindLightsIntersecting(const AxisAlignedBoundingBox_64& box, VectorLights& lights) const
+			{
+				for (size_t i = 0; i < m_UnboundedItems.size(); ++i)
+				{
+					Light* pLight = m_Items[m_UnboundedItems[i]].pLight;
+					if (pLight->IsOn())
+					{
+						lights.push_back(pLight);
+					}
+				}
+
+				if (box.IsNull())
+				{
+					return;
+				}
+
+				if (box.IsInfinite())
+				{
+					for (size_t i = 0; i < m_Items.size(); ++i)
+					{
+						const Item& item = m_Items[i];
+						if ((item.state == ITEM_TREE || item.state == ITEM_PENDING) && item.pLight->IsOn())
+						{
+							lights.push_back(item.pLight);
+						}
+					}
+					return;
+				}
+
+				// Rounded outwards like the node boxes, so the test stays conservative
+				float32 vMin[3];
+				float32 vMax[3];
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					vMin[axis] = roundDown(box.GetMin()[axis] - m_Origin[axis]);
+					vMax[axis] = roundUp(box.GetMax()[axis] - m_Origin[axis]);
+				}
+
+				for (size_t i = 0; i < m_PendingItems.size(); ++i)
+				{
+					PackedBox itemBox;
+					PackBox(m_PendingItems[i], itemBox);
+
+					Light* pLight = m_Items[m_PendingItems[i]].pLight;
+					if (pLight->IsOn() && overlaps(vMin, vMax, itemBox.vMin, itemBox.vMax))
+					{
+						lights.push_back(pLight);
+					}
+				}
+
+				if (m_Nodes.empty())
+				{
+					return;
+				}
+
+				uint32 stack[64];
+				int top = 0;
+				stack[top++] = 0;
+
+				while (top > 0)
+				{
+					uint32 index = stack[--top];
+
+					const Node& node = m_Nodes[index];
+					if (node.uCount == 0 || !overlaps(vMin, vMax, node.vMin, node.vMax))
+					{
+						continue;
+					}
+
+					if (node.uCount == s_InnerNode)
+					{
+						ASSERT_PREDICATE(top + 2 <= 64);
+						stack[top++] = node.uFirst;
+						stack[top++] = index + 1;
+						continue;
+					}
+
+					for (uint32 i = node.uFirst; i < node.uFirst + node.uCount; ++i)
+					{
+						Light* pLight = m_Items[m_LeafItems[i]].pLight;
+						if (pLight->IsOn() && overlaps(vMin, vMax, m_LeafBoxes[i].vMin, m_LeafBoxes[i].vMax))
+						{
+							lights.push_back(pLight);
+						}
+					}
+				}
+			}
+
+		}
+	}
+}
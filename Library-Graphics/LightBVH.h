@@ -0,0 +1,163 @@
+/*
+-----------------------------------------------------------------------------
+File:        LightBVH.h
+Copyright:   Copyright (C) 2026 Compro Computer Services. All rights reserved.
+Created:     10/19/2026
+Last edit:   10/19/2026
+Author:      Compro Computer Services
+E-mail:      openig@compro.net
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Graphics/Export.h>
+    #include <OpenIG-Graphics/CommonTypes.h>
+    #include <OpenIG-Graphics/CameraFwdDeclare.h>
+    #include <OpenIG-Graphics/ForwardDeclare.h>
+    #include <OpenIG-Graphics/Vector3.h>
+    #include <OpenIG-Graphics/AxisAlignedBoundingBox.h>
+#else
+    #include <Library-Graphics/Export.h>
+    #include <Library-Graphics/CommonTypes.h>
+    #include <Library-Graphics/CameraFwdDeclare.h>
+    #include <Library-Graphics/ForwardDeclare.h>
+    #include <Library-Graphics/Vector3.h>
+    #include <Library-Graphics/AxisAlignedBoundingBox.h>
+#endif
+
+FORWARD_DECLARE(Light)
+
+namespace OpenIG {
+    namespace Library {
+        namespace Graphics {
+
+            // Bounding volume hierarchy over the light bounds, laid out flat in
+            // depth first order so the left child of a node is the next node.
+            // Lights are referred to by the handle returned from Insert.
+            // Moved lights refit their leaf and its parents, the tree is
+            // rebuilt once enough lights were added or the refits degraded it
+            class IGLIBGRAPHICS_EXPORT LightBVH
+            {
+            public:
+                static const uint32 InvalidHandle = 0xFFFFFFFF;
+
+                LightBVH();
+                virtual ~LightBVH();
+
+                uint32 Insert(Light* pLight);
+                void   Remove(uint32 handle);
+
+                // Picks up the new world AABB of the light
+                void   Update(uint32 handle);
+
+                size_t GetNumLights(void) const;
+                size_t GetNumNodes(void) const;
+
+                // Applies the pending inserts and updates. Call before FindVisibleLights
+                void   Commit(void);
+
+                // Appends the lights that are on and whose bounds intersect the
+                // frustum, unbounded (directional) lights first
+                void   FindVisibleLights(const Camera_64* pCamera, VectorLights& visibleLights) const;
+
+                // Appends the lights that are on and whose bounds overlap the box,
+                // unbounded (directional) lights first
+                void   FindLightsIntersecting(const AxisAlignedBoundingBox_64& box, VectorLights& lights) const;
+            private:
+                // Boxes relative to m_Origin, rounded outwards. For an inner
+                // node uCount is all ones and uFirst the right child, for a
+                // leaf they are the range in m_LeafItems
+                struct Node
+                {
+                    float32 vMin[3];
+                    uint32  uFirst;
+                    float32 vMax[3];
+                    uint32  uCount;
+                };
+
+                struct PackedBox
+                {
+                    float32 vMin[4];
+                    float32 vMax[4];
+                };
+
+                enum ItemState
+                {
+                    ITEM_FREE = 0
+                    , ITEM_NULL
+                    , ITEM_UNBOUNDED
+                    , ITEM_PENDING
+                    , ITEM_TREE
+                };
+
+                struct Item
+                {
+                    Light*    pLight;
+                    Vector3_64 vMin;
+                    Vector3_64 vMax;
+                    // Index in the container of the state
+                    uint32    uPosition;
+                    uint32    uLeaf;
+                    ItemState state;
+                };
+                typedef std::vector<Item> Items;
+
+                struct ItemCenterLess;
+
+                Items             m_Items;
+                VecUnsignedInt32s m_FreeHandles;
+
+                std::vector<Node>      m_Nodes;
+                VecUnsignedInt32s      m_Parents;
+                VecUnsignedInt32s      m_LeafItems;
+                std::vector<PackedBox> m_LeafBoxes;
+
+                VecUnsignedInt32s m_PendingItems;
+                VecUnsignedInt32s m_UnboundedItems;
+
+                VecUnsignedInt32s  m_DirtyLeaves;
+                std::vector<byte>  m_LeafDirty;
+
+                Vector3_64 m_Origin;
+                float64    m_BuiltCost;
+                bool       m_bRebuild;
+                size_t     m_NumLights;
+
+                void Attach(uint32 handle);
+                void Detach(uint32 handle);
+                void ReadBounds(uint32 handle);
+                void PackBox(uint32 handle, PackedBox& box) const;
+
+                void Build(void);
+                uint32 BuildNode(uint32 begin, uint32 end, uint32 parent);
+                void RefitLeaf(uint32 node);
+                void RefitNode(uint32 node);
+                void RefitAll(void);
+                float64 ComputeTopLevelCost(void) const;
+            };
+        }
+    }
+}
+
+#pragma warning(pop)
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "CommonUtils.h"
 #include "VectorUtils.h"
 #include <iostream>
+#include <algorithm>
 
 namespace OpenIG {
 	namespace Library {
@@ -46,37 +47,53 @@ namespace OpenIG {
 				return sizeof(LightDataStruct);
 			}
 
-			void resize(float32*& pData, size_t numOfLights, DataFormat format, size_t& width)
-			{
-				if (pData)
-				{
-					delete[] pData;
-				}
+			// Records closer than this many slots apart are uploaded as one range
+			static const uint32 s_MaxSlotGapInRange = 4;
 
+			void resize(float32*& pData, size_t numOfLights, DataFormat format, size_t& width, size_t numFloatsToKeep = 0)
+			{
 				size_t requiredSizeInBytes = LightDataStruct::GetSizeInBytes()*numOfLights;
 				size_t requiredWidthInRGBAFloatFormat = requiredSizeInBytes / (DataFormatUtils::GetNumComponents(format)*sizeof(float32));
 				width = Math::GetUpperPowerOfTwo((uint32)requiredWidthInRGBAFloatFormat);
 
-				pData = new float32[width*DataFormatUtils::GetNumComponents(format)];
-				if (pData == 0)
+				float32* pNewData = new float32[width*DataFormatUtils::GetNumComponents(format)];
+				if (pNewData == 0)
 				{
 					width = 0;
 				}
+				else if (pData && numFloatsToKeep)
+				{
+					memcpy(pNewData, pData, numFloatsToKeep*sizeof(float32));
+				}
+
+				if (pData)
+				{
+					delete[] pData;
+				}
+				pData = pNewData;
 			}
 
 			LightData::LightData(size_t initalEstimateNumLights, DataFormat format)
 				: m_Format(format)
-				, m_NumPackedLights(0)
 				, m_pData(0)
+				, m_NumSlots(0)
+				, m_vOrigin(Vector3_64::ZERO)
+				, m_OriginEpoch(0)
+				, m_bResized(false)
 			{
 
 				ASSERT_PREDICATE(DataFormatUtils::IsFloatFormat(m_Format));
 				ASSERT_PREDICATE(DataFormatUtils::GetNumComponents(format) == 4);
 
 				resize(m_pData, initalEstimateNumLights, m_Format, m_Width);
+
+				m_SlotDirty.resize(GetNumLightsPackable(), 0);
+				m_SlotOriginEpoch.resize(GetNumLightsPackable(), 0);
 			}
 			LightData::~LightData()
 			{
+				m_LightSlots.clear();
+
 				SAFE_DELETE_ARRAY(m_pData);
 				m_pData = 0;
 			}
@@ -97,10 +114,123 @@ namespace OpenIG {
 
 			int LightData::GetPackedDataSizeInBytes() const
 			{
-				return (int)(m_NumPackedLights*LightDataStruct::GetSizeInBytes());
+				return (int)(m_NumSlots*LightDataStruct::GetSizeInBytes());
+			}
+
+			void LightData::SetOrigin(const Vector3_64& vOrigin)
+			{
+				if (memcmp(m_vOrigin.ptr(), vOrigin.ptr(), sizeof(Vector3_64)) == 0)
+				{
+					return;
+				}
+				m_vOrigin = vOrigin;
+				++m_OriginEpoch;
+			}
+
+			const Vector3_64& LightData::GetOrigin(void) const
+			{
+				return m_vOrigin;
+			}
+
+			const VecInt32s& LightData::GetVisibleSlots(void) const
+			{
+				return m_VisibleSlots;
+			}
+
+			const LightData::DirtyRanges& LightData::GetDirtyRanges(void) const
+			{
+				return m_DirtyRanges;
+			}
+
+			bool LightData::IsResized(void) const
+			{
+				return m_bResized;
+			}
+
+			size_t LightData::GetNumSlots(void) const
+			{
+				return m_NumSlots;
+			}
+
+			void LightData::ReserveSlots(size_t numSlots)
+			{
+				if (numSlots <= GetNumLightsPackable())
+				{
+					return;
+				}
+
+				std::cout << "Number of light slots required (" << numSlots << "), exceeds the capacity of the light data store(" << GetNumLightsPackable() << ")" << std::endl;
+				resize(m_pData, numSlots, m_Format, m_Width, m_NumSlots*LightDataStruct::GetSizeInFloats());
+				std::cout << "Resized Light Data store, num of lights that can be packed: " << GetNumLightsPackable() << std::endl;
+
+				m_SlotDirty.resize(GetNumLightsPackable(), 0);
+				m_SlotOriginEpoch.resize(GetNumLightsPackable(), 0);
+				m_bResized = true;
+			}
+
+			uint32 LightData::AcquireSlot(const Light* pLight)
+			{
+				LightSlots::iterator it = m_LightSlots.find(pLight);
+				if (it != m_LightSlots.end())
+				{
+					return it->second;
+				}
+
+				uint32 slot = 0;
+				if (m_FreeSlots.empty() == false)
+				{
+					slot = m_FreeSlots.back();
+					m_FreeSlots.pop_back();
+				}
+				else
+				{
+					ReserveSlots(m_NumSlots + 1);
+					slot = m_NumSlots++;
+				}
+				m_SlotDirty[slot] = 1;
+				m_LightSlots.insert(std::make_pair(pLight, slot));
+
+				return slot;
+			}
+
+			void LightData::ReleaseSlot(LightSlots::iterator it)
+			{
+				m_FreeSlots.push_back(it->second);
+				m_LightSlots.erase(it);
+			}
+
+			void LightData::LightsChanged(const LightChanges& changes)
+			{
+				if (m_LightSlots.empty())
+				{
+					return;
+				}
+
+				for (LightChanges::const_iterator itChange = changes.begin(); itChange != changes.end(); ++itChange)
+				{
+					if ((itChange->flags & (LCF_DATA | LCF_DESTROYED)) == 0)
+					{
+						continue;
+					}
+
+					LightSlots::iterator it = m_LightSlots.find(itChange->pLight);
+					if (it == m_LightSlots.end())
+					{
+						continue;
+					}
+
+					if (itChange->flags & LCF_DESTROYED)
+					{
+						ReleaseSlot(it);
+					}
+					else
+					{
+						m_SlotDirty[it->second] = 1;
+					}
+				}
 			}
 
-			void LightData::PackLight(size_t offset, const Light* pLight, bool bUseVec1Vec2)
+			void LightData::PackLight(size_t offset, const Light* pLight)
 			{
 				ASSERT_PREDICATE_RETURN(pLight);
 
@@ -114,15 +244,8 @@ namespace OpenIG {
 
 				if (pLight->GetLightType() == LT_POINT || pLight->GetLightType() == LT_SPOT)
 				{
-					if (bUseVec1Vec2)
-					{
-						memcpy(pCurDataPtr, pLight->GetVec1().ptr(), sizeof(float32) * 3); pCurDataPtr += 3;
-					}
-					else
-					{
-						vVec = VectorPrecisionConvert::ToFloat32(pLight->GetPosition());
-						memcpy(pCurDataPtr, vVec.ptr(), sizeof(float32) * 3); pCurDataPtr += 3;
-					}
+					vVec = VectorPrecisionConvert::ToFloat32(pLight->GetPosition() - m_vOrigin);
+					memcpy(pCurDataPtr, vVec.ptr(), sizeof(float32) * 3); pCurDataPtr += 3;
 				}
 				else
 				{
@@ -131,15 +254,8 @@ namespace OpenIG {
 
 				if (pLight->GetLightType() == LT_DIRECTIONAL || pLight->GetLightType() == LT_SPOT)
 				{
-					if (bUseVec1Vec2)
-					{
-						memcpy(pCurDataPtr, pLight->GetVec2().ptr(), sizeof(float32) * 3); pCurDataPtr += 3;
-					}
-					else
-					{
-						vVec = VectorPrecisionConvert::ToFloat32(pLight->GetDirection());
-						memcpy(pCurDataPtr, vVec.ptr(), sizeof(float32) * 3); pCurDataPtr += 3;
-					}
+					vVec = VectorPrecisionConvert::ToFloat32(pLight->GetDirection());
+					memcpy(pCurDataPtr, vVec.ptr(), sizeof(float32) * 3); pCurDataPtr += 3;
 				}
 				else
 				{
@@ -175,38 +291,64 @@ namespace OpenIG {
 
 				// Pack the remaining
 				pLight->GetCustomFloats(fThreeFloats);
-				memcpy(pCurDataPtr, fThreeFloats, sizeof(float32)); pCurDataPtr += 3;
+				memcpy(pCurDataPtr, fThreeFloats, sizeof(float32) * 3); pCurDataPtr += 3;
 			}
 
-			void LightData::PackLights(const VectorLights& lights)
+			void LightData::UpdateLights(const VectorLights& visibleLights)
 			{
 				ASSERT_PREDICATE(DataFormatUtils::IsFloatFormat(m_Format));
 
-				if (lights.size() > GetNumLightsPackable())
+				m_bResized = false;
+				m_DirtyRanges.clear();
+				m_SlotsToPack.clear();
+				m_VisibleSlots.resize(visibleLights.size());
+
+				for (size_t i = 0; i < visibleLights.size(); ++i)
 				{
-					std::cout << "Number of lights to be packed (" << lights.size() << "), exceeds the capacity of the light data store(" << GetNumLightsPackable() << ")" << std::endl;
-					std::cout << "Resizing Light Data store.." << std::endl;
-					resize(m_pData, lights.size(), m_Format, m_Width);
-					std::cout << "Resized Light Data store, done" << std::endl;
-					std::cout << "Num of Lights that can be packed" << std::endl;
-					std::cout << "whilst maintaining power of 2: " << GetNumLightsPackable() << std::endl;
+					const Light* pLight = visibleLights[i];
+
+					uint32 slot = AcquireSlot(pLight);
+					m_VisibleSlots[i] = (int32)slot;
+
+					if (m_SlotDirty[slot] == 0 && m_SlotOriginEpoch[slot] == m_OriginEpoch)
+					{
+						continue;
+					}
+					// Clear before packing, a change journalled meanwhile flags it again
+					m_SlotDirty[slot] = 0;
+					m_SlotOriginEpoch[slot] = m_OriginEpoch;
+
+					PackLight(slot*LightDataStruct::GetSizeInFloats(), pLight);
+					m_SlotsToPack.push_back(slot);
+				}
+
+				if (m_SlotsToPack.empty())
+				{
+					return;
 				}
 
-				size_t maxIndex = GetNumLightsPackable() - 1;
+				// Coalesce the rewritten slots into byte ranges for the upload
+				std::sort(m_SlotsToPack.begin(), m_SlotsToPack.end());
 
-				size_t currLightIndex = 0;
-				m_NumPackedLights = 0;
-				for (VectorLights::const_iterator it = lights.begin(); it != lights.end(); ++it)
+				uint32 first = m_SlotsToPack[0];
+				uint32 last = first;
+				for (size_t i = 1; i <= m_SlotsToPack.size(); ++i)
 				{
-					Light* pLight = *it;
+					if (i < m_SlotsToPack.size() && m_SlotsToPack[i] <= last + s_MaxSlotGapInRange)
+					{
+						last = m_SlotsToPack[i];
+						continue;
+					}
 
-					size_t offset = currLightIndex*LightDataStruct::GetSizeInFloats();
+					DirtyRange range;
+					range.offsetInBytes = first*LightDataStruct::GetSizeInBytes();
+					range.sizeInBytes = (last - first + 1)*LightDataStruct::GetSizeInBytes();
+					m_DirtyRanges.push_back(range);
 
-					PackLight(offset, pLight, true);
-					++m_NumPackedLights;
-					if (currLightIndex == maxIndex)
-						break;
-					++currLightIndex;
+					if (i < m_SlotsToPack.size())
+					{
+						first = last = m_SlotsToPack[i];
+					}
 				}
 			}
 
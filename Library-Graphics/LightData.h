@@ -36,10 +36,14 @@ THE SOFTWARE.
     #include <OpenIG-Graphics/DataFormat.h>
     #include <OpenIG-Graphics/ForwardDeclare.h>
     #include <OpenIG-Graphics/IntSize.h>
+    #include <OpenIG-Graphics/LightJournal.h>
 #else
     #include <Library-Graphics/DataFormat.h>
     #include <Library-Graphics/ForwardDeclare.h>
     #include <Library-Graphics/IntSize.h>
+    #include <Library-Graphics/CommonTypes.h>
+    #include <Library-Graphics/Vector3.h>
+    #include <Library-Graphics/LightJournal.h>
 #endif
 
 FORWARD_DECLARE(Light)
@@ -67,9 +71,22 @@ namespace OpenIG {
                 static size_t GetSizeInBytes(void);
             };
 
-            class IGLIBGRAPHICS_EXPORT LightData
+            // Lights are packed into persistent slots: a light keeps its slot
+            // until it is destroyed and its record is only rewritten when the
+            // light journals a change, or when the origin the positions are
+            // packed relative to moves. The shaders reach the records through
+            // the visible-index to slot indirection. Register the store with
+            // LightManager::AddChangeListener to receive the changes
+            class IGLIBGRAPHICS_EXPORT LightData : public LightChangeListener
             {
             public:
+                struct DirtyRange
+                {
+                    size_t offsetInBytes;
+                    size_t sizeInBytes;
+                };
+                typedef std::vector<DirtyRange> DirtyRanges;
+
                 LightData(size_t initalEstimateNumLights, DataFormat format);
                 virtual ~LightData();
 
@@ -79,18 +96,59 @@ namespace OpenIG {
                 size_t GetWidth(void) const;
                 DataFormat GetFormat(void) const;
 
-                // Pack lights into the grid
-                void PackLights(const VectorLights& lights);
+                // Positions are packed relative to this origin, so they keep
+                // float precision. Moving it invalidates the packed positions,
+                // which are then repacked lazily as the lights become visible
+                void SetOrigin(const Vector3_64& vOrigin);
+                const Vector3_64& GetOrigin(void) const;
+
+                // Assign slots to the visible lights and repack only the records
+                // that changed since they were last packed
+                void UpdateLights(const VectorLights& visibleLights);
+
+                // Slot of each of the lights passed to the last UpdateLights
+                const VecInt32s& GetVisibleSlots(void) const;
+                // Byte ranges of the packed data rewritten by the last UpdateLights
+                const DirtyRanges& GetDirtyRanges(void) const;
+                // True when the store was reallocated and has to be uploaded as a whole
+                bool IsResized(void) const;
+
+                size_t GetNumSlots(void) const;
+
                 // Get the light grid data
                 const float32* GetPackedData(void) const;
                 int            GetPackedDataSizeInBytes(void) const;
+
+                // LightChangeListener
+                virtual void LightsChanged(const LightChanges& changes);
             private:
                 DataFormat m_Format;
                 size_t m_Width;
                 float32* m_pData;
-                int      m_NumPackedLights;
 
-                void PackLight(size_t offset, const Light* pLight, bool bUseVec1Vec2);
+                typedef boost::unordered_map<const Light*, uint32> LightSlots;
+                LightSlots m_LightSlots;
+                VecUnsignedInt32s m_FreeSlots;
+                uint32 m_NumSlots;
+
+                // Per slot state. A slot is repacked when it is visible and either
+                // flagged dirty by the light, or packed against an older origin
+                std::vector<byte> m_SlotDirty;
+                VecUnsignedInt32s m_SlotOriginEpoch;
+
+                Vector3_64 m_vOrigin;
+                uint32 m_OriginEpoch;
+
+                VecInt32s m_VisibleSlots;
+                VecUnsignedInt32s m_SlotsToPack;
+                DirtyRanges m_DirtyRanges;
+                bool m_bResized;
+
+                uint32 AcquireSlot(const Light* pLight);
+                void   ReleaseSlot(LightSlots::iterator it);
+                void   ReserveSlots(size_t numSlots);
+
+                void PackLight(size_t offset, const Light* pLight);
             };
 
         }
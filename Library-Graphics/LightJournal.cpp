@@ -0,0 +1,95 @@
+/*
+-----------------------------------------------------------------------------
+File:        LightJournal.cpp
+Copyright:   Copyright (C) 2026 Compro Computer Services. All rights reserved.
+Created:     10/19/2026
+Last edit:   10/19/2026
+Author:      Compro Computer Services
+E-mail:      openig@compro.net
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "CommonUtils.h"
+#include "LightJournal.h"
+#include "Light.h"
+
+namespace OpenIG {
+	namespace Library {
+		namespace Graphics {
+
+			LightJournal::LightJournal()
+			{
+			}
+			LightJournal::~LightJournal()
+			{
+			}
+
+			void LightJournal::Record(Light* pLight, uint32 flags)
+			{
+				ASSERT_PREDICATE_RETURN(pLight);
+
+				// The entry index of the light is stale after a drain, the light
+				// check tells a live entry from one reused by another light
+				uint32 entry = pLight->_GetJournalEntry();
+				if (entry < m_Changes.size() && m_Changes[entry].pLight == pLight)
+				{
+					if (flags & LCF_DESTROYED)
+					{
+						m_Changes[entry].flags = LCF_DESTROYED;
+					}
+					else
+					{
+						m_Changes[entry].flags |= flags;
+					}
+					return;
+				}
+
+				pLight->_SetJournalEntry(static_cast<uint32>(m_Changes.size()));
+
+				LightChange change;
+				change.pLight = pLight;
+				change.flags = (flags & LCF_DESTROYED) ? uint32(LCF_DESTROYED) : flags;
+				m_Changes.push_back(change);
+			}
+
+			void LightJournal::Drain(LightChanges& changes)
+			{
+				// Swapping keeps the capacity of both vectors, so a steady
+				// number of changes per frame does not allocate
+				changes.clear();
+				changes.swap(m_Changes);
+			}
+
+			bool LightJournal::IsEmpty(void) const
+			{
+				return m_Changes.empty();
+			}
+			size_t LightJournal::GetNumChanges(void) const
+			{
+				return m_Changes.size();
+			}
+			size_t LightJournal::GetCapacity(void) const
+			{
+				return m_Changes.capacity();
+			}
+
+		}
+	}
+}
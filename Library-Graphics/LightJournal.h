@@ -0,0 +1,102 @@
+/*
+-----------------------------------------------------------------------------
+File:        LightJournal.h
+Copyright:   Copyright (C) 2026 Compro Computer Services. All rights reserved.
+Created:     10/19/2026
+Last edit:   10/19/2026
+Author:      Compro Computer Services
+E-mail:      openig@compro.net
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Graphics/Export.h>
+    #include <OpenIG-Graphics/CommonTypes.h>
+    #include <OpenIG-Graphics/ForwardDeclare.h>
+#else
+    #include <Library-Graphics/Export.h>
+    #include <Library-Graphics/CommonTypes.h>
+    #include <Library-Graphics/ForwardDeclare.h>
+#endif
+
+#include <vector>
+
+FORWARD_DECLARE(Light)
+
+namespace OpenIG {
+    namespace Library {
+        namespace Graphics {
+
+            enum LightChangeFlags
+            {
+                // Something that ends up in the packed light data
+                LCF_DATA = 1 << 0
+                // The world bounds
+                , LCF_BOUNDS = 1 << 1
+                // The light is gone, the pointer is only good as a key
+                , LCF_DESTROYED = 1 << 2
+            };
+
+            struct LightChange
+            {
+                const Light* pLight;
+                uint32       flags;
+            };
+            typedef std::vector<LightChange> LightChanges;
+
+            // Per frame list of the lights that changed. A light appends itself
+            // on its first change after a drain and ORs the later ones into its
+            // entry, so a light moved several times per frame is reported once
+            // and the lights carry no per listener state
+            class IGLIBGRAPHICS_EXPORT LightJournal
+            {
+            public:
+                LightJournal();
+                virtual ~LightJournal();
+
+                void Record(Light* pLight, uint32 flags);
+
+                // Hands the recorded changes out in order and empties the journal
+                void Drain(LightChanges& changes);
+
+                bool   IsEmpty(void) const;
+                size_t GetNumChanges(void) const;
+                size_t GetCapacity(void) const;
+
+            private:
+                LightChanges m_Changes;
+            };
+
+            // Receives the drained journal, once per LightManager::Commit
+            class IGLIBGRAPHICS_EXPORT LightChangeListener
+            {
+            public:
+                virtual ~LightChangeListener() {}
+                virtual void LightsChanged(const LightChanges& changes) = 0;
+            };
+        }
+    }
+}
+
+#pragma warning( pop )
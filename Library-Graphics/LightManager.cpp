@@ -30,35 +30,20 @@ THE SOFTWARE.
 #include "STLUtilities.h"
 #include "LightManager.h"
 #include "Light.h"
-#include "Octree.h"
-#include "OctreeNode.h"
 
+#include <algorithm>
 #include <iterator>
 
 namespace OpenIG {
 	namespace Library {
 		namespace Graphics {
 
-			const std::string LightManager::m_StrOctreeNodeKey = "OctreeNode";
-			const std::string LightManager::m_StrLightKey = "Light";
-
-			void LightManager::InitOctree(const AxisAlignedBoundingBox_64& box)
-			{
-				m_Octree->m_Box = box;
-				m_Octree->m_HalfSize = ((box.GetMax() - box.GetMin()))*0.5f;
-			}
-
 			LightManager::LightManager(/*const AxisAlignedBoundingBox_64& box, size_t depth*/)
 				: m_bVectorLightsdirty(false)
 			{
-				// PPP: TO DO
-				m_Octree = 0;
-				//      m_Octree = new Octree<float64>(0, 0, depth);
-				//      InitOctree(box);
 			}
 			LightManager::~LightManager()
 			{
-				SAFE_DELETE(m_Octree);
 				destroy_all_from_list(m_Lights);
 			}
 
@@ -67,16 +52,21 @@ namespace OpenIG {
 				Light* pLight = new Light();
 				pLight->SetLightType(lightType);
 				m_Lights.push_back(pLight);
-				ConnectSignals(pLight);
-				CreateOctreeNode(pLight);
+				pLight->_SetJournal(&m_Journal);
+				pLight->_SetSpatialHandle(m_LightBVH.Insert(pLight));
 				m_bVectorLightsdirty = true;
-				pLight->signal_LightUpdated(pLight);
-				pLight->signal_LightBoundsUpdated(pLight);
+				m_Journal.Record(pLight, LCF_DATA | LCF_BOUNDS);
 
 				return pLight;
 			}
 			void    LightManager::DestroyLight(Light* pLight)
 			{
+				ASSERT_PREDICATE_RETURN(pLight);
+
+				// Out of the hierarchy right away, the queries may run before the
+				// next Commit. The destructor journals the removal for the listeners
+				m_LightBVH.Remove(pLight->_GetSpatialHandle());
+				pLight->_SetSpatialHandle(LightBVH::InvalidHandle);
 				destroy_from_container(m_Lights, pLight);
 				m_bVectorLightsdirty = true;
 			}
@@ -113,70 +103,22 @@ namespace OpenIG {
 				return m_VectorLights;
 			}
 
-			void LightManager::CreateOctreeNode(Light* pLight)
-			{
-				ASSERT_PREDICATE_RETURN(pLight->GetUserObjectBindings().HasKey(m_StrOctreeNodeKey) == false);
-				OctreeNode<float64>* pOctreeNode = new OctreeNode_64();
-				pLight->GetUserObjectBindings().SetUserAny(m_StrOctreeNodeKey, pOctreeNode);
-				// Store a back pointer
-				pOctreeNode->GetUserObjectBindings().SetUserAny(m_StrLightKey, pLight);
-			}
-
-			void LightManager::DestroyOctreeNode(Light* pLight)
-			{
-				OctreeNode<float64>* pOctreeNode = GetOctreeNode(pLight);
-				ASSERT_PREDICATE(pOctreeNode);
-				SAFE_DELETE(pOctreeNode);
-				pLight->GetUserObjectBindings().EraseKey(m_StrOctreeNodeKey);
-			}
-
-			OctreeNode_64* LightManager::GetOctreeNode(const Light* pLight) const
+			void LightManager::AddChangeListener(LightChangeListener* pListener)
 			{
-				ASSERT_PREDICATE_RETURN_ZERO(pLight && pLight->GetUserObjectBindings().HasKey(m_StrOctreeNodeKey) == true);
-				UserObjectBindings& userObjectBindings = const_cast<UserObjectBindings&>(pLight->GetUserObjectBindings());
-				OctreeNode_64* pOctreeNode = boost::any_cast<OctreeNode_64*>(userObjectBindings.GetUserAny(m_StrOctreeNodeKey));
-				ASSERT_PREDICATE(pOctreeNode);
-				return pOctreeNode;
-			}
-
-			void LightManager::LightUpdated(const Light* pLight)
-			{
-				OIG_UNREFERENCED_VARIABLE(pLight);
-			}
-			void LightManager::LightBoundsUpdated(const Light* pLight)
-			{
-				ASSERT_PREDICATE_RETURN(pLight);
-				OctreeNode_64* pOctreeNode = GetOctreeNode(pLight);
-				pOctreeNode->m_WorldAABB = pLight->_GetWorldAABB();
-				if (m_Octree) m_Octree->UpdateOctreeNode(pOctreeNode);
-			}
-			void LightManager::LightDestroyed(const Light* pLight)
-			{
-				ASSERT_PREDICATE_RETURN(pLight);
-				// shutdown condition has m_Octree = 0
-				if (m_Octree)
+				ASSERT_PREDICATE_RETURN(pListener);
+				if (std::find(m_ChangeListeners.begin(), m_ChangeListeners.end(), pListener) == m_ChangeListeners.end())
 				{
-					m_Octree->RemoveOctreeNode(GetOctreeNode(pLight));
+					m_ChangeListeners.push_back(pListener);
 				}
-				DestroyOctreeNode(const_cast<Light*>(pLight));
-				DisconnectSignals(pLight);
 			}
-
-			void LightManager::ConnectSignals(Light* pLight)
+			void LightManager::RemoveChangeListener(LightChangeListener* pListener)
 			{
-				Light* pLightNonConst = const_cast<Light*>(pLight);
-
-				//  pLightNonConst->signal_LightUpdated.connect(boost::bind(&LightManager::LightUpdated, this, _1));
-				pLightNonConst->signal_LightBoundsUpdated.connect(&LightManager::LightBoundsUpdated, this);
-				pLightNonConst->signal_LightDestroyed.connect(&LightManager::LightDestroyed, this);
+				m_ChangeListeners.erase(std::remove(m_ChangeListeners.begin(), m_ChangeListeners.end(), pListener), m_ChangeListeners.end());
 			}
-			void LightManager::DisconnectSignals(const Light* pLight)
-			{
-				Light* pLightNonConst = const_cast<Light*>(pLight);
 
-				//  pLightNonConst->signal_LightUpdated.disconnect(boost::bind(&LightManager::LightUpdated, this, _1));
-				pLightNonConst->signal_LightBoundsUpdated.disconnect(&LightManager::LightBoundsUpdated, this);
-				pLightNonConst->signal_LightDestroyed.disconnect(&LightManager::LightDestroyed, this);
+			const LightJournal& LightManager::GetJournal(void) const
+			{
+				return m_Journal;
 			}
 
 			void LightManager::Update(Camera_64* pCamera)
@@ -189,49 +131,46 @@ namespace OpenIG {
 
 			void LightManager::FindVisibleObjects(Camera_64* pCamera)
 			{
-				m_VisibleOctreeNodes.clear();
-				if (m_Octree) m_Octree->FindVisibleObjects(m_VisibleOctreeNodes, m_Octree, pCamera, false);
-
+				Commit();
 
-				m_DequeLightsScratchPad.clear();
+				// Directional lights come first
+				m_FrustumAffectingLights.clear();
+				FindVisibleLights(pCamera, m_FrustumAffectingLights);
+			}
 
-				// PPP: Fix this
-#if 0
-				BOOST_FOREACH(OctreeNode_64* pOctreeNode, m_VisibleOctreeNodes)
+			void LightManager::Commit(void)
+			{
+				if (m_Journal.IsEmpty() == false)
 				{
-					ASSERT_PREDICATE(pOctreeNode->GetUserObjectBindings().HasKey(m_StrLightKey));
-					Light* pLight = boost::any_cast<Light*>
-						(pOctreeNode->GetUserObjectBindings().GetUserAny(m_StrLightKey));
+					m_Journal.Drain(m_Changes);
 
-					m_DequeLightsScratchPad.push_back(pLight);
-				}
-#endif
-				for (ListLights::const_iterator it = m_Lights.begin(); it != m_Lights.end(); ++it)
-				{
-					Light* pLight = *it;
-					if (pLight->IsOn() == false)
+					for (LightChanges::const_iterator it = m_Changes.begin(); it != m_Changes.end(); ++it)
 					{
-						continue;
+						// Destroyed lights already left the hierarchy in DestroyLight
+						if ((it->flags & (LCF_BOUNDS | LCF_DESTROYED)) == LCF_BOUNDS)
+						{
+							m_LightBVH.Update(it->pLight->_GetSpatialHandle());
+						}
 					}
 
-					if (pCamera->IsVisible(pLight->_GetWorldAABB()))
+					for (LightChangeListeners::iterator it = m_ChangeListeners.begin(); it != m_ChangeListeners.end(); ++it)
 					{
-						if (pLight->GetLightType()==LT_DIRECTIONAL)
-						{
-							m_DequeLightsScratchPad.push_front(pLight);
-						}
-						else
-						{
-							m_DequeLightsScratchPad.push_back(pLight);
-						}	
+						(*it)->LightsChanged(m_Changes);
 					}
 				}
 
-				m_FrustumAffectingLights.clear();
-				for(unsigned int i = 0; i < m_DequeLightsScratchPad.size(); ++i)
-				{
-					m_FrustumAffectingLights.push_back(m_DequeLightsScratchPad[i]);
-				}
+				m_LightBVH.Commit();
+			}
+
+			void LightManager::FindVisibleLights(const Camera_64* pCamera, VectorLights& visibleLights) const
+			{
+				ASSERT_PREDICATE_RETURN(pCamera);
+				m_LightBVH.FindVisibleLights(pCamera, visibleLights);
+			}
+
+			void LightManager::FindLightsAffecting(const AxisAlignedBoundingBox_64& box, VectorLights& lights) const
+			{
+				m_LightBVH.FindLightsIntersecting(box, lights);
 			}
 
 			const VectorLights& LightManager::GetFrustumAffectingLights(void) const
@@ -33,19 +33,17 @@ THE SOFTWARE.
     #include <OpenIG-Graphics/ForwardDeclare.h>
     #include <OpenIG-Graphics/AxisAlignedBoundingBox.h>
     #include <OpenIG-Graphics/Light.h>
-    #include <OpenIG-Graphics/OctreeFwdDeclare.h>
-    #include <OpenIG-Graphics/OctreeNodeFwdDeclare.h>
     #include <OpenIG-Graphics/CameraFwdDeclare.h>
-    #include <OpenIG-Graphics/Octree.h>
+    #include <OpenIG-Graphics/LightBVH.h>
+    #include <OpenIG-Graphics/LightJournal.h>
 #else
     #include <Library-Graphics/Export.h>
     #include <Library-Graphics/ForwardDeclare.h>
     #include <Library-Graphics/AxisAlignedBoundingBox.h>
     #include <Library-Graphics/Light.h>
-    #include <Library-Graphics/OctreeFwdDeclare.h>
-    #include <Library-Graphics/OctreeNodeFwdDeclare.h>
     #include <Library-Graphics/CameraFwdDeclare.h>
-    #include <Library-Graphics/Octree.h>
+    #include <Library-Graphics/LightBVH.h>
+    #include <Library-Graphics/LightJournal.h>
 #endif
 
 namespace OpenIG {
@@ -69,6 +67,26 @@ namespace OpenIG {
                 // Call this before calling either of the 2 queries below
                 void Update(Camera_64* pCamera);
 
+                // Drains the light change journal: refits the moved lights in the
+                // shared light structure and hands the changes to the listeners.
+                // Call once per frame before FindVisibleLights
+                void Commit(void);
+
+                // The listeners see every change recorded since the previous Commit,
+                // including the destruction of the lights they keep state for
+                void AddChangeListener(LightChangeListener* pListener);
+                void RemoveChangeListener(LightChangeListener* pListener);
+
+                const LightJournal& GetJournal(void) const;
+
+                // Get the lights affecting the camera frustum. Only reads the shared
+                // light structure, so several views can query it in parallel after Commit
+                void FindVisibleLights(const Camera_64* pCamera, VectorLights& visibleLights) const;
+
+                // Get the lights whose range reaches into the box, for assigning
+                // lights to objects. Same threading rules as FindVisibleLights
+                void FindLightsAffecting(const AxisAlignedBoundingBox_64& box, VectorLights& lights) const;
+
                 // Get all the lights that affect the view frustum. Must be called after LightManager::Update
                 const VectorLights& GetFrustumAffectingLights(void) const;
             protected:
@@ -78,27 +96,16 @@ namespace OpenIG {
                 mutable bool m_bVectorLightsdirty;
                 mutable VectorLights m_VectorLights;
 
-                Octree_64* m_Octree;
-                void InitOctree(const AxisAlignedBoundingBox_64& box);
-
-                void LightUpdated(const Light* pLight);
-                void LightBoundsUpdated(const Light* pLight);
-                void LightDestroyed(const Light* pLight);
-
-                void ConnectSignals(Light* pSceneNode);
-                void DisconnectSignals(const Light* pLight);
+                LightBVH m_LightBVH;
 
-                void CreateOctreeNode(Light* pLight);
-                void DestroyOctreeNode(Light* pLight);
-                OctreeNode_64* GetOctreeNode(const Light* pLight) const;
+                LightJournal m_Journal;
+                LightChanges m_Changes;
 
-                static const std::string m_StrOctreeNodeKey;
-                static const std::string m_StrLightKey;
+                typedef std::vector<LightChangeListener*> LightChangeListeners;
+                LightChangeListeners m_ChangeListeners;
 
                 void FindVisibleObjects(Camera_64* pCamera);
-                Octree_64::NodeList m_VisibleOctreeNodes;
                 VectorLights m_FrustumAffectingLights;
-                DequeLights m_DequeLightsScratchPad;
 
                 VectorLights m_FrustumAffectingLightsSortingScratchPad;
             };
@@ -32,40 +32,342 @@ THE SOFTWARE.
 #include "Light.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+#include <boost/bind.hpp>
+
+#if TBB_FOUND
+#include "TBBFunctional.h"
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENIG_LIGHTGRID_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	// The binning is split in at most this many chunks of at least this many lights.
+	// Every chunk has its own tile histogram
+	const size_t s_MinLightsPerChunk = 128;
+	const size_t s_MaxChunks = 32;
+
+	// Spheres with a corner at or behind this clip w cross the near plane,
+	// the ones with all corners behind it are behind the eye
+	const float s_MinClipW = 1e-4f;
+
+#if TBB_FOUND
+	void tbbParallelFor(size_t count, const OpenIG::Library::Graphics::TileSpaceLightGrid::RangeFunc& func)
+	{
+		TBBFunctional::Func f = func;
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, count), TBBFunctional(f));
+	}
+#endif
+
+	// Screen rectangles of 4 view space spheres. The box around every sphere
+	// is projected with the rows 0, 1 and 3 of the projection matrix. Spheres
+	// crossing the near plane cover the whole viewport, spheres behind the eye
+	// get an empty rectangle
+	void projectSpheres(const float proj[12], const float cx[4], const float cy[4], const float cz[4], const float r[4]
+		, float viewportX, float viewportY, int minX[4], int minY[4], int maxX[4], int maxY[4])
+	{
+#if OPENIG_LIGHTGRID_SSE
+		const __m128 x0 = _mm_loadu_ps(cx);
+		const __m128 y0 = _mm_loadu_ps(cy);
+		const __m128 z0 = _mm_loadu_ps(cz);
+		const __m128 rr = _mm_loadu_ps(r);
+
+		__m128 ndcMinX = _mm_set1_ps(FLT_MAX);
+		__m128 ndcMinY = _mm_set1_ps(FLT_MAX);
+		__m128 ndcMaxX = _mm_set1_ps(-FLT_MAX);
+		__m128 ndcMaxY = _mm_set1_ps(-FLT_MAX);
+		__m128 minW = _mm_set1_ps(FLT_MAX);
+		__m128 maxW = _mm_set1_ps(-FLT_MAX);
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const __m128 x = (corner & 1) ? _mm_add_ps(x0, rr) : _mm_sub_ps(x0, rr);
+			const __m128 y = (corner & 2) ? _mm_add_ps(y0, rr) : _mm_sub_ps(y0, rr);
+			const __m128 z = (corner & 4) ? _mm_add_ps(z0, rr) : _mm_sub_ps(z0, rr);
+
+			__m128 clipX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), x), _mm_mul_ps(_mm_set1_ps(proj[1]), y))
+				, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), z), _mm_set1_ps(proj[3])));
+			__m128 clipY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), x), _mm_mul_ps(_mm_set1_ps(proj[5]), y))
+				, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[6]), z), _mm_set1_ps(proj[7])));
+			__m128 clipW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[8]), x), _mm_mul_ps(_mm_set1_ps(proj[9]), y))
+				, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[10]), z), _mm_set1_ps(proj[11])));
+
+			minW = _mm_min_ps(minW, clipW);
+			maxW = _mm_max_ps(maxW, clipW);
+
+			// Lanes with w <= 0 are garbage here and get replaced below
+			__m128 invW = _mm_div_ps(_mm_set1_ps(1.f), _mm_max_ps(clipW, _mm_set1_ps(s_MinClipW)));
+			clipX = _mm_mul_ps(clipX, invW);
+			clipY = _mm_mul_ps(clipY, invW);
+
+			ndcMinX = _mm_min_ps(ndcMinX, clipX);
+			ndcMinY = _mm_min_ps(ndcMinY, clipY);
+			ndcMaxX = _mm_max_ps(ndcMaxX, clipX);
+			ndcMaxY = _mm_max_ps(ndcMaxY, clipY);
+		}
+
+		const __m128 minusOne = _mm_set1_ps(-1.f);
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 inFront = _mm_cmpgt_ps(minW, _mm_set1_ps(s_MinClipW));
+		const __m128 behind = _mm_cmple_ps(maxW, _mm_set1_ps(s_MinClipW));
+		const __m128 maxFallback = _mm_or_ps(_mm_and_ps(behind, minusOne), _mm_andnot_ps(behind, one));
+
+		ndcMinX = _mm_or_ps(_mm_and_ps(inFront, _mm_min_ps(_mm_max_ps(ndcMinX, minusOne), one)), _mm_andnot_ps(inFront, minusOne));
+		ndcMinY = _mm_or_ps(_mm_and_ps(inFront, _mm_min_ps(_mm_max_ps(ndcMinY, minusOne), one)), _mm_andnot_ps(inFront, minusOne));
+		ndcMaxX = _mm_or_ps(_mm_and_ps(inFront, _mm_min_ps(_mm_max_ps(ndcMaxX, minusOne), one)), _mm_andnot_ps(inFront, maxFallback));
+		ndcMaxY = _mm_or_ps(_mm_and_ps(inFront, _mm_min_ps(_mm_max_ps(ndcMaxY, minusOne), one)), _mm_andnot_ps(inFront, maxFallback));
+
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 vpX = _mm_set1_ps(viewportX);
+		const __m128 vpY = _mm_set1_ps(viewportY);
+
+		_mm_storeu_si128((__m128i*)minX, _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ndcMinX, half), half), vpX)));
+		_mm_storeu_si128((__m128i*)minY, _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ndcMinY, half), half), vpY)));
+		_mm_storeu_si128((__m128i*)maxX, _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ndcMaxX, half), half), vpX)));
+		_mm_storeu_si128((__m128i*)maxY, _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ndcMaxY, half), half), vpY)));
+#else
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			float ndcMinX = FLT_MAX, ndcMinY = FLT_MAX;
+			float ndcMaxX = -FLT_MAX, ndcMaxY = -FLT_MAX;
+			float minW = FLT_MAX;
+			float maxW = -FLT_MAX;
+
+			for (int corner = 0; corner < 8; ++corner)
+			{
+				const float x = (corner & 1) ? cx[lane] + r[lane] : cx[lane] - r[lane];
+				const float y = (corner & 2) ? cy[lane] + r[lane] : cy[lane] - r[lane];
+				const float z = (corner & 4) ? cz[lane] + r[lane] : cz[lane] - r[lane];
+
+				const float clipX = proj[0] * x + proj[1] * y + proj[2] * z + proj[3];
+				const float clipY = proj[4] * x + proj[5] * y + proj[6] * z + proj[7];
+				const float clipW = proj[8] * x + proj[9] * y + proj[10] * z + proj[11];
+
+				minW = std::min(minW, clipW);
+				maxW = std::max(maxW, clipW);
+				if (clipW <= s_MinClipW)
+				{
+					continue;
+				}
+
+				ndcMinX = std::min(ndcMinX, clipX / clipW);
+				ndcMinY = std::min(ndcMinY, clipY / clipW);
+				ndcMaxX = std::max(ndcMaxX, clipX / clipW);
+				ndcMaxY = std::max(ndcMaxY, clipY / clipW);
+			}
+
+			if (maxW <= s_MinClipW)
+			{
+				ndcMinX = ndcMinY = ndcMaxX = ndcMaxY = -1.f;
+			}
+			else if (minW <= s_MinClipW)
+			{
+				ndcMinX = ndcMinY = -1.f;
+				ndcMaxX = ndcMaxY = 1.f;
+			}
+
+			minX[lane] = (int)((std::min(std::max(ndcMinX, -1.f), 1.f)*0.5f + 0.5f)*viewportX);
+			minY[lane] = (int)((std::min(std::max(ndcMinY, -1.f), 1.f)*0.5f + 0.5f)*viewportY);
+			maxX[lane] = (int)((std::min(std::max(ndcMaxX, -1.f), 1.f)*0.5f + 0.5f)*viewportX);
+			maxY[lane] = (int)((std::min(std::max(ndcMaxY, -1.f), 1.f)*0.5f + 0.5f)*viewportY);
+		}
+#endif
+	}
+}
 
 namespace OpenIG {
 	namespace Library {
 		namespace Graphics {
 
 			TileSpaceLightGrid::TileSpaceLightGrid(const Vector2_uint32& tileSize)
-				: m_ScreenSpaceRejectArea(Vector2_uint32::ZERO)
-				, m_TileSize(tileSize)
-				, m_GridOffsetsAndSizeWidth(0)
-				, m_GridCounts(0)
+				: m_pLights(0)
+				, m_pCamera(0)
+				, m_NumChunks(0)
+				, m_LightsPerChunk(s_MinLightsPerChunk)
 				, m_GridOffsets(0)
+				, m_GridCounts(0)
 				, m_pGridOffsetsAndSizesData(0)
+				, m_GridOffsetsAndSizeWidth(0)
+				, m_ScreenSpaceRejectArea(Vector2_uint32::ZERO)
+				, m_TileSize(tileSize)
 			{
-
+#if TBB_FOUND
+				m_ParallelFor = &tbbParallelFor;
+#endif
 			}
 			TileSpaceLightGrid::~TileSpaceLightGrid()
 			{
 				TearDownGridOffsetsAndCounts();
 			}
 
-			void TileSpaceLightGrid::UpdateScreenSpaceRectangles(const VectorLights& frustumVisibleLights, const Camera_64* pCamera, const Vector2_uint32& viewportSize, const Vector2_uint32& tileSize)
+			void TileSpaceLightGrid::SetParallelFor(const ParallelForFunc& parallelFor)
+			{
+				m_ParallelFor = parallelFor;
+			}
+
+			void TileSpaceLightGrid::RunParallel(size_t count, const RangeFunc& func)
+			{
+				if (m_ParallelFor && count > 1)
+				{
+					m_ParallelFor(count, func);
+				}
+				else
+				{
+					func(0, count);
+				}
+			}
+
+			void TileSpaceLightGrid::GetChunkLights(size_t chunk, size_t& first, size_t& count) const
+			{
+				first = chunk*m_LightsPerChunk;
+				count = std::min(m_LightsPerChunk, m_pLights->size() - first);
+			}
+
+			void TileSpaceLightGrid::ProjectLights(size_t first, size_t count)
+			{
+				const VectorLights& lights = *m_pLights;
+				const Matrix4_64& view = m_pCamera->GetViewMatrix();
+				const Matrix4_64& projection = m_pCamera->GetProjectionMatrix();
+
+				// Rows 0, 1 and 3, enough for the window coordinates
+				float proj[12];
+				for (int column = 0; column < 4; ++column)
+				{
+					proj[column] = (float)projection[0][column];
+					proj[4 + column] = (float)projection[1][column];
+					proj[8 + column] = (float)projection[3][column];
+				}
+
+				for (size_t i = first; i < first + count; i += 4)
+				{
+					size_t numInGroup = std::min(size_t(4), first + count - i);
+
+					float cx[4] = { 0, 0, 0, 0 };
+					float cy[4] = { 0, 0, 0, 0 };
+					float cz[4] = { -1, -1, -1, -1 };
+					float r[4] = { 0, 0, 0, 0 };
+					bool project[4] = { false, false, false, false };
+
+					for (size_t k = 0; k < numInGroup; ++k)
+					{
+						const AxisAlignedBoundingBox_64& box = lights[i + k]->_GetWorldAABB();
+						ScreenRect& rect = m_ScreenRects[i + k];
+
+						if (box.IsInfinite())
+						{
+							rect.vMin = Vector2_uint32::ZERO;
+							rect.vMax = m_ViewportSize;
+							continue;
+						}
+						if (box.IsNull())
+						{
+							rect.vMin = Vector2_uint32::ZERO;
+							rect.vMax = Vector2_uint32::ZERO;
+							continue;
+						}
+
+						// The view transform is done in double precision,
+						// what is left is small enough for floats
+						Vector4_64 center = view*Vector4_64(box.GetCenter(), 1);
+						Vector3_64 halfSize = box.GetHalfSize();
+
+						cx[k] = (float)center.x;
+						cy[k] = (float)center.y;
+						cz[k] = (float)center.z;
+						r[k] = (float)std::max(halfSize.x, std::max(halfSize.y, halfSize.z));
+						project[k] = true;
+					}
+
+					int32 minX[4], minY[4], maxX[4], maxY[4];
+					projectSpheres(proj, cx, cy, cz, r, (float)m_ViewportSize.x, (float)m_ViewportSize.y, minX, minY, maxX, maxY);
+
+					for (size_t k = 0; k < numInGroup; ++k)
+					{
+						if (project[k] == false)
+						{
+							continue;
+						}
+						ScreenRect& rect = m_ScreenRects[i + k];
+						rect.vMin = Vector2_uint32((uint32)minX[k], (uint32)minY[k]);
+						rect.vMax = Vector2_uint32((uint32)maxX[k], (uint32)maxY[k]);
+					}
+				}
+			}
+
+			void TileSpaceLightGrid::ProjectAndCountChunks(size_t firstChunk, size_t numChunks)
 			{
-				OIG_UNREFERENCED_VARIABLE(tileSize);
-				m_ViewSpaceLights.clear();
-				m_ScreenRects.clear();
+				const size_t numTiles = m_TileGridMaxDims.x*m_TileGridMaxDims.y;
 
-				for (uint32 i = 0; i < frustumVisibleLights.size(); ++i)
+				for (size_t chunk = firstChunk; chunk < firstChunk + numChunks; ++chunk)
 				{
-					const Light* pLight = frustumVisibleLights[i];
-					ScreenRect rect = pCamera->GetScreenAABB(pLight->_GetWorldAABB(), viewportSize);
-					ASSERT_PREDICATE(rect.vMin.x <= rect.vMax.x && rect.vMin.y <= rect.vMax.y);
-					m_ScreenRects.push_back(rect);
-					// save light in model space
-					m_ViewSpaceLights.push_back(pLight);
+					size_t first = 0;
+					size_t count = 0;
+					GetChunkLights(chunk, first, count);
+
+					ProjectLights(first, count);
+
+					int32* tileCounts = &m_ChunkTileCounts[chunk*numTiles];
+					memset(tileCounts, 0, numTiles*sizeof(int32));
+
+					for (size_t i = first; i < first + count; ++i)
+					{
+						const ScreenRect& rect = m_ScreenRects[i];
+						ScreenRect& tileRect = m_TileRects[i];
+
+						if (rect.width() < m_ScreenSpaceRejectArea.x && rect.height() < m_ScreenSpaceRejectArea.y)
+						{
+							tileRect.vMin = tileRect.vMax = Vector2_uint32::ZERO;
+							continue;
+						}
+
+						tileRect.vMin = Math::Clamp(rect.vMin / m_TileSize, Vector2_uint32::ZERO, m_TileGridMaxDims);
+						tileRect.vMax = Math::Clamp((rect.vMax + m_TileSize - 1) / m_TileSize, Vector2_uint32::ZERO, m_TileGridMaxDims);
+
+						for (uint32 y = tileRect.vMin.y; y < tileRect.vMax.y; ++y)
+						{
+							int32* row = tileCounts + y*m_TileGridMaxDims.x;
+							for (uint32 x = tileRect.vMin.x; x < tileRect.vMax.x; ++x)
+							{
+								++row[x];
+							}
+						}
+					}
+				}
+			}
+
+			void TileSpaceLightGrid::ScatterChunks(size_t firstChunk, size_t numChunks)
+			{
+				const size_t numTiles = m_TileGridMaxDims.x*m_TileGridMaxDims.y;
+				int32* data = &m_TileLightIndexLists[0];
+
+				for (size_t chunk = firstChunk; chunk < firstChunk + numChunks; ++chunk)
+				{
+					size_t first = 0;
+					size_t count = 0;
+					GetChunkLights(chunk, first, count);
+
+					// Every chunk writes through its own offsets, no two chunks share a slot
+					int32* tileOffsets = &m_ChunkTileCounts[chunk*numTiles];
+
+					for (size_t i = first + count; i-- > first;)
+					{
+						const ScreenRect& tileRect = m_TileRects[i];
+						for (uint32 y = tileRect.vMin.y; y < tileRect.vMax.y; ++y)
+						{
+							int32* row = tileOffsets + y*m_TileGridMaxDims.x;
+							for (uint32 x = tileRect.vMin.x; x < tileRect.vMax.x; ++x)
+							{
+								data[row[x]++] = int32(i);
+							}
+						}
+					}
 				}
 			}
 
@@ -124,139 +426,72 @@ namespace OpenIG {
 
 			void TileSpaceLightGrid::Update(const VectorLights& frustumVisibleLights, const Camera_64* pCamera, const Vector2_uint32& viewportSize)
 			{
-#if 0
-				m_gridMinMaxZ = gridMinMaxZ;
-				m_minMaxGridValid = !gridMinMaxZ.empty();
+				m_TileGridMaxDims = ComputeGridMaxDims(viewportSize);
 
-				const float2 *gridMinMaxZPtr = m_minMaxGridValid ? &m_gridMinMaxZ[0] : 0;
-#endif
+				ResizeGridOffsetsAndCountsIfNecessary(m_TileGridMaxDims);
 
-				Vector2_uint32 tileGridMaxDims = ComputeGridMaxDims(viewportSize);
+				m_pLights = &frustumVisibleLights;
+				m_pCamera = pCamera;
+				m_ViewportSize = viewportSize;
+				m_MaxTileLightCount = 0;
 
-				ResizeGridOffsetsAndCountsIfNecessary(tileGridMaxDims);
+				const size_t numLights = frustumVisibleLights.size();
+				const size_t numTiles = m_TileGridMaxDims.x*m_TileGridMaxDims.y;
 
-				m_MaxTileLightCount = 0;
+				m_ScreenRects.resize(numLights);
+				m_TileRects.resize(numLights);
 
-				UpdateScreenSpaceRectangles(frustumVisibleLights, pCamera, viewportSize, m_TileSize);
+				m_LightsPerChunk = std::max(s_MinLightsPerChunk, (numLights + s_MaxChunks - 1) / s_MaxChunks);
+				m_NumChunks = (numLights + m_LightsPerChunk - 1) / m_LightsPerChunk;
+				m_ChunkTileCounts.resize(m_NumChunks*numTiles);
+
+				// First pass, per chunk tile histograms
+				RunParallel(m_NumChunks, boost::bind(&TileSpaceLightGrid::ProjectAndCountChunks, this, _1, _2));
 
 				memset(m_GridOffsets, 0, m_GridOffsetsAndSizeWidth*sizeof(int32));
 				memset(m_GridCounts, 0, m_GridOffsetsAndSizeWidth*sizeof(int32));
 
-				// For each light find whether its spans a tile
-				// Update grid count if so
-				int totalus = 0;
+				// Prefix sum over the tiles. The chunks are laid out last to first,
+				// and lights are scattered in reverse, so every tile lists its
+				// lights by descending index as the serial fill did
+				int32 offset = 0;
+				for (size_t tile = 0; tile < numTiles; ++tile)
 				{
-					for (size_t i = 0; i < m_ScreenRects.size(); ++i)
+					int32 tileStart = offset;
+					for (size_t chunk = m_NumChunks; chunk-- > 0;)
 					{
-						const ScreenRect& rect = m_ScreenRects[i];
-
-						if (rect.width() < m_ScreenSpaceRejectArea.x && rect.height() < m_ScreenSpaceRejectArea.y)
-						{
-							continue;
-						}
-#if 0
-						Light* light = m_viewSpaceLights[i];
-#endif
-						Vector2_uint32 tileLowerBound = Math::Clamp(rect.vMin / m_TileSize, Vector2_uint32::ZERO, tileGridMaxDims + 1);
-						Vector2_uint32 tileUpperBound = Math::Clamp((rect.vMax + m_TileSize - 1) / m_TileSize, Vector2_uint32::ZERO, tileGridMaxDims + 1);
-
-						for (uint32 y = tileLowerBound.y; y < tileUpperBound.y; ++y)
-						{
-							for (uint32 x = tileLowerBound.x; x < tileUpperBound.x; ++x)
-							{
-#if 0
-								if (!m_minMaxGridValid || testDepthBounds(gridMinMaxZPtr[y * m_gridDim.x + x], light))
-#endif
-								{
-									GridCount(x, y, tileGridMaxDims) += 1;
-									++totalus;
-								}
-							}
-						}
+						int32& chunkCount = m_ChunkTileCounts[chunk*numTiles + tile];
+						int32 count = chunkCount;
+						chunkCount = offset;
+						offset += count;
 					}
-				}
-				m_TileLightIndexLists.resize(totalus);
-#ifdef _DEBUG
-				if (!m_TileLightIndexLists.empty())
-				{
-					memset(&m_TileLightIndexLists[0], 0, m_TileLightIndexLists.size() * sizeof(m_TileLightIndexLists[0]));
-				}
-#endif // _DEBUG
 
-				// For each grid find out what its grid count is
-				// and update grid offset for that tile
-				uint32 offset = 0;
-				{
-					for (uint32 y = 0; y < tileGridMaxDims.y; ++y)
-					{
-						for (uint32 x = 0; x < tileGridMaxDims.x; ++x)
-						{
-							uint32 count = GridCount(x, y, tileGridMaxDims);
-							// set offset to be just past end, then decrement while filling in
-							GridOffset(x, y, tileGridMaxDims) = offset + count;
-							offset += count;
+					uint32 count = uint32(offset - tileStart);
+					m_GridCounts[tile] = int32(count);
+					m_GridOffsets[tile] = tileStart;
 
-							// for debug/profiling etc.
-							m_MaxTileLightCount = std::max(m_MaxTileLightCount, count);
-						}
-					}
+					// for debug/profiling etc.
+					m_MaxTileLightCount = std::max(m_MaxTileLightCount, count);
 				}
 
-				bool ok = m_ScreenRects.size() && !m_TileLightIndexLists.empty();
-				if (!ok)
-					return;
-
-				// Update the tile light index list
-				int *data = &m_TileLightIndexLists[0];
+				m_TileLightIndexLists.resize(offset);
 
-				// For each light
-				for (size_t i = 0; i < m_ScreenRects.size(); ++i)
+				// Second pass, scatter the light indices
+				if (offset > 0)
 				{
-					const ScreenRect& rect = m_ScreenRects[i];
-
-					if (rect.width() < m_ScreenSpaceRejectArea.x && rect.height() < m_ScreenSpaceRejectArea.y)
-					{
-						continue;
-					}
-
-					Vector2_uint32 tileLowerBound = Math::Clamp(rect.vMin / m_TileSize, Vector2_uint32::ZERO, tileGridMaxDims + 1);
-					Vector2_uint32 tileUpperBound = Math::Clamp((rect.vMax + m_TileSize - 1) / m_TileSize, Vector2_uint32::ZERO, tileGridMaxDims + 1);
-
-					// For all the tiles it spans
-					for (uint32 y = tileLowerBound.y; y < tileUpperBound.y; ++y)
-					{
-						for (uint32 x = tileLowerBound.x; x < tileUpperBound.x; ++x)
-						{
-#if 0
-							Light* light = m_viewSpaceLights[i];
-							if (!m_minMaxGridValid || testDepthBounds(gridMinMaxZPtr[y * m_gridDim.x + x], light))
-#endif
-							{
-								// store reversely into next free slot
-								uint32 offset = GridOffset(x, y, tileGridMaxDims) - 1;
-								uint32 lightId = uint32(i);
-								data[offset] = lightId;
-								GridOffset(x, y, tileGridMaxDims) = offset;
-							}
-						}
-					}
+					RunParallel(m_NumChunks, boost::bind(&TileSpaceLightGrid::ScatterChunks, this, _1, _2));
 				}
 
-				const int32 *counts = GetTileCountsDataPtr();
-				const int32 *offsets = GetTileDataPtr();
-
-				memset(m_pGridOffsetsAndSizesData, GetTileGridOffsetAndSizeSizeInBytes(), 0);
+				memset(m_pGridOffsetsAndSizesData, 0, GetTileGridOffsetAndSizeSizeInBytes());
 
-				for (uint32 y = 0; y < tileGridMaxDims.y; ++y)
+				for (size_t tile = 0; tile < numTiles; ++tile)
 				{
-					for (uint32 x = 0; x < tileGridMaxDims.x; ++x)
-					{
-						size_t offset = x + y * tileGridMaxDims.x;
-
-						m_pGridOffsetsAndSizesData[offset * 2 + 0] = counts[offset];
-						m_pGridOffsetsAndSizesData[offset * 2 + 1] = offsets[offset];
-					}
+					m_pGridOffsetsAndSizesData[tile * 2 + 0] = m_GridCounts[tile];
+					m_pGridOffsetsAndSizesData[tile * 2 + 1] = m_GridOffsets[tile];
 				}
+
+				m_pLights = 0;
+				m_pCamera = 0;
 			}
 
 			void TileSpaceLightGrid::SetScreenAreaCullSize(const Vector2_uint32& val)
@@ -46,6 +46,8 @@ THE SOFTWARE.
     #include <Library-Graphics/DataFormat.h>
 #endif
 
+#include <boost/function.hpp>
+
 FORWARD_DECLARE(Light)
 
 namespace OpenIG {
@@ -55,9 +57,17 @@ namespace OpenIG {
             class IGLIBGRAPHICS_EXPORT TileSpaceLightGrid
             {
             public:
+                // Runs func(begin, count) over the chunks of [0, count), possibly in parallel
+                typedef boost::function<void (size_t, size_t)> RangeFunc;
+                typedef boost::function<void (size_t, const RangeFunc&)> ParallelForFunc;
+
                 TileSpaceLightGrid(const Vector2_uint32& tileSize);
                 virtual ~TileSpaceLightGrid();
 
+                // The projection and the binning are split in chunks of lights
+                // and run through this. Serial unless one is set (or TBB is found)
+                void SetParallelFor(const ParallelForFunc& parallelFor);
+
                 void Update(const VectorLights& frustumVisibleLights, const Camera_64* pCamera, const Vector2_uint32& viewportSize);
 
                 const int *GetTileLightIndexListsPtr() const { return &m_TileLightIndexLists[0]; }
@@ -74,7 +84,29 @@ namespace OpenIG {
 
                 const Vector2_uint32& GetTileSize(void) const{ return m_TileSize; }
             private:
-                void UpdateScreenSpaceRectangles(const VectorLights& frustumVisibleLights, const Camera_64* pCamera, const Vector2_uint32& viewportSize, const Vector2_uint32& tileSize);
+                // Projects the bounding spheres of the lights to screen rectangles
+                void ProjectLights(size_t first, size_t count);
+                // Binning first pass, projects the lights of the chunks and counts them per tile
+                void ProjectAndCountChunks(size_t firstChunk, size_t numChunks);
+                // Binning second pass, writes the light indices of the chunks to the tiles
+                void ScatterChunks(size_t firstChunk, size_t numChunks);
+                void GetChunkLights(size_t chunk, size_t& first, size_t& count) const;
+                void RunParallel(size_t count, const RangeFunc& func);
+
+                ParallelForFunc m_ParallelFor;
+
+                // Valid during Update
+                const VectorLights* m_pLights;
+                const Camera_64* m_pCamera;
+                Vector2_uint32 m_ViewportSize;
+                Vector2_uint32 m_TileGridMaxDims;
+
+                size_t m_NumChunks;
+                size_t m_LightsPerChunk;
+                // Per chunk tile histograms, turned into per chunk write offsets by the prefix sum
+                std::vector<int32> m_ChunkTileCounts;
+                // Tiles covered by every light, empty for rejected lights
+                VectorScreenRectangles m_TileRects;
 
 #if 0
                 const Vector2_32 getTileMinMax(uint32 x, uint32 y) const { return m_minMaxGridValid ? m_gridMinMaxZ[x + y * m_gridDim.x] : chag::make_vector(0.0f, 0.0f); }
@@ -93,7 +125,6 @@ namespace OpenIG {
                 uint32 m_MaxTileLightCount;
                 bool m_MinMaxGridValid;
 
-                ConstVectorLights m_ViewSpaceLights;
                 VectorScreenRectangles m_ScreenRects;
 
                 int GetGridOffset(int x, int y, const Vector2_uint32& lightGridMaxDims);
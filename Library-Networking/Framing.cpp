@@ -0,0 +1,134 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+
+
+#include <Library-Networking/Framing.h>
+
+#include <algorithm>
+
+using namespace OpenIG::Library::Networking;
+
+const unsigned int Framing::HeaderSize;
+const unsigned int Framing::MaxFrameSize;
+
+Framing::FramePtr Framing::frame(const Buffer& buffer)
+{
+    unsigned int size = (unsigned int)buffer.getWritten();
+
+    Frame* frame = new Frame(HeaderSize + size);
+    (*frame)[0] = (char)((size >> 24) & 0xff);
+    (*frame)[1] = (char)((size >> 16) & 0xff);
+    (*frame)[2] = (char)((size >> 8) & 0xff);
+    (*frame)[3] = (char)(size & 0xff);
+
+    if (size) std::copy(buffer.getData(), buffer.getData() + size, frame->begin() + HeaderSize);
+
+    return FramePtr(frame);
+}
+
+Framing::Framing()
+    : _pos(0)
+    , _broken(false)
+{
+}
+
+void Framing::append(const char* data, int size)
+{
+    if (size <= 0 || _broken) return;
+
+    // Drop what was already taken out before growing
+    if (_pos && _pos == _data.size())
+    {
+        _data.clear();
+        _pos = 0;
+    }
+    else if (_pos > _data.size() / 2)
+    {
+        _data.erase(_data.begin(), _data.begin() + _pos);
+        _pos = 0;
+    }
+
+    _data.insert(_data.end(), data, data + size);
+}
+
+bool Framing::next(Frame& frame)
+{
+    if (_broken || _data.size() - _pos < HeaderSize) return false;
+
+    const unsigned char* header = reinterpret_cast<const unsigned char*>(&_data[_pos]);
+    unsigned int size =
+        ((unsigned int)header[0] << 24) |
+        ((unsigned int)header[1] << 16) |
+        ((unsigned int)header[2] << 8) |
+        (unsigned int)header[3];
+
+    if (size > MaxFrameSize)
+    {
+        _broken = true;
+        return false;
+    }
+
+    if (_data.size() - _pos < HeaderSize + size) return false;
+
+    frame.assign(_data.begin() + _pos + HeaderSize, _data.begin() + _pos + HeaderSize + size);
+    _pos += HeaderSize + size;
+
+    return true;
+}
+
+bool Framing::isBroken() const
+{
+    return _broken;
+}
+
+void Framing::clear()
+{
+    _data.clear();
+    _pos = 0;
+    _broken = false;
+}
+
+size_t Framing::getPending() const
+{
+    return _data.size() - _pos;
+}
@@ -0,0 +1,104 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+
+
+#ifndef FRAMING_H
+#define FRAMING_H
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Networking/Export.h>
+    #include <OpenIG-Networking/Buffer.h>
+#else
+    #include <Library-Networking/Export.h>
+    #include <Library-Networking/Buffer.h>
+#endif
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace OpenIG {
+    namespace Library {
+        namespace Networking {
+
+            // The TCP streams carry whole frames, each one the
+            // written part of a Buffer behind its size as a
+            // 4 byte unsigned integer in network byte order
+            class IGLIBNETWORKING_EXPORT Framing
+            {
+            public:
+                typedef std::vector<char>					Frame;
+                typedef boost::shared_ptr<const Frame>		FramePtr;
+
+                static const unsigned int HeaderSize = 4;
+
+                // Bigger than any frame the IG sends, anything over it is a broken stream
+                static const unsigned int MaxFrameSize = 16 * 1024 * 1024;
+
+                // The header and the payload, ready to be written
+                static FramePtr frame(const Buffer& buffer);
+
+                Framing();
+
+                // Appends what was read from the stream
+                void append(const char* data, int size);
+
+                // Takes the next whole frame out, false if there is none yet
+                bool next(Frame& frame);
+
+                bool isBroken() const;
+                void clear();
+
+                // The bytes received but not yet taken out
+                size_t getPending() const;
+
+            protected:
+                std::vector<char>	_data;
+                size_t				_pos;
+                bool				_broken;
+            };
+        } // namespace
+    } // namespace
+} // namespace
+
+#endif // FRAMING_H
@@ -19,7 +19,11 @@ SOURCES +=  Buffer.cpp\
             UDPNetwork.cpp\
             TCPServer.cpp\
             TCPClient.cpp\
-            Factory.cpp
+            Factory.cpp\
+            TrafficRecorder.cpp\
+            ReplayNetwork.cpp\
+            Framing.cpp\
+            MulticastNetwork.cpp
 
 HEADERS +=  Export.h\
             Buffer.h\
@@ -30,7 +34,11 @@ HEADERS +=  Export.h\
             TCPServer.h\
             TCPClient.h\
             Error.h\
-            Factory.h
+            Factory.h\
+            TrafficRecorder.h\
+            ReplayNetwork.h\
+            Framing.h\
+            MulticastNetwork.h
 
 INCLUDEPATH += ../
 DEPENDPATH += ../
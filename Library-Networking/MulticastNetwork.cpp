@@ -0,0 +1,177 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+
+
+#include <Library-Networking/MulticastNetwork.h>
+
+#include <boost/asio.hpp>
+
+using namespace OpenIG::Library::Networking;
+
+#if defined(SO_REUSEPORT)
+typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port;
+#endif
+
+MulticastNetwork::MulticastNetwork(const std::string& group, const std::string& interfaceAddress, unsigned int ttl, bool nonBlocking)
+    : Network()
+    , _senderSocket(0)
+    , _receiverSocket(0)
+    , _group(group)
+    , _interface(interfaceAddress.empty() ? std::string("0.0.0.0") : interfaceAddress)
+    , _ttl(ttl)
+    , _loopback(true)
+    , _reusePort(false)
+    , _senderSocketInitiated(false)
+    , _receiverSocketInitiated(false)
+    , _nonBlocking(nonBlocking)
+{
+}
+
+MulticastNetwork::~MulticastNetwork()
+{
+    if (_senderSocket) delete _senderSocket;
+    if (_receiverSocket) delete _receiverSocket;
+}
+
+void MulticastNetwork::setLoopback(bool loopback)
+{
+    _loopback = loopback;
+}
+
+void MulticastNetwork::setReusePort(bool reusePort)
+{
+    _reusePort = reusePort;
+}
+
+void MulticastNetwork::send(const Buffer& buffer)
+{
+    if (_senderSocket == 0 && !_senderSocketInitiated)
+    {
+        _senderSocketInitiated = true;
+        try
+        {
+            boost::asio::ip::address_v4 interfaceAddress = boost::asio::ip::address_v4::from_string(_interface);
+
+            _groupEndpoint = boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string(_group), _port);
+
+            _senderSocket = new boost::asio::ip::udp::socket(_senderIOService);
+            _senderSocket->open(boost::asio::ip::udp::v4());
+            _senderSocket->set_option(boost::asio::ip::multicast::hops(_ttl));
+            _senderSocket->set_option(boost::asio::ip::multicast::enable_loopback(_loopback));
+            if (!interfaceAddress.is_unspecified())
+            {
+                _senderSocket->set_option(boost::asio::ip::multicast::outbound_interface(interfaceAddress));
+            }
+        }
+        catch (std::exception& e)
+        {
+            std::ostringstream oss;
+            *log << oss << "Networking: multicast send socket setup exception thrown: " << e.what() << std::endl;
+
+            if (_senderSocket)
+            {
+                delete _senderSocket;
+                _senderSocket = 0;
+            }
+        }
+    }
+
+    if (_senderSocket)
+    {
+        boost::system::error_code error;
+        _senderSocket->send_to(boost::asio::buffer(buffer.getData(), buffer.getWritten()), _groupEndpoint, 0, error);
+        if (error)
+        {
+            std::ostringstream oss;
+            *log << oss << "Networking: multicast send_to error: " << error.message() << std::endl;
+        }
+    }
+}
+
+void MulticastNetwork::receive(Buffer& buffer, bool resetBuffer)
+{
+    if (_receiverSocket == 0 && !_receiverSocketInitiated)
+    {
+        _receiverSocketInitiated = true;
+        try
+        {
+            boost::asio::ip::address_v4 interfaceAddress = boost::asio::ip::address_v4::from_string(_interface);
+
+            _receiverSocket = new boost::asio::ip::udp::socket(_receiverIOService);
+            _receiverSocket->open(boost::asio::ip::udp::v4());
+            _receiverSocket->set_option(boost::asio::ip::udp::socket::reuse_address(true));
+#if defined(SO_REUSEPORT)
+            if (_reusePort) _receiverSocket->set_option(reuse_port(true));
+#endif
+            _receiverSocket->bind(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::any(), _port));
+            _receiverSocket->set_option(boost::asio::ip::multicast::join_group(boost::asio::ip::address_v4::from_string(_group), interfaceAddress));
+            if (_nonBlocking) _receiverSocket->non_blocking(true);
+        }
+        catch (std::exception& e)
+        {
+            std::ostringstream oss;
+            *log << oss << "Networking: multicast receive socket setup exception thrown: " << e.what() << std::endl;
+
+            if (_receiverSocket)
+            {
+                delete _receiverSocket;
+                _receiverSocket = 0;
+            }
+        }
+    }
+
+    if (_receiverSocket)
+    {
+        Buffer rbuff(BUFFER_SIZE);
+        boost::asio::ip::udp::endpoint	sendersEndpoint;
+        boost::system::error_code		error;
+
+        size_t bytes_recv = _receiverSocket->receive_from(boost::asio::buffer((void*)rbuff.getData(), rbuff.getSize()), sendersEndpoint, 0, error);
+        if (bytes_recv && !error)
+        {
+            record(TrafficRecord::Datagram, rbuff.getData(), (int)bytes_recv);
+            buffer.write(rbuff.getData(), (int)bytes_recv);
+            if (resetBuffer) buffer.reset();
+        }
+    }
+}
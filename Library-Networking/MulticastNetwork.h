@@ -0,0 +1,109 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+
+
+#ifndef MULTICASTNETWORK_H
+#define MULTICASTNETWORK_H
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Networking/Export.h>
+    #include <OpenIG-Networking/Network.h>
+#else
+    #include <Library-Networking/Export.h>
+    #include <Library-Networking/Network.h>
+#endif
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <string>
+
+namespace OpenIG {
+    namespace Library {
+        namespace Networking {
+
+            // UDP to a multicast group. The master sends every frame
+            // once, whatever the number of slaves, and only the hosts
+            // that joined the group get it, unlike with a broadcast.
+            // The interface is the local address the group is sent
+            // and joined on, 0.0.0.0 lets the system pick
+            class IGLIBNETWORKING_EXPORT MulticastNetwork : public Network
+            {
+            public:
+                explicit MulticastNetwork(const std::string& group, const std::string& interfaceAddress = "0.0.0.0", unsigned int ttl = 1, bool nonBlocking = false);
+                virtual ~MulticastNetwork();
+
+                virtual void send(const Buffer&);
+                virtual void receive(Buffer&, bool resetBuffer = true);
+
+                // Whether the sent frames come back to the receivers on
+                // the sending host, true by default so slaves can run on
+                // the master host too
+                void setLoopback(bool loopback);
+
+                // More than one receiver process on a host, on the same
+                // port, where the system supports SO_REUSEPORT
+                void setReusePort(bool reusePort);
+
+            protected:
+                boost::asio::io_service			_senderIOService;
+                boost::asio::ip::udp::socket*	_senderSocket;
+                boost::asio::ip::udp::endpoint	_groupEndpoint;
+
+                boost::asio::io_service			_receiverIOService;
+                boost::asio::ip::udp::socket*	_receiverSocket;
+
+                std::string						_group;
+                std::string						_interface;
+                unsigned int					_ttl;
+                bool							_loopback;
+                bool							_reusePort;
+                bool							_senderSocketInitiated;
+                bool							_receiverSocketInitiated;
+                bool							_nonBlocking;
+            };
+        } // namespace
+    } // namespace
+} // namespace
+
+#endif // MULTICASTNETWORK_H
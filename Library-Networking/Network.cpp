@@ -46,6 +46,7 @@
 using namespace OpenIG::Library::Networking;
 
 Network::Network()
+    : _port(0)
 {
 
 }
@@ -98,6 +99,21 @@ void Network::setParser(Parser* parser)
     _parser = boost::shared_ptr<Parser>(parser);
 }
 
+void Network::setRecorder(TrafficRecorder* recorder)
+{
+    _recorder = boost::shared_ptr<TrafficRecorder>(recorder);
+}
+
+TrafficRecorder* Network::getRecorder() const
+{
+    return _recorder.get();
+}
+
+void Network::record(TrafficRecord::Kind kind, const char* data, int size)
+{
+    if (_recorder.get()) _recorder->record(kind, _port, data, size);
+}
+
 void Network::process()
 {
     if (_parser.get() == 0) return;
@@ -51,6 +51,7 @@
     #include <OpenIG-Networking/Parser.h>
     #include <OpenIG-Networking/Network.h>
     #include <OpenIG-Networking/Error.h>
+    #include <OpenIG-Networking/TrafficRecorder.h>
 #else
     #include <Library-Networking/Export.h>
     #include <Library-Networking/Packet.h>
@@ -58,6 +59,7 @@
     #include <Library-Networking/Parser.h>
     #include <Library-Networking/Network.h>
     #include <Library-Networking/Error.h>
+    #include <Library-Networking/TrafficRecorder.h>
 #endif
 
 #include <boost/shared_ptr.hpp>
@@ -96,12 +98,20 @@ namespace OpenIG {
                 void setPort(unsigned int);
                 void setParser(Parser*);
 
+                // Everything received from now on is also written to the recorder
+                void setRecorder(TrafficRecorder*);
+                TrafficRecorder* getRecorder() const;
+
                 Network& operator<<(const Packet&);
 
             protected:
                 PacketCallbacks					_callbacks;
                 unsigned int					_port;
                 boost::shared_ptr<Parser>		_parser;
+                boost::shared_ptr<TrafficRecorder>	_recorder;
+
+                // Called by the implementations with what they received
+                void record(TrafficRecord::Kind kind, const char* data, int size);
 
             public:
                 static boost::shared_ptr<ErrorHandler> log;
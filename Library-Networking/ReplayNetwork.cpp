@@ -0,0 +1,196 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+
+
+#include <Library-Networking/ReplayNetwork.h>
+
+#include <boost/thread/thread.hpp>
+
+using namespace OpenIG::Library::Networking;
+
+ReplayNetwork::ReplayNetwork(const std::string& fileName, Pacing pacing, bool blocking)
+    : Network()
+    , _fileName(fileName)
+    , _pacing(pacing)
+    , _blocking(blocking)
+    , _valid(false)
+    , _hasNext(false)
+    , _firstTime(0)
+    , _started(false)
+    , _lastDueTime(0.0)
+    , _numReplayed(0)
+    , _numBytesReplayed(0)
+{
+    open();
+}
+
+ReplayNetwork::~ReplayNetwork()
+{
+}
+
+void ReplayNetwork::open()
+{
+    _file.open(_fileName.c_str(), std::ios::in | std::ios::binary);
+    _valid = _file.is_open() && TrafficRecorder::readHeader(_file);
+
+    if (!_valid)
+    {
+        std::ostringstream oss;
+        *log << oss << "Networking: not a traffic recording: " << _fileName << std::endl;
+        return;
+    }
+
+    readNext();
+    _firstTime = _hasNext ? _next.time : 0;
+}
+
+void ReplayNetwork::readNext()
+{
+    _hasNext = _file.is_open() && TrafficRecorder::readRecord(_file, _next);
+}
+
+double ReplayNetwork::dueTime(const TrafficRecord& record) const
+{
+    return (double)(record.time - _firstTime) / 1000000.0;
+}
+
+void ReplayNetwork::send(const Buffer&)
+{
+}
+
+void ReplayNetwork::receive(Buffer& buffer, bool resetBuffer)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+
+    if (!_hasNext) return;
+
+    if (!_started)
+    {
+        _start = boost::posix_time::microsec_clock::universal_time();
+        _started = true;
+    }
+
+    double now = (boost::posix_time::microsec_clock::universal_time() - _start).total_microseconds() / 1000000.0;
+    double due = now;
+
+    if (_pacing == RecordedSpeed)
+    {
+        due = dueTime(_next);
+        if (due > now)
+        {
+            if (!_blocking) return;
+
+            // Not holding the lock while waiting, the statistics
+            // are read from other threads than the receiving one
+            lock.unlock();
+            boost::this_thread::sleep(boost::posix_time::microseconds((long long)((due - now) * 1000000.0)));
+            lock.lock();
+
+            if (!_hasNext) return;
+        }
+    }
+
+    if (_next.data.size())
+    {
+        buffer.write(&_next.data[0], (int)_next.data.size());
+        if (resetBuffer) buffer.reset();
+    }
+
+    _lastDueTime = due;
+    ++_numReplayed;
+    _numBytesReplayed += _next.data.size();
+
+    readNext();
+}
+
+bool ReplayNetwork::isValid() const
+{
+    return _valid;
+}
+
+bool ReplayNetwork::isFinished() const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return !_hasNext;
+}
+
+void ReplayNetwork::rewind()
+{
+    boost::mutex::scoped_lock lock(_mutex);
+
+    _file.close();
+    _file.clear();
+
+    _started = false;
+    _lastDueTime = 0.0;
+    _numReplayed = 0;
+    _numBytesReplayed = 0;
+
+    open();
+}
+
+unsigned int ReplayNetwork::getNumReplayed() const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _numReplayed;
+}
+
+unsigned long long ReplayNetwork::getNumBytesReplayed() const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _numBytesReplayed;
+}
+
+double ReplayNetwork::getTime() const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    if (!_started) return 0.0;
+
+    return (boost::posix_time::microsec_clock::universal_time() - _start).total_microseconds() / 1000000.0;
+}
+
+double ReplayNetwork::getLastDueTime() const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _lastDueTime;
+}
@@ -0,0 +1,133 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+
+
+#ifndef REPLAYNETWORK_H
+#define REPLAYNETWORK_H
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Networking/Export.h>
+    #include <OpenIG-Networking/Network.h>
+    #include <OpenIG-Networking/TrafficRecorder.h>
+#else
+    #include <Library-Networking/Export.h>
+    #include <Library-Networking/Network.h>
+    #include <Library-Networking/TrafficRecorder.h>
+#endif
+
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <fstream>
+#include <string>
+
+namespace OpenIG {
+    namespace Library {
+        namespace Networking {
+
+            // Plays back a recording made by a TrafficRecorder in place
+            // of a live network, one recorded receive per receive call.
+            // Sends go nowhere. With AsFastAsPossible every receive gets
+            // the next record, so a run over the same recording always
+            // sees the same packets in the same frames
+            class IGLIBNETWORKING_EXPORT ReplayNetwork : public Network
+            {
+            public:
+                enum Pacing
+                {
+                    RecordedSpeed,
+                    AsFastAsPossible
+                };
+
+                // Blocking receives wait for the next record to be due,
+                // the others return empty handed until it is
+                explicit ReplayNetwork(const std::string& fileName, Pacing pacing = RecordedSpeed, bool blocking = false);
+                virtual ~ReplayNetwork();
+
+                virtual void send(const Buffer&);
+                virtual void receive(Buffer&, bool resetBuffer = true);
+
+                bool isValid() const;
+                bool isFinished() const;
+
+                // Starts over from the first record
+                void rewind();
+
+                unsigned int getNumReplayed() const;
+                unsigned long long getNumBytesReplayed() const;
+
+                // Seconds since the first receive of the replay, and
+                // when the last record handed out was due on that clock.
+                // Their difference, taken once the record is applied,
+                // is the latency of the receiver
+                double getTime() const;
+                double getLastDueTime() const;
+
+            protected:
+                std::string						_fileName;
+                std::ifstream					_file;
+                Pacing							_pacing;
+                bool							_blocking;
+                bool							_valid;
+
+                TrafficRecord					_next;
+                bool							_hasNext;
+                unsigned long long				_firstTime;
+
+                bool							_started;
+                boost::posix_time::ptime		_start;
+                double							_lastDueTime;
+
+                unsigned int					_numReplayed;
+                unsigned long long				_numBytesReplayed;
+                mutable boost::mutex			_mutex;
+
+                void open();
+                void readNext();
+                double dueTime(const TrafficRecord& record) const;
+            };
+        } // namespace
+    } // namespace
+} // namespace
+
+#endif // REPLAYNETWORK_H
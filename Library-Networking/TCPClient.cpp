@@ -56,6 +56,7 @@ TCPClient::TCPClient(const std::string& host, const std::string& server)
     , _socket(0)
     , _setup_socket(false)
     , _host(host)
+    , _connected(false)
 {
 }
 
@@ -73,15 +74,16 @@ void TCPClient::send(const Buffer& buffer)
 
     if (_socket)
     {
-        boost::asio::mutable_buffers_1	buff((void*)buffer.getData(), buffer.getSize());
-        boost::system::error_code error;
+        Framing::FramePtr frame = Framing::frame(buffer);
 
         try
         {
-            _socket->write_some(buff);
+            boost::asio::write(*_socket, boost::asio::buffer(&(*frame)[0], frame->size()));
         }
         catch (std::exception& e)
         {
+            setConnected(false);
+
             std::ostringstream oss;
             *log << oss << "Networking: tcp client exception: " << e.what() << std::endl;
         }
@@ -104,24 +106,74 @@ void TCPClient::receive(Buffer& buffer, bool resetBuffer)
         try
         {
             setupSocket(*_socket);
-            size_t len = _socket->read_some(buff, error);
 
-            if (len)
+            // Read until there is a whole frame, the
+            // stream splits them wherever it likes
+            Framing::Frame frame;
+            while (!_received.next(frame))
+            {
+                if (_received.isBroken())
+                {
+                    _received.clear();
+                    throw std::runtime_error("broken framing");
+                }
+
+                size_t len = _socket->read_some(buff, error);
+                if (error)
+                    throw boost::system::system_error(error);
+
+                _received.append(cbuff.getData(), (int)len);
+            }
+
+            if (frame.size())
             {
-                buffer.write(cbuff.getData(), len);
+                record(TrafficRecord::Stream, &frame[0], (int)frame.size());
+                buffer.write(&frame[0], (int)frame.size());
                 if (resetBuffer) buffer.reset();
             }
-            if (error)
-                throw boost::system::system_error(error);
         }
         catch (std::exception& e)
         {
+            setConnected(false);
+
             std::ostringstream oss;
             *log << oss << "Networking: tcp client exception: " << e.what() << std::endl;
         }
     }
 }
 
+bool TCPClient::connect()
+{
+    if (_socket == 0)
+    {
+        createSocket();
+    }
+    return isConnected();
+}
+
+bool TCPClient::isConnected() const
+{
+    boost::mutex::scoped_lock lock(_connectedMutex);
+    return _connected;
+}
+
+void TCPClient::setConnected(bool connected)
+{
+    boost::mutex::scoped_lock lock(_connectedMutex);
+    _connected = connected;
+}
+
+void TCPClient::disconnect()
+{
+    if (_socket)
+    {
+        // Shutting down wakes up a receive blocked on another thread
+        boost::system::error_code ignored_error;
+        _socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored_error);
+    }
+    setConnected(false);
+}
+
 void TCPClient::createSocket()
 {
     try
@@ -138,6 +190,8 @@ void TCPClient::createSocket()
         _socket->open(boost::asio::ip::tcp::v4());
         _socket->bind(boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string(_host), 0));
         _socket->connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string(_server), atoi(oss.str().c_str())));
+
+        setConnected(true);
     }
     catch (std::exception& e)
     {
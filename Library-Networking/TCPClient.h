@@ -47,20 +47,25 @@
 #if defined(OPENIG_SDK)
     #include <OpenIG-Networking/Export.h>
     #include <OpenIG-Networking/Network.h>
+    #include <OpenIG-Networking/Framing.h>
 #else
     #include <Library-Networking/Export.h>
     #include <Library-Networking/Network.h>
+    #include <Library-Networking/Framing.h>
 #endif
 
 #include <iostream>
 #include <string>
 #include <boost/array.hpp>
 #include <boost/asio.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace OpenIG {
     namespace Library {
         namespace Networking {
 
+            // Sends whole frames to a TCPServer, and receives one
+            // whole frame per receive, blocking until it is in
             class IGLIBNETWORKING_EXPORT TCPClient : public Network
             {
             public:
@@ -70,6 +75,16 @@ namespace OpenIG {
                 virtual void send(const Buffer&);
                 virtual void receive(Buffer&, bool resetBuffer = true);
 
+                // Connects now rather than on the first send or receive
+                bool connect();
+
+                // False once a send or a receive failed. The client
+                // does not reconnect, a new one has to be made
+                bool isConnected() const;
+
+                // Safe to call while another thread is blocked in receive
+                void disconnect();
+
             protected:
 
                 std::string						_server;
@@ -77,6 +92,13 @@ namespace OpenIG {
                 boost::asio::ip::tcp::socket*	_socket;
                 bool							_setup_socket;
                 std::string						_host;
+                Framing							_received;
+                bool							_connected;
+                mutable boost::mutex			_connectedMutex;
+
+                // _connected is set by the receiving thread and
+                // read by the others, so it goes through these
+                void setConnected(bool connected);
 
                 void createSocket();
                 void setupSocket(boost::asio::ip::tcp::socket& socket);
@@ -38,6 +38,7 @@
 //#*
 
 #include <iostream>
+#include <algorithm>
 
 #include <Library-Networking/TCPServer.h>
 
@@ -46,8 +47,21 @@
 
 using namespace OpenIG::Library::Networking;
 
+TCPServer::ClientStats::ClientStats()
+    : queueDepth(0)
+    , maxQueueDepth(0)
+    , numDropped(0)
+    , numFramesSent(0)
+    , numBytesSent(0)
+    , lastSendLatency(0.0)
+    , averageSendLatency(0.0)
+{
+}
+
 TCPServer::TCPServer(const std::string& host, unsigned port)
     : Network()
+    , _sendQueueLimit(8)
+    , _overflowPolicy(DropOldest)
     , _serverInitiated(false)
     , _host(host)
 {
@@ -57,13 +71,14 @@ TCPServer::TCPServer(const std::string& host, unsigned port)
 
 TCPServer::~TCPServer()
 {
+    _work.reset();
     _io_service.stop();
 
+    if (_thread) _thread->join();
+
     _mutex.lock();
     _connections.clear();
     _mutex.unlock();
-
-    if (_thread) _thread->join();
 }
 
 void TCPServer::init()
@@ -79,6 +94,9 @@ void TCPServer::init()
                     boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string(_host), _port) )
                 );
 
+            // Keeps the server thread running while there is nothing to write
+            _work = boost::shared_ptr<boost::asio::io_service::work>(new boost::asio::io_service::work(_io_service));
+
             accept();
 
             _thread = boost::shared_ptr<boost::thread>(new boost::thread(&TCPServer::run, this));
@@ -95,94 +113,88 @@ void TCPServer::init()
     }
 }
 
+void TCPServer::setSendQueueLimit(unsigned int depth, OverflowPolicy policy)
+{
+    _mutex.lock();
+    _sendQueueLimit = depth;
+    _overflowPolicy = policy;
+    _mutex.unlock();
+}
+
 void TCPServer::send(const Buffer& buffer)
 {
     init();
 
+    // Framed once, shared by the queues of all the clients
+    Framing::FramePtr frame = Framing::frame(buffer);
+
     _mutex.lock();
 
-    unsigned erased = 0;
+    removeFailedConnections();
+
     std::multimap<std::string, Connection::pointer>::iterator itr = _connections.begin();
-    while (itr != _connections.end())
+    for (; itr != _connections.end(); ++itr)
     {
-        itr->second->send(buffer);
-        if (itr->second->exception_thrown())
-        {
-            ++erased;
-
-            std::multimap<std::string, Connection::pointer>::iterator savedItr = itr;
-            ++savedItr;
-            _connections.erase(itr);
-            itr = savedItr;
+        if (itr->first.empty()) continue;
 
-            std::ostringstream oss;
-            *log << oss << "TCPServer::send() -- Exception thrown" << std::endl;
-        }
-        else
-        {
-            ++itr;
-        }
-    }
-    if (erased)
-    {
-        std::ostringstream oss;
-        *log << oss << "Networking: tcp server #connections: " << _connections.size() - 1 << std::endl;
+        itr->second->send(frame, _sendQueueLimit, _overflowPolicy);
     }
 
     _mutex.unlock();
 }
+
 void TCPServer::receive(Buffer& buffer, bool resetBuffer)
 {
-    boost::asio::mutable_buffers_1	buff((void*)buffer.getData(), buffer.getSize());
-    boost::system::error_code error;
-    std::multimap<std::string, Connection::pointer>::iterator itr;
-    try
+    Framing::Frame frame;
+
+    _mutex.lock();
+
+    removeFailedConnections();
+
+    std::multimap<std::string, Connection::pointer>::iterator itr = _connections.begin();
+    for (; itr != _connections.end(); ++itr)
     {
-        _mutex.lock();
+        if (itr->first.empty()) continue;
 
-        itr = _connections.begin();
-        for (; itr != _connections.end(); ++itr)
+        while (itr->second->receive(frame))
         {
-            if (itr == _connections.begin()) continue;
+            if (frame.empty()) continue;
 
-            Connection::pointer connection = itr->second;
+            record(TrafficRecord::Stream, &frame[0], (int)frame.size());
+            buffer.write(&frame[0], (int)frame.size());
+        }
+    }
 
-            Buffer cbuff(BUFFER_SIZE);
-            boost::asio::mutable_buffers_1	buff((void*)cbuff.getData(), cbuff.getSize());
-            boost::system::error_code error;
+    _mutex.unlock();
 
-            size_t len = connection->socket().read_some(buff, error);
-            if (len)
-            {
-                buffer.write(cbuff.getData(), len);
-            }
+    if(resetBuffer) buffer.reset();
+}
 
-            if (error)
-            {
-                std::ostringstream oss;
-                if (boost::asio::error::eof == error)
-                    *log << oss << "Networking: tcp server receive error: eof" << std::endl;
-                else
-                    *log << oss << "Networking: tcp server receive error: " << error << std::endl;
-                throw boost::system::system_error(error);
-            }
+void TCPServer::removeFailedConnections()
+{
+    unsigned erased = 0;
+    std::multimap<std::string, Connection::pointer>::iterator itr = _connections.begin();
+    while (itr != _connections.end())
+    {
+        if (!itr->first.empty() && itr->second->exception_thrown())
+        {
+            ++erased;
 
+            std::multimap<std::string, Connection::pointer>::iterator savedItr = itr;
+            ++savedItr;
+            _connections.erase(itr);
+            itr = savedItr;
+        }
+        else
+        {
+            ++itr;
         }
-        _mutex.unlock();
-
-
     }
-    catch (std::exception& e)
+    if (erased)
     {
-        _connections.erase(itr);
-
-        _mutex.unlock();
-
         std::ostringstream oss;
-        *log << oss << "Networking: tcp server exception: " << e.what() << std::endl;
+        *log << oss << "Networking: tcp server #connections: " << _connections.size() - 1 << std::endl;
     }
-
-    if(resetBuffer) buffer.reset();
 }
 
 void TCPServer::run()
@@ -229,14 +241,25 @@ void TCPServer::handle(TCPServer::Connection::pointer connection, const boost::s
 {
     if (!error)
     {
-        std::multimap<std::string, Connection::pointer>::iterator itr = _connections.find("");
+        boost::system::error_code ignored_error;
+        std::string address = connection->socket().remote_endpoint(ignored_error).address().to_string();
+
+        _mutex.lock();
+
+        std::multimap<std::string, Connection::pointer>::iterator itr = _connections.begin();
+        for (; itr != _connections.end(); ++itr)
+        {
+            if (itr->second == connection)
+            {
+                _connections.erase(itr);
+                break;
+            }
+        }
+        _connections.insert(std::pair<std::string, Connection::pointer>(address, connection));
+
+        _mutex.unlock();
 
-        _connections.insert(
-            std::pair<std::string, Connection::pointer>(
-                connection->socket().remote_endpoint().address().to_string(), connection
-            )
-        );
-        _connections.erase(itr);
+        connection->start();
 
         accept();
     }
@@ -261,9 +284,222 @@ void TCPServer::getConnectedClients(std::vector<std::string>& clients)
 
     _mutex.unlock();
 }
+
+void TCPServer::getClientStats(ClientStatsList& stats)
+{
+    stats.clear();
+
+    _mutex.lock();
+
+    std::multimap<std::string, Connection::pointer>::iterator itr = _connections.begin();
+    for (; itr != _connections.end(); ++itr)
+    {
+        if (itr->first.empty()) continue;
+
+        ClientStats clientStats;
+        clientStats.address = itr->first;
+        itr->second->getStats(clientStats);
+
+        stats.push_back(clientStats);
+    }
+
+    _mutex.unlock();
+}
+
 void TCPServer::Connection::setupSocket(boost::asio::ip::tcp::socket& socket)
 {
     _socket_setup = true;
     socket.set_option(boost::asio::ip::tcp::no_delay(true));
 }
 
+void TCPServer::Connection::start()
+{
+    try
+    {
+        if (!_socket_setup)
+        {
+            setupSocket(_socket);
+        }
+    }
+    catch (std::exception& e)
+    {
+        fail(e.what());
+        return;
+    }
+
+    read();
+}
+
+void TCPServer::Connection::send(const Framing::FramePtr& frame, unsigned int limit, OverflowPolicy policy)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+
+    if (_exception_thrown) return;
+
+    // The frame in flight can not be taken back, only the waiting ones
+    size_t waiting = _queue.size() - (_writing ? 1 : 0);
+    if (limit && waiting >= limit)
+    {
+        switch (policy)
+        {
+        case DropOldest:
+            _queue.erase(_queue.begin() + (_writing ? 1 : 0));
+            ++_numDropped;
+            break;
+        case Disconnect:
+            {
+                _exception_thrown = true;
+                _io_service.post(boost::bind(&Connection::shutdown, shared_from_this()));
+
+                std::ostringstream oss;
+                *Network::log << oss << "Networking: tcp server client fell " << waiting << " frames behind, disconnecting" << std::endl;
+            }
+            return;
+        }
+    }
+
+    QueuedFrame queued;
+    queued.frame = frame;
+    queued.queued = boost::posix_time::microsec_clock::universal_time();
+    _queue.push_back(queued);
+
+    _maxQueueDepth = std::max(_maxQueueDepth, (unsigned int)_queue.size());
+
+    if (!_writing)
+    {
+        _writing = true;
+        _io_service.post(boost::bind(&Connection::write, shared_from_this()));
+    }
+}
+
+void TCPServer::Connection::write()
+{
+    Framing::FramePtr frame;
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_queue.empty() || _exception_thrown)
+        {
+            _writing = false;
+            return;
+        }
+        frame = _queue.front().frame;
+    }
+
+    // The handler keeps the frame alive until the write is
+    // done, the queue might be cleared in the meantime
+    boost::asio::async_write(_socket,
+        boost::asio::buffer(&(*frame)[0], frame->size()),
+        boost::bind(&Connection::handleWrite, shared_from_this(),
+            boost::asio::placeholders::error,
+            boost::asio::placeholders::bytes_transferred,
+            frame));
+}
+
+void TCPServer::Connection::handleWrite(const boost::system::error_code& error, size_t bytes_transferred, Framing::FramePtr)
+{
+    if (error)
+    {
+        fail(error.message());
+        return;
+    }
+
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_queue.empty()) return;
+
+        double latency = (boost::posix_time::microsec_clock::universal_time() - _queue.front().queued).total_microseconds() / 1000000.0;
+
+        _queue.pop_front();
+
+        _lastSendLatency = latency;
+        _totalSendLatency += latency;
+        ++_numFramesSent;
+        _numBytesSent += bytes_transferred;
+    }
+
+    write();
+}
+
+void TCPServer::Connection::read()
+{
+    _socket.async_read_some(boost::asio::buffer(_readBuffer, sizeof(_readBuffer)),
+        boost::bind(&Connection::handleRead, shared_from_this(),
+            boost::asio::placeholders::error,
+            boost::asio::placeholders::bytes_transferred));
+}
+
+void TCPServer::Connection::handleRead(const boost::system::error_code& error, size_t bytes_transferred)
+{
+    if (error)
+    {
+        fail(boost::asio::error::eof == error ? std::string("eof") : error.message());
+        return;
+    }
+
+    bool broken = false;
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _received.append(_readBuffer, (int)bytes_transferred);
+        broken = _received.isBroken();
+    }
+
+    if (broken)
+    {
+        fail("broken framing");
+        return;
+    }
+
+    read();
+}
+
+bool TCPServer::Connection::receive(Framing::Frame& frame)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _received.next(frame);
+}
+
+void TCPServer::Connection::close()
+{
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _exception_thrown = true;
+    }
+    _io_service.post(boost::bind(&Connection::shutdown, shared_from_this()));
+}
+
+void TCPServer::Connection::fail(const std::string& what)
+{
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_exception_thrown) return;
+
+        _exception_thrown = true;
+        _writing = false;
+        _queue.clear();
+    }
+
+    std::ostringstream oss;
+    *Network::log << oss << "Networking: tcp server connection exception: " << what << std::endl;
+
+    shutdown();
+}
+
+void TCPServer::Connection::shutdown()
+{
+    boost::system::error_code ignored_error;
+    _socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored_error);
+    _socket.close(ignored_error);
+}
+
+void TCPServer::Connection::getStats(ClientStats& stats) const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+
+    stats.queueDepth = (unsigned int)_queue.size();
+    stats.maxQueueDepth = _maxQueueDepth;
+    stats.numDropped = _numDropped;
+    stats.numFramesSent = _numFramesSent;
+    stats.numBytesSent = _numBytesSent;
+    stats.lastSendLatency = _lastSendLatency;
+    stats.averageSendLatency = _numFramesSent ? _totalSendLatency / _numFramesSent : 0.0;
+}
@@ -41,34 +41,67 @@
 //#*    Email address: openig@compro.net
 //#*
 
+
 #ifndef TCPSERVER_H
 #define TCPSERVER_H
 
 #if defined(OPENIG_SDK)
     #include <OpenIG-Networking/Export.h>
     #include <OpenIG-Networking/Network.h>
+    #include <OpenIG-Networking/Framing.h>
 #else
     #include <Library-Networking/Export.h>
     #include <Library-Networking/Network.h>
+    #include <Library-Networking/Framing.h>
 #endif
 
 #include <iostream>
 #include <string>
 #include <map>
+#include <deque>
+#include <vector>
 #include <boost/bind.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 namespace OpenIG {
     namespace Library {
         namespace Networking {
 
+            // Sends and receives whole frames (see Framing). Every client
+            // has its own send queue, written asynchronously on the thread
+            // of the server, so a slow client never holds up the caller of
+            // send or the other clients. Receives never block, they take
+            // the frames the clients have sent so far
             class IGLIBNETWORKING_EXPORT TCPServer : public Network
             {
             public:
+                // What happens when a client falls behind by more frames than the send queue limit
+                enum OverflowPolicy
+                {
+                    DropOldest,
+                    Disconnect
+                };
+
+                struct ClientStats
+                {
+                    ClientStats();
+
+                    std::string					address;
+                    unsigned int				queueDepth;
+                    unsigned int				maxQueueDepth;
+                    unsigned int				numDropped;
+                    unsigned long long			numFramesSent;
+                    unsigned long long			numBytesSent;
+                    double						lastSendLatency;		// seconds from the send to the frame written out
+                    double						averageSendLatency;
+                };
+                typedef std::vector<ClientStats>	ClientStatsList;
+
                 explicit TCPServer(const std::string& host, unsigned port);
                 virtual ~TCPServer();
 
@@ -76,6 +109,11 @@ namespace OpenIG {
                 virtual void receive(Buffer&, bool resetBuffer = true);
 
                 void getConnectedClients(std::vector<std::string>&);
+                void getClientStats(ClientStatsList&);
+
+                // The number of frames waiting to be written to a client before
+                // the policy kicks in. The frame being written is not counted
+                void setSendQueueLimit(unsigned int depth, OverflowPolicy policy = DropOldest);
 
             protected:
 
@@ -96,69 +134,91 @@ namespace OpenIG {
 
                     void setupSocket(boost::asio::ip::tcp::socket& socket);
 
-                    void send(const Buffer& buffer)
-                    {
-                        try
-                        {
-                            if (_socket.is_open())
-                            {
-                                if (!_socket_setup)
-                                {
-                                    setupSocket(_socket);
-                                }
-
-                                boost::system::error_code ignore_error;
-                                size_t len = boost::asio::write(
-                                    _socket,
-                                    boost::asio::buffer(buffer.getData(), buffer.getSize()),
-                                    boost::asio::transfer_all(),
-                                    ignore_error
-                                    );
-
-                                if (!len)
-                                {
-                                    throw std::runtime_error("Socket closed");
-                                }
-                            }
-                        }
-                        catch (std::exception& e)
-                        {
-                            std::ostringstream oss;
-                            *Network::log << oss << "Networking: tcp server connection exception: " << e.what() << std::endl;
-
-                            _exception_thrown = true;
-                        }
-                    }
+                    // Called on the server thread once the connection is accepted
+                    void start();
+
+                    // Queues the frame, safe from any thread
+                    void send(const Framing::FramePtr& frame, unsigned int limit, OverflowPolicy policy);
+
+                    // Takes the next whole frame the client sent
+                    bool receive(Framing::Frame& frame);
+
+                    void close();
 
                     bool exception_thrown() const
                     {
+                        boost::mutex::scoped_lock lock(_mutex);
                         return _exception_thrown;
                     }
 
+                    void getStats(ClientStats& stats) const;
+
                 private:
                     Connection(boost::asio::io_service& io_service)
-                        : _socket(io_service)
+                        : _io_service(io_service)
+                        , _socket(io_service)
                         , _exception_thrown(false)
                         , _socket_setup(false)
+                        , _writing(false)
+                        , _maxQueueDepth(0)
+                        , _numDropped(0)
+                        , _numFramesSent(0)
+                        , _numBytesSent(0)
+                        , _lastSendLatency(0.0)
+                        , _totalSendLatency(0.0)
                     {
                     }
 
+                    struct QueuedFrame
+                    {
+                        Framing::FramePtr			frame;
+                        boost::posix_time::ptime	queued;
+                    };
+
+                    boost::asio::io_service&			_io_service;
                     boost::asio::ip::tcp::socket		_socket;
                     bool								_exception_thrown;
                     bool								_socket_setup;
 
+                    std::deque<QueuedFrame>				_queue;
+                    bool								_writing;
+                    char								_readBuffer[BUFFER_SIZE];
+                    Framing								_received;
+                    mutable boost::mutex				_mutex;
+
+                    unsigned int						_maxQueueDepth;
+                    unsigned int						_numDropped;
+                    unsigned long long					_numFramesSent;
+                    unsigned long long					_numBytesSent;
+                    double								_lastSendLatency;
+                    double								_totalSendLatency;
+
+                    void fail(const std::string& what);
+
+                    // These run on the server thread only
+                    void write();
+                    void handleWrite(const boost::system::error_code& error, size_t bytes_transferred, Framing::FramePtr frame);
+                    void read();
+                    void handleRead(const boost::system::error_code& error, size_t bytes_transferred);
+                    void shutdown();
                 };
 
                 boost::asio::io_service								_io_service;
+                boost::shared_ptr<boost::asio::io_service::work>	_work;
                 boost::shared_ptr<boost::asio::ip::tcp::acceptor>	_acceptor;
                 std::multimap<std::string, Connection::pointer>		_connections;
                 boost::mutex										_mutex;
                 boost::shared_ptr<boost::thread>					_thread;
+                unsigned int										_sendQueueLimit;
+                OverflowPolicy										_overflowPolicy;
 
                 void run();
                 void accept();
                 void handle(Connection::pointer connection, const boost::system::error_code& error);
 
+                // Drops the connections that failed, with _mutex held
+                void removeFailedConnections();
+
                 void init();
                 bool												_serverInitiated;
                 std::string											_host;
@@ -0,0 +1,184 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+
+
+#include <Library-Networking/TrafficRecorder.h>
+#include <Library-Networking/Network.h>
+
+#include <cstring>
+
+using namespace OpenIG::Library::Networking;
+
+namespace
+{
+    const char          Magic[] = { 'O', 'I', 'G', 'N', 'E', 'T' };
+    const unsigned int  RecordHeaderSize = 16;
+
+    // The records are written byte by byte so the file reads
+    // back the same on any host, regardless of its byte order
+    void put(char* dst, unsigned long long value, int size)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            dst[i] = (char)((value >> (8 * i)) & 0xff);
+        }
+    }
+
+    unsigned long long get(const char* src, int size)
+    {
+        unsigned long long value = 0;
+        for (int i = 0; i < size; ++i)
+        {
+            value |= ((unsigned long long)(unsigned char)src[i]) << (8 * i);
+        }
+        return value;
+    }
+}
+
+const unsigned short TrafficRecorder::Version;
+
+TrafficRecorder::TrafficRecorder(const std::string& fileName)
+    : _fileName(fileName)
+    , _start(boost::posix_time::microsec_clock::universal_time())
+    , _lastFlush(_start)
+    , _numRecords(0)
+    , _numBytes(0)
+{
+    _file.open(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!_file.is_open())
+    {
+        std::ostringstream oss;
+        *Network::log << oss << "Networking: failed to open traffic recording: " << fileName << std::endl;
+        return;
+    }
+
+    char version[2];
+    put(version, Version, 2);
+
+    _file.write(Magic, sizeof(Magic));
+    _file.write(version, sizeof(version));
+}
+
+TrafficRecorder::~TrafficRecorder()
+{
+    if (_file.is_open())
+    {
+        _file.close();
+
+        std::ostringstream oss;
+        *Network::log << oss << "Networking: recorded " << _numRecords << " receives, " << _numBytes << " bytes to: " << _fileName << std::endl;
+    }
+}
+
+bool TrafficRecorder::isOpen() const
+{
+    return _file.is_open();
+}
+
+void TrafficRecorder::record(TrafficRecord::Kind kind, unsigned int port, const char* data, int size)
+{
+    if (size <= 0) return;
+
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+
+    boost::mutex::scoped_lock lock(_mutex);
+    if (!_file.is_open()) return;
+
+    char header[RecordHeaderSize];
+    put(header, (unsigned long long)(now - _start).total_microseconds(), 8);
+    put(header + 8, port, 2);
+    put(header + 10, kind, 1);
+    put(header + 11, 0, 1);
+    put(header + 12, size, 4);
+
+    _file.write(header, RecordHeaderSize);
+    _file.write(data, size);
+
+    ++_numRecords;
+    _numBytes += size;
+
+    // Keep what is on the disk no more than a second behind, a
+    // recording is most wanted after a run that did not end well
+    if ((now - _lastFlush).total_milliseconds() >= 1000)
+    {
+        _file.flush();
+        _lastFlush = now;
+    }
+}
+
+unsigned int TrafficRecorder::getNumRecords() const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _numRecords;
+}
+
+unsigned long long TrafficRecorder::getNumBytes() const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _numBytes;
+}
+
+bool TrafficRecorder::readHeader(std::istream& is)
+{
+    char header[sizeof(Magic) + 2];
+    if (!is.read(header, sizeof(header))) return false;
+    if (std::memcmp(header, Magic, sizeof(Magic)) != 0) return false;
+
+    return get(header + sizeof(Magic), 2) == Version;
+}
+
+bool TrafficRecorder::readRecord(std::istream& is, TrafficRecord& record)
+{
+    char header[RecordHeaderSize];
+    if (!is.read(header, RecordHeaderSize)) return false;
+
+    record.time = get(header, 8);
+    record.port = (unsigned short)get(header + 8, 2);
+    record.kind = (unsigned char)get(header + 10, 1);
+
+    unsigned int size = (unsigned int)get(header + 12, 4);
+    record.data.resize(size);
+
+    // A recording cut short by a crash ends with a partial record
+    return size == 0 || (bool)is.read(&record.data[0], size);
+}
@@ -0,0 +1,121 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+
+
+#ifndef TRAFFICRECORDER_H
+#define TRAFFICRECORDER_H
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Networking/Export.h>
+#else
+    #include <Library-Networking/Export.h>
+#endif
+
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace OpenIG {
+    namespace Library {
+        namespace Networking {
+
+            // One received datagram or stream read, as it came off the socket
+            struct TrafficRecord
+            {
+                enum Kind
+                {
+                    Datagram = 0,
+                    Stream = 1
+                };
+
+                TrafficRecord() : time(0), port(0), kind(Datagram) {}
+
+                unsigned long long		time;	// microseconds since the start of the recording
+                unsigned short			port;
+                unsigned char			kind;
+                std::vector<char>		data;
+            };
+
+            // Writes everything a Network receives to a file, with the
+            // time it was received at, to be played back by a ReplayNetwork.
+            // The file is a small header followed by the records, all
+            // little endian:
+            //      "OIGNET" version(uint16)
+            //      time(uint64) port(uint16) kind(uint8) reserved(uint8) size(uint32) data
+            class IGLIBNETWORKING_EXPORT TrafficRecorder
+            {
+            public:
+                static const unsigned short Version = 1;
+
+                explicit TrafficRecorder(const std::string& fileName);
+                ~TrafficRecorder();
+
+                bool isOpen() const;
+
+                // Safe to call from more than one receiving thread
+                void record(TrafficRecord::Kind kind, unsigned int port, const char* data, int size);
+
+                unsigned int getNumRecords() const;
+                unsigned long long getNumBytes() const;
+
+                // Reading back, shared with the ReplayNetwork
+                static bool readHeader(std::istream& is);
+                static bool readRecord(std::istream& is, TrafficRecord& record);
+
+            protected:
+                std::ofstream					_file;
+                std::string						_fileName;
+                boost::posix_time::ptime		_start;
+                boost::posix_time::ptime		_lastFlush;
+                unsigned int					_numRecords;
+                unsigned long long				_numBytes;
+                mutable boost::mutex			_mutex;
+            };
+        } // namespace
+    } // namespace
+} // namespace
+
+#endif // TRAFFICRECORDER_H
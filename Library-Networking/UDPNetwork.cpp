@@ -187,6 +187,7 @@ void UDPNetwork::receive(Buffer& buffer, bool resetBuffer)
             bytes_recv = _recieverSocket->receive_from(buff, sendersEndpoint, 0, errorcode);
             if (bytes_recv)
             {
+                record(TrafficRecord::Datagram, rbuff.getData(), (int)bytes_recv);
                 buffer.write(rbuff.getData(), bytes_recv);
                 if (resetBuffer) buffer.reset();
             }
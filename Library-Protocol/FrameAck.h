@@ -0,0 +1,76 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#pragma once
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Networking/Buffer.h>
+    #include <OpenIG-Networking/Packet.h>
+    #include <OpenIG-Protocol/Export.h>
+    #include <OpenIG-Protocol/Opcodes.h>
+#else
+    #include <Library-Networking/Buffer.h>
+    #include <Library-Networking/Packet.h>
+    #include <Library-Protocol/Export.h>
+    #include <Library-Protocol/Opcodes.h>
+#endif
+
+namespace OpenIG {
+    namespace Library {
+        namespace Protocol {
+
+            // Sent back to the host by an IG once it applied what it
+            // received in a frame, with the newest frame number it saw.
+            // The host measures the end to end latency with it
+            struct IGLIBPROTOCOL_EXPORT FrameAck : public OpenIG::Library::Networking::Packet
+            {
+                FrameAck();
+
+                META_Packet(OPCODE_FRAMEACK, FrameAck);
+
+                virtual int write(OpenIG::Library::Networking::Buffer &buf) const;
+                virtual int read(OpenIG::Library::Networking::Buffer &buf);
+
+                unsigned int	frameNumber;
+                unsigned int	numDatagrams;	// received and applied in the frame
+            };
+
+        }
+    }
+}
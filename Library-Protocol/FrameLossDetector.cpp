@@ -0,0 +1,93 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include <Library-Protocol/FrameLossDetector.h>
+
+using namespace OpenIG::Library::Protocol;
+
+FrameLossDetector::FrameLossDetector(unsigned int window)
+    : started(false)
+    , frameNumber(0)
+    , restartWindow(window)
+    , numReceived(0)
+    , numLost(0)
+    , numLate(0)
+    , numRestarts(0)
+{
+}
+
+unsigned int FrameLossDetector::process(unsigned int frame)
+{
+    ++numReceived;
+
+    if (!started)
+    {
+        started = true;
+        frameNumber = frame;
+        return 0;
+    }
+
+    if (frame > frameNumber)
+    {
+        unsigned int lost = frame - frameNumber - 1;
+        numLost += lost;
+        frameNumber = frame;
+        return lost;
+    }
+
+    if (frameNumber - frame > restartWindow)
+    {
+        ++numRestarts;
+        frameNumber = frame;
+        return 0;
+    }
+
+    ++numLate;
+    return 0;
+}
+
+void FrameLossDetector::reset()
+{
+    started = false;
+    frameNumber = 0;
+    numReceived = 0;
+    numLost = 0;
+    numLate = 0;
+    numRestarts = 0;
+}
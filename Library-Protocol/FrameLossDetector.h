@@ -0,0 +1,76 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#pragma once
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Protocol/Export.h>
+#else
+    #include <Library-Protocol/Export.h>
+#endif
+
+namespace OpenIG {
+    namespace Library {
+        namespace Protocol {
+
+            // Follows the frame numbers of the Header packets a slave
+            // receives and counts the frames it never got. Datagrams can
+            // also come late or twice, these are counted apart and do not
+            // move the sequence back. A frame number far behind the last
+            // one is taken as a restarted master and starts over
+            struct IGLIBPROTOCOL_EXPORT FrameLossDetector
+            {
+                FrameLossDetector(unsigned int restartWindow = 64);
+
+                // Returns the number of frames lost right before this one
+                unsigned int process(unsigned int frameNumber);
+                void reset();
+
+                bool			started;
+                unsigned int	frameNumber;
+                unsigned int	restartWindow;
+
+                unsigned int	numReceived;
+                unsigned int	numLost;
+                unsigned int	numLate;
+                unsigned int	numRestarts;
+            };
+        }
+    }
+}
@@ -23,7 +23,10 @@ SOURCES +=  Header.cpp\
             TOD.cpp\
             Command.cpp\
             LightState.cpp\
-            DeadReckonEntityState.cpp
+            DeadReckonEntityState.cpp\
+            FrameLossDetector.cpp\
+            TerrainQueryClient.cpp\
+            FrameAck.cpp
 
 HEADERS +=  Export.h\
             Opcodes.h\
@@ -37,7 +40,10 @@ HEADERS +=  Export.h\
             TOD.h\
             Command.h\
             LightState.h\
-            DeadReckonEntityState.h
+            DeadReckonEntityState.h\
+            FrameLossDetector.h\
+            TerrainQueryClient.h\
+            FrameAck.h
 
 INCLUDEPATH += ../
 DEPENDPATH += ../
@@ -50,6 +50,7 @@
 #define OPCODE_COMMAND                  107
 #define OPCODE_LIGHTSTATE               108
 #define OPCODE_DEADRECKON_ENTITYSTATE   109
+#define OPCODE_FRAMEACK                 110
 
 namespace OpenIG {
     namespace Library {
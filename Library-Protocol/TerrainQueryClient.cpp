@@ -0,0 +1,448 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+
+#include <Library-Protocol/TerrainQueryClient.h>
+#include <Library-Protocol/Header.h>
+#include <Library-Protocol/HOT.h>
+#include <Library-Protocol/HOTResponse.h>
+#include <Library-Protocol/LOS.h>
+#include <Library-Protocol/LOSResponse.h>
+
+#include <Library-Networking/Factory.h>
+#include <Library-Networking/Parser.h>
+
+#include <boost/bind.hpp>
+
+using namespace OpenIG::Library::Protocol;
+
+namespace
+{
+    // Not connected yet, or lost. Connecting is
+    // not retried more often than this, in seconds
+    const double RECONNECT_INTERVAL = 1.0;
+
+    struct ResponseParser : public OpenIG::Library::Networking::Parser
+    {
+        ResponseParser()
+        {
+            OpenIG::Library::Networking::Factory::instance()->addTemplate(new Header);
+            OpenIG::Library::Networking::Factory::instance()->addTemplate(new HOTResponse);
+            OpenIG::Library::Networking::Factory::instance()->addTemplate(new LOSResponse);
+        }
+
+        virtual OpenIG::Library::Networking::Packet* parse(OpenIG::Library::Networking::Buffer& buffer)
+        {
+            if (buffer.getRest() <= 0) return 0;
+
+            const unsigned char* opcode = buffer.fetch();
+
+            OpenIG::Library::Networking::Packet* packet = OpenIG::Library::Networking::Factory::instance()->packet(*opcode);
+            if (packet)
+            {
+                packet->read(buffer);
+
+                Header* header = dynamic_cast<Header*>(packet);
+                if (header && header->magic != SWAP_BYTES_COMPARE)
+                {
+                    buffer.setSwapBytes(true);
+                }
+            }
+            return packet;
+        }
+    };
+
+    struct HOTResponseCallback : public OpenIG::Library::Networking::Packet::Callback
+    {
+        HOTResponseCallback(TerrainQueryClient* client) : _client(client) {}
+
+        virtual void process(OpenIG::Library::Networking::Packet& packet)
+        {
+            HOTResponse* response = dynamic_cast<HOTResponse*>(&packet);
+            if (response)
+            {
+                _client->responseReceived(response->id, response->position, osg::Vec3f());
+            }
+        }
+
+        TerrainQueryClient* _client;
+    };
+
+    struct LOSResponseCallback : public OpenIG::Library::Networking::Packet::Callback
+    {
+        LOSResponseCallback(TerrainQueryClient* client) : _client(client) {}
+
+        virtual void process(OpenIG::Library::Networking::Packet& packet)
+        {
+            LOSResponse* response = dynamic_cast<LOSResponse*>(&packet);
+            if (response)
+            {
+                _client->responseReceived(response->id, response->position, response->normal);
+            }
+        }
+
+        TerrainQueryClient* _client;
+    };
+}
+
+bool TerrainQueryClient::Query::complete(Result::Status status, const osg::Vec3d& position, const osg::Vec3f& normal)
+{
+    boost::mutex::scoped_lock lock(mutex);
+
+    if (result.status != Result::Pending) return false;
+
+    result.status = status;
+    result.position = position;
+    result.normal = normal;
+
+    completed.notify_all();
+
+    return true;
+}
+
+unsigned int TerrainQueryClient::Future::id() const
+{
+    return _query.get() ? _query->result.id : 0;
+}
+
+bool TerrainQueryClient::Future::ready() const
+{
+    if (_query.get() == 0) return false;
+
+    boost::mutex::scoped_lock lock(_query->mutex);
+    return _query->result.status != Result::Pending;
+}
+
+TerrainQueryClient::Result TerrainQueryClient::Future::get() const
+{
+    if (_query.get() == 0) return Result();
+
+    boost::mutex::scoped_lock lock(_query->mutex);
+
+    while (_query->result.status == Result::Pending)
+    {
+        if (!_query->completed.timed_wait(lock, _query->deadline))
+        {
+            // The client counts it and runs the callback on the next dispatch
+            if (_query->result.status == Result::Pending)
+            {
+                _query->result.status = Result::TimedOut;
+            }
+        }
+    }
+
+    return _query->result;
+}
+
+TerrainQueryClient::TerrainQueryClient(const std::string& host, const std::string& server, unsigned int port, double timeout)
+    : _host(host)
+    , _server(server)
+    , _port(port)
+    , _timeout(timeout)
+    , _stopping(false)
+    , _pending(BUFFER_SIZE)
+    , _nextID(0)
+    , _numSent(0)
+    , _numCompleted(0)
+    , _numTimedOut(0)
+    , _numStale(0)
+    , _numFailed(0)
+{
+}
+
+TerrainQueryClient::~TerrainQueryClient()
+{
+    disconnect();
+}
+
+TerrainQueryClient::Future TerrainQueryClient::issue(const Callback& callback)
+{
+    QueryPointer query(new Query);
+
+    // Zero is left out, the hosts use it for no request
+    if (++_nextID == 0) ++_nextID;
+
+    query->result.id = _nextID;
+    query->callback = callback;
+    query->deadline = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::microseconds((boost::int64_t)(_timeout * 1000000.0));
+
+    _pendingQueries.push_back(query);
+
+    return Future(query);
+}
+
+TerrainQueryClient::Future TerrainQueryClient::hot(const osg::Vec3d& position, const Callback& callback)
+{
+    Future future = issue(callback);
+
+    HOT packet;
+    packet.id = future.id();
+    packet.position = position;
+    packet.write(_pending);
+
+    return future;
+}
+
+TerrainQueryClient::Future TerrainQueryClient::los(const osg::Vec3d& start, const osg::Vec3d& end, const Callback& callback)
+{
+    Future future = issue(callback);
+
+    LOS packet;
+    packet.id = future.id();
+    packet.start = start;
+    packet.end = end;
+    packet.write(_pending);
+
+    return future;
+}
+
+void TerrainQueryClient::add(const OpenIG::Library::Networking::Packet& packet)
+{
+    packet.write(_pending);
+}
+
+void TerrainQueryClient::flush(unsigned int frameNumber)
+{
+    // Lost since the last flush
+    if (_client.get() && !_client->isConnected())
+    {
+        disconnect();
+    }
+
+    if (_pending.getWritten() == 0) return;
+
+    if (!connect())
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+
+        for (QueryList::iterator itr = _pendingQueries.begin(); itr != _pendingQueries.end(); ++itr)
+        {
+            if ((*itr)->complete(Result::Failed, osg::Vec3d(), osg::Vec3f()))
+            {
+                ++_numFailed;
+                _completed.push_back(*itr);
+            }
+        }
+        _pendingQueries.clear();
+        _pending.rewrite();
+
+        return;
+    }
+
+    // In flight before they are sent, the
+    // response can be quicker than the send
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+
+        for (QueryList::iterator itr = _pendingQueries.begin(); itr != _pendingQueries.end(); ++itr)
+        {
+            _inFlight[(*itr)->result.id] = *itr;
+        }
+    }
+    _numSent += (unsigned int)_pendingQueries.size();
+    _pendingQueries.clear();
+
+    OpenIG::Library::Networking::Buffer buffer(BUFFER_SIZE);
+
+    Header header(frameNumber);
+    header.write(buffer);
+
+    buffer.write(_pending.getData(), _pending.getWritten());
+    _pending.rewrite();
+
+    _client->send(buffer);
+}
+
+void TerrainQueryClient::dispatch()
+{
+    QueryList completed;
+
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+
+        completed.swap(_completed);
+
+        boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+
+        Queries::iterator itr = _inFlight.begin();
+        while (itr != _inFlight.end())
+        {
+            QueryPointer query = itr->second;
+            if (now >= query->deadline)
+            {
+                // Or already by a Future that waited for it
+                query->complete(Result::TimedOut, osg::Vec3d(), osg::Vec3f());
+
+                ++_numTimedOut;
+                completed.push_back(query);
+
+                itr = _inFlight.erase(itr);
+            }
+            else
+            {
+                ++itr;
+            }
+        }
+    }
+
+    for (QueryList::iterator itr = completed.begin(); itr != completed.end(); ++itr)
+    {
+        Query& query = **itr;
+        if (query.callback.empty()) continue;
+
+        Result result;
+        {
+            boost::mutex::scoped_lock lock(query.mutex);
+            result = query.result;
+        }
+        query.callback(result);
+    }
+}
+
+void TerrainQueryClient::setTimeout(double timeout)
+{
+    _timeout = timeout;
+}
+
+double TerrainQueryClient::getTimeout() const
+{
+    return _timeout;
+}
+
+size_t TerrainQueryClient::getNumInFlight() const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _inFlight.size();
+}
+
+bool TerrainQueryClient::connect()
+{
+    if (_client.get()) return _client->isConnected();
+
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    if (!_lastConnectAttempt.is_not_a_date_time() && (now - _lastConnectAttempt).total_milliseconds() < RECONNECT_INTERVAL * 1000.0)
+    {
+        return false;
+    }
+    _lastConnectAttempt = now;
+
+    boost::shared_ptr<OpenIG::Library::Networking::TCPClient> client(new OpenIG::Library::Networking::TCPClient(_host, _server));
+    client->setPort(_port);
+    client->setParser(new ResponseParser);
+    client->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_HOTRESPONSE, new HOTResponseCallback(this));
+    client->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_LOSRESPONSE, new LOSResponseCallback(this));
+
+    if (!client->connect()) return false;
+
+    _client = client;
+    _stopping = false;
+    _receiveThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&TerrainQueryClient::receiveThreadFunc, this)));
+
+    return true;
+}
+
+void TerrainQueryClient::disconnect()
+{
+    _stopping = true;
+
+    if (_client.get())
+    {
+        _client->disconnect();
+    }
+    if (_receiveThread.get())
+    {
+        _receiveThread->join();
+        _receiveThread.reset();
+    }
+    _client.reset();
+
+    failInFlight();
+}
+
+void TerrainQueryClient::failInFlight()
+{
+    boost::mutex::scoped_lock lock(_mutex);
+
+    for (Queries::iterator itr = _inFlight.begin(); itr != _inFlight.end(); ++itr)
+    {
+        if (itr->second->complete(Result::Failed, osg::Vec3d(), osg::Vec3f()))
+        {
+            ++_numFailed;
+            _completed.push_back(itr->second);
+        }
+    }
+    _inFlight.clear();
+}
+
+void TerrainQueryClient::receiveThreadFunc()
+{
+    while (!_stopping && _client->isConnected())
+    {
+        _client->process();
+    }
+}
+
+void TerrainQueryClient::responseReceived(unsigned int id, const osg::Vec3d& position, const osg::Vec3f& normal)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+
+    Queries::iterator itr = _inFlight.find(id);
+    if (itr == _inFlight.end())
+    {
+        // Timed out and dispatched already, or not ours
+        ++_numStale;
+        return;
+    }
+
+    QueryPointer query = itr->second;
+    _inFlight.erase(itr);
+
+    if (query->complete(Result::Done, position, normal))
+    {
+        ++_numCompleted;
+        _completed.push_back(query);
+    }
+    else
+    {
+        // Timed out by a Future, dispatch did not see it yet
+        ++_numStale;
+        ++_numTimedOut;
+        _completed.push_back(query);
+    }
+}
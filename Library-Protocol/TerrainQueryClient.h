@@ -0,0 +1,205 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#pragma once
+
+#if defined(OPENIG_SDK)
+    #include <OpenIG-Networking/Buffer.h>
+    #include <OpenIG-Networking/TCPClient.h>
+    #include <OpenIG-Protocol/Export.h>
+#else
+    #include <Library-Networking/Buffer.h>
+    #include <Library-Networking/TCPClient.h>
+    #include <Library-Protocol/Export.h>
+#endif
+
+#include <osg/Vec3d>
+#include <osg/Vec3f>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <string>
+#include <vector>
+
+namespace OpenIG {
+    namespace Library {
+        namespace Protocol {
+
+            // HOT and LOS queries to the terrain query server that never
+            // block the host. The queries issued between two flush calls
+            // go out in one frame, the responses are matched back to them
+            // by their request ID on a thread of the client, and each query
+            // completes through its Future, its callback or both. Queries
+            // not answered within the timeout complete as TimedOut, and a
+            // response coming after that is dropped as stale
+            class IGLIBPROTOCOL_EXPORT TerrainQueryClient
+            {
+            public:
+                struct Result
+                {
+                    enum Status
+                    {
+                        Pending,
+                        Done,
+                        TimedOut,
+                        Failed			// not sent, or the connection was lost
+                    };
+
+                    Result() : status(Pending), id(0) {}
+
+                    Status			status;
+                    unsigned int	id;
+                    osg::Vec3d		position;
+                    osg::Vec3f		normal;		// LOS only
+                };
+
+                // Called from dispatch, on the thread of the host
+                typedef boost::function<void (const Result&)>	Callback;
+
+            protected:
+                struct Query
+                {
+                    Result									result;
+                    Callback								callback;
+                    boost::posix_time::ptime				deadline;
+                    boost::mutex							mutex;
+                    boost::condition_variable				completed;
+
+                    // True if this call completed it
+                    bool complete(Result::Status status, const osg::Vec3d& position, const osg::Vec3f& normal);
+                };
+                typedef boost::shared_ptr<Query>		QueryPointer;
+
+            public:
+                class IGLIBPROTOCOL_EXPORT Future
+                {
+                public:
+                    Future() {}
+
+                    bool valid() const { return _query.get() != 0; }
+                    unsigned int id() const;
+
+                    bool ready() const;
+
+                    // Waits for the response, no longer than the timeout of the query
+                    Result get() const;
+
+                protected:
+                    friend class TerrainQueryClient;
+                    Future(const QueryPointer& query) : _query(query) {}
+
+                    QueryPointer	_query;
+                };
+
+                TerrainQueryClient(const std::string& host, const std::string& server, unsigned int port, double timeout = 1.0);
+                ~TerrainQueryClient();
+
+                Future hot(const osg::Vec3d& position, const Callback& callback = Callback());
+                Future los(const osg::Vec3d& start, const osg::Vec3d& end, const Callback& callback = Callback());
+
+                // Goes out with the queries of the next flush, like the
+                // entity updates the server pages the terrain around
+                void add(const OpenIG::Library::Networking::Packet& packet);
+
+                // Sends the queries issued since the last flush in one frame.
+                // Connects on the first call, and again after the connection
+                // was lost, failing the queries that were in flight
+                void flush(unsigned int frameNumber = 0);
+
+                // Times out the late queries and runs the callbacks of
+                // the queries completed since the last call
+                void dispatch();
+
+                void setTimeout(double timeout);
+                double getTimeout() const;
+
+                size_t getNumInFlight() const;
+                unsigned int getNumSent() const { return _numSent; }
+                unsigned int getNumCompleted() const { return _numCompleted; }
+                unsigned int getNumTimedOut() const { return _numTimedOut; }
+                unsigned int getNumStale() const { return _numStale; }
+                unsigned int getNumFailed() const { return _numFailed; }
+
+            protected:
+                typedef boost::unordered_map<unsigned int, QueryPointer>	Queries;
+                typedef std::vector<QueryPointer>							QueryList;
+
+                std::string										_host;
+                std::string										_server;
+                unsigned int									_port;
+                double											_timeout;
+
+                boost::shared_ptr<OpenIG::Library::Networking::TCPClient>	_client;
+                boost::shared_ptr<boost::thread>				_receiveThread;
+                volatile bool									_stopping;
+
+                OpenIG::Library::Networking::Buffer				_pending;
+                QueryList										_pendingQueries;
+                unsigned int									_nextID;
+                boost::posix_time::ptime						_lastConnectAttempt;
+
+                Queries											_inFlight;
+                QueryList										_completed;
+                mutable boost::mutex							_mutex;
+
+                unsigned int									_numSent;
+                unsigned int									_numCompleted;
+                unsigned int									_numTimedOut;
+                unsigned int									_numStale;
+                unsigned int									_numFailed;
+
+                Future issue(const Callback& callback);
+                bool connect();
+                void disconnect();
+                void failInFlight();
+                void receiveThreadFunc();
+
+            public:
+                // Called with the responses by the receiving thread
+                void responseReceived(unsigned int id, const osg::Vec3d& position, const osg::Vec3f& normal);
+            };
+        }
+    }
+}
@@ -9,6 +9,7 @@ SUBDIRS +=  Library-Graphics\
             Utility-veggen\
             Utility-vegviewer\
             Utility-oigconv\
+            Utility-oigbench\
             Plugin-GPUVegetation\
             Plugin-LightsControl\
             Plugin-SimpleLighting\
@@ -251,6 +251,8 @@ namespace OpenIG {
             {
                 entitiesMutex.lock();
 
+                _entityUpdates.clear();
+
                 EntityStateMap::iterator itr = entities.begin();
                 for (;  itr != entities.end(); ++itr)
                 {
@@ -278,11 +280,13 @@ namespace OpenIG {
                     {
                         osg::Matrixd mx = OpenIG::Base::Math::instance()->toMatrix(0, 0, 0, es.h, es.p, es.r) * l2w;
 
-                        context.getImageGenerator()->updateEntity(es.id, mx);
+                        _entityUpdates.push_back(OpenIG::Base::ImageGenerator::EntityUpdate(es.id, mx));
                     }
                 }
 
                 entitiesMutex.unlock();
+
+                context.getImageGenerator()->updateEntities(_entityUpdates);
             }
 
             virtual void clean(OpenIG::PluginBase::PluginContext& context)
@@ -314,6 +318,7 @@ namespace OpenIG {
             unsigned int												_CIGIVersionMajor;
             unsigned int												_CIGIVersionMinor;
             boost::thread												_thread;
+            OpenIG::Base::ImageGenerator::EntityUpdates						_entityUpdates;
 
         };
     } // namespace
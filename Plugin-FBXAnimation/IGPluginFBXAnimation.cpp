@@ -141,7 +141,7 @@ namespace OpenIG {
                             unsigned int entityID = attr->getValue().entityId;
                             if (context.getImageGenerator()->getEntityMap().count(entityID) == 0) continue;
 
-                            OpenIG::Base::ImageGenerator::Entity entity = context.getImageGenerator()->getEntityMap()[entityID];
+                            OpenIG::Base::ImageGenerator::Entity entity = context.getImageGenerator()->getEntityMap().get(entityID);
                             if (!entity.valid()) continue;
 
                             osg::ref_ptr<osgAnimation::BasicAnimationManager> am = dynamic_cast<osgAnimation::BasicAnimationManager*>(entity->getUserData());
@@ -35,6 +35,8 @@
 
 using namespace osg;
 
+const unsigned int DummyLight::InvalidLightSourceIndex;
+
 void DummyLight::apply(osg::State& state) const
 {
     if (_id >=8) return;
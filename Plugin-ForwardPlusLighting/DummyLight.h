@@ -49,6 +49,7 @@ namespace osg
         DummyLight(unsigned int id)
             : osg::Light(id)
             , _id(id)
+            , _lightSourceIndex(InvalidLightSourceIndex)
         {
 			setUserValue("id", (unsigned int)id);
         }
@@ -56,10 +57,16 @@ namespace osg
         void setLightSource(osg::LightSource* lightSource);
         osg::LightSource* getLightSource(void);
 
+        // The index of the light source in the light source table of the ForwardPlusEngine
+        static const unsigned int InvalidLightSourceIndex = ~0u;
+
+        void setLightSourceIndex(unsigned int index) { _lightSourceIndex = index; }
+        unsigned int getLightSourceIndex(void) const { return _lightSourceIndex; }
 
         virtual void apply(osg::State& state) const;
     protected:
         unsigned int    _id;
+        unsigned int    _lightSourceIndex;
 
         osg::ref_ptr<osg::LightSource> _lightSource;
 
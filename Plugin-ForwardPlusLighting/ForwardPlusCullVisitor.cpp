@@ -32,22 +32,56 @@
 //#*****************************************************************************
 #include "ForwardPlusCullVisitor.h"
 #include "ForwardPlusEngine.h"
+#include "DummyLight.h"
+
+#include <osg/Transform>
 
 using namespace OpenIG::Plugins;
 
 ForwardPlusCullVisitor::ForwardPlusCullVisitor(ForwardPlusEngine* engine)
 	: osgUtil::CullVisitor()
 	, _fpEngine(engine)
+	, _fpView(0)
+	, _viewCamera(0)
 {
 
 }
 
+void ForwardPlusCullVisitor::setView(ForwardPlusView* view)
+{
+	_fpView = view;
+	_viewCamera = 0;
+
+	osg::Camera* camera = view ? view->camera.get() : 0;
+	if (camera)
+	{
+		_viewCamera = camera;
+		_inverseViewMatrix = camera->getInverseViewMatrix();
+	}
+}
+
 void ForwardPlusCullVisitor::apply(osg::LightSource& node)
 {	
-	if (!isCulled(node))
+	if (_fpView && !isCulled(node))
 	{
-		_fpEngine->apply(&node, this);
-	}		
+		osg::DummyLight* light = dynamic_cast<osg::DummyLight*>(node.getLight());
+		if (light && light->getLightSourceIndex() != osg::DummyLight::InvalidLightSourceIndex)
+		{
+			// Under the camera of the view the world matrix is what the model
+			// view accumulated so far. Nested cameras walk the node path
+			osg::Matrixd worldMatrix;
+			if (_viewCamera && getCurrentCamera() == _viewCamera && getModelViewMatrix())
+			{
+				worldMatrix = *getModelViewMatrix() * _inverseViewMatrix;
+			}
+			else
+			{
+				worldMatrix = osg::computeLocalToWorld(getNodePath());
+			}
+
+			_fpEngine->markLightSourceVisible(*_fpView, light->getLightSourceIndex(), worldMatrix, _inverseViewMatrix.getTrans());
+		}
+	}
 
 	if (node.getLight()->getLightNum() == 0)
 	{
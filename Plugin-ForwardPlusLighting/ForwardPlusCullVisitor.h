@@ -45,15 +45,24 @@ namespace OpenIG {
 	namespace Plugins {
 
 		class ForwardPlusEngine;
+		struct ForwardPlusView;
+
 		class ForwardPlusCullVisitor : public osgUtil::CullVisitor
 		{
 		public:
 			ForwardPlusCullVisitor(ForwardPlusEngine* engine);
+
+			// Set by the cull callback of the view around its traversal.
+			// The light sources are marked visible in this view
+			void			setView(ForwardPlusView* view);
 			
 			virtual void	apply(osg::LightSource& node);											
 
 		protected:
 			ForwardPlusEngine*	_fpEngine;
+			ForwardPlusView*	_fpView;
+			osg::Camera*		_viewCamera;
+			osg::Matrixd		_inverseViewMatrix;
 		};
 	}
 }
\ No newline at end of file
@@ -38,46 +38,159 @@
 #include <Core-OpenIG/Engine.h>
 
 #include <Core-Base/Configuration.h>
+#include <Core-Base/ThreadPool.h>
 
 #include <osg/Texture2D>
 
+#include <boost/bind.hpp>
+
+#include <algorithm>
+
 using namespace OpenIG::Plugins;
 
+// The light positions are packed relative to an origin kept within
+// this distance of the eye, which keeps them in float precision
+static const double _lightDataOriginRebaseDistance = 5000.0;
+
+ForwardPlusLightSource::ForwardPlusLightSource()
+	: osgLight(0)
+	, fpLight(0)
+	, enabled(false)
+	, lod(0.0)
+	, attributesDirty(false)
+	, on(false)
+	, appliedStamp(0)
+{
+}
+
+ForwardPlusView::ForwardPlusView(unsigned int viewIndex)
+	: index(viewIndex)
+	, culledFrameNumber(~0u)
+	, updatedFrameNumber(~0u)
+{
+	lightData = new LightData(341, FORMAT_R32G32B32A32_FLOAT);
+	lightActivation = new LightActivation();
+
+	Vector2_uint32 tileSize(32, 32);
+	tileSpaceLightGrid = new TileSpaceLightGrid(tileSize);
+	tileSpaceLightGrid->SetScreenAreaCullSize(tileSize/2);
+	tileSpaceLightGrid->SetParallelFor(boost::bind(&OpenIG::Base::ThreadPool::parallelFor, OpenIG::Base::ThreadPool::instance(), _1, _2, 1));
+}
+
+ForwardPlusView::~ForwardPlusView()
+{
+	SAFE_DELETE(tileSpaceLightGrid);
+	SAFE_DELETE(lightActivation);
+	SAFE_DELETE(lightData);
+}
+
 ForwardPlusEngine::ForwardPlusEngine(
 		OpenIG::Base::ImageGenerator* ig, 
 		osg::Group* scene,
 		LightManager& lightManager, 
-		FPLightMap& fplights, 
-		LightData& lightData, 
-		TileSpaceLightGrid& tileSpaceLightGrid)
+		FPLightMap& fplights)
 	: _ig(ig)
 	, _scene(scene)
 	, _lightManager(lightManager)
 	, _fplights(fplights)
-	, _lightData(lightData)
-	, _tileSpaceLightGrid(tileSpaceLightGrid)
+	, _frameNumber(0)
+	, _frameStarted(false)
 	, _isLodCullingEnabled(false)
+	, _lodHysteresis(0.1f)
+	, _minLightScreenSize(16.f)
+	, _maxActiveLights(1024)
+	, _maxProxyLights(32)
+	, _proxyCellSize(500.0)
+	, _lodCullRangeScale(1.0)
+	, _applyStamp(0)
 {
 	std::string cullingActive = OpenIG::Base::Configuration::instance()->getConfig("ForwardPlusLightsLODCulling", "yes");
 	if (cullingActive.compare(0, 3, "yes") == 0)
 	{
 		_isLodCullingEnabled = true;
 	}	
+
+	_lodHysteresis = (float)osg::maximum(OpenIG::Base::Configuration::instance()->getConfig("ForwardPlusLightsLODHysteresis", 0.1), 0.0);
+	// The default is the area the tile grid drops the lights below anyway
+	_minLightScreenSize = (float)OpenIG::Base::Configuration::instance()->getConfig("ForwardPlusLightsMinScreenSize", 16.0);
+	_maxActiveLights = osg::maximum(OpenIG::Base::Configuration::instance()->getConfig("ForwardPlusLightsMaxActive", 1024), 0);
+	_maxProxyLights = osg::maximum(OpenIG::Base::Configuration::instance()->getConfig("ForwardPlusLightsMaxProxies", 32), 0);
+	_proxyCellSize = OpenIG::Base::Configuration::instance()->getConfig("ForwardPlusLightsProxyCellSize", 500.0);
+	if (_proxyCellSize <= 0.0)
+	{
+		_proxyCellSize = 500.0;
+	}
+
+	// Far enough out for the hysteresis and, with the proxies on, for
+	// the lights past their LOD range to still show through them
+	_lodCullRangeScale = 1.0 + _lodHysteresis;
+	if (_maxProxyLights > 0)
+	{
+		_lodCullRangeScale = osg::maximum(OpenIG::Base::Configuration::instance()->getConfig("ForwardPlusLightsProxyRangeScale", 4.0), _lodCullRangeScale);
+	}
+}
+
+ForwardPlusEngine::~ForwardPlusEngine()
+{
+	for (ForwardPlusViews::iterator itr = _views.begin(); itr != _views.end(); ++itr)
+	{
+		_lightManager.RemoveChangeListener((*itr)->lightActivation);
+		_lightManager.RemoveChangeListener((*itr)->lightData);
+		SAFE_DELETE(*itr);
+	}
+	_views.clear();
+}
+
+ForwardPlusView* ForwardPlusEngine::getOrCreateView(unsigned int viewIndex)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_viewsMutex);
+
+	while (_views.size() <= viewIndex)
+	{
+		ForwardPlusView* view = new ForwardPlusView((unsigned int)_views.size());
+		_lightManager.AddChangeListener(view->lightData);
+
+		view->lightActivation->SetHysteresis(_lodHysteresis);
+		view->lightActivation->SetMinScreenSize(_minLightScreenSize);
+		view->lightActivation->SetMaxActiveLights(_maxActiveLights);
+		view->lightActivation->SetMaxProxyLights(_maxProxyLights);
+		view->lightActivation->SetProxyCellSize(_proxyCellSize);
+		_lightManager.AddChangeListener(view->lightActivation);
+		view->lightActivation->AddChangeListener(view->lightData);
+		_views.push_back(view);
+	}
+	return _views[viewIndex];
 }
 
-void ForwardPlusEngine::updateFPCamera(void)
+ForwardPlusView* ForwardPlusEngine::findView(const osg::Camera* camera)
 {
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_viewsMutex);
+
+	for (size_t i = 0; i < _views.size(); ++i)
+	{
+		if (camera && _views[i]->camera.get() == camera) return _views[i];
+	}
+	return 0;
+}
+
+void ForwardPlusEngine::updateFPCamera(ForwardPlusView& view)
+{
+	osg::Camera* pOsgCamera = view.camera.get();
+	if (pOsgCamera == 0 || pOsgCamera->getViewport() == 0)
+	{
+		return;
+	}
+
 	osg::Vec3d vEye, vCenter, vUp;
-	osg::Camera* pOsgCamera = _ig->getViewer()->getView(0)->getCamera();
 
 	double fovy, aspectRatio, zNear, zFar;
 	pOsgCamera->getProjectionMatrixAsPerspective(fovy, aspectRatio, zNear, zFar);
-	_fpCamera.SetPerspective(Math::ToRadians(fovy), aspectRatio, zNear, zFar);
+	view.fpCamera.SetPerspective(Math::ToRadians(fovy), aspectRatio, zNear, zFar);
 
 	pOsgCamera->getViewMatrixAsLookAt(vEye, vCenter, vUp);
-	_fpCamera.LookAt(OsgToFPUtils::toVector3_64(vEye), OsgToFPUtils::toVector3_64(vCenter), OsgToFPUtils::toVector3_64(vUp));
+	view.fpCamera.LookAt(OsgToFPUtils::toVector3_64(vEye), OsgToFPUtils::toVector3_64(vCenter), OsgToFPUtils::toVector3_64(vUp));
 
-	Matrix4_64 mat1 = _fpCamera.GetViewProjectionMatrix();
+	Matrix4_64 mat1 = view.fpCamera.GetViewProjectionMatrix();
 	Matrix4_64 mat2;
 	osg::Matrixd osgmat = pOsgCamera->getViewMatrix()*pOsgCamera->getProjectionMatrix();
 	for (int i = 0; i < 4; ++i)
@@ -90,21 +203,318 @@ void ForwardPlusEngine::updateFPCamera(void)
 	ASSERT_PREDICATE(mat1.IsEqual(mat2, 0.001));
 
 	osg::Viewport* viewport = pOsgCamera->getViewport();
-	_fpViewport = Vector2_uint32(viewport->width(), viewport->height());
+	view.fpViewport = Vector2_uint32(viewport->width(), viewport->height());
+}
+
+void ForwardPlusEngine::beginViewCull(ForwardPlusView& view, unsigned int frameNumber)
+{
+	// Only the cull of the view itself touches its list
+	view.visibleLightSources.clear();
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_viewsMutex);
+
+	// The first view culled in a frame sets up the sun/moon. The
+	// other lights are turned on from the marks of the views
+	if (_frameStarted && _frameNumber == frameNumber)
+	{
+		return;
+	}
+	_frameStarted = true;
+	_frameNumber = frameNumber;
+
+	setUpSunOrMoonLight();
+}
+
+void ForwardPlusEngine::endViewCull(ForwardPlusView& view, unsigned int frameNumber)
+{
+	bool allViewsCulled = true;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_viewsMutex);
+
+		updateFPCamera(view);
+		view.culledFrameNumber = frameNumber;
+
+		for (ForwardPlusViews::iterator itr = _views.begin(); itr != _views.end(); ++itr)
+		{
+			ForwardPlusView* other = *itr;
+			if (other->camera.valid() && other->culledFrameNumber != frameNumber)
+			{
+				allViewsCulled = false;
+				break;
+			}
+		}
+	}
+
+	// Views that are not culled in this frame are picked up
+	// by their state attribute at draw time instead
+	if (allViewsCulled)
+	{
+		updateViews(frameNumber);
+	}
+}
+
+void ForwardPlusEngine::updateViews(unsigned int frameNumber)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_viewsMutex);
+
+	_pendingViews.clear();
+	for (ForwardPlusViews::iterator itr = _views.begin(); itr != _views.end(); ++itr)
+	{
+		ForwardPlusView* view = *itr;
+		if (view->culledFrameNumber == frameNumber && view->updatedFrameNumber != frameNumber)
+		{
+			view->updatedFrameNumber = frameNumber;
+			_pendingViews.push_back(view);
+		}
+	}
+	if (_pendingViews.empty())
+	{
+		return;
+	}
+
+	applyLightSources(frameNumber);
+
+	// One commit of the shared light structure, which also hands the
+	// light changes to the light data of every view. The queries and
+	// the packing that follow only touch per view state
+	_lightManager.Commit();
+
+	OpenIG::Base::ThreadPool::instance()->parallelFor(_pendingViews.size(), boost::bind(&ForwardPlusEngine::cullViewRange, this, _1, _2), 1);
+}
+
+void ForwardPlusEngine::cullViewRange(size_t begin, size_t num)
+{
+	for (size_t i = begin; i < begin + num; ++i)
+	{
+		ForwardPlusView& view = *_pendingViews[i];
+
+		view.visibleLights.clear();
+		_lightManager.FindVisibleLights(&view.fpCamera, view.visibleLights);
+
+		// Bounds the lights the binning and the packing see, whatever
+		// the number of lights in the frustum
+		view.lightActivation->Apply(&view.fpCamera, view.fpViewport, view.visibleLights, view.activeLights);
+
+		view.tileSpaceLightGrid->Update(view.activeLights, &view.fpCamera, view.fpViewport);
+
+		packViewLights(view);
+	}
+}
+
+unsigned int ForwardPlusEngine::registerLightSource(osg::DummyLight* osgLight, Light* fpLight)
+{
+	ASSERT_PREDICATE(osgLight && fpLight);
+
+	OpenThreads::ScopedWriteLock lock(_lightSourcesMutex);
+
+	unsigned int index = 0;
+	if (!_freeLightSources.empty())
+	{
+		index = _freeLightSources.back();
+		_freeLightSources.pop_back();
+	}
+	else
+	{
+		index = (unsigned int)_lightSources.size();
+		_lightSources.push_back(ForwardPlusLightSource());
+	}
+
+	ForwardPlusLightSource& lightSource = _lightSources[index];
+	lightSource = ForwardPlusLightSource();
+	lightSource.osgLight = osgLight;
+	lightSource.fpLight = fpLight;
+
+	// Off until a view reaches it
+	fpLight->SetOn(false);
+
+	osgLight->setLightSourceIndex(index);
+	cacheLightSourceAttributes(lightSource);
+
+	return index;
+}
+
+void ForwardPlusEngine::unregisterLightSource(unsigned int index)
+{
+	OpenThreads::ScopedWriteLock lock(_lightSourcesMutex);
+
+	if (index >= _lightSources.size() || _lightSources[index].fpLight == 0)
+	{
+		return;
+	}
+
+	ForwardPlusLightSource& lightSource = _lightSources[index];
+	if (lightSource.on)
+	{
+		std::vector<unsigned int>::iterator itr = std::find(_onLightSources.begin(), _onLightSources.end(), index);
+		if (itr != _onLightSources.end())
+		{
+			*itr = _onLightSources.back();
+			_onLightSources.pop_back();
+		}
+	}
+
+	lightSource.osgLight->setLightSourceIndex(osg::DummyLight::InvalidLightSourceIndex);
+	lightSource = ForwardPlusLightSource();
+
+	_freeLightSources.push_back(index);
+}
+
+void ForwardPlusEngine::lightSourceChanged(unsigned int index)
+{
+	OpenThreads::ScopedWriteLock lock(_lightSourcesMutex);
+
+	if (index >= _lightSources.size() || _lightSources[index].fpLight == 0)
+	{
+		return;
+	}
+
+	cacheLightSourceAttributes(_lightSources[index]);
+}
+
+void ForwardPlusEngine::cacheLightSourceAttributes(ForwardPlusLightSource& lightSource)
+{
+	lightSource.enabled = false;
+	lightSource.osgLight->getUserValue("enabled", lightSource.enabled);
+
+	lightSource.lod = 0.0;
+	lightSource.osgLight->getUserValue("realLightLOD", lightSource.lod);
+
+	lightSource.attributesDirty = true;
+}
+
+size_t ForwardPlusEngine::getNumLightSources(void) const
+{
+	OpenThreads::ScopedReadLock lock(_lightSourcesMutex);
+
+	return _lightSources.size() - _freeLightSources.size();
 }
 
-void ForwardPlusEngine::updateFPEngine(void)
+void ForwardPlusEngine::markLightSourceVisible(ForwardPlusView& view, unsigned int index, const osg::Matrixd& worldMatrix, const osg::Vec3d& eye)
 {
-	updateFPCamera();
-	_lightManager.Update(&_fpCamera);
+	// Several views can cull at once, they only read
+	OpenThreads::ScopedReadLock lock(_lightSourcesMutex);
+
+	if (index >= _lightSources.size())
+	{
+		return;
+	}
+
+	const ForwardPlusLightSource& lightSource = _lightSources[index];
+	if (lightSource.fpLight == 0 || lightSource.enabled == false)
+	{
+		return;
+	}
+
+	// Only the coarse cut, the light activation of the view
+	// decides on the LOD with the hysteresis
+	if (_isLodCullingEnabled && lightSource.lod > 0.0)
+	{
+		osg::Vec4d vWorldPos = computeWorldPosition(lightSource.osgLight, worldMatrix);
+		osg::Vec3d vWorldPos3(vWorldPos.x(), vWorldPos.y(), vWorldPos.z());
+		double cullRange = lightSource.lod * _lodCullRangeScale;
+		if ((eye - vWorldPos3).length2() > cullRange * cullRange)
+		{
+			return;
+		}
+	}
+
+	view.visibleLightSources.push_back(VisibleLightSource());
+	view.visibleLightSources.back().index = index;
+	view.visibleLightSources.back().worldMatrix = worldMatrix;
 }
 
-void ForwardPlusEngine::turnAllFPLights(bool on)
+void ForwardPlusEngine::applyLightSources(unsigned int frameNumber)
 {
-	for (FPLightMap::const_iterator fpLightIter = _fplights.begin(); fpLightIter != _fplights.end(); ++fpLightIter)
+	OpenThreads::ScopedWriteLock lock(_lightSourcesMutex);
+
+	++_applyStamp;
+
+	for (ForwardPlusViews::iterator itr = _views.begin(); itr != _views.end(); ++itr)
 	{
-		Light* pLight = fpLightIter->second;
-		pLight->SetOn(on);
+		ForwardPlusView* view = *itr;
+		if (view->culledFrameNumber != frameNumber)
+		{
+			continue;
+		}
+
+		for (VisibleLightSources::const_iterator vitr = view->visibleLightSources.begin(); vitr != view->visibleLightSources.end(); ++vitr)
+		{
+			ForwardPlusLightSource& lightSource = _lightSources[vitr->index];
+
+			// The first view to reach a light source places it
+			if (lightSource.fpLight == 0 || lightSource.appliedStamp == _applyStamp)
+			{
+				continue;
+			}
+			lightSource.appliedStamp = _applyStamp;
+
+			Light* pFPLight = lightSource.fpLight;
+			OpenIG::Library::Graphics::LightType lightType = pFPLight->GetLightType();
+			if (lightType == OpenIG::Library::Graphics::LT_UNKNOWN)
+			{
+				continue;
+			}
+
+			if (lightSource.attributesDirty)
+			{
+				updateLightFromOsgLight(pFPLight, lightSource.osgLight);
+				pFPLight->SetLODRange(_isLodCullingEnabled ? (float)lightSource.lod : 0.f);
+				lightSource.attributesDirty = false;
+			}
+
+			if (lightType == OpenIG::Library::Graphics::LT_POINT || lightType == OpenIG::Library::Graphics::LT_SPOT)
+			{
+				pFPLight->SetPosition(OsgToFPUtils::toVector3_64(computeWorldPosition(lightSource.osgLight, vitr->worldMatrix)));
+			}
+			if (lightType == OpenIG::Library::Graphics::LT_SPOT || lightType == OpenIG::Library::Graphics::LT_DIRECTIONAL)
+			{
+				pFPLight->SetDirection(OsgToFPUtils::toVector3_64(computeWorldDirection(lightSource.osgLight, vitr->worldMatrix)));
+			}
+
+			pFPLight->SetOn(true);
+			if (!lightSource.on)
+			{
+				lightSource.on = true;
+				_onLightSources.push_back(vitr->index);
+			}
+		}
+	}
+
+	// Only the light sources that were on are visited to turn them off
+	for (size_t i = 0; i < _onLightSources.size(); )
+	{
+		ForwardPlusLightSource& lightSource = _lightSources[_onLightSources[i]];
+		if (lightSource.appliedStamp == _applyStamp)
+		{
+			++i;
+			continue;
+		}
+
+		lightSource.on = false;
+		lightSource.fpLight->SetOn(false);
+
+		_onLightSources[i] = _onLightSources.back();
+		_onLightSources.pop_back();
+	}
+}
+
+void ForwardPlusEngine::packViewLights(ForwardPlusView& view)
+{
+	Vector3_64 vEye = view.fpCamera.GetPosition();
+	if (vEye.GetDistance(view.lightData->GetOrigin()) > _lightDataOriginRebaseDistance)
+	{
+		view.lightData->SetOrigin(vEye);
+	}
+	view.lightData->UpdateLights(view.activeLights);
+
+	// The grid bins indices into the active lights, the shaders
+	// fetch the light records by their persistent slots
+	const VecInt32s& visibleSlots = view.lightData->GetVisibleSlots();
+	const int* tileLightIndexList = view.tileSpaceLightGrid->GetTileLightIndexListsPtr();
+	view.tileLightSlotList.resize(view.tileSpaceLightGrid->GetTotalTileLightIndexListLength());
+	for (size_t i = 0; i < view.tileLightSlotList.size(); ++i)
+	{
+		view.tileLightSlotList[i] = visibleSlots[tileLightIndexList[i]];
 	}
 }
 
@@ -118,8 +528,6 @@ void ForwardPlusEngine::setUpSunOrMoonLight()
 		return;
 	}
 
-	const osg::Matrixd& viewMatrix = openIG->getViewer()->getView(0)->getCamera()->getViewMatrix();
-
 	static const unsigned int id = 0; // PPP: Reserved
 
 	FPLightMap::const_iterator it = _fplights.find(id);
@@ -130,7 +538,7 @@ void ForwardPlusEngine::setUpSunOrMoonLight()
 		float fCustomFloats[3];
 		fCustomFloats[0] = 99; fCustomFloats[1] = 0; fCustomFloats[2] = 0;
 		pFPLight->SetCustomFloats(fCustomFloats);
-		pFPLight->GetUserObjectBindings().SetUserAny("id", id);
+		pFPLight->SetUserID(id);
 		_fplights.insert(std::make_pair(id, pFPLight));
 	}
 	else
@@ -171,89 +579,14 @@ void ForwardPlusEngine::setUpSunOrMoonLight()
 	pFPLight->SetDiffuseColor(OsgToFPUtils::toColorValue(sunOrMoonColor));
 	pFPLight->SetSpecularColor(OsgToFPUtils::toColorValue(sunOrMoonColor));
 
-	osg::Vec3d vViewSpaceDir = computeViewSpaceDirection(osg::Vec4d(0, 0, 0, 1), sunOrMoonPosition, viewMatrix);
-	vViewSpaceDir.normalize();
-	pFPLight->SetVec3_32_2(Vector3_32((float)-vViewSpaceDir.x(), -vViewSpaceDir.y(), -vViewSpaceDir.z()));
+	// The light data carries world directions, transformed to view space in the shaders
+	osg::Vec3d vWorldDir = -osg::Vec3d(sunOrMoonPosition);
+	vWorldDir.normalize();
+	pFPLight->SetDirection(OsgToFPUtils::toVector3_64(vWorldDir));
 
 	pFPLight->SetOn(true);	
 }
 
-bool ForwardPlusEngine::isLodCulled(osg::DummyLight* pLight, const osg::Vec3d& vWorldPos, const osg::Vec3d& vEyePos)
-{
-	double lod = 0.0;
-	if (pLight->getUserValue("realLightLOD", lod) && lod > 0.0)
-	{
-		if ((vEyePos - vWorldPos).length() > lod)
-		{
-			return true;
-		}
-	}
-	return false;
-}
-
-osg::Matrix ForwardPlusEngine::computeWorldMatrix(osg::LightSource* lightSource, osgUtil::CullVisitor* cv)
-{
-	if (lightSource->getDataVariance() == osg::Object::STATIC)
-	{
-		osg::RefMatrix* rmx = dynamic_cast<osg::RefMatrix*>(lightSource->getUserData());
-		if (rmx != NULL)
-		{
-			return *rmx;
-		}
-	}
-
-#if 0
-	osg::NodePath np;
-	np.push_back(lightSource);
-
-	osg::ref_ptr<osg::Group> parent = lightSource->getNumParents() ? lightSource->getParent(0) : 0;
-	while (parent)
-	{
-		np.insert(np.begin(), parent);
-		parent = parent->getNumParents() ? parent->getParent(0) : 0;
-	}
-
-	osg::Matrixd mx = osg::computeLocalToWorld(np);
-#else
-        osg::Matrixd mx = osg::computeLocalToWorld(cv->getNodePath());
-#endif
-	if (lightSource->getDataVariance() == osg::Object::STATIC)
-	{
-		lightSource->setUserData(new osg::RefMatrixd(mx));
-	}
-	return mx;
-}
-
-#if 0
-void ForwardPlusEngine::findOsgLightsAndMatrices(LightsToModelViewMatrices& lmv, LightsToWorldMatrices& lw, osgUtil::RenderStage* rs)
-{
-	osgUtil::PositionalStateContainer::AttrMatrixList& aml = rs->getPositionalStateContainer()->getAttrMatrixList();
-
-	for (osgUtil::PositionalStateContainer::AttrMatrixList::iterator itr = aml.begin(); itr != aml.end(); ++itr)
-	{
-		const osg::DummyLight* light = dynamic_cast<const osg::DummyLight*>(itr->first.get());
-		if (light == 0)
-		{
-			continue;
-		}
-		osg::DummyLight* ncLight = const_cast<osg::DummyLight*>(light);
-		osg::LightSource* lightSource = ncLight->getLightSource();
-		if (lightSource == 0)
-		{
-			continue;
-		}
-
-		osg::RefMatrixd *refMatrix = itr->second.get();
-
-		lmv.insert(std::make_pair(ncLight, osg::Matrixd(refMatrix ? *refMatrix : osg::Matrix::identity())));
-
-		osg::Matrixd worldMatrix = computeWorldMatrix(lightSource);
-
-		lw.insert(std::make_pair(ncLight, worldMatrix));
-	}
-}
-#endif
-
 osg::Vec4d ForwardPlusEngine::computeWorldPosition(osg::DummyLight* light, const osg::Matrixd& worldMatrix)
 {
 	return osg::Vec4d(light->getPosition().x(), light->getPosition().y(), light->getPosition().z(), 1)*worldMatrix;
@@ -276,28 +609,6 @@ osg::Vec3d ForwardPlusEngine::computeWorldDirection(osg::DummyLight* light, cons
 	return litDir;
 }
 
-osg::Vec4d ForwardPlusEngine::computeViewSpacePosition(const osg::Vec4d& worldPos, const osg::Matrixd& viewMatrix)
-{
-	return worldPos*viewMatrix;
-}
-
-osg::Vec3d ForwardPlusEngine::computeViewSpaceDirection(const osg::Vec4d& worldPos, const osg::Vec3d& worldDirection, const osg::Matrixd& viewMatrix)
-{
-	osg::Vec4d pos1 = worldPos*viewMatrix;
-	pos1.w() = 1;
-
-	osg::Vec4d pos2 = worldPos + osg::Vec4d(worldDirection, 1);
-	pos2.w() = 1;
-	pos2 = pos2*viewMatrix;
-	pos2.w() = 1;
-
-	osg::Vec4d litDir4 = pos2 - pos1;
-	osg::Vec3d litDir(litDir4.x(), litDir4.y(), litDir4.z());
-
-	litDir.normalize();
-	return litDir;
-}
-
 void ForwardPlusEngine::updateLightFromOsgLight(Light* pFPLight, osg::DummyLight* pOsgLight)
 {
 	ASSERT_PREDICATE(pFPLight && pOsgLight);
@@ -325,80 +636,3 @@ void ForwardPlusEngine::updateLightFromOsgLight(Light* pFPLight, osg::DummyLight
 		pFPLight->SetSpotLightAngles(fSpotInnerAngle, fSpotOuterAngle);
 	}
 }
-
-bool ForwardPlusEngine::apply(osg::LightSource* lightSource, osgUtil::CullVisitor* cv)
-{
-	EXTRA_LOGGING_STATIC_HANDLER
-
-	osg::DummyLight* pLight = dynamic_cast<osg::DummyLight*>(lightSource->getLight());
-	if (pLight == NULL) return false;
-
-	bool enabled = false;
-	pLight->getUserValue("enabled", enabled);
-	if (enabled == false) return false;
-			
-	const osg::Matrixd& worldMatrix = computeWorldMatrix(lightSource, cv);	
-	const osg::Matrixd& viewMatrix = _ig->getViewer()->getView(0)->getCamera()->getViewMatrix();
-
-	osg::Vec3d eye;
-	osg::Vec3d ignore;
-	_ig->getViewer()->getView(0)->getCamera()->getViewMatrixAsLookAt(eye,ignore,ignore);
-
-	osg::Vec4d vWorldPos = computeWorldPosition(pLight, worldMatrix);
-	osg::Vec3d vWorldDir = computeWorldDirection(pLight, worldMatrix);
-
-	osg::Vec4d vViewSpacePos = computeViewSpacePosition(vWorldPos, viewMatrix);
-	osg::Vec3d vViewSpaceDir = computeViewSpaceDirection(vWorldPos, vWorldDir, viewMatrix);
-
-	osg::Vec3d vWorldPos3(osg::Vec3d(vWorldPos.x(), vWorldPos.y(), vWorldPos.z()));
-
-	if (_isLodCullingEnabled)
-	{
-		bool bIsLodCulled = isLodCulled(pLight, vWorldPos3, eye);
-		if (bIsLodCulled) return false;		
-	}
-
-	FPLightMapIterator fpIter = _fplights.find(pLight->getLightNum());
-	ASSERT_PREDICATE(fpIter != _fplights.end());
-
-	Light* pFPLight = fpIter->second;
-	if (pFPLight->GetLightType() == OpenIG::Library::Graphics::LT_UNKNOWN) return false;
-
-	pFPLight->SetOn(true);
-
-#if EXTRA_LOGGING
-	++numOfLightsEnabled;
-#endif
-
-	updateLightFromOsgLight(pFPLight, pLight);
-
-	if (pFPLight->GetLightType() == OpenIG::Library::Graphics::LT_POINT || pFPLight->GetLightType() == OpenIG::Library::Graphics::LT_SPOT)
-	{
-		pFPLight->SetPosition(OsgToFPUtils::toVector3_64(vWorldPos));
-	}
-	if (pFPLight->GetLightType() == OpenIG::Library::Graphics::LT_SPOT || pFPLight->GetLightType() == OpenIG::Library::Graphics::LT_DIRECTIONAL)
-	{
-		pFPLight->SetDirection(OsgToFPUtils::toVector3_64(vWorldDir));
-	}
-
-	pFPLight->SetVec3_32_1(Vector3_32((float)vViewSpacePos.x(), vViewSpacePos.y(), vViewSpacePos.z()));
-	pFPLight->SetVec3_32_2(Vector3_32((float)vViewSpaceDir.x(), vViewSpaceDir.y(), vViewSpaceDir.z()));	
-
-#if 0
-	if (_rampTexture.valid())
-	{
-		static bool once = true;
-		static const int textureSlot = 8;
-		if (once)
-		{
-			once = false;
-
-			_scene->getOrCreateStateSet()->setTextureAttribute(textureSlot, _rampTexture);
-			_scene->getOrCreateStateSet()->addUniform(new osg::Uniform("rampTexture", textureSlot));
-		}
-	}
-#endif
-
-	return true;
-}
-
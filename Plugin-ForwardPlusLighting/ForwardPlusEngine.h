@@ -34,9 +34,16 @@
 
 #include <Core-Base/ImageGenerator.h>
 
+#include <osg/Camera>
+
+#include <OpenThreads/ReadWriteMutex>
+
+#include <vector>
+
 #include <Library-Graphics/CommonUtils.h>
 #include <Library-Graphics/LightManager.h>
 #include <Library-Graphics/LightData.h>
+#include <Library-Graphics/LightActivation.h>
 #include <Library-Graphics/TileSpaceLightGrid.h>
 #include <Library-Graphics/Camera.h>
 
@@ -48,8 +55,70 @@ using namespace OpenIG::Library::Graphics;
 namespace OpenIG {
 	namespace Plugins {
 
-		typedef boost::unordered_map<osg::DummyLight*, osg::Matrixd> LightsToModelViewMatrices;
-		typedef boost::unordered_map<osg::DummyLight*, osg::Matrixd> LightsToWorldMatrices;
+		// An osg::LightSource registered once with the engine. The cull
+		// only marks it visible by its index, the rest is resolved once
+		// per frame in the update of the views
+		struct ForwardPlusLightSource
+		{
+			ForwardPlusLightSource();
+
+			osg::DummyLight*							osgLight;
+			Light*										fpLight;
+
+			// Cached from the user values of the light on every change
+			bool										enabled;
+			double										lod;
+			bool										attributesDirty;
+
+			bool										on;
+			unsigned int								appliedStamp;
+		};
+		typedef std::vector<ForwardPlusLightSource>		ForwardPlusLightSources;
+
+		// A light source a view culled, with the world matrix
+		// taken from the model view the cull visitor was at
+		struct VisibleLightSource
+		{
+			unsigned int								index;
+			osg::Matrixd								worldMatrix;
+		};
+		typedef std::vector<VisibleLightSource>			VisibleLightSources;
+
+		// The Forward+ state of one view. The lights are queried from
+		// the shared LightManager, binned and packed per view, and the
+		// view uploads the results through its own state attribute
+		struct ForwardPlusView
+		{
+			ForwardPlusView(unsigned int viewIndex);
+			~ForwardPlusView();
+
+			unsigned int								index;
+			osg::observer_ptr<osg::Camera>				camera;
+			osg::ref_ptr<LightManagerStateAttribute>	stateAttribute;
+
+			Camera_64									fpCamera;
+			Vector2_uint32								fpViewport;
+
+			// Cleared, but never shrunk, on every cull of the view
+			VisibleLightSources							visibleLightSources;
+
+			VectorLights								visibleLights;
+
+			// The visible lights within their LOD and screen size, followed
+			// by the proxies of the rest. Only these are binned and packed
+			LightActivation*							lightActivation;
+			VectorLights								activeLights;
+
+			LightData*									lightData;
+			TileSpaceLightGrid*							tileSpaceLightGrid;
+
+			// The tile light index list remapped from visible light indices to light data slots
+			VecInt32s									tileLightSlotList;
+
+			unsigned int								culledFrameNumber;
+			unsigned int								updatedFrameNumber;
+		};
+		typedef std::vector<ForwardPlusView*>			ForwardPlusViews;
 
 		class ForwardPlusEngine
 		{
@@ -58,11 +127,9 @@ namespace OpenIG {
 				OpenIG::Base::ImageGenerator* ig, 
 				osg::Group* scene, 
 				LightManager& lightManager, 
-				FPLightMap& fplights, 
-				LightData& lightData, 
-				TileSpaceLightGrid& tileSpaceLightGrid
+				FPLightMap& fplights
 			);
-			
+			~ForwardPlusEngine();
 			
 		protected:
 			osg::observer_ptr<osg::Group>		_scene;
@@ -70,11 +137,12 @@ namespace OpenIG {
 
 			LightManager&						_lightManager;
 			FPLightMap&							_fplights;
-			LightData&							_lightData;
-			TileSpaceLightGrid&					_tileSpaceLightGrid;
 
-			Camera_64							_fpCamera;
-			Vector2_uint32						_fpViewport;
+			ForwardPlusViews					_views;
+			ForwardPlusViews					_pendingViews;
+			unsigned int						_frameNumber;
+			bool								_frameStarted;
+			OpenThreads::Mutex					_viewsMutex;
 
 			osg::ref_ptr<osg::Image>            _rampImage;
 			osg::ref_ptr<osg::Texture2D>        _rampTexture;
@@ -82,9 +150,62 @@ namespace OpenIG {
 			OpenThreads::Mutex					_updateSunMoonMutex;
 			bool								_isLodCullingEnabled;
 
+			// Applied to the light activation of every view
+			float								_lodHysteresis;
+			float								_minLightScreenSize;
+			unsigned int						_maxActiveLights;
+			unsigned int						_maxProxyLights;
+			double								_proxyCellSize;
+
+			// The cull drops the light sources beyond their LOD range times
+			// this. Past the LOD range they only feed the proxies
+			double								_lodCullRangeScale;
+
+			// The flat table of the light sources, indexed by the
+			// light source index kept in their DummyLight. Registering
+			// on the update can reallocate it while the views cull, so
+			// the cull reads under the read lock and the rest writes
+			mutable OpenThreads::ReadWriteMutex	_lightSourcesMutex;
+			ForwardPlusLightSources				_lightSources;
+			std::vector<unsigned int>			_freeLightSources;
+			std::vector<unsigned int>			_onLightSources;
+			unsigned int						_applyStamp;
+
+			void cullViewRange(size_t begin, size_t num);
+			void packViewLights(ForwardPlusView& view);
+
+			// Turns on the light sources marked by the views culled in the
+			// frame, with their world positions, and off the rest
+			void applyLightSources(unsigned int frameNumber);
+			void cacheLightSourceAttributes(ForwardPlusLightSource& lightSource);
+			void updateLightFromOsgLight(Light* pFPLight, osg::DummyLight* pOsgLight);
+
 		public:
-			void updateFPCamera(void);
-			void updateFPEngine(void);
+			// Called by the cull callback of each view around its traversal
+			void beginViewCull(ForwardPlusView& view, unsigned int frameNumber);
+			void endViewCull(ForwardPlusView& view, unsigned int frameNumber);
+
+			// Queries, bins and packs the lights of the views culled in this frame,
+			// in parallel across the views. Safe to call more than once per frame
+			void updateViews(unsigned int frameNumber);
+
+			ForwardPlusView* getOrCreateView(unsigned int viewIndex);
+
+			// The view drawn by the camera, NULL for none
+			ForwardPlusView* findView(const osg::Camera* camera);
+			size_t getNumViews(void) const { return _views.size(); }
+
+			// Called by the light implementation callback as the lights come and go.
+			// The returned index is kept in the DummyLight of the light source
+			unsigned int registerLightSource(osg::DummyLight* osgLight, Light* fpLight);
+			void unregisterLightSource(unsigned int index);
+			void lightSourceChanged(unsigned int index);
+
+			// Called by the cull visitor on the light sources it reaches, on the cull thread of the view
+			void markLightSourceVisible(ForwardPlusView& view, unsigned int index, const osg::Matrixd& worldMatrix, const osg::Vec3d& eye);
+			size_t getNumLightSources(void) const;
+
+			void updateFPCamera(ForwardPlusView& view);
 			void packLights(void);
 			void updateLightDataTBO();
 			void updateTileLightGridOffsetAndSizeTBO();
@@ -93,21 +214,10 @@ namespace OpenIG {
 			void updateTiledShadingStuff(void);
 			void initializeRampTexture(void);
 			void setUpSunOrMoonLight();		
-			void turnAllFPLights(bool on);
-			bool isLodCulled(osg::DummyLight* pLight, const osg::Vec3d& vWorldPos, const osg::Vec3d& vEyePos);
-			void findOsgLightsAndMatrices(LightsToModelViewMatrices& lmv, LightsToWorldMatrices& lw, osgUtil::RenderStage* rs);
-			void updateLightFromOsgLight(Light* pFPLight, osg::DummyLight* pOsgLight);
-			bool apply(osg::LightSource* lightSource, osgUtil::CullVisitor* cv);
 
-			osg::Matrix computeWorldMatrix(osg::LightSource* lightSource, osgUtil::CullVisitor* cv);
 			osg::Vec4d	computeWorldPosition(osg::DummyLight* light, const osg::Matrixd& worldMatrix);
 			osg::Vec3d	computeWorldDirection(osg::DummyLight* light, const osg::Matrixd& worldMatrix);
-			osg::Vec4d	computeViewSpacePosition(const osg::Vec4d& worldPos, const osg::Matrixd& viewMatrix);
-			osg::Vec3d	computeViewSpaceDirection(const osg::Vec4d& worldPos, const osg::Vec3d& worldDirection, const osg::Matrixd& viewMatrix);
 
-			Camera_64*		getFPCamera()	{ return &_fpCamera; }
-			Vector2_uint32* getFPViewport()	{ return &_fpViewport; }
-			
 		};
 	} // namespace
 } // namespace
@@ -36,6 +36,7 @@
 #include "DummyLight.h"
 #include "OSGtoFPUtils.h"
 #include "ForwardPlusEngine.h"
+#include "ForwardPlusCullVisitor.h"
 
 #include <Core-Base/ImageGenerator.h>
 #include <Core-Base/Configuration.h>
@@ -63,8 +64,6 @@
 using namespace OpenIG::Plugins;
 using namespace OpenIG::Library::Graphics;
 
-static const std::string strTilingParamsUniform = "vTilingParams";
-
 
 ForwardPlusLightImplementationCallback::ForwardPlusLightImplementationCallback(OpenIG::Base::ImageGenerator* ig)
 	: _ig(ig)	
@@ -72,21 +71,13 @@ ForwardPlusLightImplementationCallback::ForwardPlusLightImplementationCallback(O
 {
 	_lightManager = new LightManager();
 
-	_lightData = new LightData(341, FORMAT_R32G32B32A32_FLOAT);
-
-	Vector2_uint32 tileSize(32, 32);
-	_tileSpaceLightGrid = new TileSpaceLightGrid(tileSize);
-	_tileSpaceLightGrid->SetScreenAreaCullSize(tileSize*2);	
-	
-	_fpEngine = new ForwardPlusEngine(_ig, _ig->getScene()->asGroup(), *_lightManager, _fplights, *_lightData, *_tileSpaceLightGrid);	
+	_fpEngine = new ForwardPlusEngine(_ig, _ig->getScene()->asGroup(), *_lightManager, _fplights);	
 }
 
 ForwardPlusLightImplementationCallback::~ForwardPlusLightImplementationCallback()
 {
-	SAFE_DELETE(_tileSpaceLightGrid);
-	SAFE_DELETE(_lightData);
-	SAFE_DELETE(_lightManager);
 	SAFE_DELETE(_fpEngine);
+	SAFE_DELETE(_lightManager);
 }
 
 void ForwardPlusLightImplementationCallback::setInitialOSGLightParameters(osg::Light* light, const OpenIG::Base::LightAttributes& definition, const osg::Vec4d& pos, const osg::Vec3f& dir)
@@ -197,6 +188,8 @@ OpenIG::Library::Graphics::LightType ForwardPlusLightImplementationCallback::toF
 	return OpenIG::Library::Graphics::LT_UNKNOWN;
 }
 
+// The view is told by the camera being culled, the
+// scene root can be shared by the views
 struct ForwardPlusEngineCullCallback : public osg::NodeCallback
 {
 	ForwardPlusEngineCullCallback(ForwardPlusEngine* fpEngine)
@@ -206,36 +199,70 @@ struct ForwardPlusEngineCullCallback : public osg::NodeCallback
 
 	virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
 	{
-		_fpEngine->turnAllFPLights(false);
-		_fpEngine->setUpSunOrMoonLight();
+		osgUtil::CullVisitor* cullVisitor = dynamic_cast<osgUtil::CullVisitor*>(nv);
+		ForwardPlusView* fpView = cullVisitor ? _fpEngine->findView(cullVisitor->getCurrentCamera()) : 0;
+		if (fpView == 0)
+		{
+			traverse(node, nv);
+			return;
+		}
+
+		unsigned int frameNumber = nv->getFrameStamp() ? nv->getFrameStamp()->getFrameNumber() : 0;
+
+		_fpEngine->beginViewCull(*fpView, frameNumber);
+
+		ForwardPlusCullVisitor* cv = dynamic_cast<ForwardPlusCullVisitor*>(nv);
+		if (cv) cv->setView(fpView);
 
 		traverse(node, nv);
 
-		_fpEngine->updateFPEngine();		
+		if (cv) cv->setView(0);
+
+		_fpEngine->endViewCull(*fpView, frameNumber);
 	}
 
 protected:
 	ForwardPlusEngine*	_fpEngine;
 };
 
-osg::Referenced* ForwardPlusLightImplementationCallback::createLight(unsigned int id, const OpenIG::Base::LightAttributes& definition, osg::Group* lightsGroup)
+void ForwardPlusLightImplementationCallback::setUpViews()
 {
-	// special case, light ID==0, the sun/moon light
-	if (id == 0)
+	osgViewer::CompositeViewer* viewer = _ig->getViewer();
+	for (unsigned int i = 0; i < viewer->getNumViews(); ++i)
 	{
-		osg::Node* root = _ig->getViewer()->getView(0)->getSceneData();
+		osg::Group* root = viewer->getView(i)->getSceneData() ? viewer->getView(i)->getSceneData()->asGroup() : 0;
+		if (root == 0)
+		{
+			continue;
+		}
+
+		// Each view gets its own lights query, tile grid and
+		// TBOs, all fed from the one LightManager
+		ForwardPlusView* fpView = _fpEngine->getOrCreateView(i);
+		fpView->camera = viewer->getView(i)->getCamera();
+
 		if (root->getCullCallback() == NULL)
 		{
 			root->setCullCallback(new ForwardPlusEngineCullCallback(_fpEngine));
 		}
 
-		if (_lightManagerStateAttribute.valid() == false)
+		// On the camera, the scene root can be shared by the views
+		// and the attribute sets the uniforms of its view in draw
+		if (fpView->stateAttribute.valid() == false)
 		{
-			_lightManagerStateAttribute = new LightManagerStateAttribute();
-			_lightManagerStateAttribute->set(_lightManager, _fpEngine->getFPCamera(), _fpEngine->getFPViewport(), _ig->getScene()->asGroup(), _ig);
-			osg::StateSet* stateset = _ig->getScene()->asGroup()->getOrCreateStateSet();
-			stateset->setAttribute(_lightManagerStateAttribute, osg::StateAttribute::ON);
+			fpView->stateAttribute = new LightManagerStateAttribute();
+			fpView->stateAttribute->set(_fpEngine, fpView, _ig);
+			fpView->stateAttribute->addToStateSet(fpView->camera->getOrCreateStateSet());
 		}
+	}
+}
+
+osg::Referenced* ForwardPlusLightImplementationCallback::createLight(unsigned int id, const OpenIG::Base::LightAttributes& definition, osg::Group* lightsGroup)
+{
+	// special case, light ID==0, the sun/moon light
+	if (id == 0)
+	{
+		setUpViews();
 		return 0;
 	}
 
@@ -263,9 +290,12 @@ osg::Referenced* ForwardPlusLightImplementationCallback::createLight(unsigned in
 	Light* pFPLight = _lightManager->CreateLight(toFPLightType(definition.lightType));
 
 	// the original code didn't actually update the lights (or create them for that matter) in the tbo, so this is all we are going to set for now
-	pFPLight->GetUserObjectBindings().SetUserAny("id", id);
+	pFPLight->SetUserID(id);
 	_fplights.insert(std::make_pair(id, pFPLight));
 
+	// The cull only marks the light source visible by this index
+	_fpEngine->registerLightSource(osgLight, pFPLight);
+
 	osg::ref_ptr<osg::StateAttribute> attr = lightSource->getOrCreateStateSet()->getAttribute(osg::StateAttribute::LIGHT);
 	if (attr.valid())
 	{
@@ -276,19 +306,7 @@ osg::Referenced* ForwardPlusLightImplementationCallback::createLight(unsigned in
 	_lightSourcesMap[id] = lightSource;
 	_lightsGroup = lightsGroup;	
 
-	osg::Node* root = _ig->getViewer()->getView(0)->getSceneData();
-	if (root->getCullCallback() == NULL)
-	{
-		root->setCullCallback(new ForwardPlusEngineCullCallback(_fpEngine));
-	}
-
-	if (_lightManagerStateAttribute.valid()==false)
-	{
-		_lightManagerStateAttribute = new LightManagerStateAttribute();
-		_lightManagerStateAttribute->set(_lightManager, _fpEngine->getFPCamera(), _fpEngine->getFPViewport(), _ig->getScene()->asGroup(), _ig);
-		osg::StateSet* stateset =  _ig->getScene()->asGroup()->getOrCreateStateSet();
-		stateset->setAttribute(_lightManagerStateAttribute, osg::StateAttribute::ON);
-	}	
+	setUpViews();
 
 	return lightSource;
 }
@@ -318,8 +336,12 @@ void ForwardPlusLightImplementationCallback::updateLight(unsigned int id, const
 
 	updateOSGLightParameters(light, definition);
 
-	// PPP: The original code didn't really update the light parameters that were set above, but just set the light id and then updated
-	// based upon the raw DummyLight parameters. So we are not going to do anything for now
+	// The Forward+ light picks up the new parameters the next time a view reaches it
+	osg::DummyLight* dl = dynamic_cast<osg::DummyLight*>(light);
+	if (dl)
+	{
+		_fpEngine->lightSourceChanged(dl->getLightSourceIndex());
+	}
 }
 
 void ForwardPlusLightImplementationCallback::deleteLight(unsigned int id)
@@ -329,6 +351,11 @@ void ForwardPlusLightImplementationCallback::deleteLight(unsigned int id)
 	{
 		return;
 	}
+	osg::DummyLight* dl = dynamic_cast<osg::DummyLight*>(itr->second->getLight());
+	if (dl)
+	{
+		_fpEngine->unregisterLightSource(dl->getLightSourceIndex());
+	}
 	_lightSourcesMap.erase(itr);
 
 	FPLightMap::iterator fpitr = _fplights.find(id);
@@ -61,8 +61,6 @@ namespace OpenIG {
 		namespace Graphics {
 			class Light;
 			class LightManager;
-			class LightData;
-			class TileSpaceLightGrid;
 		}
 	}
 }
@@ -98,11 +96,11 @@ namespace OpenIG {
 			OpenIG::Library::Graphics::LightManager*		_lightManager;
 			LightSourcesMap									_lightSourcesMap;
 			FPLightMap										_fplights;
-			OpenIG::Library::Graphics::LightData*			_lightData;
-			OpenIG::Library::Graphics::TileSpaceLightGrid*	_tileSpaceLightGrid;
-			osg::ref_ptr<LightManagerStateAttribute>		_lightManagerStateAttribute;
 			ForwardPlusEngine*								_fpEngine;
 
+			// Attaches the Forward+ cull callback and state attribute to the views without them
+			void setUpViews();
+
 			void setInitialOSGLightParameters(
 						osg::Light* light, 
 						const OpenIG::Base::LightAttributes& definition, 
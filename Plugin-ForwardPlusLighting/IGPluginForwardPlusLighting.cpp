@@ -45,9 +45,12 @@
 #include <Core-Base/Commands.h>
 #include <Core-Base/StringUtils.h>
 #include <Core-Base/FileSystem.h>
+#include <Core-Base/FileWatcher.h>
 
 #include <Library-Graphics/LightManager.h>
 
+#include <Core-Utils/ShaderUtils.h>
+
 #include <osg/Version>
 #include <osg/ref_ptr>
 #include <osg/LightSource>
@@ -83,6 +86,7 @@
 #include <ctime>
 
 #include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 
 #include "DummyLight.h"
@@ -106,8 +110,7 @@ namespace OpenIG {
 				, _lightBrightness_day(1.f)
 				, _lightBrightness_night(1.f)
 				, _todHour(12)
-				, _xmlFileObserverThreadRunning(false)
-				, _xmlFileObserverThreadRunningCondition(false)
+				, _xmlSubscription(0)
 			{
 			}
 
@@ -138,7 +141,13 @@ namespace OpenIG {
 
 					if (child->name == "Material")
 					{
-						_sceneMaterial = new osg::Material;
+						// changed in place on reload, it is
+						// already set on the scene stateset
+						if (!_sceneMaterial.valid())
+						{
+							_sceneMaterial = new osg::Material;
+							_sceneMaterial->setDataVariance(osg::Object::DYNAMIC);
+						}
 
 						osgDB::XmlNode::Children::iterator citr = child->children.begin();
 						for (; citr != child->children.end(); ++citr)
@@ -195,6 +204,10 @@ namespace OpenIG {
 				}
 			}
 
+			// The material is updated live. Max-Num-Of-Lights is
+			// compiled in the shaders and takes a restart
+			virtual bool isConfigReloadable() { return true; }
+
 			class EffectsCommand : public OpenIG::Base::Commands::Command
 			{
 			public:
@@ -236,7 +249,7 @@ namespace OpenIG {
 
 						if (_ig->getEntityMap().count(id) == 0) return -1;
 
-						OpenIG::Base::ImageGenerator::Entity& entity = _ig->getEntityMap()[id];
+						OpenIG::Base::ImageGenerator::Entity entity = _ig->getEntityMap().get(id);
 						if (!entity.valid()) return -1;
 
 						std::map< std::string, std::string > e2d;
@@ -361,33 +374,34 @@ namespace OpenIG {
 				// that will find out our ShadowedScene
 				// osg::Program. Nick
 				osgViewer::CompositeViewer* viewer = context.getImageGenerator()->getViewer();
-				osgViewer::Renderer* renderer = dynamic_cast<osgViewer::Renderer*>(viewer->getView(0)->getCamera()->getRenderer());
-				if (renderer == 0)
+				for (unsigned int i = 0; i < viewer->getNumViews(); ++i)
 				{
-					return;
-				}
+					// Every view feeds the lights it reaches
+					// into its own Forward+ light query
+					osgViewer::Renderer* renderer = dynamic_cast<osgViewer::Renderer*>(viewer->getView(i)->getCamera()->getRenderer());
+					if (renderer == 0)
+					{
+						continue;
+					}
 
-				osgUtil::SceneView* sv = renderer->getSceneView(0);
-				if (sv == 0)
-				{
-					return;
-				}
+					osgUtil::SceneView* sv = renderer->getSceneView(0);
+					if (sv == 0)
+					{
+						continue;
+					}
 
-#if 1
-				sv->setCullVisitor(new ForwardPlusCullVisitor(fpEngine));
-				osg::notify(osg::NOTICE) << "ForwardPlusLighting: default CullVisitor replaced in SceneView 0" << std::endl;
-#endif
+					sv->setCullVisitor(new ForwardPlusCullVisitor(fpEngine));
+					osg::notify(osg::NOTICE) << "ForwardPlusLighting: default CullVisitor replaced in SceneView 0 of view " << i << std::endl;
 
-				sv = renderer->getSceneView(1);
-				if (sv == 0)
-				{
-					return;
-				}
+					sv = renderer->getSceneView(1);
+					if (sv == 0)
+					{
+						continue;
+					}
 
-#if 1
-				sv->setCullVisitor(renderer->getSceneView(0)->getCullVisitor());
-				osg::notify(osg::NOTICE) << "ForwardPlusLighting: default CullVisitor replaced in SceneView 1" << std::endl;
-#endif
+					sv->setCullVisitor(renderer->getSceneView(0)->getCullVisitor());
+					osg::notify(osg::NOTICE) << "ForwardPlusLighting: default CullVisitor replaced in SceneView 1 of view " << i << std::endl;
+				}
 			}
 
 			ForwardPlusCullVisitor* getCullVisitor(OpenIG::PluginBase::PluginContext& context)
@@ -411,49 +425,37 @@ namespace OpenIG {
 
 			void setupShaders(OpenIG::PluginBase::PluginContext& context)
 			{
-				std::string strSource;
-
 				std::string resourcesPath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../resources");
 
-				std::string strLogZDepthBuffer = OpenIG::Base::Configuration::instance()->getConfig("LogZDepthBuffer","yes");
-				if (strLogZDepthBuffer.compare(0, 3, "yes") == 0)
+				std::stringstream ssMAX_LIGHTS_PER_PIXEL;ssMAX_LIGHTS_PER_PIXEL<<_maxNumLightsPerPixel;
+
+				osg::ShaderProgramRegistry::Description description("forwardplus_program");
+				description
+					.addShader(osg::Shader::VERTEX)
+						.addSource("#version 130\n")
+						.addFile(resourcesPath + "/shaders/forwardplus_vs.glsl")
+					.addShader(osg::Shader::FRAGMENT)
+						.addFile(resourcesPath + "/shaders/forwardplus_preamble.glsl")
+						.addFile(resourcesPath + "/shaders/forwardplus_ps.glsl")
+						.addFile(resourcesPath + "/shaders/lighting_math.glsl")
+						.addFile(resourcesPath + "/shaders/forwardplus_math.glsl")
+					.addShader(osg::Shader::VERTEX)
+						.addFile(resourcesPath + "/shaders/shadow_vs.glsl")
+					.addShader(osg::Shader::FRAGMENT)
+						.addFile(resourcesPath + "/shaders/shadow_ps.glsl")
+					.addDefine("MAX_LIGHTS_PER_PIXEL", ssMAX_LIGHTS_PER_PIXEL.str());
+
+				if (osg::ShaderUtils::useLogZDepthBuffer())
 				{
-					strLogZDepthBuffer = std::string("#define USE_LOG_DEPTH_BUFFER\n");
+					description.addDefine("USE_LOG_DEPTH_BUFFER");
 				}
-				else
+
+				osg::ref_ptr<osg::Program> program = osg::ShaderProgramRegistry::instance()->getOrCreateProgram(description);
+				if (!program.valid())
 				{
-					strLogZDepthBuffer="";
+					return;
 				}
 
-
-				strSource = 
-					std::string("#version 130\n")
-					+ strLogZDepthBuffer
-					+ OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/forwardplus_vs.glsl");
-				osg::Shader* mainVertexShader = new osg::Shader(osg::Shader::VERTEX, strSource);
-				mainVertexShader->setName("ForwardPlusLighting: main vertex shader");
-
-				std::stringstream ssMAX_LIGHTS_PER_PIXEL;ssMAX_LIGHTS_PER_PIXEL<<_maxNumLightsPerPixel;
-				std::string strMAX_LIGHTS_PER_PIXEL = "#define MAX_LIGHTS_PER_PIXEL " + ssMAX_LIGHTS_PER_PIXEL.str()+"\n";
-
-				strSource = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/forwardplus_preamble.glsl")
-					+ strLogZDepthBuffer
-					+ strMAX_LIGHTS_PER_PIXEL
-					+ OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/forwardplus_ps.glsl")
-					+ OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/lighting_math.glsl")
-					+ OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/forwardplus_math.glsl");
-
-				osg::Shader* mainFragmentShader = new osg::Shader(osg::Shader::FRAGMENT, strSource);
-				mainFragmentShader->setName("ForwardPlusLighting: main fragment shader");
-
-				strSource = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/shadow_vs.glsl");
-				osg::Shader* shadowVertexShader = new osg::Shader(osg::Shader::VERTEX, strSource);
-				shadowVertexShader->setName("ForwardPlusLighting: shadow vertex shader");
-
-				strSource = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/shadow_ps.glsl");
-				osg::Shader* shadowFragmentShader = new osg::Shader(osg::Shader::FRAGMENT, strSource);
-				shadowFragmentShader->setName("ForwardPlusLighting: shadow fragment shader");
-
 				osgShadow::ShadowedScene* scene = dynamic_cast<osgShadow::ShadowedScene*>(context.getImageGenerator()->getScene());
 				if (scene == 0)
 				{
@@ -471,10 +473,10 @@ namespace OpenIG {
 					return;
 				}
 
-				msm->setMainVertexShader(mainVertexShader);
-				msm->setMainFragmentShader(mainFragmentShader);
-				msm->setShadowVertexShader(shadowVertexShader);
-				msm->setShadowFragmentShader(shadowFragmentShader);
+				msm->setMainVertexShader(program->getShader(0));
+				msm->setMainFragmentShader(program->getShader(1));
+				msm->setShadowVertexShader(program->getShader(2));
+				msm->setShadowFragmentShader(program->getShader(3));
 
 				unsigned int defaultDiffuseSlot = OpenIG::Base::Configuration::instance()->getConfig("Default-diffuse-texture-slot", 0);
 				ss->addUniform(new osg::Uniform("baseTexture", (int)defaultDiffuseSlot), osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE);
@@ -498,11 +500,6 @@ namespace OpenIG {
 				osg::ref_ptr<osgShadow::ViewDependentShadowMap> vdsm = new osgShadow::ViewDependentShadowMap;
 				scene->setShadowTechnique(vdsm);
 
-				osg::ref_ptr<osg::Program> program = new osg::Program;
-				program->addShader(mainVertexShader);
-				program->addShader(mainFragmentShader);
-				program->addShader(shadowVertexShader);
-				program->addShader(shadowFragmentShader);
 				scene->getOrCreateStateSet()->setAttributeAndModes(program, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE);
 
 				float factor = 10.1;
@@ -524,18 +521,16 @@ namespace OpenIG {
 #endif
 				if (!_sceneMaterial.valid())
 				{
-					osg::Material* sceneMaterial = new osg::Material;
-					sceneMaterial->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.7, 0.7, 0.7, 1.0));
-					sceneMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(0.6, 0.6, 0.6, 1.0));
-					sceneMaterial->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(0.6, 0.6, 0.6, 1.0));
-					sceneMaterial->setShininess(osg::Material::FRONT_AND_BACK, 60);
-
-					ss->setAttributeAndModes(sceneMaterial, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE);
-				}
-				else
-				{
-					ss->setAttributeAndModes(_sceneMaterial, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE);
+					// kept so a config reload adding
+					// a material changes this one
+					_sceneMaterial = new osg::Material;
+					_sceneMaterial->setDataVariance(osg::Object::DYNAMIC);
+					_sceneMaterial->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.7, 0.7, 0.7, 1.0));
+					_sceneMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(0.6, 0.6, 0.6, 1.0));
+					_sceneMaterial->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(0.6, 0.6, 0.6, 1.0));
+					_sceneMaterial->setShininess(osg::Material::FRONT_AND_BACK, 60);
 				}
+				ss->setAttributeAndModes(_sceneMaterial, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE);
 
 				float shadowsFactor = OpenIG::Base::Configuration::instance()->getConfig("Shadows-Factor", 0.5);
 				ss->addUniform(new osg::Uniform("shadowsFactor", shadowsFactor));
@@ -576,17 +571,6 @@ namespace OpenIG {
 				{
 					_todHour = attr->getValue().getHour();
 				}
-
-				// Here we check if the XML has changed. If so, reload and update
-				_xmlAccessMutex.lock();
-				if (_xmlLastCheckedTime != _xmlLastWriteTime)
-				{
-					osg::notify(osg::NOTICE) << "ForwardPlus: XML updated: " << _xmlFile << std::endl;
-					updateFromXML(_xmlFile);
-
-					_xmlLastCheckedTime = _xmlLastWriteTime;
-				}
-				_xmlAccessMutex.unlock();
 			}
 
 			virtual void databaseRead(const std::string& fileName, osg::Node*, const osgDB::Options*)
@@ -600,13 +584,16 @@ namespace OpenIG {
 					updateFromXML(_xmlFile = xmlFileName);
 
 					// we expect one config file per
-					// visual database so we launch
-					// a observer thread to monitor
-					// changes on this file. If there
+					// visual database so we watch
+					// this one for changes. If there
 					// will be a need of muitiple files
 					// like per tile, or multiple databases
 					// then consider making these in a vector
-					_xmlFileObserverThread = boost::shared_ptr<boost::thread>(new boost::thread(&OpenIG::Plugins::ForwardPlusLightingPlugin::xmlFileObserverThread, this));
+					OpenIG::Base::FileWatcher::instance()->unsubscribe(_xmlSubscription);
+					_xmlSubscription = OpenIG::Base::FileWatcher::instance()->subscribe(
+						xmlFileName,
+						boost::bind(&OpenIG::Plugins::ForwardPlusLightingPlugin::xmlFileChanged, this, _1)
+						);
 				}
 			}
 
@@ -615,31 +602,17 @@ namespace OpenIG {
 			{
 				context.getImageGenerator()->setLightImplementationCallback(0);
 
-				if (_xmlFileObserverThread.get())
-				{
-					_xmlFileObserverThreadRunningCondition = false;
-					while (_xmlFileObserverThreadRunning);
-					_xmlFileObserverThread->join();
-				}
-				_xmlFileObserverThread.reset();
+				OpenIG::Base::FileWatcher::instance()->unsubscribe(_xmlSubscription);
+				_xmlSubscription = 0;
 			}
 
 		protected:
-			void xmlFileObserverThread()
+			// Called by the FileWatcher from the update
+			// when the lighting XML file has changed
+			void xmlFileChanged(const std::string& fileName)
 			{
-				_xmlFileObserverThreadRunning = true;
-				_xmlFileObserverThreadRunningCondition = true;
-
-				while (_xmlFileObserverThreadRunningCondition)
-				{
-					_xmlAccessMutex.lock();
-					_xmlLastWriteTime = OpenIG::Base::FileSystem::lastWriteTime(_xmlFile);
-					_xmlAccessMutex.unlock();
-
-					OpenThreads::Thread::microSleep(10000);
-				}
-
-				_xmlFileObserverThreadRunning = false;
+				osg::notify(osg::NOTICE) << "ForwardPlus: XML updated: " << fileName << std::endl;
+				updateFromXML(fileName);
 			}
 
 			osg::ref_ptr<OpenIG::Base::LightImplementationCallback> _lightImplementationCallback;			
@@ -654,13 +627,8 @@ namespace OpenIG {
 			LightManager*                                           _lightManager;
 			osg::ref_ptr<osg::Program>								_program;
 
-			boost::shared_ptr<boost::thread>	_xmlFileObserverThread;
-			boost::mutex						_xmlAccessMutex;
-			std::time_t							_xmlLastWriteTime;
-			std::time_t							_xmlLastCheckedTime;
-			std::string							_xmlFile;
-			volatile bool						_xmlFileObserverThreadRunning;
-			volatile bool						_xmlFileObserverThreadRunningCondition;
+			OpenIG::Base::FileWatcher::SubscriptionID	_xmlSubscription;
+			std::string									_xmlFile;
 		};
 	} // namespace
 } // namespace
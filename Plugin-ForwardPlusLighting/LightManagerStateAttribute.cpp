@@ -37,10 +37,13 @@ using namespace osg;
 using namespace OpenIG::Plugins;
 using namespace OpenIG::Library::Graphics;
 
+#include "ForwardPlusEngine.h"
+
 #include <Library-Graphics/LightManager.h>
 #include <Library-Graphics/LightData.h>
 #include <Library-Graphics/TileSpaceLightGrid.h>
 #include <Library-Graphics/DataFormat.h>
+#include <Library-Graphics/Camera.h>
 
 #include <Core-Utils/GLErrorUtils.h>
 
@@ -49,6 +52,7 @@ using namespace OpenIG::Library::Graphics;
 #include <Core-OpenIG/Engine.h>
 
 #include <osg/State>
+#include <osg/FrameStamp>
 
 const int _lightDataTBOTexUnit              = 15;
 const int _lightIndexListTBOTexUnit         = 14;
@@ -61,21 +65,27 @@ LightManagerStateAttribute::~LightManagerStateAttribute()
 {
 }
 
-void LightManagerStateAttribute::setAttributesAndUniformsIfNotSet(void)
+static const std::string strLightDataToViewMatrixUniform = "lightDataToViewMatrix";
+static const std::string strTilingParamsUniform = "vTilingParams";
+
+void LightManagerStateAttribute::addToStateSet(osg::StateSet* stateSet)
 {
-	osg::StateSet* stateSet = _scene->getStateSet();
-	if (stateSet->getUniform("lightDataTBO")==0)
-	{
-		stateSet->addUniform(new osg::Uniform("lightDataTBO", _lightDataTBOTexUnit));
-	}
-	if (stateSet->getUniform("lightIndexListTBO")==0)
+	if (_lightDataToViewMatrixUniform.valid()==false)
 	{
-		stateSet->addUniform(new osg::Uniform("lightIndexListTBO", _lightIndexListTBOTexUnit));
+		_lightDataToViewMatrixUniform = new osg::Uniform(osg::Uniform::FLOAT_MAT4, strLightDataToViewMatrixUniform);
 	}
-	if (stateSet->getUniform("lightGridOffsetAndSizeTBO")==0)
+	if (_tilingParamsUniform.valid()==false)
 	{
-		stateSet->addUniform(new osg::Uniform("lightGridOffsetAndSizeTBO", _lightGridOffsetAndSizeTBOTexUnit));
+		int i = 0;
+		_tilingParamsUniform = new osg::Uniform(strTilingParamsUniform.c_str(), i, i, i, i);
 	}
+
+	stateSet->setAttribute(this, osg::StateAttribute::ON);
+	stateSet->addUniform(_lightDataToViewMatrixUniform.get());
+	stateSet->addUniform(_tilingParamsUniform.get());
+	stateSet->addUniform(new osg::Uniform("lightDataTBO", _lightDataTBOTexUnit));
+	stateSet->addUniform(new osg::Uniform("lightIndexListTBO", _lightIndexListTBOTexUnit));
+	stateSet->addUniform(new osg::Uniform("lightGridOffsetAndSizeTBO", _lightGridOffsetAndSizeTBOTexUnit));
 }
 
 namespace OpenIG {
@@ -103,7 +113,7 @@ namespace OpenIG {
 //! \brief Apply the GLLights in the DtOsgLightManager.
 void LightManagerStateAttribute::apply(osg::State& state) const
 {
-	if (_lightManager==0)
+	if (_fpEngine==0 || _fpView==0)
 	{
 		return;
 	}
@@ -119,6 +129,13 @@ void LightManagerStateAttribute::apply(osg::State& state) const
 	}
 
 
+	// Normally done once all the views are culled, this
+	// catches a view drawn before the others were culled
+	if (state.getFrameStamp())
+	{
+		_fpEngine->updateViews(state.getFrameStamp()->getFrameNumber());
+	}
+
 	nonConst->packLights();
 	nonConst->updateTiledShadingStuff();
 
@@ -149,22 +166,13 @@ void LightManagerStateAttribute::apply(osg::State& state) const
 	state.setActiveTextureUnit(tu);
 }
 
-void LightManagerStateAttribute::set(OpenIG::Library::Graphics::LightManager*	 lightManager
-	, OpenIG::Library::Graphics::Camera_64*	  fpCamera
-	, OpenIG::Library::Graphics::Vector2_uint32* fpViewport
-	, osg::Group* scene
+void LightManagerStateAttribute::set(ForwardPlusEngine* fpEngine
+	, ForwardPlusView* fpView
 	, OpenIG::Base::ImageGenerator* ig)
 {
-	_lightManager = lightManager;
-	_fpCamera = fpCamera;
-	_fpViewport = fpViewport;
-	_scene = scene;
+	_fpEngine = fpEngine;
+	_fpView = fpView;
 	_ig = ig;
-
-	_lightData = new LightData(341, FORMAT_R32G32B32A32_FLOAT);
-	Vector2_uint32 tileSize(32, 32);
-	_tileSpaceLightGrid = new TileSpaceLightGrid(tileSize);
-	_tileSpaceLightGrid->SetScreenAreaCullSize(tileSize/2);
 }
 
 int LightManagerStateAttribute::compare(const StateAttribute& sa) const
@@ -172,13 +180,13 @@ int LightManagerStateAttribute::compare(const StateAttribute& sa) const
 	// check the types are equal and then create the rhs variable
 	// used by the COMPARE_StateAttribute_Parameter macros below.
 	COMPARE_StateAttribute_Types(LightManagerStateAttribute,sa)
+	COMPARE_StateAttribute_Parameter(_fpView)
 	return 0;
 }
 
 LightManagerStateAttribute::LightManagerStateAttribute()
-	: _lightManager(0)
-	, _fpCamera(0)
-	, _fpViewport(0)
+	: _fpEngine(0)
+	, _fpView(0)
 	, _lightDataTBO(0)
 	, _lightGridOffsetAndSizeTBO(0)
 	, _lightIndexListTBO(0)
@@ -191,9 +199,8 @@ LightManagerStateAttribute::LightManagerStateAttribute()
 
 
 LightManagerStateAttribute::LightManagerStateAttribute(const LightManagerStateAttribute& rhs,const CopyOp& copyop)
-	: _lightManager(0)
-	, _fpCamera(0)
-	, _fpViewport(0)
+	: _fpEngine(0)
+	, _fpView(0)
 	, _lightDataTBO(0)
 	, _lightGridOffsetAndSizeTBO(0)
 	, _lightIndexListTBO(0)
@@ -207,36 +214,73 @@ LightManagerStateAttribute::LightManagerStateAttribute(const LightManagerStateAt
 
 void LightManagerStateAttribute::updateLightDataTBO(void)
 {
+	bool uploadAll = false;
 	if (_lightDataTBO==0)
 	{
-		_lightDataTBO = new osg::TBO(_lightData->GetWidth(), _lightData->GetFormat(), _extensions);
+		_lightDataTBO = new osg::TBO(_fpView->lightData->GetWidth(), _fpView->lightData->GetFormat(), _extensions);
+		uploadAll = true;
 	}
 	if (_lightDataTBO->isValid()==false)
 	{
 		std::cout<<"Error"<<std::endl;
 		return;
 	}
-	if (_lightDataTBO->getWidth()!=_lightData->GetWidth())
+	if (_lightDataTBO->getWidth()!=_fpView->lightData->GetWidth())
 	{
-		_lightDataTBO->resize(_lightData->GetWidth());
+		_lightDataTBO->resize(_fpView->lightData->GetWidth());
+		uploadAll = true;
 	}
 	if (_lightDataTBO->isValid()==false)
 	{
 		std::cout<<"Error"<<std::endl;
 		return;
 	}
-	ASSERT_PREDICATE(_lightDataTBO->getWidth()==_lightData->GetWidth());
+	ASSERT_PREDICATE(_lightDataTBO->getWidth()==_fpView->lightData->GetWidth());
+
+	if (uploadAll || _fpView->lightData->IsResized())
+	{
+		_lightDataTBO->copyData(_fpView->lightData->GetPackedData(), 0, _fpView->lightData->GetPackedDataSizeInBytes());
+		return;
+	}
 
-	_lightDataTBO->copyData(_lightData->GetPackedData(), 0, _lightData->GetPackedDataSizeInBytes());
+	// Only the records rewritten this frame
+	const char* packedData = reinterpret_cast<const char*>(_fpView->lightData->GetPackedData());
+	const LightData::DirtyRanges& ranges = _fpView->lightData->GetDirtyRanges();
+	for (LightData::DirtyRanges::const_iterator itr = ranges.begin(); itr != ranges.end(); ++itr)
+	{
+		_lightDataTBO->copyData(packedData + itr->offsetInBytes, (int)itr->offsetInBytes, (int)itr->sizeInBytes);
+	}
 }
 
 void LightManagerStateAttribute::packLights(void)
 {
-	_lightData->PackLights(_lightManager->GetFrustumAffectingLights());
 	updateLightDataTBO();
+	updateLightDataToViewMatrix();
 }
 
-static const std::string strTilingParamsUniform = "vTilingParams";
+void LightManagerStateAttribute::updateLightDataToViewMatrix()
+{
+	if (_lightDataToViewMatrixUniform.valid()==false)
+	{
+		return;
+	}
+
+	// Composed in double precision, the translation left is the
+	// view space position of the origin and fits a float
+	const Matrix4_64& view = _fpView->fpCamera.GetViewMatrix();
+	osg::Matrixd viewMatrix;
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			viewMatrix(j, i) = view[i][j];
+		}
+	}
+	const Vector3_64& vOrigin = _fpView->lightData->GetOrigin();
+	osg::Matrixd lightDataToView = osg::Matrixd::translate(vOrigin.x, vOrigin.y, vOrigin.z) * viewMatrix;
+
+	_lightDataToViewMatrixUniform->set(osg::Matrixf(lightDataToView));
+}
 
 static void updateTilingParamsForGlobalContext(OpenIG::Base::ImageGenerator* _ig, const osg::Vec4i& _vTilingParams)
 {
@@ -251,53 +295,52 @@ static void updateTilingParamsForGlobalContext(OpenIG::Base::ImageGenerator* _ig
 }
 void LightManagerStateAttribute::updateTilingParams()
 {
-	osg::StateSet* stateSet = _scene->getStateSet();
-	if (stateSet->getUniform(strTilingParamsUniform)==0)
+	if (_tilingParamsUniform.valid()==false)
 	{
-		int i = 0;
-		osg::Uniform* vTilingParamsUniform = new osg::Uniform(strTilingParamsUniform.c_str(), i, i, i, i);
-		stateSet->addUniform(vTilingParamsUniform);
-	}
-	ASSERT_PREDICATE(stateSet && stateSet->getUniform(strTilingParamsUniform));
-	Vector2_uint32 tileSize = _tileSpaceLightGrid->GetTileSize();
-	Vector2_uint32 viewport = *_fpViewport;
-	stateSet->getUniform(strTilingParamsUniform)->set((int)tileSize.x, (int)tileSize.y, (int)viewport.x, (int)viewport.y);
-	updateTilingParamsForGlobalContext(_ig, osg::Vec4i((int)tileSize.x, (int)tileSize.y, (int)viewport.x, (int)viewport.y));
+		return;
+	}
+	Vector2_uint32 tileSize = _fpView->tileSpaceLightGrid->GetTileSize();
+	Vector2_uint32 viewport = _fpView->fpViewport;
+	_tilingParamsUniform->set((int)tileSize.x, (int)tileSize.y, (int)viewport.x, (int)viewport.y);
+	if (_fpView->index == 0)
+	{
+		updateTilingParamsForGlobalContext(_ig, osg::Vec4i((int)tileSize.x, (int)tileSize.y, (int)viewport.x, (int)viewport.y));
+	}
 }
 
 void LightManagerStateAttribute::updateTileLightGridOffsetAndSizeTBO()
 {
 	if (_lightGridOffsetAndSizeTBO==0)
 	{
-		_lightGridOffsetAndSizeTBO = new osg::TBO(_tileSpaceLightGrid->GetTileGridOffsetAndSizeWidth()
-												, _tileSpaceLightGrid->GetTileGridOffsetAndSizeDataFormat(), _extensions);
+		_lightGridOffsetAndSizeTBO = new osg::TBO(_fpView->tileSpaceLightGrid->GetTileGridOffsetAndSizeWidth()
+												, _fpView->tileSpaceLightGrid->GetTileGridOffsetAndSizeDataFormat(), _extensions);
 	}
 	if (_lightGridOffsetAndSizeTBO->isValid()==false)
 	{
 		std::cout<<"Error"<<std::endl;
 		return;
 	}
-	if (_lightGridOffsetAndSizeTBO->getWidth()!=_tileSpaceLightGrid->GetTileGridOffsetAndSizeWidth())
+	if (_lightGridOffsetAndSizeTBO->getWidth()!=_fpView->tileSpaceLightGrid->GetTileGridOffsetAndSizeWidth())
 	{
-		_lightGridOffsetAndSizeTBO->resize(_tileSpaceLightGrid->GetTileGridOffsetAndSizeWidth());
+		_lightGridOffsetAndSizeTBO->resize(_fpView->tileSpaceLightGrid->GetTileGridOffsetAndSizeWidth());
 	}
 	if (_lightGridOffsetAndSizeTBO->isValid()==false)
 	{
 		std::cout<<"Error"<<std::endl;
 		return;
 	}
-	ASSERT_PREDICATE(_lightGridOffsetAndSizeTBO->getWidth()==_tileSpaceLightGrid->GetTileGridOffsetAndSizeWidth());
+	ASSERT_PREDICATE(_lightGridOffsetAndSizeTBO->getWidth()==_fpView->tileSpaceLightGrid->GetTileGridOffsetAndSizeWidth());
 
-	_lightGridOffsetAndSizeTBO->copyData(_tileSpaceLightGrid->GetTileGridOffsetAndSizeDataPtr(), 0, _tileSpaceLightGrid->GetTileGridOffsetAndSizeSizeInBytes());
+	_lightGridOffsetAndSizeTBO->copyData(_fpView->tileSpaceLightGrid->GetTileGridOffsetAndSizeDataPtr(), 0, _fpView->tileSpaceLightGrid->GetTileGridOffsetAndSizeSizeInBytes());
 }
 
 void LightManagerStateAttribute::updateTileLightIndexListTBO()
 {
-	if (_tileSpaceLightGrid->GetTotalTileLightIndexListLength()==0)
+	if (_fpView->tileSpaceLightGrid->GetTotalTileLightIndexListLength()==0)
 	{
 		return;
 	}
-	unsigned int widthRequired = Math::GetUpperPowerOfTwo(_tileSpaceLightGrid->GetTotalTileLightIndexListLength()/4 + 1);
+	unsigned int widthRequired = Math::GetUpperPowerOfTwo(_fpView->tileSpaceLightGrid->GetTotalTileLightIndexListLength()/4 + 1);
 
 	if (_lightIndexListTBO==0)
 	{
@@ -316,17 +359,23 @@ void LightManagerStateAttribute::updateTileLightIndexListTBO()
 		std::cout<<"Error"<<std::endl;
 		return;
 	}
-	size_t sizeToCopy = _tileSpaceLightGrid->GetTotalTileLightIndexListLength()*sizeof(int32);
-	_lightIndexListTBO->copyData(_tileSpaceLightGrid->GetTileLightIndexListsPtr(), 0, sizeToCopy);
+
+	// Remapped to the light data slots by the engine
+	const VecInt32s& tileLightSlotList = _fpView->tileLightSlotList;
+	if (tileLightSlotList.empty())
+	{
+		return;
+	}
+
+	size_t sizeToCopy = tileLightSlotList.size()*sizeof(int32);
+	_lightIndexListTBO->copyData(&tileLightSlotList[0], 0, sizeToCopy);
 }
 
 void LightManagerStateAttribute::updateTiledShadingStuff(void)
 {
-	_tileSpaceLightGrid->Update(_lightManager->GetFrustumAffectingLights(), _fpCamera, *_fpViewport);
 	updateTileLightGridOffsetAndSizeTBO();
 	updateTileLightIndexListTBO();
 	updateTilingParams();
-	setAttributesAndUniformsIfNotSet();
 	//initializeRampTexture();
 }
 
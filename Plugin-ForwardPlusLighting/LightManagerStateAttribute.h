@@ -36,21 +36,12 @@
 
 #include <Library-Graphics/Vector2.h>
 #include <Library-Graphics/CameraFwdDeclare.h>
+#include <Library-Graphics/CommonTypes.h>
 
 #include <Core-Utils/TBO.h>
 
-#include <osg/Group>
-#include <osg/observer_ptr>
-
-namespace OpenIG {
-	namespace Library {
-		namespace Graphics {
-			class LightManager;
-			class LightData;
-			class TileSpaceLightGrid;
-		}
-	}
-}
+#include <osg/StateSet>
+#include <osg/Uniform>
 
 namespace OpenIG {
 	namespace Base {
@@ -62,19 +53,26 @@ namespace OpenIG {
 	namespace Plugins {
 
 		class glActiveTextureWrapped;
+		class ForwardPlusEngine;
+		struct ForwardPlusView;
 
+		// Uploads the lights and the tile grid of one view to its
+		// own set of TBOs. Set on the state set of the view camera,
+		// along with the uniforms of the view it updates in draw
 		class LightManagerStateAttribute : public osg::StateAttribute
 		{
 		public:
 			LightManagerStateAttribute();
 			LightManagerStateAttribute(const LightManagerStateAttribute& text, const osg::CopyOp& copyop = osg::CopyOp::SHALLOW_COPY);
 
-			void set(OpenIG::Library::Graphics::LightManager*	 _lightManager
-				, OpenIG::Library::Graphics::Camera_64*	  _fpCamera
-				, OpenIG::Library::Graphics::Vector2_uint32* _fpViewport
-				, osg::Group* scene
+			void set(ForwardPlusEngine* fpEngine
+				, ForwardPlusView* fpView
 				, OpenIG::Base::ImageGenerator* ig);
 
+			// Adds the attribute and its uniforms to the state set of the view.
+			// Done once at set up, the draw only changes the uniform values
+			void addToStateSet(osg::StateSet* stateSet);
+
 
 			META_StateAttribute(igplugins, OpenIG::Plugins::LightManagerStateAttribute, osg::StateAttribute::Type(PATCH_PARAMETER + 10));
 
@@ -84,9 +82,8 @@ namespace OpenIG {
 
 		protected:
 			virtual ~LightManagerStateAttribute();
-			OpenIG::Library::Graphics::LightManager*	 _lightManager;
-			OpenIG::Library::Graphics::Camera_64*		 _fpCamera;
-			OpenIG::Library::Graphics::Vector2_uint32* _fpViewport;
+			ForwardPlusEngine* _fpEngine;
+			ForwardPlusView* _fpView;
 			OpenIG::Base::ImageGenerator* _ig;
 
 			void packLights(void);
@@ -95,9 +92,7 @@ namespace OpenIG {
 			void updateTileLightGridOffsetAndSizeTBO();
 			void updateTileLightIndexListTBO();
 			void updateTilingParams();
-
-			OpenIG::Library::Graphics::LightData*      _lightData;
-			OpenIG::Library::Graphics::TileSpaceLightGrid* _tileSpaceLightGrid;
+			void updateLightDataToViewMatrix();
 
 			osg::TBO* _lightDataTBO;
 			osg::TBO*  _lightGridOffsetAndSizeTBO;
@@ -105,9 +100,9 @@ namespace OpenIG {
 
 			osg::GLExtensions* _extensions;
 
-			osg::observer_ptr<osg::Group> _scene;
-
-			void setAttributesAndUniformsIfNotSet(void);
+			// Owned by the view, so the views drawn in parallel do not share them
+			osg::ref_ptr<osg::Uniform> _lightDataToViewMatrixUniform;
+			osg::ref_ptr<osg::Uniform> _tilingParamsUniform;
 
 			glActiveTextureWrapped* _glActiveTextureWrapped;
 
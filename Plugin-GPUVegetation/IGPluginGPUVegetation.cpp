@@ -40,6 +40,8 @@
 #include <Core-Base/Commands.h>
 #include <Core-Base/FileSystem.h>
 
+#include <Core-Utils/ShaderUtils.h>
+
 #include <osg/ref_ptr>
 #include <osg/StateSet>
 #include <osg/Texture2D>
@@ -74,60 +76,44 @@ namespace OpenIG {
 
             virtual std::string getAuthor() { return "ComPro, Nick"; }
 
-            static bool useLogZDepthBuffer(void)
-            {
-                std::string strLogZDepthBuffer = OpenIG::Base::Configuration::instance()->getConfig("LogZDepthBuffer","yes");
-                if (strLogZDepthBuffer.compare(0, 3, "yes") == 0)
-                    return true;
-                else
-                    return false;
-            }
-
             void setUpShaders(osg::StateSet* ss)
             {
-                if (!_gpuProgram.valid()) _gpuProgram = new osg::Program;
-                osg::ref_ptr<osg::Program> program = _gpuProgram;
-
-                program->setName("gpu_veg_program");
-
+                // The same program for all the vegetation StateSets, the
+                // registry gives it back once it was put together
+                if (!_gpuProgram.valid())
+                {
 #if defined(_WIN32)
-            std::string resourcesPath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../resources");
+                    std::string resourcesPath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../resources");
 #else
-            std::string resourcesPath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../../openig/resources");
+                    std::string resourcesPath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../../openig/resources");
 #endif
-                std::string strSource;
-
-                useLogZDepthBuffer();
-
-                strSource = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/vegetation_vs.glsl");
-                osg::Shader* mainVertexShader = new osg::Shader(osg::Shader::VERTEX, strSource);
-
-                strSource = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/vegetation_gs.glsl");
-                osg::Shader* mainGeometryShader = new osg::Shader(osg::Shader::GEOMETRY, strSource);
-
-                // A fair metric for vegetation
-                std::string strMAX_LIGHTS_PER_PIXEL = (_forwardPlusEnabled)? "#define MAX_LIGHTS_PER_PIXEL 200\n"
-                    : "#define MAX_LIGHTS_PER_PIXEL 200\n";
-
-                strSource = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/vegetation_ps.glsl")
-                    + strMAX_LIGHTS_PER_PIXEL
-                    + OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/lighting_math.glsl")
-                    + OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/forwardplus_math.glsl");
-                osg::Shader* mainFragmentShader = new osg::Shader(osg::Shader::FRAGMENT, strSource);
-
-                program->addShader(mainVertexShader);
-                program->addShader(mainFragmentShader);
-                program->addShader(mainGeometryShader);
-
-                program->setParameter(GL_GEOMETRY_VERTICES_OUT_EXT, 8);
-                program->setParameter(GL_GEOMETRY_INPUT_TYPE_EXT, GL_POINTS);
-                program->setParameter(GL_GEOMETRY_OUTPUT_TYPE_EXT, GL_TRIANGLE_STRIP);
-
-                program->addBindAttribLocation("inUV", 6);
-                program->addBindAttribLocation("inScale", 7);
+                    osg::ShaderProgramRegistry::Description description("gpu_veg_program");
+                    description
+                        .addShader(osg::Shader::VERTEX)
+                            .addFile(resourcesPath + "/shaders/vegetation_vs.glsl")
+                        .addShader(osg::Shader::GEOMETRY)
+                            .addFile(resourcesPath + "/shaders/vegetation_gs.glsl")
+                        .addShader(osg::Shader::FRAGMENT)
+                            .addFile(resourcesPath + "/shaders/vegetation_ps.glsl")
+                            .addFile(resourcesPath + "/shaders/lighting_math.glsl")
+                            .addFile(resourcesPath + "/shaders/forwardplus_math.glsl")
+                        // A fair metric for vegetation
+                        .addDefine("MAX_LIGHTS_PER_PIXEL", "200")
+                        .setParameter(GL_GEOMETRY_VERTICES_OUT_EXT, 8)
+                        .setParameter(GL_GEOMETRY_INPUT_TYPE_EXT, GL_POINTS)
+                        .setParameter(GL_GEOMETRY_OUTPUT_TYPE_EXT, GL_TRIANGLE_STRIP)
+                        .addBindAttribLocation("inUV", 6)
+                        .addBindAttribLocation("inScale", 7);
+
+                    _gpuProgram = osg::ShaderProgramRegistry::instance()->getOrCreateProgram(description);
+                    if (!_gpuProgram.valid())
+                    {
+                        return;
+                    }
+                }
 
-                ss->setAttributeAndModes(program, osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | osg::StateAttribute::OVERRIDE);
-                if (useLogZDepthBuffer())
+                ss->setAttributeAndModes(_gpuProgram, osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | osg::StateAttribute::OVERRIDE);
+                if (osg::ShaderUtils::useLogZDepthBuffer())
                 {
                     ss->setDefine("USE_LOG_DEPTH_BUFFER", "1");
                 }
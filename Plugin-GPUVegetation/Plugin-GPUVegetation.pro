@@ -17,7 +17,7 @@ SOURCES += IGPluginGPUVegetation.cpp
 
 HEADERS +=
 
-LIBS += -losg -losgDB -losgViewer -lOpenIG-Engine -lOpenThreads -lOpenIG-PluginBase -lOpenIG-Base
+LIBS += -losg -losgDB -losgViewer -lOpenIG-Engine -lOpenThreads -lOpenIG-PluginBase -lOpenIG-Base -lOpenIG-Utils
 
 INCLUDEPATH += ../
 DEPENDPATH += ../
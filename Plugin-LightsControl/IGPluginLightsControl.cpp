@@ -45,9 +45,11 @@
 #include <Core-Base/Mathematics.h>
 #include <Core-Base/Commands.h>
 #include <Core-Base/FileSystem.h>
+#include <Core-Base/FileWatcher.h>
 #include <Core-Base/Configuration.h>
 
 #include <Core-Utils/TextureCache.h>
+#include <Core-Utils/ShaderUtils.h>
 
 #include <Core-OpenIG/RenderBins.h>
 #include <Core-OpenIG/Engine.h>
@@ -73,6 +75,7 @@
 #include <ctime>
 
 #include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 
 using namespace osg;
@@ -97,9 +100,7 @@ namespace OpenIG { namespace Plugins {
     
     LightsControlPlugin()
     : _ig(0)
-    , _xmlThreadIsRunning(false)
-    , _xmlThreadRunningCondition(false)
-    , _xmlLastCheckedTime(0)
+    , _xmlSubscription(0)
     {
       std::string resourcePath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../resources");
       _textureCache.addPath(resourcePath);
@@ -1363,14 +1364,16 @@ namespace OpenIG { namespace Plugins {
         readXML(_xmlFile = xmlFileName);
         
         // we expect one config file per
-        // visual database so we launch
-        // a observer thread to monitor
-        // changes on this file. If there
+        // visual database so we watch
+        // this one for changes. If there
         // will be a need of muitiple files
         // like per tile, or multiple databases
         // then consider making these in a vector
-        _xmlThreadRunningCondition = true;
-        _xmlFileObserverThread = boost::shared_ptr<boost::thread>(new boost::thread(&OpenIG::Plugins::LightsControlPlugin::xmlFileObserverThread, this));
+        OpenIG::Base::FileWatcher::instance()->unsubscribe(_xmlSubscription);
+        _xmlSubscription = OpenIG::Base::FileWatcher::instance()->subscribe(
+          xmlFileName,
+          boost::bind(&OpenIG::Plugins::LightsControlPlugin::xmlFileChanged, this, _1)
+          );
         
       }
       else
@@ -1520,23 +1523,6 @@ namespace OpenIG { namespace Plugins {
           ++itr;
       }
       
-      // Here we check if the XML has changed. If so, reload and update
-      _xmlAccessMutex.lock();
-      if (_xmlLastCheckedTime == 0)
-      {
-        _xmlLastCheckedTime = _xmlLastWriteTime;
-      }
-      if (_xmlLastCheckedTime != _xmlLastWriteTime)
-      {
-        osg::notify(osg::NOTICE) << "LightsControl: XML updated: " << _xmlFile << std::endl;
-        readXML(_xmlFile);
-        updateLightPointNodesBasedOnXMLDefinitions(context.getImageGenerator()->getScene());
-        updateLightPointNodesBasedOnTimeOfDay(context.getImageGenerator()->getScene());
-        
-        _xmlLastCheckedTime = _xmlLastWriteTime;
-      }
-      _xmlAccessMutex.unlock();
-      
       // Save the current time
       osg::ref_ptr<osg::Referenced> todRef = context.getAttribute("TOD");
       OpenIG::PluginBase::PluginContext::Attribute<OpenIG::Base::TimeOfDayAttributes> *todAttr = dynamic_cast<OpenIG::PluginBase::PluginContext::Attribute<OpenIG::Base::TimeOfDayAttributes> *>(todRef.get());
@@ -1586,13 +1572,8 @@ namespace OpenIG { namespace Plugins {
       }
       _plodLightPointNodes.clear();
       
-      if (_xmlFileObserverThread.get())
-      {
-        _xmlThreadRunningCondition = false;
-        while (_xmlThreadIsRunning);
-        _xmlFileObserverThread->join();
-      }
-      _xmlFileObserverThread.reset();
+      OpenIG::Base::FileWatcher::instance()->unsubscribe(_xmlSubscription);
+      _xmlSubscription = 0;
     }
     
   protected:
@@ -1963,15 +1944,6 @@ namespace OpenIG { namespace Plugins {
         stateSet->setTextureAttributeAndModes(0,0);
       }
       
-      static bool useLogZDepthBuffer(void)
-      {
-        std::string strLogZDepthBuffer = OpenIG::Base::Configuration::instance()->getConfig("LogZDepthBuffer","yes");
-        if (strLogZDepthBuffer.compare(0, 3, "yes") == 0)
-          return true;
-        else
-          return false;
-      }
-      
       void setUpSpriteStateSet(osgSim::LightPointNode* lpn, LightPointDefinition& def)
       {
         // Not sure why this was looking for the F+ lights - I know there was a reason
@@ -2041,7 +2013,7 @@ namespace OpenIG { namespace Plugins {
         stateSet->setTextureAttributeAndModes(0,texture,val);
         stateSet->addUniform(new osg::Uniform("spriteTexture",0), val);
         
-        if (useLogZDepthBuffer())
+        if (osg::ShaderUtils::useLogZDepthBuffer())
         {
           stateSet->setDefine("USE_LOG_DEPTH_BUFFER");
         }
@@ -2079,28 +2051,17 @@ namespace OpenIG { namespace Plugins {
       std::string resourcesPath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../../openig/resources");
       #endif
       
-      std::string strVS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/sprite_bb_vs.glsl");
-      std::string strGS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/sprite_bb_gs.glsl");
-      std::string strPS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/sprite_bb_ps.glsl");
-      if (strVS!=""&&strPS!=""&&strGS!="")
+      // The same program as the sprites of the ModelComposition plugin
+      osg::ShaderProgramRegistry::Description description("sprite_bb_program");
+      description
+        .addShader(osg::Shader::VERTEX).addFile(resourcesPath + "/shaders/sprite_bb_vs.glsl")
+        .addShader(osg::Shader::GEOMETRY).addFile(resourcesPath + "/shaders/sprite_bb_gs.glsl")
+        .addShader(osg::Shader::FRAGMENT).addFile(resourcesPath + "/shaders/sprite_bb_ps.glsl");
+      
+      _spriteProgram = osg::ShaderProgramRegistry::instance()->getOrCreateProgram(description);
+      if (_spriteProgram.valid())
       {
         osg::notify(osg::NOTICE)<<"Lights Control: Successfully read in sprite programs (vs, gs, ps)"<<std::endl;
-        _spriteProgram = new osg::Program;
-        bool statusV = _spriteProgram->addShader(new osg::Shader(osg::Shader::VERTEX  , strVS));
-        if(statusV)
-          osg::notify(osg::NOTICE)<<"Lights Control: added sprite VERTEX shader!!"<<std::endl;
-        else
-          osg::notify(osg::NOTICE)<<"Lights Control: FAILED to add sprite VERTEX shader!!"<<std::endl;
-        bool statusG = _spriteProgram->addShader(new osg::Shader(osg::Shader::GEOMETRY, strGS));
-        if(statusG)
-          osg::notify(osg::NOTICE)<<"Lights Control: added GEOMETRY shader!!"<<std::endl;
-        else
-          osg::notify(osg::NOTICE)<<"Lights Control: FAILED to add sprite GEOMETRY shader!!"<<std::endl;
-        bool statusF = _spriteProgram->addShader(new osg::Shader(osg::Shader::FRAGMENT, strPS));
-        if(statusF)
-          osg::notify(osg::NOTICE)<<"Lights Control: added FRAGMENT shader!!"<<std::endl;
-        else
-          osg::notify(osg::NOTICE)<<"Lights Control: FAILED to add sprite FRAGMENT shader!!"<<std::endl;
       }
       else
       {
@@ -2125,14 +2086,14 @@ namespace OpenIG { namespace Plugins {
       osg::notify(osg::NOTICE)<<"Lights Control: setUpLightPointStateSetProgram resourcesPath: " << resourcesPath << std::endl;
       
       
-      std::string strVS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath+"/shaders/lightpoint_vs.glsl");
-      std::string strPS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath+"/shaders/lightpoint_ps.glsl");
+      osg::ShaderProgramRegistry::Description description("lightpoint_program");
+      description
+        .addShader(osg::Shader::VERTEX).addFile(resourcesPath + "/shaders/lightpoint_vs.glsl")
+        .addShader(osg::Shader::FRAGMENT).addFile(resourcesPath + "/shaders/lightpoint_ps.glsl");
       
-      if (strVS!=""&&strPS!="")
+      _lightPointProgram = osg::ShaderProgramRegistry::instance()->getOrCreateProgram(description);
+      if (_lightPointProgram.valid())
       {
-        _lightPointProgram = new osg::Program;
-        _lightPointProgram->addShader(new osg::Shader(osg::Shader::VERTEX  , strVS));
-        _lightPointProgram->addShader(new osg::Shader(osg::Shader::FRAGMENT, strPS));
         osg::notify(osg::NOTICE)<<"Lights Control: Loaded light point (fallback) programs"<<std::endl;
       }
       else
@@ -2155,39 +2116,24 @@ namespace OpenIG { namespace Plugins {
       }
     }
     
-    boost::shared_ptr<boost::thread>	_xmlFileObserverThread;
-    volatile bool						_xmlThreadIsRunning;
-    volatile bool						_xmlThreadRunningCondition;
-    boost::mutex						_xmlAccessMutex;
-    std::time_t							_xmlLastWriteTime;
-    std::time_t							_xmlLastCheckedTime;
+    OpenIG::Base::FileWatcher::SubscriptionID	_xmlSubscription;
     
   public:
     static OpenThreads::Mutex	lightMutex;
   protected:
     
-    // Thread function to check the
-    // XML config file if changed
-    void xmlFileObserverThread()
+    // Called by the FileWatcher from the
+    // update when the XML config file has changed
+    void xmlFileChanged(const std::string& fileName)
     {
-      _xmlThreadIsRunning = true;
-      while (_xmlThreadRunningCondition)
+      osg::notify(osg::NOTICE) << "LightsControl: XML updated: " << fileName << std::endl;
+      readXML(fileName);
+      
+      if (_ig)
       {
-        try
-        {
-          _xmlAccessMutex.lock();
-          _xmlLastWriteTime = OpenIG::Base::FileSystem::lastWriteTime(_xmlFile);
-          _xmlAccessMutex.unlock();
-        }
-        catch (const std::exception& e)
-        {
-          osg::notify(osg::NOTICE) << "Lights control: File montoring exception: " << e.what() << std::endl;
-          break;
-        }
-        
-        OpenThreads::Thread::microSleep(10000);
+        updateLightPointNodesBasedOnXMLDefinitions(_ig->getScene());
+        updateLightPointNodesBasedOnTimeOfDay(_ig->getScene());
       }
-      _xmlThreadIsRunning = false;
     }
     
   public:
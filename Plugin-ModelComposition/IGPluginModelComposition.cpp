@@ -42,6 +42,7 @@
 #include <Core-Base/FileSystem.h>
 
 #include <Core-Utils/TextureCache.h>
+#include <Core-Utils/ShaderUtils.h>
 
 #include <Core-OpenIG/RenderBins.h>
 #include <Core-OpenIG/Engine.h>
@@ -375,12 +376,21 @@ public:
 
         // setup ambiento occlusion
         bool ao = tags["Ambient-Occlusion"].value == "yes";
+
+        // Start decoding the textures side by side, they
+        // are waited for below when set up
+        TextureCache::RequestPointer aoTextureRequest;
+        if (ao) aoTextureRequest = _textureCache.getAsync(tags["Pre-Baked-Ambient-Occlusion-Texture"].value);
+        TextureCache::RequestPointer diffuseTextureRequest = _textureCache.getAsync(_diffuseTextureName);
+        TextureCache::RequestPointer normalMapTextureRequest;
+        if (tags.count("NormalMap") && !tags["NormalMap"].value.empty()) normalMapTextureRequest = _textureCache.getAsync(tags["NormalMap"].value);
+
         if (ao)
         {
             std::string	aotexture = tags["Pre-Baked-Ambient-Occlusion-Texture"].value;
             float factor = atof(tags["Ambient-Occlusion-Factor"].value.c_str());
 
-            Texture2DPointer texture = _textureCache.get(aotexture);
+            Texture2DPointer texture = aoTextureRequest->get();
             if (texture.valid())
             {
                 osg::notify(osg::NOTICE) << "ModelComposition: (" << fileName << ")" << " ao texture:" << aotexture << ", slot:" << _aoSlot << std::endl;
@@ -439,7 +449,7 @@ public:
         }
 
         // setup diffuse
-        Texture2DPointer diffuseTexture = _textureCache.get(_diffuseTextureName);
+        Texture2DPointer diffuseTexture = diffuseTextureRequest->get();
         if (diffuseTexture.valid())
         {
             osg::notify(osg::NOTICE) << "ModelComposition: (" << fileName << ")" << " diffuse texture:" << _diffuseTextureName << ", slot:" << _diffuseSlot << std::endl;
@@ -456,7 +466,7 @@ public:
             int normalMapSlot = atoi(iterNormalMapSlot->second.value.c_str());
             if (normalMap!="")
             {
-                Texture2DPointer normalMapTexture = _textureCache.get(normalMap);
+                Texture2DPointer normalMapTexture = normalMapTextureRequest->get();
                 if (normalMapTexture.valid())
                 {
                     osg::notify(osg::NOTICE) << "ModelComposition: (" << fileName << ")" << " normal map texture:" << normalMap << ", slot:" << normalMapSlot << std::endl;
@@ -697,16 +707,17 @@ protected:
             std::string resourcesPath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../../openig/resources");
 #endif
 
-        std::string strVS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/sprite_bb_vs.glsl");
-        std::string strGS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/sprite_bb_gs.glsl");
-        std::string strPS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath + "/shaders/sprite_bb_ps.glsl");
-        if (strVS!=""&&strPS!=""&&strGS!="")
+        // The same program as the sprites of the LightsControl plugin
+        osg::ShaderProgramRegistry::Description description("sprite_bb_program");
+        description
+            .addShader(osg::Shader::VERTEX).addFile(resourcesPath + "/shaders/sprite_bb_vs.glsl")
+            .addShader(osg::Shader::GEOMETRY).addFile(resourcesPath + "/shaders/sprite_bb_gs.glsl")
+            .addShader(osg::Shader::FRAGMENT).addFile(resourcesPath + "/shaders/sprite_bb_ps.glsl");
+
+        _spriteProgram = osg::ShaderProgramRegistry::instance()->getOrCreateProgram(description);
+        if (_spriteProgram.valid())
         {
             osg::notify(osg::NOTICE)<<"Model Composition: Loaded sprite programs (vs, gs, ps)"<<std::endl;
-            _spriteProgram = new osg::Program;
-            _spriteProgram->addShader(new osg::Shader(osg::Shader::VERTEX  , strVS));
-            _spriteProgram->addShader(new osg::Shader(osg::Shader::GEOMETRY, strGS));
-            _spriteProgram->addShader(new osg::Shader(osg::Shader::FRAGMENT, strPS));
         }
         else
         {
@@ -717,15 +728,6 @@ protected:
     TextureCache			_textureCache;
     TextureCubeMapCache		_textureCubeMapCache;
 
-    static bool useLogZDepthBuffer(void)
-    {
-        std::string strLogZDepthBuffer = OpenIG::Base::Configuration::instance()->getConfig("LogZDepthBuffer","yes");
-        if (strLogZDepthBuffer.compare(0, 3, "yes") == 0)
-            return true;
-        else
-            return false;
-    }
-
     void setUpSpriteStateSet(osgSim::LightPointNode& lpn, const LightAttribs& def, OpenIG::Base::ImageGenerator* ig)
     {
         if (def._spriteTexture.empty())
@@ -755,7 +757,7 @@ protected:
         stateSet->setTextureAttributeAndModes(0, spriteTexture, val);
         stateSet->addUniform(new osg::Uniform("spriteTexture", 0), val);
 
-        if (useLogZDepthBuffer())
+        if (osg::ShaderUtils::useLogZDepthBuffer())
         {
             stateSet->setDefine("USE_LOG_DEPTH_BUFFER");
         }
@@ -785,15 +787,15 @@ protected:
             std::string resourcesPath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../../openig/resources");
 #endif
 
-        std::string strVS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath+"/shaders/lightpoint_vs.glsl");
-        std::string strPS = OpenIG::Base::FileSystem::readFileIntoString(resourcesPath+"/shaders/lightpoint_ps.glsl");
+        osg::ShaderProgramRegistry::Description description("lightpoint_program");
+        description
+            .addShader(osg::Shader::VERTEX).addFile(resourcesPath + "/shaders/lightpoint_vs.glsl")
+            .addShader(osg::Shader::FRAGMENT).addFile(resourcesPath + "/shaders/lightpoint_ps.glsl");
 
-        if (strVS!=""&&strPS!="")
+        _lightPointProgram = osg::ShaderProgramRegistry::instance()->getOrCreateProgram(description);
+        if (_lightPointProgram.valid())
         {
             osg::notify(osg::NOTICE)<<"Model Composition: Loaded light point (fallback) programs"<<std::endl;
-            _lightPointProgram = new osg::Program;
-            _lightPointProgram->addShader(new osg::Shader(osg::Shader::VERTEX  , strVS));
-            _lightPointProgram->addShader(new osg::Shader(osg::Shader::FRAGMENT, strPS));
         }
         else
         {
@@ -813,7 +815,7 @@ protected:
         osg::StateSet* stateSet = lpn.getOrCreateStateSet();
         stateSet->setMode(GL_LIGHTING, osg::StateAttribute::OFF|osg::StateAttribute::PROTECTED|osg::StateAttribute::OVERRIDE);
         stateSet->setAttributeAndModes(_lightPointProgram, osg::StateAttribute::ON|osg::StateAttribute::PROTECTED|osg::StateAttribute::OVERRIDE);
-        if (useLogZDepthBuffer())
+        if (osg::ShaderUtils::useLogZDepthBuffer())
         {
             stateSet->setDefine("USE_LOG_DEPTH_BUFFER");
         }
@@ -1185,7 +1187,7 @@ protected:
         }
 
         // Setup the animation
-        OpenIG::Base::ImageGenerator::Entity& entity = context.getImageGenerator()->getEntityMap()[entityId];\
+        OpenIG::Base::ImageGenerator::Entity entity = context.getImageGenerator()->getEntityMap().get(entityId);\
         if (entity.valid())
         {
             OpenIG::Base::Animations::AnimationContainer* ac = dynamic_cast<OpenIG::Base::Animations::AnimationContainer*>(entity->getUserData());
@@ -1322,7 +1324,7 @@ protected:
                 addSubmodel(submodel, context, entityId, smm);
                 submodelAdded = true;
             }
-            OpenIG::Base::ImageGenerator::Entity& submodelEntity = context.getImageGenerator()->getEntityMap()[submodel._id];
+            OpenIG::Base::ImageGenerator::Entity submodelEntity = context.getImageGenerator()->getEntityMap().get(submodel._id);
             readLight((itr++)->second.node, *submodelEntity, context, submodel._id);
 
             if (itr == mmtags.end() || itr->first != "Light") break;
@@ -1397,7 +1399,7 @@ protected:
         context.getImageGenerator()->bindToEntity(submodel._id,entityId);
         context.getImageGenerator()->setEntityName(submodel._id,submodel._name);
 
-        OpenIG::Base::ImageGenerator::Entity& subentity = context.getImageGenerator()->getEntityMap()[submodel._id];
+        OpenIG::Base::ImageGenerator::Entity subentity = context.getImageGenerator()->getEntityMap().get(submodel._id);
         subentity->setStateSet(_ss);
 
         // Special case when submodels can turn off the
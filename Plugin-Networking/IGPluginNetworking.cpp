@@ -48,10 +48,14 @@
 #include <Library-Networking/Buffer.h>
 #include <Library-Networking/Parser.h>
 #include <Library-Networking/Factory.h>
+#include <Library-Networking/TrafficRecorder.h>
+#include <Library-Networking/ReplayNetwork.h>
+#include <Library-Networking/MulticastNetwork.h>
 
 #include <Library-Protocol/Header.h>
 #include <Library-Protocol/EntityState.h>
 #include <Library-Protocol/Camera.h>
+#include <Library-Protocol/FrameLossDetector.h>
 
 #include <osgDB/XmlParser>
 
@@ -63,6 +67,7 @@
 #include <OpenThreads/Block>
 
 #include <sstream>
+#include <iomanip>
 
 #include <stdlib.h>
 
@@ -113,6 +118,8 @@ struct HeaderCallback : public OpenIG::Library::Networking::Packet::Callback
     NetworkingPlugin*		plugin;
     unsigned int			frameNumber;
     bool					packetDropsDetected;
+
+    OpenIG::Library::Protocol::FrameLossDetector	lossDetector;
 };
 
 
@@ -120,6 +127,7 @@ struct EntityStateCallback : public OpenIG::Library::Networking::Packet::Callbac
 {
     EntityStateCallback(OpenIG::Base::ImageGenerator* ig)
         : imageGenerator(ig)
+        , numUpdates(0)
     {
 
     }
@@ -129,11 +137,22 @@ struct EntityStateCallback : public OpenIG::Library::Networking::Packet::Callbac
         OpenIG::Library::Protocol::EntityState* es = dynamic_cast<OpenIG::Library::Protocol::EntityState*>(&packet);
         if (es)
         {
-            imageGenerator->updateEntity(es->entityID, es->mx);
+            updates.push_back(OpenIG::Base::ImageGenerator::EntityUpdate(es->entityID, es->mx));
         }
     }
 
-    OpenIG::Base::ImageGenerator* imageGenerator;
+    // The entity states of a frame are collected and
+    // applied together when the frame is processed
+    void flush()
+    {
+        imageGenerator->updateEntities(updates);
+        numUpdates += updates.size();
+        updates.clear();
+    }
+
+    OpenIG::Base::ImageGenerator*                   imageGenerator;
+    OpenIG::Base::ImageGenerator::EntityUpdates     updates;
+    unsigned int                                    numUpdates;
 };
 
 struct CameraPacketCallback : public OpenIG::Library::Networking::Packet::Callback
@@ -173,6 +192,14 @@ public:
         , _statsOn(false)
         , _dt(0.0)
         , _timeGraphSteps(10)
+        , _entityStateCallback(0)
+        , _replayPacing(OpenIG::Library::Networking::ReplayNetwork::RecordedSpeed)
+        , _processTime(0.0)
+        , _tcpSendQueue(8)
+        , _tcpSendOverflow(OpenIG::Library::Networking::TCPServer::DropOldest)
+        , _multicastGroup("239.255.42.99")
+        , _multicastTTL(1)
+        , _multicastReusePort(false)
     {
     }
 
@@ -259,7 +286,10 @@ public:
                     if (child->contents == "TCP")
                         _protocol = TCP;
                     else
-                        _protocol = Unknown;
+                        if (child->contents == "MULTICAST")
+                            _protocol = Multicast;
+                        else
+                            _protocol = Unknown;
             }
             else
             if (child->name == "TCP-Server")
@@ -293,7 +323,82 @@ public:
                 std::transform(child->contents.begin(), child->contents.end(), child->contents.begin(), ::tolower);
                 _broadcast = (child->contents == "yes");
             }
+            else
+            if (child->name == "Multicast-Group")
+            {
+                _multicastGroup = child->contents;
+            }
+            else
+            if (child->name == "Multicast-TTL")
+            {
+                _multicastTTL = atoi(child->contents.c_str());
+            }
+            else
+            if (child->name == "Multicast-Reuse-Port")
+            {
+                std::transform(child->contents.begin(), child->contents.end(), child->contents.begin(), ::tolower);
+                _multicastReusePort = (child->contents == "yes");
+            }
+            else
+            if (child->name == "TCP-Send-Queue")
+            {
+                _tcpSendQueue = atoi(child->contents.c_str());
+            }
+            else
+            if (child->name == "TCP-Send-Overflow")
+            {
+                std::transform(child->contents.begin(), child->contents.end(), child->contents.begin(), ::toupper);
+                if (child->contents == "DISCONNECT")
+                    _tcpSendOverflow = OpenIG::Library::Networking::TCPServer::Disconnect;
+                else
+                    _tcpSendOverflow = OpenIG::Library::Networking::TCPServer::DropOldest;
+            }
+            else
+            if (child->name == "Record")
+            {
+                _recordFile = child->contents;
+            }
+            else
+            if (child->name == "Replay")
+            {
+                _replayFile = child->contents;
+            }
+            else
+            if (child->name == "Replay-Pacing")
+            {
+                std::transform(child->contents.begin(), child->contents.end(), child->contents.begin(), ::toupper);
+                if (child->contents == "FAST")
+                    _replayPacing = OpenIG::Library::Networking::ReplayNetwork::AsFastAsPossible;
+                else
+                    _replayPacing = OpenIG::Library::Networking::ReplayNetwork::RecordedSpeed;
+            }
         }
+
+        // The recording and the replay can be set from the environment
+        // too, for tools running the IG with an installed configuration
+        const char* env = getenv("OPENIG_NETWORKING_RECORD");
+        if (env) _recordFile = env;
+
+        env = getenv("OPENIG_NETWORKING_REPLAY");
+        if (env) _replayFile = env;
+
+        env = getenv("OPENIG_NETWORKING_REPLAY_PACING");
+        if (env)
+        {
+            std::string pacing(env);
+            std::transform(pacing.begin(), pacing.end(), pacing.begin(), ::toupper);
+            _replayPacing = pacing == "FAST" ? OpenIG::Library::Networking::ReplayNetwork::AsFastAsPossible : OpenIG::Library::Networking::ReplayNetwork::RecordedSpeed;
+        }
+    }
+
+    void processNetwork()
+    {
+        osg::Timer_t start = osg::Timer::instance()->tick();
+
+        _network->process();
+        _entityStateCallback->flush();
+
+        _processTime = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
     }
 
     void SlaveThreadFunc()
@@ -307,7 +412,7 @@ public:
 
             if (_network)
             {
-                _network->process();
+                processNetwork();
             }
 
 
@@ -398,16 +503,38 @@ public:
         _ig = context.getImageGenerator();
 
         //OpenIG::Library::Networking::Network::log = boost::shared_ptr<OpenIG::Library::Networking::ErrorHandler>(new OSGNotifyErrorHandler);
+
+        // A replay stands in for the network of a slave,
+        // whatever the protocol the recording was made with
+        if (!_replayFile.empty())
+        {
+            _mode = Slave;
+            _protocol = Unknown;
+            _network = boost::shared_ptr<OpenIG::Library::Networking::ReplayNetwork>(new OpenIG::Library::Networking::ReplayNetwork(_replayFile, _replayPacing));
+        }
+
         switch (_protocol)
         {
         case UDP:
             _network = boost::shared_ptr<OpenIG::Library::Networking::UDPNetwork>(new OpenIG::Library::Networking::UDPNetwork(_host,_destination,_broadcast));
             break;
+        case Multicast:
+            {
+                boost::shared_ptr<OpenIG::Library::Networking::MulticastNetwork> multicast(
+                    new OpenIG::Library::Networking::MulticastNetwork(_multicastGroup, _host, _multicastTTL));
+                multicast->setReusePort(_multicastReusePort);
+                _network = multicast;
+            }
+            break;
         case TCP:
             switch (_mode)
             {
             case Master:
-                _network = boost::shared_ptr<OpenIG::Library::Networking::TCPServer>(new OpenIG::Library::Networking::TCPServer(_host,_port));
+                {
+                    boost::shared_ptr<OpenIG::Library::Networking::TCPServer> server(new OpenIG::Library::Networking::TCPServer(_host, _port));
+                    server->setSendQueueLimit(_tcpSendQueue, _tcpSendOverflow);
+                    _network = server;
+                }
                 break;
             case Slave:
                 _network = boost::shared_ptr<OpenIG::Library::Networking::TCPClient>(new OpenIG::Library::Networking::TCPClient(_host,_server));
@@ -420,10 +547,18 @@ public:
             break;
         }
 
+        if (!_network) return;
+
         _network->setPort(_port);
 
+        if (!_recordFile.empty())
+        {
+            _network->setRecorder(new OpenIG::Library::Networking::TrafficRecorder(_recordFile));
+        }
+
         _network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_HEADER, new HeaderCallback(_ig,this));
-        _network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_ENTITYSTATE, new EntityStateCallback(_ig));
+        _entityStateCallback = new EntityStateCallback(_ig);
+        _network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_ENTITYSTATE, _entityStateCallback);
         _network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_CAMERA, new CameraPacketCallback(dynamic_cast<OpenIG::Engine*>(_ig)));
 
         _network->setParser(new Parser);
@@ -483,18 +618,22 @@ public:
                 }
 
                 OpenIG::Library::Networking::TCPServer* server = dynamic_cast<OpenIG::Library::Networking::TCPServer*>(_network.get());
-                if (server)
+                if (server && _tcpClientsText.valid())
                 {
-                    std::vector<std::string> clients;
-                    server->getConnectedClients(clients);
+                    OpenIG::Library::Networking::TCPServer::ClientStatsList clients;
+                    server->getClientStats(clients);
 
                     std::ostringstream oss;
                     oss << "Clients connected: " << clients.size() << std::endl;
+                    oss << std::fixed << std::setprecision(2);
 
-                    std::vector<std::string>::iterator itr = clients.begin();
+                    OpenIG::Library::Networking::TCPServer::ClientStatsList::iterator itr = clients.begin();
                     for (; itr != clients.end(); ++itr)
                     {
-                        oss << *itr << std::endl;
+                        oss << itr->address
+                            << "  queue: " << itr->queueDepth << " (max " << itr->maxQueueDepth << ")"
+                            << "  send: " << itr->lastSendLatency * 1000.0 << " ms (avg " << itr->averageSendLatency * 1000.0 << " ms)"
+                            << "  dropped: " << itr->numDropped << std::endl;
                     }
 
                     _tcpClientsText->setText(oss.str());
@@ -534,13 +673,23 @@ public:
             {
                 if (_network)
                 {
-                    _network->process();
+                    processNetwork();
                 }
             }
+
+            updateProcessStats(context);
             break;
         }
     }
 
+    // The entity, light and camera updates from the packets are buffered
+    // by the Engine with the pipelined frame on. The stats overlays are not,
+    // their text is changed in the update
+    virtual bool isUpdatePipelineSafe()
+    {
+        return !_stats.valid();
+    }
+
     virtual void clean(OpenIG::PluginBase::PluginContext& context)
     {
         switch (_mode)
@@ -597,6 +746,7 @@ protected:
     {
         UDP,
         TCP,
+        Multicast,
         Unknown
     };
 
@@ -628,6 +778,37 @@ protected:
     osg::ref_ptr<osgText::Text>								_tcpClientsText;
     std::string												_host;
     bool                                                    _broadcast;
+    EntityStateCallback*                                    _entityStateCallback;   // owned by _network
+    std::string                                             _recordFile;
+    std::string                                             _replayFile;
+    OpenIG::Library::Networking::ReplayNetwork::Pacing      _replayPacing;
+    double                                                  _processTime;
+    unsigned int                                            _tcpSendQueue;
+    OpenIG::Library::Networking::TCPServer::OverflowPolicy  _tcpSendOverflow;
+    std::string                                             _multicastGroup;
+    unsigned int                                            _multicastTTL;
+    bool                                                    _multicastReusePort;
+
+    // Published through the plugin context for the tools
+    // driving a replay, like the netreplay benchmark
+    void updateProcessStats(OpenIG::PluginBase::PluginContext& context)
+    {
+        osg::ValueObject* values = context.getOrCreateValueObject();
+
+        values->setUserValue("Networking-Process-Time", _processTime);
+        if (_entityStateCallback) values->setUserValue("Networking-Entity-Updates", _entityStateCallback->numUpdates);
+
+        OpenIG::Library::Networking::ReplayNetwork* replay = dynamic_cast<OpenIG::Library::Networking::ReplayNetwork*>(_network.get());
+        if (replay == 0) return;
+
+        // The records of this frame are applied by now, so the
+        // replay clock against when the last one was due is the
+        // latency from the receive to the entities being updated
+        values->setUserValue("Networking-Replay-Records", replay->getNumReplayed());
+        values->setUserValue("Networking-Replay-Bytes", (double)replay->getNumBytesReplayed());
+        values->setUserValue("Networking-Replay-Latency", replay->getTime() - replay->getLastDueTime());
+        values->setUserValue("Networking-Replay-Finished", replay->isFinished());
+    }
 
 
     void updateNetworkStatsTimeout()
@@ -1059,16 +1240,15 @@ void HeaderCallback::process(OpenIG::Library::Networking::Packet& packet)
     {
         if (h->masterIsDead == 1) imageGenerator->getViewer()->setDone(true);
 
-        static bool firstHeaderPacket = true;
-        if (firstHeaderPacket)
-        {
-            firstHeaderPacket = false;
-        }
-        else
+        bool first = !lossDetector.started;
+
+        unsigned int lost = lossDetector.process(h->frameNumber);
+        if (!first)
         {
-            if (frameNumber + 1 != h->frameNumber)
+            if (lost)
             {
-                osg::notify(osg::NOTICE) << "Networking: Detected packet drops. Frame #" << h->frameNumber << std::endl;
+                osg::notify(osg::NOTICE) << "Networking: Detected packet drops. Frame #" << h->frameNumber
+                    << ", " << lost << " lost, " << lossDetector.numLost << " in total" << std::endl;
                 packetDropsDetected = true;
 
                 plugin->updateNetworkStatsFrameDrops(true);
@@ -1079,7 +1259,7 @@ void HeaderCallback::process(OpenIG::Library::Networking::Packet& packet)
                 packetDropsDetected = false;
             }
         }
-        frameNumber = h->frameNumber;
+        frameNumber = lossDetector.frameNumber;
 
     }
 }
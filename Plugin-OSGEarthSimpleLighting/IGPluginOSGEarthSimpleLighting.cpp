@@ -40,6 +40,8 @@
 #include <Core-Base/Types.h>
 #include <Core-Base/Configuration.h>
 
+#include <Core-Utils/LightAssignment.h>
+
 #include <osg/ref_ptr>
 #include <osg/LightSource>
 #include <osg/Material>
@@ -66,15 +68,16 @@ namespace OpenIG {
         public:
             OSGEarthSimpleLightingPlugin()
                 :_cloudsShadowsTextureSlot(6)
+                , _lightAssignment(new osg::LightAssignment(1, 7))
             {
 
             }
 
             virtual std::string getName() { return "OSGEarthSimpleLighting"; }
 
-            virtual std::string getDescription() { return "Implements simple lighting with osgEarth by using shaders and OpenGL, limited to 7 (+sun) lights"; }
+            virtual std::string getDescription() { return "Implements simple lighting with osgEarth by using shaders and OpenGL, the 7 (+sun) most influential lights per drawable"; }
 
-            virtual std::string getVersion() { return "1.0.0"; }
+            virtual std::string getVersion() { return "1.1.0"; }
 
             virtual std::string getAuthor() { return "ComPro, Nick"; }
 
@@ -174,9 +177,14 @@ namespace OpenIG {
                 OpenIG::Base::ImageGenerator*     _ig;
             };
 
+            virtual void databaseRead(const std::string&, osg::Node* node, const osgDB::Options*)
+            {
+                if (node) _lightAssignment->install(*node);
+            }
+
             virtual void init(OpenIG::PluginBase::PluginContext& context)
             {
-                _lightImplementationCallback = new SimpleLightImplementationCallback(context.getImageGenerator());
+                _lightImplementationCallback = new SimpleLightImplementationCallback(context.getImageGenerator(), _lightAssignment);
                 context.getImageGenerator()->setLightImplementationCallback(_lightImplementationCallback);
 
 
@@ -440,40 +448,12 @@ namespace OpenIG {
                 OpenIG::Base::ImageGenerator*     _ig;
             };
 
-            class DummyLight : public osg::Light
-            {
-            public:
-                DummyLight(unsigned int id, bool enabled)
-                    : osg::Light(id)
-                    , _enabled(enabled)
-                    , _id(id)
-                {
-                    setUserValue("id", (unsigned int)id);
-                    setUserValue("enabled", (bool)enabled);
-                }
-
-                inline bool getEnabled() const
-                {
-                    return _enabled;
-                }
-
-                virtual void apply(osg::State& state) const
-                {
-                    if (_id >= 8) return;
-                    osg::Light::apply(state);
-                }
-
-
-            protected:
-                bool            _enabled;
-                unsigned int    _id;
-            };
-
             class SimpleLightImplementationCallback : public OpenIG::Base::LightImplementationCallback
             {
             public:
-                SimpleLightImplementationCallback(OpenIG::Base::ImageGenerator* ig)
+                SimpleLightImplementationCallback(OpenIG::Base::ImageGenerator* ig, osg::LightAssignment* assignment)
                     : _ig(ig)
+                    , _assignment(assignment)
                 {
 
                 }
@@ -483,29 +463,36 @@ namespace OpenIG {
                     const OpenIG::Base::LightAttributes& definition,
                     osg::Group*)
                 {
-                    osg::LightSource* light = new osg::LightSource;
-
-                    DummyLight* dl = new DummyLight(id, true);
+                    // The sun/moon is light 0 and stays global
+                    if (id == 0) return NULL;
+
+                    osg::ref_ptr<osg::Light> light = new osg::Light;
+                    light->setAmbient(definition.ambient);
+                    light->setDiffuse(definition.diffuse*definition.brightness);
+                    light->setSpecular(definition.specular);
+                    light->setConstantAttenuation(1.f / definition.constantAttenuation);
+                    light->setSpotCutoff(definition.spotCutoff);
+                    light->setPosition(osg::Vec4(0, 0, 0, 1));
+                    light->setDirection(osg::Vec3(0, 1, -0));
+
+                    // Read by the light assignment
+                    light->setUserValue("id", (unsigned int)id);
+                    light->setUserValue("enabled", definition.enabled);
+                    light->setUserValue("fStartRange", (double)definition.fStartRange);
+                    light->setUserValue("fEndRange", (double)definition.fEndRange);
 
-                    dl->setLightNum(id);
-                    dl->setAmbient(definition.ambient);
-                    dl->setDiffuse(definition.diffuse*definition.brightness);
-                    dl->setSpecular(definition.specular);
-                    dl->setConstantAttenuation(1.f / definition.constantAttenuation);
-                    dl->setSpotCutoff(definition.spotCutoff);
-                    dl->setPosition(osg::Vec4(0, 0, 0, 1));
-                    dl->setDirection(osg::Vec3(0, 1, -0));
-
-                    light->setLight(dl);
+                    _lights[id] = light;
 
-                    if (id >= 1 && id < 8)
-                    {
-                        light->setStateSetModes(*_ig->getViewer()->getView(0)->getSceneData()->getOrCreateStateSet(), osg::StateAttribute::ON);
-                    }
+                    osg::Node* node = _assignment->addLight(id, light);
+                    node->setDataVariance(definition.dataVariance);
 
-                    _lights[id] = light;
+                    return node;
+                }
 
-                    return light;
+                virtual void deleteLight(unsigned int id)
+                {
+                    _lights.erase(id);
+                    _assignment->removeLight(id);
                 }
 
                 virtual void updateLight(unsigned int id, const OpenIG::Base::LightAttributes& definition)
@@ -513,32 +500,43 @@ namespace OpenIG {
                     LightsMapIterator itr = _lights.find(id);
                     if (itr != _lights.end())
                     {
-                        osg::LightSource* light = itr->second;
+                        osg::Light* light = itr->second;
 
                         if ((definition.dirtyMask & OpenIG::Base::LightAttributes::AMBIENT) == OpenIG::Base::LightAttributes::AMBIENT)
-                            light->getLight()->setAmbient(definition.ambient);
+                            light->setAmbient(definition.ambient);
 
                         if ((definition.dirtyMask & OpenIG::Base::LightAttributes::DIFFUSE) == OpenIG::Base::LightAttributes::DIFFUSE &&
                             (definition.dirtyMask & OpenIG::Base::LightAttributes::BRIGHTNESS) == OpenIG::Base::LightAttributes::BRIGHTNESS)
-                            light->getLight()->setDiffuse(definition.diffuse*definition.brightness);
+                            light->setDiffuse(definition.diffuse*definition.brightness);
 
                         if ((definition.dirtyMask & OpenIG::Base::LightAttributes::SPECULAR) == OpenIG::Base::LightAttributes::SPECULAR)
-                            light->getLight()->setSpecular(definition.specular);
+                            light->setSpecular(definition.specular);
 
                         if ((definition.dirtyMask & OpenIG::Base::LightAttributes::CONSTANTATTENUATION) == OpenIG::Base::LightAttributes::CONSTANTATTENUATION)
-                            light->getLight()->setConstantAttenuation(1.f / definition.constantAttenuation);
+                            light->setConstantAttenuation(1.f / definition.constantAttenuation);
 
                         if ((definition.dirtyMask & OpenIG::Base::LightAttributes::SPOTCUTOFF) == OpenIG::Base::LightAttributes::SPOTCUTOFF)
-                            light->getLight()->setSpotCutoff(definition.spotCutoff);
+                            light->setSpotCutoff(definition.spotCutoff);
+
+                        if ((definition.dirtyMask & OpenIG::Base::LightAttributes::RANGES) == OpenIG::Base::LightAttributes::RANGES)
+                        {
+                            light->setUserValue("fStartRange", (double)definition.fStartRange);
+                            light->setUserValue("fEndRange", (double)definition.fEndRange);
+                        }
+
+                        if ((definition.dirtyMask & OpenIG::Base::LightAttributes::ENABLED) == OpenIG::Base::LightAttributes::ENABLED)
+                            light->setUserValue("enabled", definition.enabled);
 
+                        _assignment->lightChanged(id);
                     }
                 }
 
             protected:
                 OpenIG::Base::ImageGenerator*     _ig;
+                osg::ref_ptr<osg::LightAssignment> _assignment;
 
-                typedef std::map<unsigned int, osg::ref_ptr<osg::LightSource> >                 LightsMap;
-                typedef std::map<unsigned int, osg::ref_ptr<osg::LightSource> >::iterator       LightsMapIterator;
+                typedef std::map<unsigned int, osg::ref_ptr<osg::Light> >                 LightsMap;
+                typedef std::map<unsigned int, osg::ref_ptr<osg::Light> >::iterator       LightsMapIterator;
 
                 LightsMap                   _lights;
             };
@@ -546,6 +544,7 @@ namespace OpenIG {
             osg::ref_ptr<OpenIG::Base::LightImplementationCallback>       _lightImplementationCallback;
             osg::ref_ptr<osg::Material>                             _sceneMaterial;
             int                                                     _cloudsShadowsTextureSlot;
+            osg::ref_ptr<osg::LightAssignment>                      _lightAssignment;
         };
     } // namespace
 } // namespace
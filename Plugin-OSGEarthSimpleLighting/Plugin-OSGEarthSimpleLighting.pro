@@ -18,7 +18,7 @@ SOURCES += IGPluginOSGEarthSimpleLighting.cpp
 HEADERS +=
 
 LIBS += -losg -losgDB -losgViewer -lOpenThreads -losgShadow\
-        -lOpenIG-Engine -lOpenIG-Base -lOpenIG-PluginBase
+        -lOpenIG-Engine -lOpenIG-Base -lOpenIG-PluginBase -lOpenIG-Graphics -lOpenIG-Utils
 
 INCLUDEPATH += ../
 DEPENDPATH += ../
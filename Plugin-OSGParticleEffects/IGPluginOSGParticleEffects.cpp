@@ -38,9 +38,17 @@
 #include <Core-Base/Commands.h>
 #include <Core-Base/Types.h>
 #include <Core-Base/FileSystem.h>
+#include <Core-Base/Configuration.h>
+
+#include <Core-Utils/ShaderUtils.h>
+
+#include "ParticleSimulation.h"
+#include "ParticleBatchRenderer.h"
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <map>
 
 #include <osgDB/FileNameUtils>
 
@@ -73,7 +81,11 @@ namespace OpenIG {
                 OSGParticleEffectImplementationCallback(OpenIG::Base::ImageGenerator *ig)
                     : _ig(ig)
                 {
-
+#ifdef _WIN32
+                    _resourcePath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../resources");
+#else
+                    _resourcePath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../../resources");
+#endif
                 }
 
                 virtual osg::Node* create(unsigned int id, const std::string& name, OpenIG::Base::GenericAttribute* attributes = 0)
@@ -87,6 +99,17 @@ namespace OpenIG {
                     float particleSpeed = 0.0f;
                     float mass = 0.0f;
 
+                    OpenIG::Base::EffectAttributes* effectAttributes = dynamic_cast<OpenIG::Base::EffectAttributes*>(attributes);
+                    if (effectAttributes != 0)
+                    {
+                        effectAttributes->getFloat("scale", scale);
+                        effectAttributes->getFloat("intensity", intensity);
+                        effectAttributes->getFloat("emiterduration", emiterDuration);
+                        effectAttributes->getFloat("particleduration", particleDuration);
+                        effectAttributes->getFloat("speed", particleSpeed);
+                        effectAttributes->getFloat("mass", mass);
+                    }
+                    else
                     if (attributes != 0)
                     {
                         attributes->getUserValue("scale", scale);
@@ -97,48 +120,25 @@ namespace OpenIG {
                         attributes->getUserValue("mass", mass);
                     }
 
-#ifdef _WIN32
-                    std::string resourcePath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../resources");
-#else
-                    std::string resourcePath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../../resources");
-#endif
-                    osg::ref_ptr<osgParticle::ParticleEffect> effect;
-                    if (name == "ExplosionEffect")
-                    {
-                        effect = new osgParticle::ExplosionEffect(osg::Vec3(0, 0, 0), scale, intensity);
-                    }
-                    if (name == "ExplosionDebrisEffect")
-                    {
-                        effect = new osgParticle::ExplosionDebrisEffect(osg::Vec3(0, 0, 0), scale, intensity);
-                    }
-                    if (name == "SmokeEffect")
-                    {
-                        effect = new osgParticle::SmokeEffect(osg::Vec3(0, 0, 0), scale, intensity);
-                    }
-                    if (name == "FireEffect")
+                    EffectInstance instance;
+                    if (!acquire(name, instance))
                     {
-                        effect = new osgParticle::FireEffect(osg::Vec3(0, 0, 0), scale, intensity);
+                        instance = createInstance(name);
+                        if (!instance.effect.valid()) return 0;
                     }
-                    if (name == "SmokeTrailEffect")
-                    {
-                        effect = new osgParticle::SmokeTrailEffect(osg::Vec3(0, 0, 0), scale, intensity);
 
-                        if(effect.valid())
-                        {
-                            effect->setWind(osg::Vec3(1.0f,0.0f,0.0f));
-                            effect->setTextureFileName(resourcePath + "/textures/continuous_smoke.rgb");
-                        }
-                    }
-
-                    if (!effect.valid()) return 0;
+                    osg::ref_ptr<osgParticle::ParticleEffect> effect = instance.effect;
 
+                    // Recycled instances are reset with the new
+                    // attributes. The setters rebuild the emitter and
+                    // program, but keep the particle system and its state
+                    effect->setScale(scale);
+                    effect->setIntensity(intensity);
                     effect->setParticleDuration(particleDuration);
                     effect->setEmitterDuration(emiterDuration);
-
-                    if (name != "SmokeTrailEffect")
-                        effect->setTextureFileName(resourcePath + "/textures/smoke.rgb");
-
-                    _effects[id] = effect;
+                    effect->setStartTime(0.0);
+                    effect->getEmitter()->setCurrentTime(0.0);
+                    effect->getProgram()->setCurrentTime(0.0);
 
                     effect->setUseLocalParticleSystem(false);
                     effect->getEmitter()->setUseDefaultTemplate(true);
@@ -161,62 +161,11 @@ namespace OpenIG {
                         p.setMass(mass);
                     }
 
-                    osg::ref_ptr<osg::Group> group = new osg::Group;
-                    group->addChild(effect);
+                    _ig->getViewer()->getView(0)->getSceneData()->asGroup()->addChild(instance.geode);
 
-                    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
-                    geode->addDrawable(effect->getParticleSystem());
+                    _effects[id] = instance;
 
-#define USE_LOG_DEPTH_BUFFER 1
-                    const char *VertSource = {
-#ifdef USE_LOG_DEPTH_BUFFER
-                        "uniform float Fcoef;																		\n"
-#endif
-                        "varying vec3 eyeVec;																		\n"
-                        "void main()																				\n"
-                        "{																							\n"
-                        "   eyeVec = -vec3(gl_ModelViewMatrix * gl_Vertex);											\n"
-                        "   gl_FrontColor = gl_Color;																\n"
-                        "   gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;									\n"
-                        "   gl_TexCoord[0] = gl_TextureMatrix[0] *gl_MultiTexCoord0;								\n"
-#ifdef USE_LOG_DEPTH_BUFFER
-                        "   gl_Position.z = (log2(max(1e-6, 1.0 + gl_Position.w)) * Fcoef - 1.0) * gl_Position.w;	\n"
-#endif
-                        "}																							\n"
-                    };
-                    const char *FragSource = {
-                        "varying vec3 eyeVec;                                                   \n"
-                        "uniform sampler2D baseTexture;                                         \n"
-                        "void computeFogColor(inout vec4 color)                                 \n"
-                        "{                                                                      \n"
-                        "   float fogExp = gl_Fog.density * length(eyeVec);                     \n"
-                        "   float fogFactor = exp(-(fogExp * fogExp));                          \n"
-                        "   fogFactor = clamp(fogFactor, 0.0, 1.0);                             \n"
-                        "   vec4 clr = color;                                                   \n"
-                        "   color = mix(gl_Fog.color, color, fogFactor);                        \n"
-                        "   color.a = clr.a;                                                    \n"
-                        "}                                                                      \n"
-                        "void main()															\n"
-                        "{																		\n"
-                        "   vec4 color = texture2D( baseTexture, gl_TexCoord[0].xy )*gl_Color;	\n"
-                        "	computeFogColor(color);												\n"
-                        "	gl_FragColor = color;												\n"
-                        "}																		\n"
-                    };
-
-                    osg::ref_ptr<osg::Program> pointProgram = new osg::Program;
-                    pointProgram->addShader(new osg::Shader(osg::Shader::VERTEX, VertSource));
-                    pointProgram->addShader(new osg::Shader(osg::Shader::FRAGMENT, FragSource));
-
-                    osg::StateSet *stateSet = geode->getOrCreateStateSet();
-                    //Commented out to allow smoke trails to be white until we can fix whatever the shader issue is at the moment CGR for NICK...
-                    //stateSet->setAttributeAndModes(pointProgram.get(), osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | osg::StateAttribute::OVERRIDE);
-
-                    _ig->getViewer()->getView(0)->getSceneData()->asGroup()->addChild(geode);
-
-                    _effectsGeodes[id] = geode;
-
-                    return group.release();
+                    return instance.group.get();
                 }
 
                 virtual void destroy(unsigned int id)
@@ -224,44 +173,308 @@ namespace OpenIG {
                     EffectsMap::iterator itr = _effects.find(id);
                     if (itr == _effects.end()) return;
 
+                    EffectInstance instance = itr->second;
                     _effects.erase(itr);
 
-                    EffectsGeodesMap::iterator gitr = _effectsGeodes.find(id);
-                    if (gitr != _effectsGeodes.end())
+                    osg::Node::ParentList pl = instance.geode->getParents();
+                    osg::Node::ParentList::iterator pitr = pl.begin();
+                    for (; pitr != pl.end(); ++pitr)
                     {
-                        osg::ref_ptr<osg::Geode> geode = gitr->second;
+                        osg::Group* parent = *pitr;
+                        parent->removeChild(instance.geode);
+                    }
 
-                        osg::Node::ParentList pl = geode->getParents();
-                        osg::Node::ParentList::iterator pitr = pl.begin();
-                        for (; pitr != pl.end(); ++pitr)
+                    release(instance);
+                }
+
+                virtual void update(unsigned int, OpenIG::Base::GenericAttribute*)
+                {
+                }
+
+            protected:
+                /*! One effect with its particle system geode. These are
+                *   recycled through per effect type pools so bursts of
+                *   explosions do not rebuild the particle systems
+                */
+                struct EffectInstance
+                {
+                    std::string										name;
+                    osg::ref_ptr<osgParticle::ParticleEffect>		effect;
+                    osg::ref_ptr<osg::Geode>						geode;
+                    osg::ref_ptr<osg::Group>						group;
+                };
+
+                typedef std::vector< EffectInstance >				EffectInstances;
+                typedef std::map< std::string, EffectInstances >	EffectPools;
+
+                bool acquire(const std::string& name, EffectInstance& instance)
+                {
+                    EffectPools::iterator itr = _pools.find(name);
+                    if (itr == _pools.end() || itr->second.empty()) return false;
+
+                    instance = itr->second.back();
+                    itr->second.pop_back();
+
+                    return true;
+                }
+
+                void release(EffectInstance& instance)
+                {
+                    // the effect group might still be attached to the
+                    // Engine's effect transform, detach it
+                    osg::Node::ParentList pl = instance.group->getParents();
+                    for (osg::Node::ParentList::iterator pitr = pl.begin(); pitr != pl.end(); ++pitr)
+                    {
+                        (*pitr)->removeChild(instance.group);
+                    }
+
+                    EffectInstances& pool = _pools[instance.name];
+
+                    static const size_t maxPooledInstancesPerType = 64;
+                    if (pool.size() >= maxPooledInstancesPerType) return;
+
+                    // kill the live particles, the particle system
+                    // reuses the dead ones when the instance is recycled
+                    osgParticle::ParticleSystem* ps = instance.effect->getParticleSystem();
+                    if (ps)
+                    {
+                        for (int i = 0; i < ps->numParticles(); ++i)
                         {
-                            osg::Group* parent = *pitr;
-                            parent->removeChild(geode);
+                            ps->destroyParticle(i);
                         }
+                    }
+
+                    pool.push_back(instance);
+                }
+
+                EffectInstance createInstance(const std::string& name)
+                {
+                    EffectInstance instance;
+                    instance.name = name;
+
+                    osg::ref_ptr<osgParticle::ParticleEffect> effect;
+                    if (name == "ExplosionEffect")
+                    {
+                        effect = new osgParticle::ExplosionEffect(osg::Vec3(0, 0, 0));
+                    }
+                    if (name == "ExplosionDebrisEffect")
+                    {
+                        effect = new osgParticle::ExplosionDebrisEffect(osg::Vec3(0, 0, 0));
+                    }
+                    if (name == "SmokeEffect")
+                    {
+                        effect = new osgParticle::SmokeEffect(osg::Vec3(0, 0, 0));
+                    }
+                    if (name == "FireEffect")
+                    {
+                        effect = new osgParticle::FireEffect(osg::Vec3(0, 0, 0));
+                    }
+                    if (name == "SmokeTrailEffect")
+                    {
+                        effect = new osgParticle::SmokeTrailEffect(osg::Vec3(0, 0, 0));
 
-                        _effectsGeodes.erase(gitr);
+                        if(effect.valid())
+                        {
+                            effect->setWind(osg::Vec3(1.0f,0.0f,0.0f));
+                            effect->setTextureFileName(_resourcePath + "/textures/continuous_smoke.rgb");
+                        }
                     }
+
+                    if (!effect.valid()) return instance;
+
+                    if (name != "SmokeTrailEffect")
+                        effect->setTextureFileName(_resourcePath + "/textures/smoke.rgb");
+
+                    instance.effect = effect;
+
+                    instance.group = new osg::Group;
+                    instance.group->addChild(effect);
+
+                    instance.geode = new osg::Geode;
+                    instance.geode->addDrawable(effect->getParticleSystem());
+
+                    // Drawn with the fixed function osgParticle shading. The point
+                    // shader with the log depth and fog is left out so the smoke
+                    // trails stay white, until its issue with them is fixed
+
+                    return instance;
+                }
+
+                typedef std::map< unsigned int, EffectInstance >	EffectsMap;
+                EffectsMap					_effects;
+
+                EffectPools					_pools;
+
+                std::string					_resourcePath;
+
+                OpenIG::Base::ImageGenerator		*_ig;
+            };
+
+            /*! Effects implemented on the OpenIG particle simulation instead of
+            *   osgParticle. The effect node placed in the scene only tracks the
+            *   emitter position, the particles are simulated in \ref update and
+            *   drawn in world space with one draw per effect type
+            */
+            class ParticleSimulationEffectImplementationCallback : public OpenIG::Base::GenericImplementationCallback
+            {
+            public:
+                ParticleSimulationEffectImplementationCallback(OpenIG::Base::ImageGenerator *ig)
+                    : _ig(ig)
+                    , _lastSimulationTime(-1.0)
+                {
+#ifdef _WIN32
+                    std::string resourcePath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../resources");
+#else
+                    std::string resourcePath = OpenIG::Base::FileSystem::path(OpenIG::Base::FileSystem::Resources, "../../openig/resources");
+#endif
+                    _renderer = new Particles::ParticleBatchRenderer(resourcePath, osg::ShaderUtils::useLogZDepthBuffer());
+                }
+
+                virtual osg::Node* create(unsigned int id, const std::string& name, OpenIG::Base::GenericAttribute* attributes = 0)
+                {
+                    float scale = 10.f;
+                    float intensity = 1.f;
+                    float emiterDuration = 65.f;
+                    float particleDuration = 10.f;
+                    float particleSpeed = 0.0f;
+                    float mass = 0.0f;
+
+                    OpenIG::Base::EffectAttributes* effectAttributes = dynamic_cast<OpenIG::Base::EffectAttributes*>(attributes);
+                    if (effectAttributes != 0)
+                    {
+                        effectAttributes->getFloat("scale", scale);
+                        effectAttributes->getFloat("intensity", intensity);
+                        effectAttributes->getFloat("emiterduration", emiterDuration);
+                        effectAttributes->getFloat("particleduration", particleDuration);
+                        effectAttributes->getFloat("speed", particleSpeed);
+                        effectAttributes->getFloat("mass", mass);
+                    }
+                    else
+                    if (attributes != 0)
+                    {
+                        attributes->getUserValue("scale", scale);
+                        attributes->getUserValue("intensity", intensity);
+                        attributes->getUserValue("emiterduration", emiterDuration);
+                        attributes->getUserValue("particleduration", particleDuration);
+                        attributes->getUserValue("speed", particleSpeed);
+                        attributes->getUserValue("mass", mass);
+                    }
+
+                    Particles::EmitterParams params;
+                    if (!Particles::presetFor(name, scale, intensity, params)) return 0;
+
+                    params.emitterDuration = emiterDuration;
+                    params.particleLifetime = particleDuration;
+                    if (particleSpeed != 0.0f)
+                    {
+                        params.speedMin = params.speedMax = particleSpeed;
+                    }
+                    if (mass != 0.0f)
+                    {
+                        // heavier particles fall, light ones rise
+                        params.gravity = osg::clampBetween(9.81f * (mass - 1.f), -9.81f, 9.81f);
+                    }
+
+                    _simulation.create(id, name, params);
+
+                    if (!_renderer->getRoot()->getNumParents())
+                    {
+                        _ig->getViewer()->getView(0)->getSceneData()->asGroup()->addChild(_renderer->getRoot());
+                    }
+
+                    osg::ref_ptr<osg::Node> emitter = new osg::Node;
+                    emitter->setUpdateCallback(new EmitterPositionCallback(this, id));
+
+                    return emitter.release();
+                }
+
+                virtual void destroy(unsigned int id)
+                {
+                    _simulation.destroy(id);
                 }
 
                 virtual void update(unsigned int, OpenIG::Base::GenericAttribute*)
                 {
                 }
 
+                void setEmitterPosition(unsigned int id, const osg::Vec3& position)
+                {
+                    Particles::ParticleSystem* system = _simulation.get(id);
+                    if (system)
+                    {
+                        system->setEmitterPosition(position.x(), position.y(), position.z());
+                    }
+                }
+
+                void simulate(double simulationTime)
+                {
+                    double dt = _lastSimulationTime < 0.0 ? 0.0 : simulationTime - _lastSimulationTime;
+                    _lastSimulationTime = simulationTime;
+
+                    // clamp after pauses, we do not want a frame to
+                    // simulate seconds worth of particles
+                    _simulation.update(osg::clampBetween(float(dt), 0.f, 0.1f));
+
+                    _renderer->update(_simulation);
+                }
+
             protected:
-                typedef std::map< unsigned int, osg::ref_ptr<osgParticle::ParticleEffect> >	EffectsMap;
-                EffectsMap					_effects;
+                // Tracks the world position of the effect node,
+                // bound effects move with their entities
+                class EmitterPositionCallback : public osg::NodeCallback
+                {
+                public:
+                    EmitterPositionCallback(ParticleSimulationEffectImplementationCallback* effects, unsigned int id)
+                        : _effects(effects)
+                        , _id(id)
+                    {
+                    }
 
-                typedef std::map< unsigned int, osg::ref_ptr<osg::Geode> >					EffectsGeodesMap;
-                EffectsGeodesMap			_effectsGeodes;
+                    virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+                    {
+                        osg::Matrixd mx = osg::computeLocalToWorld(nv->getNodePath());
+                        _effects->setEmitterPosition(_id, mx.getTrans());
 
-                OpenIG::Base::ImageGenerator		*_ig;
+                        traverse(node, nv);
+                    }
+
+                protected:
+                    ParticleSimulationEffectImplementationCallback*	_effects;
+                    unsigned int									_id;
+                };
+
+                OpenIG::Base::ImageGenerator*							_ig;
+                Particles::ParticleSimulation							_simulation;
+                osg::ref_ptr<Particles::ParticleBatchRenderer>			_renderer;
+                double													_lastSimulationTime;
             };
 
             virtual void init(OpenIG::PluginBase::PluginContext& context)
             {
-                context.getImageGenerator()->setEffectImplementationCallback(new OSGParticleEffectImplementationCallback(context.getImageGenerator()));
+                // The OpenIG particle simulation is opt-in, the
+                // osgParticle implementation stays the default
+                std::string strCPUSimulation = OpenIG::Base::Configuration::instance()->getConfig("OSGParticleEffects-CPUSimulation", "no");
+                if (strCPUSimulation.compare(0, 3, "yes") == 0)
+                {
+                    _simulationEffects = new ParticleSimulationEffectImplementationCallback(context.getImageGenerator());
+                    context.getImageGenerator()->setEffectImplementationCallback(_simulationEffects.get());
+                }
+                else
+                {
+                    context.getImageGenerator()->setEffectImplementationCallback(new OSGParticleEffectImplementationCallback(context.getImageGenerator()));
+                }
+            }
+
+            virtual void update(OpenIG::PluginBase::PluginContext& context)
+            {
+                if (_simulationEffects.valid())
+                {
+                    _simulationEffects->simulate(context.getImageGenerator()->getViewer()->getFrameStamp()->getSimulationTime());
+                }
             }
 
+        protected:
+            osg::ref_ptr<ParticleSimulationEffectImplementationCallback>	_simulationEffects;
 
 
         };
@@ -0,0 +1,207 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#include "ParticleBatchRenderer.h"
+
+#include <Core-Utils/ShaderUtils.h>
+
+#include <osg/BlendFunc>
+#include <osg/Depth>
+
+#include <osgDB/ReadFile>
+
+using namespace OpenIG::Plugins::Particles;
+
+namespace
+{
+	// The bounds are known from the simulation, no need
+	// to have osg go through the vertices again
+	class BatchBoundingBoxCallback : public osg::Drawable::ComputeBoundingBoxCallback
+	{
+	public:
+		virtual osg::BoundingBox computeBound(const osg::Drawable&) const
+		{
+			return _bb;
+		}
+
+		osg::BoundingBox _bb;
+	};
+}
+
+ParticleBatchRenderer::ParticleBatchRenderer(const std::string& resourcePath, bool logZDepthBuffer)
+	: _root(new osg::Group)
+	, _resourcePath(resourcePath)
+{
+	osg::ShaderProgramRegistry::Description description("particles_program");
+	description
+		.addShader(osg::Shader::VERTEX).addFile(_resourcePath + "/shaders/particles_vs.glsl")
+		.addShader(osg::Shader::GEOMETRY).addFile(_resourcePath + "/shaders/particles_gs.glsl")
+		.addShader(osg::Shader::FRAGMENT).addFile(_resourcePath + "/shaders/particles_ps.glsl")
+		.addBindAttribLocation("inSize", 6);
+
+	_program = osg::ShaderProgramRegistry::instance()->getOrCreateProgram(description);
+	if (!_program.valid())
+	{
+		osg::notify(osg::NOTICE) << "OSGParticleEffects: could not load the particle programs (vs, gs, ps)" << std::endl;
+	}
+
+	osg::StateSet* ss = _root->getOrCreateStateSet();
+	if (_program.valid())
+	{
+		ss->setAttributeAndModes(_program.get(), osg::StateAttribute::ON | osg::StateAttribute::PROTECTED);
+	}
+	ss->setAttributeAndModes(new osg::BlendFunc(osg::BlendFunc::SRC_ALPHA, osg::BlendFunc::ONE_MINUS_SRC_ALPHA), osg::StateAttribute::ON);
+	ss->setAttributeAndModes(new osg::Depth(osg::Depth::LESS, 0.0, 1.0, false), osg::StateAttribute::ON);
+	ss->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+	ss->setRenderingHint(osg::StateSet::TRANSPARENT_BIN);
+	ss->addUniform(new osg::Uniform("baseTexture", 0));
+
+	if (logZDepthBuffer)
+	{
+		ss->setDefine("USE_LOG_DEPTH_BUFFER", "1");
+	}
+}
+
+ParticleBatchRenderer::Batch& ParticleBatchRenderer::getOrCreateBatch(const std::string& type)
+{
+	Batches::iterator itr = _batches.find(type);
+	if (itr != _batches.end()) return itr->second;
+
+	Batch& batch = _batches[type];
+
+	batch.vertices = new osg::Vec3Array;
+	batch.colors = new osg::Vec4Array;
+	batch.sizes = new osg::FloatArray;
+	batch.primitive = new osg::DrawArrays(osg::PrimitiveSet::POINTS, 0, 0);
+
+	batch.geometry = new osg::Geometry;
+	batch.geometry->setDataVariance(osg::Object::DYNAMIC);
+	batch.geometry->setUseDisplayList(false);
+	batch.geometry->setUseVertexBufferObjects(true);
+	batch.geometry->setVertexArray(batch.vertices.get());
+	batch.geometry->setColorArray(batch.colors.get(), osg::Array::BIND_PER_VERTEX);
+	batch.geometry->setVertexAttribArray(6, batch.sizes.get(), osg::Array::BIND_PER_VERTEX);
+	batch.geometry->addPrimitiveSet(batch.primitive.get());
+	batch.geometry->setComputeBoundingBoxCallback(new BatchBoundingBoxCallback);
+
+	std::string texture = type == "SmokeTrailEffect" ? "/textures/continuous_smoke.rgb" : "/textures/smoke.rgb";
+	osg::ref_ptr<osg::Image> image = osgDB::readImageFile(_resourcePath + texture);
+	if (image.valid())
+	{
+		batch.geometry->getOrCreateStateSet()->setTextureAttributeAndModes(0, new osg::Texture2D(image.get()), osg::StateAttribute::ON);
+	}
+
+	batch.geode = new osg::Geode;
+	batch.geode->addDrawable(batch.geometry.get());
+
+	batch.transform = new osg::MatrixTransform;
+	batch.transform->setDataVariance(osg::Object::DYNAMIC);
+	batch.transform->addChild(batch.geode.get());
+
+	_root->addChild(batch.transform.get());
+
+	return batch;
+}
+
+void ParticleBatchRenderer::update(const ParticleSimulation& simulation)
+{
+	for (Batches::iterator itr = _batches.begin(); itr != _batches.end(); ++itr)
+	{
+		Batch& batch = itr->second;
+		batch.origin.set(0.0, 0.0, 0.0);
+		batch.vertices->clear();
+		batch.colors->clear();
+		batch.sizes->clear();
+		static_cast<BatchBoundingBoxCallback*>(batch.geometry->getComputeBoundingBoxCallback())->_bb.init();
+	}
+
+	const ParticleSimulation::Systems& systems = simulation.getSystems();
+	for (size_t i = 0; i < systems.size(); ++i)
+	{
+		const ParticleSystem* system = systems.at(i);
+
+		size_t n = system->size();
+		if (n == 0) continue;
+
+		Batch& batch = getOrCreateBatch(system->getType());
+		osg::BoundingBox& bb = static_cast<BatchBoundingBoxCallback*>(batch.geometry->getComputeBoundingBoxCallback())->_bb;
+
+		// the first system sets the origin of the batch, the
+		// others are offset from it with the difference in double
+		const double* origin = system->origin();
+		osg::Vec3d systemOrigin(origin[0], origin[1], origin[2]);
+		if (batch.vertices->empty())
+		{
+			batch.origin = systemOrigin;
+		}
+		osg::Vec3 offset = systemOrigin - batch.origin;
+
+		const float* px = system->px();
+		const float* py = system->py();
+		const float* pz = system->pz();
+		const float* sizes = system->sizes();
+		const float* alphas = system->alphas();
+		const float* color = system->getParams().color;
+
+		float maxSize = 0.f;
+		for (size_t p = 0; p < n; ++p)
+		{
+			osg::Vec3 v = offset + osg::Vec3(px[p], py[p], pz[p]);
+			batch.vertices->push_back(v);
+			batch.colors->push_back(osg::Vec4(color[0], color[1], color[2], alphas[p]));
+			batch.sizes->push_back(sizes[p]);
+
+			bb.expandBy(v);
+			maxSize = osg::maximum(maxSize, sizes[p]);
+		}
+
+		// the quads are bigger than the points
+		bb.expandBy(bb._min - osg::Vec3(maxSize, maxSize, maxSize));
+		bb.expandBy(bb._max + osg::Vec3(maxSize, maxSize, maxSize));
+	}
+
+	for (Batches::iterator itr = _batches.begin(); itr != _batches.end(); ++itr)
+	{
+		Batch& batch = itr->second;
+
+		batch.primitive->setCount(batch.vertices->size());
+		batch.primitive->dirty();
+
+		batch.vertices->dirty();
+		batch.colors->dirty();
+		batch.sizes->dirty();
+
+		batch.geometry->dirtyBound();
+		batch.transform->setMatrix(osg::Matrixd::translate(batch.origin));
+		batch.transform->setNodeMask(batch.vertices->empty() ? 0x0 : ~0x0);
+	}
+}
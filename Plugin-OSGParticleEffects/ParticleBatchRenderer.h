@@ -0,0 +1,97 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#ifndef PARTICLEBATCHRENDERER_H
+#define PARTICLEBATCHRENDERER_H
+
+#include "ParticleSimulation.h"
+
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+#include <osg/Program>
+#include <osg/Texture2D>
+
+#include <map>
+#include <string>
+
+namespace OpenIG {
+	namespace Plugins {
+		namespace Particles {
+
+			/*! Draws the particles of the \ref ParticleSimulation with one
+			 *  draw per effect type. The particles are passed as points and
+			 *  expanded to camera facing quads in a geometry shader, the same
+			 *  way the sprites and the GPU vegetation are done. All the types
+			 *  share one program. The vertices of a batch are relative to the
+			 *  origin of one of its systems, placed with a double precision
+			 *  transform so large world coordinates do not jitter
+			 * \brief Batched particle rendering
+			 */
+			class ParticleBatchRenderer : public osg::Referenced
+			{
+			public:
+				ParticleBatchRenderer(const std::string& resourcePath, bool logZDepthBuffer);
+
+				/*! The root to be attached to the scene, in world space */
+				osg::Group* getRoot() { return _root.get(); }
+
+				/*! Copies the simulated particles into the per type batches */
+				void update(const ParticleSimulation& simulation);
+
+			protected:
+				struct Batch
+				{
+					osg::ref_ptr<osg::MatrixTransform>	transform;
+					osg::ref_ptr<osg::Geode>		geode;
+					osg::ref_ptr<osg::Geometry>		geometry;
+					osg::ref_ptr<osg::Vec3Array>	vertices;
+					osg::ref_ptr<osg::Vec4Array>	colors;
+					osg::ref_ptr<osg::FloatArray>	sizes;
+					osg::ref_ptr<osg::DrawArrays>	primitive;
+					osg::Vec3d						origin;
+				};
+
+				Batch& getOrCreateBatch(const std::string& type);
+
+				typedef std::map< std::string, Batch >	Batches;
+				Batches						_batches;
+
+				osg::ref_ptr<osg::Group>	_root;
+				osg::ref_ptr<osg::Program>	_program;
+				std::string					_resourcePath;
+			};
+		}
+	}
+}
+
+#endif // PARTICLEBATCHRENDERER_H
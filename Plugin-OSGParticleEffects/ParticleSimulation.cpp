@@ -0,0 +1,515 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#include "ParticleSimulation.h"
+
+#include <Core-Base/ThreadPool.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENIG_PARTICLES_SSE 1
+#include <emmintrin.h>
+#endif
+
+using namespace OpenIG::Plugins::Particles;
+
+// The particle positions are floats relative to an origin kept within
+// this distance of the emitter, so they keep sub millimeter precision
+static const double _originRebaseDistance = 1000.0;
+
+EmitterParams::EmitterParams()
+	: rate(20.f)
+	, burst(0)
+	, emitterDuration(65.f)
+	, particleLifetime(10.f)
+	, speedMin(0.f)
+	, speedMax(1.f)
+	, spread(0.2f)
+	, sizeStart(1.f)
+	, sizeEnd(4.f)
+	, alphaStart(1.f)
+	, alphaEnd(0.f)
+	, drag(0.5f)
+	, gravity(0.f)
+	, windX(0.f)
+	, windY(0.f)
+	, windZ(0.f)
+{
+	color[0] = color[1] = color[2] = 0.5f;
+}
+
+bool OpenIG::Plugins::Particles::presetFor(const std::string& name, float scale, float intensity, EmitterParams& params)
+{
+	params = EmitterParams();
+
+	if (name == "ExplosionEffect")
+	{
+		params.rate = 0.f;
+		params.burst = (unsigned int)(200.f * intensity);
+		params.emitterDuration = 1.f;
+		params.particleLifetime = 1.f;
+		params.speedMin = 1.f * scale;
+		params.speedMax = 3.f * scale;
+		params.spread = 1.f;
+		params.sizeStart = 0.75f * scale;
+		params.sizeEnd = 3.f * scale;
+		params.drag = 3.f;
+		params.color[0] = 1.f; params.color[1] = 0.8f; params.color[2] = 0.2f;
+	}
+	else
+	if (name == "ExplosionDebrisEffect")
+	{
+		params.rate = 0.f;
+		params.burst = (unsigned int)(50.f * intensity);
+		params.emitterDuration = 1.f;
+		params.particleLifetime = 3.f;
+		params.speedMin = 2.f * scale;
+		params.speedMax = 10.f * scale;
+		params.spread = 0.6f;
+		params.sizeStart = 0.1f * scale;
+		params.sizeEnd = 0.1f * scale;
+		params.alphaEnd = 1.f;
+		params.drag = 0.1f;
+		params.gravity = 9.81f;
+		params.color[0] = params.color[1] = params.color[2] = 0.2f;
+	}
+	else
+	if (name == "SmokeEffect")
+	{
+		params.rate = 10.f * intensity;
+		params.particleLifetime = 10.f;
+		params.speedMin = 0.5f * scale * 0.1f;
+		params.speedMax = 1.f * scale * 0.1f;
+		params.spread = 0.2f;
+		params.sizeStart = 0.75f * scale;
+		params.sizeEnd = 3.f * scale;
+		params.alphaStart = 0.5f;
+		params.gravity = -0.1f * scale;
+		params.color[0] = params.color[1] = params.color[2] = 0.3f;
+	}
+	else
+	if (name == "SmokeTrailEffect")
+	{
+		params.rate = 20.f * intensity;
+		params.particleLifetime = 10.f;
+		params.speedMin = 0.f;
+		params.speedMax = 0.1f * scale;
+		params.spread = 1.f;
+		params.sizeStart = 0.5f * scale;
+		params.sizeEnd = 4.f * scale;
+		params.alphaStart = 0.5f;
+		params.windX = 1.f;
+		params.color[0] = params.color[1] = params.color[2] = 0.8f;
+	}
+	else
+	if (name == "FireEffect")
+	{
+		params.rate = 20.f * intensity;
+		params.particleLifetime = 0.5f;
+		params.speedMin = 0.5f * scale * 0.1f;
+		params.speedMax = 1.5f * scale * 0.1f;
+		params.spread = 0.1f;
+		params.sizeStart = 0.5f * scale;
+		params.sizeEnd = 0.2f * scale;
+		params.gravity = -1.f * scale;
+		params.color[0] = 1.f; params.color[1] = 0.5f; params.color[2] = 0.1f;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+ParticleSystem::ParticleSystem(const std::string& type, const EmitterParams& params, unsigned int seed)
+	: _type(type)
+{
+	reset(params, seed);
+}
+
+void ParticleSystem::reset(const EmitterParams& params, unsigned int seed)
+{
+	_params = params;
+	_time = 0.f;
+	_emitAccumulator = 0.f;
+	_random = seed ? seed : 1;
+	_origin[0] = _origin[1] = _origin[2] = 0.0;
+	_emitterPosition[0] = _emitterPosition[1] = _emitterPosition[2] = 0.f;
+
+	// clear() keeps the capacity, so recycled
+	// systems do not allocate again
+	_px.clear(); _py.clear(); _pz.clear();
+	_vx.clear(); _vy.clear(); _vz.clear();
+	_age.clear();
+	_size.clear();
+	_alpha.clear();
+}
+
+void ParticleSystem::setEmitterPosition(double x, double y, double z)
+{
+	double dx = x - _origin[0];
+	double dy = y - _origin[1];
+	double dz = z - _origin[2];
+	if (dx * dx + dy * dy + dz * dz > _originRebaseDistance * _originRebaseDistance)
+	{
+		rebase(x, y, z);
+	}
+
+	_emitterPosition[0] = float(x - _origin[0]);
+	_emitterPosition[1] = float(y - _origin[1]);
+	_emitterPosition[2] = float(z - _origin[2]);
+}
+
+void ParticleSystem::rebase(double x, double y, double z)
+{
+	// the offset is computed in double, the live
+	// particles only move by what fits a float
+	const float ox = float(_origin[0] - x);
+	const float oy = float(_origin[1] - y);
+	const float oz = float(_origin[2] - z);
+
+	for (size_t i = 0; i < _px.size(); ++i)
+	{
+		_px[i] += ox;
+		_py[i] += oy;
+		_pz[i] += oz;
+	}
+
+	_origin[0] = x;
+	_origin[1] = y;
+	_origin[2] = z;
+}
+
+bool ParticleSystem::isFinished() const
+{
+	return _params.emitterDuration > 0.f && _time >= _params.emitterDuration && _px.empty();
+}
+
+float ParticleSystem::random()
+{
+	// xorshift32, good enough for particles and cheap
+	_random ^= _random << 13;
+	_random ^= _random >> 17;
+	_random ^= _random << 5;
+
+	return (_random & 0xFFFFFF) / float(0x1000000);
+}
+
+void ParticleSystem::update(float dt)
+{
+	if (dt <= 0.f) return;
+
+	integrate(dt);
+	retire();
+
+	bool emitting = _params.emitterDuration <= 0.f || _time < _params.emitterDuration;
+	if (emitting)
+	{
+		unsigned int count = 0;
+		if (_time == 0.f)
+		{
+			count += _params.burst;
+		}
+
+		_emitAccumulator += _params.rate * dt;
+		unsigned int fromRate = (unsigned int)_emitAccumulator;
+		_emitAccumulator -= fromRate;
+
+		emit(count + fromRate);
+	}
+
+	_time += dt;
+}
+
+void ParticleSystem::emit(unsigned int count)
+{
+	static const float twoPi = 6.28318530718f;
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		float z = 1.f - 2.f * _params.spread * random();
+		float r = std::sqrt(std::max(0.f, 1.f - z * z));
+		float phi = twoPi * random();
+		float speed = _params.speedMin + (_params.speedMax - _params.speedMin) * random();
+
+		_px.push_back(_emitterPosition[0]);
+		_py.push_back(_emitterPosition[1]);
+		_pz.push_back(_emitterPosition[2]);
+		_vx.push_back(r * std::cos(phi) * speed);
+		_vy.push_back(r * std::sin(phi) * speed);
+		_vz.push_back(z * speed);
+		_age.push_back(0.f);
+		_size.push_back(_params.sizeStart);
+		_alpha.push_back(_params.alphaStart);
+	}
+}
+
+void ParticleSystem::integrate(float dt)
+{
+	const size_t n = _px.size();
+	if (n == 0) return;
+
+	const float drag = std::min(1.f, _params.drag * dt);
+	const float gdt = -_params.gravity * dt;
+	const float invLife = _params.particleLifetime > 0.f ? 1.f / _params.particleLifetime : 0.f;
+	const float dSize = _params.sizeEnd - _params.sizeStart;
+	const float dAlpha = _params.alphaEnd - _params.alphaStart;
+
+	float* px = &_px[0]; float* py = &_py[0]; float* pz = &_pz[0];
+	float* vx = &_vx[0]; float* vy = &_vy[0]; float* vz = &_vz[0];
+	float* age = &_age[0];
+	float* size = &_size[0];
+	float* alpha = &_alpha[0];
+
+	size_t i = 0;
+
+#if OPENIG_PARTICLES_SSE
+	const __m128 vdt = _mm_set1_ps(dt);
+	const __m128 vdrag = _mm_set1_ps(drag);
+	const __m128 vgdt = _mm_set1_ps(gdt);
+	const __m128 vwx = _mm_set1_ps(_params.windX);
+	const __m128 vwy = _mm_set1_ps(_params.windY);
+	const __m128 vwz = _mm_set1_ps(_params.windZ);
+	const __m128 vinvLife = _mm_set1_ps(invLife);
+	const __m128 vone = _mm_set1_ps(1.f);
+	const __m128 vsize0 = _mm_set1_ps(_params.sizeStart);
+	const __m128 vdsize = _mm_set1_ps(dSize);
+	const __m128 valpha0 = _mm_set1_ps(_params.alphaStart);
+	const __m128 vdalpha = _mm_set1_ps(dAlpha);
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(vx + i);
+		__m128 y = _mm_loadu_ps(vy + i);
+		__m128 z = _mm_loadu_ps(vz + i);
+
+		x = _mm_add_ps(x, _mm_mul_ps(_mm_sub_ps(vwx, x), vdrag));
+		y = _mm_add_ps(y, _mm_mul_ps(_mm_sub_ps(vwy, y), vdrag));
+		z = _mm_add_ps(_mm_add_ps(z, _mm_mul_ps(_mm_sub_ps(vwz, z), vdrag)), vgdt);
+
+		_mm_storeu_ps(vx + i, x);
+		_mm_storeu_ps(vy + i, y);
+		_mm_storeu_ps(vz + i, z);
+
+		_mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(x, vdt)));
+		_mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(y, vdt)));
+		_mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(z, vdt)));
+
+		__m128 a = _mm_add_ps(_mm_loadu_ps(age + i), vdt);
+		_mm_storeu_ps(age + i, a);
+
+		__m128 t = _mm_min_ps(_mm_mul_ps(a, vinvLife), vone);
+		_mm_storeu_ps(size + i, _mm_add_ps(vsize0, _mm_mul_ps(vdsize, t)));
+		_mm_storeu_ps(alpha + i, _mm_add_ps(valpha0, _mm_mul_ps(vdalpha, t)));
+	}
+#endif
+
+	for (; i < n; ++i)
+	{
+		vx[i] += (_params.windX - vx[i]) * drag;
+		vy[i] += (_params.windY - vy[i]) * drag;
+		vz[i] += (_params.windZ - vz[i]) * drag + gdt;
+
+		px[i] += vx[i] * dt;
+		py[i] += vy[i] * dt;
+		pz[i] += vz[i] * dt;
+
+		age[i] += dt;
+
+		float t = std::min(age[i] * invLife, 1.f);
+		size[i] = _params.sizeStart + dSize * t;
+		alpha[i] = _params.alphaStart + dAlpha * t;
+	}
+}
+
+void ParticleSystem::retire()
+{
+	// swap-remove, a dead particle takes the last one
+	// so only the dead are moved, not all the live ones
+	size_t n = _age.size();
+	for (size_t i = 0; i < n; )
+	{
+		if (_age[i] < _params.particleLifetime)
+		{
+			++i;
+			continue;
+		}
+
+		--n;
+		_px[i] = _px[n]; _py[i] = _py[n]; _pz[i] = _pz[n];
+		_vx[i] = _vx[n]; _vy[i] = _vy[n]; _vz[i] = _vz[n];
+		_age[i] = _age[n];
+		_size[i] = _size[n];
+		_alpha[i] = _alpha[n];
+	}
+
+	if (n == _age.size()) return;
+
+	_px.resize(n); _py.resize(n); _pz.resize(n);
+	_vx.resize(n); _vy.resize(n); _vz.resize(n);
+	_age.resize(n);
+	_size.resize(n);
+	_alpha.resize(n);
+}
+
+ParticleSimulation::ParticleSimulation()
+	: _seed(1)
+{
+}
+
+ParticleSimulation::~ParticleSimulation()
+{
+	for (SystemsById::iterator itr = _systemsById.begin(); itr != _systemsById.end(); ++itr)
+	{
+		delete itr->second;
+	}
+	for (SystemPools::iterator itr = _pools.begin(); itr != _pools.end(); ++itr)
+	{
+		for (size_t i = 0; i < itr->second.size(); ++i)
+		{
+			delete itr->second.at(i);
+		}
+	}
+}
+
+ParticleSystem* ParticleSimulation::create(unsigned int id, const std::string& type, const EmitterParams& params)
+{
+	destroy(id);
+
+	_seed = _seed * 1664525u + 1013904223u;
+
+	ParticleSystem* system = 0;
+
+	std::vector<ParticleSystem*>& pool = _pools[type];
+	if (!pool.empty())
+	{
+		system = pool.back();
+		pool.pop_back();
+		system->reset(params, _seed);
+	}
+	else
+	{
+		system = new ParticleSystem(type, params, _seed);
+	}
+
+	_systemsById[id] = system;
+	_systems.push_back(system);
+
+	return system;
+}
+
+void ParticleSimulation::destroy(unsigned int id)
+{
+	SystemsById::iterator itr = _systemsById.find(id);
+	if (itr == _systemsById.end()) return;
+
+	ParticleSystem* system = itr->second;
+	_systemsById.erase(itr);
+
+	Systems::iterator sitr = std::find(_systems.begin(), _systems.end(), system);
+	if (sitr != _systems.end())
+	{
+		*sitr = _systems.back();
+		_systems.pop_back();
+	}
+
+	static const size_t maxPooledSystemsPerType = 64;
+
+	std::vector<ParticleSystem*>& pool = _pools[system->getType()];
+	if (pool.size() < maxPooledSystemsPerType)
+	{
+		pool.push_back(system);
+	}
+	else
+	{
+		delete system;
+	}
+}
+
+ParticleSystem* ParticleSimulation::get(unsigned int id)
+{
+	SystemsById::iterator itr = _systemsById.find(id);
+	return itr != _systemsById.end() ? itr->second : 0;
+}
+
+void ParticleSimulation::updateRange(float dt, size_t start, size_t num)
+{
+	for (size_t i = start; i < start + num; ++i)
+	{
+		_systems[i]->update(dt);
+	}
+}
+
+void ParticleSimulation::update(float dt, bool parallel)
+{
+	// Below a few systems the hand off to the
+	// pool costs more than the update itself
+	static const size_t minSystemsPerChunk = 4;
+
+	if (parallel && _systems.size() > minSystemsPerChunk)
+	{
+		OpenIG::Base::ThreadPool::instance()->parallelFor(
+			_systems.size(),
+			boost::bind(&ParticleSimulation::updateRange, this, dt, _1, _2),
+			minSystemsPerChunk);
+	}
+	else
+	{
+		updateRange(dt, 0, _systems.size());
+	}
+
+	// back to the pools, the effect is not
+	// visible anymore and the system can be reused
+	for (SystemsById::iterator itr = _systemsById.begin(); itr != _systemsById.end(); )
+	{
+		unsigned int id = itr->first;
+		bool finished = itr->second->isFinished();
+		++itr;
+
+		if (finished) destroy(id);
+	}
+}
+
+size_t ParticleSimulation::getNumParticles() const
+{
+	size_t count = 0;
+	for (size_t i = 0; i < _systems.size(); ++i)
+	{
+		count += _systems[i]->size();
+	}
+	return count;
+}
@@ -0,0 +1,185 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#ifndef PARTICLESIMULATION_H
+#define PARTICLESIMULATION_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OpenIG {
+	namespace Plugins {
+		namespace Particles {
+
+			/*! Parameters of a particle emitter. The defaults for the
+			 *  known effect names are given by \ref presetFor and then
+			 *  scaled by the effect attributes
+			 * \brief Particle emitter parameters
+			 */
+			struct EmitterParams
+			{
+				float	rate;				// particles per second
+				unsigned int burst;			// particles emitted at start
+				float	emitterDuration;	// seconds, 0 is endless
+				float	particleLifetime;	// seconds, same for all the particles of a system
+				float	speedMin;
+				float	speedMax;
+				float	spread;				// 0 straight up, 1 full sphere
+				float	sizeStart;
+				float	sizeEnd;
+				float	alphaStart;
+				float	alphaEnd;
+				float	drag;				// 1/s, how fast particles follow the wind
+				float	gravity;			// m/s^2 along -Z, negative for buoyant smoke
+				float	windX;
+				float	windY;
+				float	windZ;
+				float	color[3];
+
+				EmitterParams();
+			};
+
+			/*!
+			 * \brief Default emitter parameters for the effect names the plugin
+			 *		  always supported, with the same attributes semantics
+			 * \param name		Effect name, ex ExplosionEffect, SmokeEffect ...
+			 * \param scale		The "scale" attribute
+			 * \param intensity	The "intensity" attribute
+			 * \param params	The resulting parameters
+			 * \return false if the name is unknown
+			 */
+			bool presetFor(const std::string& name, float scale, float intensity, EmitterParams& params);
+
+			/*! Particles of one effect in structure-of-arrays layout. The
+			 *  positions are floats relative to a double precision origin
+			 *  that follows the emitter, so they stay precise far from the
+			 *  world origin. Dead particles are swap-removed, the order of
+			 *  the particles is not kept
+			 * \brief Particle system with SoA storage
+			 */
+			class ParticleSystem
+			{
+			public:
+				ParticleSystem(const std::string& type, const EmitterParams& params, unsigned int seed = 1);
+
+				/*! Resets the system to be recycled for a new effect */
+				void reset(const EmitterParams& params, unsigned int seed = 1);
+
+				/*! World position of the emitter. Rebases the origin
+				 *  when the emitter got too far from it */
+				void setEmitterPosition(double x, double y, double z);
+
+				/*! Emits, integrates and retires particles */
+				void update(float dt);
+
+				const std::string& getType() const { return _type; }
+				const EmitterParams& getParams() const { return _params; }
+
+				size_t size() const { return _px.size(); }
+
+				/*! The emitter is done and all its particles are dead */
+				bool isFinished() const;
+
+				/*! World position the particle positions are relative to */
+				const double* origin() const { return _origin; }
+
+				const float* px() const { return size() ? &_px[0] : 0; }
+				const float* py() const { return size() ? &_py[0] : 0; }
+				const float* pz() const { return size() ? &_pz[0] : 0; }
+				const float* sizes() const { return size() ? &_size[0] : 0; }
+				const float* alphas() const { return size() ? &_alpha[0] : 0; }
+
+			protected:
+				void emit(unsigned int count);
+				void integrate(float dt);
+				void retire();
+				void rebase(double x, double y, double z);
+
+				float random();
+
+				std::string		_type;
+				EmitterParams	_params;
+
+				double			_origin[3];
+				float			_emitterPosition[3];
+				float			_time;
+				float			_emitAccumulator;
+				unsigned int	_random;
+
+				std::vector<float>	_px, _py, _pz;
+				std::vector<float>	_vx, _vy, _vz;
+				std::vector<float>	_age;
+				std::vector<float>	_size;
+				std::vector<float>	_alpha;
+			};
+
+			/*! All the particle systems, updated in chunks in parallel. Systems
+			 *  of destroyed or finished effects are kept in per type pools for reuse
+			 * \brief The particle simulation
+			 */
+			class ParticleSimulation
+			{
+			public:
+				ParticleSimulation();
+				~ParticleSimulation();
+
+				ParticleSystem* create(unsigned int id, const std::string& type, const EmitterParams& params);
+				void destroy(unsigned int id);
+
+				ParticleSystem* get(unsigned int id);
+
+				/*! Updates all the systems. Uses the thread pool when there is enough work.
+				 *  The finished systems are destroyed afterwards */
+				void update(float dt, bool parallel = true);
+
+				size_t getNumParticles() const;
+
+				typedef std::vector<ParticleSystem*>	Systems;
+				const Systems& getSystems() const { return _systems; }
+
+			protected:
+				void updateRange(float dt, size_t start, size_t num);
+
+				typedef std::map<unsigned int, ParticleSystem*>				SystemsById;
+				typedef std::map<std::string, std::vector<ParticleSystem*> >	SystemPools;
+
+				SystemsById		_systemsById;
+				Systems			_systems;
+				SystemPools		_pools;
+				unsigned int	_seed;
+			};
+		}
+	}
+}
+
+#endif // PARTICLESIMULATION_H
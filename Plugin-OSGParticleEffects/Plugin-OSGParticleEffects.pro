@@ -13,12 +13,16 @@ TEMPLATE = lib
 
 DEFINES += IGPLUGINOSGPARTICLEEFFECTS_LIBRARY
 
-SOURCES += IGPluginOSGParticleEffects.cpp
+SOURCES += IGPluginOSGParticleEffects.cpp\
+           ParticleBatchRenderer.cpp\
+           ParticleSimulation.cpp
 
-HEADERS +=
+HEADERS += ParticleBatchRenderer.h\
+           ParticleSimulation.h
 
 LIBS += -losg -losgDB -losgViewer -lOpenThreads -losgShadow -losgParticle\
-        -lOpenIG-Engine -lOpenIG-PluginBase -lOpenIG-Base
+        -lOpenIG-Engine -lOpenIG-PluginBase -lOpenIG-Base -lOpenIG-Utils\
+        -lboost_system -lboost_thread
 
 INCLUDEPATH += ../
 DEPENDPATH += ../
@@ -38,6 +38,7 @@
 #include <Core-Base/Mathematics.h>
 #include <Core-Base/Commands.h>
 #include <Core-Base/FileSystem.h>
+#include <Core-Base/FileWatcher.h>
 
 #include <Core-OpenIG/Engine.h>
 #include <Core-OpenIG/RenderBins.h>
@@ -52,6 +53,7 @@
 #include <SilverLining.h>
 
 #include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 
 #include "AtmosphereReference.h"
@@ -81,6 +83,7 @@ namespace OpenIG {
                 , _sunMoonBrightness_day(1.f)
                 , _sunMoonBrightness_night(1.f)
                 , _updateEnvMapDynamically(false)
+                , _xmlSubscription(0)
             {
 
             }
@@ -606,15 +609,6 @@ namespace OpenIG {
                 }
                 if (h > 23) h = 0;
 #endif
-                // Here we check if the XML has changed. If so, reload and update
-                _xmlAccessMutex.lock();
-                if (_xmlLastCheckedTime != _xmlLastWriteTime)
-                {
-                    osg::notify(osg::NOTICE) << "SilverLining: XML updated: " << _xmlFileName << std::endl;
-                    readXML(_xmlFileName);
-                    _xmlLastCheckedTime = _xmlLastWriteTime;
-                }
-                _xmlAccessMutex.unlock();
 
                 {
                     if (!_skyboxSizeSet)
@@ -830,13 +824,8 @@ namespace OpenIG {
 
             virtual void clean(OpenIG::PluginBase::PluginContext& context)
             {
-                if (_xmlFileObserverThread.get())
-                {
-                    _xmlThreadRunningCondition = false;
-                    while (_xmlThreadIsRunning);
-                    _xmlFileObserverThread->join();
-                }
-                _xmlFileObserverThread.reset();
+                OpenIG::Base::FileWatcher::instance()->unsubscribe(_xmlSubscription);
+                _xmlSubscription = 0;
 
                 OpenIG::Base::Commands::instance()->removeCommand("silverlining");
                 OpenIG::Base::Commands::instance()->removeCommand("setskyboxsize");
@@ -947,30 +936,12 @@ namespace OpenIG {
                 }
             }
 
-            // Thread function to check the
-            // XML config file if changed
-            void xmlFileObserverThread()
+            // Called by the FileWatcher from the
+            // update when the XML config file has changed
+            void xmlFileChanged(const std::string& fileName)
             {
-                _xmlThreadRunningCondition = true;
-                _xmlThreadIsRunning = true;
-
-                while (_xmlThreadRunningCondition)
-                {
-                    try
-                    {
-                        _xmlAccessMutex.lock();
-                        _xmlLastWriteTime = _xmlLastWriteTime = OpenIG::Base::FileSystem::lastWriteTime(_xmlFileName);
-                        _xmlAccessMutex.unlock();
-                    }
-                    catch (const std::exception& e)
-                    {
-                        osg::notify(osg::NOTICE) << "SilverLining: File montoring exception: " << e.what() << std::endl;
-                        break;
-                    }
-
-                    OpenThreads::Thread::microSleep(10000);
-                }
-                _xmlThreadIsRunning = false;
+                osg::notify(osg::NOTICE) << "SilverLining: XML updated: " << fileName << std::endl;
+                readXML(fileName);
             }
 
             virtual void databaseRead(const std::string& fileName, osg::Node*, const osgDB::Options*)
@@ -978,8 +949,11 @@ namespace OpenIG {
                 std::string xmlFile = fileName + ".lighting.xml";
                 if (!osgDB::fileExists(xmlFile)) return;
 
-                _xmlFileObserverThread = boost::shared_ptr<boost::thread>(new boost::thread(&OpenIG::Plugins::SilverLiningPlugin::xmlFileObserverThread, this));
-
+                OpenIG::Base::FileWatcher::instance()->unsubscribe(_xmlSubscription);
+                _xmlSubscription = OpenIG::Base::FileWatcher::instance()->subscribe(
+                    xmlFile,
+                    boost::bind(&OpenIG::Plugins::SilverLiningPlugin::xmlFileChanged, this, _1)
+                    );
 
                 readXML(_xmlFileName = xmlFile);
             }
@@ -1010,12 +984,7 @@ namespace OpenIG {
             osg::ref_ptr<osg::Geode>		_skyGeode;
             osg::ref_ptr<osg::Geode>		_cloudsGeode;
 
-            boost::shared_ptr<boost::thread>	_xmlFileObserverThread;
-            volatile bool						_xmlThreadIsRunning;
-            volatile bool						_xmlThreadRunningCondition;
-            boost::mutex						_xmlAccessMutex;
-            std::time_t							_xmlLastWriteTime;
-            std::time_t							_xmlLastCheckedTime;
+            OpenIG::Base::FileWatcher::SubscriptionID	_xmlSubscription;
 
 
             const EnvMapUpdater* initSilverLining(OpenIG::Base::ImageGenerator* ig)
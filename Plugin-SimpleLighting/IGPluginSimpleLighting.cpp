@@ -41,6 +41,9 @@
 #include <Core-Base/Configuration.h>
 #include <Core-Base/FileSystem.h>
 
+#include <Core-Utils/LightAssignment.h>
+#include <Core-Utils/ShaderUtils.h>
+
 #include <osg/ref_ptr>
 #include <osg/LightSource>
 #include <osg/Material>
@@ -63,15 +66,16 @@ namespace OpenIG {
             SimpleLightingPlugin()
                 : _cloudsShadowsTextureSlot(6)
                 , _setupDone(false)
+                , _lightAssignment(new osg::LightAssignment(1, 7))
             {
 
             }
 
             virtual std::string getName() { return "SimpleLighting"; }
 
-            virtual std::string getDescription() { return "Implements simple lighting by using shaders and OpenGL, limited to 7 (+sun) lights"; }
+            virtual std::string getDescription() { return "Implements simple lighting by using shaders and OpenGL, the 7 (+sun) most influential lights per drawable"; }
 
-            virtual std::string getVersion() { return "1.0.0"; }
+            virtual std::string getVersion() { return "1.1.0"; }
 
             virtual std::string getAuthor() { return "ComPro, Nick"; }
 
@@ -157,10 +161,19 @@ namespace OpenIG {
                 if (!_setupDone) setup(context);
             }
 
+            virtual void databaseRead(const std::string&, osg::Node* node, const osgDB::Options*)
+            {
+                if (node) _lightAssignment->install(*node);
+            }
+
             virtual void setup(OpenIG::PluginBase::PluginContext& context)
             {
-                _lightImplementationCallback = new SimpleLightImplementationCallback(context.getImageGenerator());
-                context.getImageGenerator()->setLightImplementationCallback(_lightImplementationCallback);
+                // The lights live in the callback, keep it across the setup retries
+                if (!_lightImplementationCallback.valid())
+                {
+                    _lightImplementationCallback = new SimpleLightImplementationCallback(context.getImageGenerator(), _lightAssignment);
+                    context.getImageGenerator()->setLightImplementationCallback(_lightImplementationCallback);
+                }
 
                 std::ostringstream ossfs;
                 ossfs << "#define SELF_SHADOW_STAGE  1                                                                   \n";
@@ -263,8 +276,7 @@ namespace OpenIG {
                                 float shadowsFactor = OpenIG::Base::Configuration::instance()->getConfig("Shadows-Factor", 0.5);
                                 ss->addUniform(new osg::Uniform("shadowsFactor", shadowsFactor));
 
-                                std::string strLogZDepthBuffer = OpenIG::Base::Configuration::instance()->getConfig("LogZDepthBuffer", "yes");
-                                if (strLogZDepthBuffer.compare(0, 3, "yes") == 0)
+                                if (osg::ShaderUtils::useLogZDepthBuffer())
                                 {
                                     ss->setDefine("USE_LOG_DEPTH_BUFFER");
                                 }
@@ -300,11 +312,13 @@ namespace OpenIG {
 
                 }
 
+                // The slots past the sun are enabled per drawable by the light assignment
                 virtual void operator () (osg::Uniform* u, osg::NodeVisitor*)
                 {
-                    for (size_t i = 0; i < 8; ++i)
+                    u->setElement(0, _ig->isLightEnabled(0));
+                    for (size_t i = 1; i < 8; ++i)
                     {
-                        u->setElement(i, _ig->isLightEnabled(i));
+                        u->setElement(i, false);
                     }
                 }
 
@@ -315,8 +329,9 @@ namespace OpenIG {
             class SimpleLightImplementationCallback : public OpenIG::Base::LightImplementationCallback
             {
             public:
-                SimpleLightImplementationCallback(OpenIG::Base::ImageGenerator* ig)
+                SimpleLightImplementationCallback(OpenIG::Base::ImageGenerator* ig, osg::LightAssignment* assignment)
                     : _ig(ig)
+                    , _assignment(assignment)
                 {
 
                 }
@@ -395,28 +410,27 @@ namespace OpenIG {
                     const OpenIG::Base::LightAttributes& definition,
                     osg::Group*)
                 {
-                    if (_lights.size() < 8) return NULL;
+                    // The sun/moon is light 0 and stays global
+                    if (id == 0) return NULL;
 
-                    osg::LightSource* light = new osg::LightSource;
-                    light->getLight()->setLightNum(id);
-                    setInitialOSGLightParameters(light->getLight(), definition, osg::Vec4d(0, 0, 0, 1), osg::Vec3f(0, 1, 0));
+                    osg::ref_ptr<osg::Light> light = new osg::Light;
+                    setInitialOSGLightParameters(light, definition, osg::Vec4d(0, 0, 0, 1), osg::Vec3f(0, 1, 0));
 
-                    light->getLight()->setUserValue("id", (unsigned int)id);
-                    light->getLight()->setUserValue("enabled", definition.enabled);
+                    light->setUserValue("id", (unsigned int)id);
+                    light->setUserValue("enabled", definition.enabled);
 
-                    light->setDataVariance(definition.dataVariance);
-                    light->setCullingActive(true);
+                    _lights[id] = light;
 
-                    osg::ref_ptr<osg::StateAttribute> attr = light->getOrCreateStateSet()->getAttribute(osg::StateAttribute::LIGHT);
-                    if (attr.valid())
-                    {
-                        light->getOrCreateStateSet()->removeAttribute(attr);
-                        osg::notify(osg::NOTICE) << "Light attr removed" << std::endl;
-                    }
+                    osg::Node* node = _assignment->addLight(id, light);
+                    node->setDataVariance(definition.dataVariance);
 
-                    _lights[id] = light;
+                    return node;
+                }
 
-                    return light;
+                virtual void deleteLight(unsigned int id)
+                {
+                    _lights.erase(id);
+                    _assignment->removeLight(id);
                 }
 
                 virtual void updateLight(unsigned int id, const OpenIG::Base::LightAttributes& definition)
@@ -425,18 +439,17 @@ namespace OpenIG {
                     LightsMapIterator itr = _lights.find(id);
                     if (itr != _lights.end())
                     {
-                        osg::LightSource* lightSource = itr->second;
-                        osg::Light* light = lightSource->getLight();
-
-                        updateOSGLightParameters(light, definition);
+                        updateOSGLightParameters(itr->second, definition);
+                        _assignment->lightChanged(id);
                     }
                 }
 
             protected:
                 OpenIG::Base::ImageGenerator*	_ig;
+                osg::ref_ptr<osg::LightAssignment>	_assignment;
 
-                typedef std::map<unsigned int, osg::ref_ptr<osg::LightSource> >                 LightsMap;
-                typedef std::map<unsigned int, osg::ref_ptr<osg::LightSource> >::iterator       LightsMapIterator;
+                typedef std::map<unsigned int, osg::ref_ptr<osg::Light> >                 LightsMap;
+                typedef std::map<unsigned int, osg::ref_ptr<osg::Light> >::iterator       LightsMapIterator;
 
                 LightsMap						_lights;
             };
@@ -445,6 +458,7 @@ namespace OpenIG {
             osg::ref_ptr<osg::Material>										_sceneMaterial;
             int																_cloudsShadowsTextureSlot;
             bool															_setupDone;
+            osg::ref_ptr<osg::LightAssignment>								_lightAssignment;
         };
     } // namespace
 } // namespace
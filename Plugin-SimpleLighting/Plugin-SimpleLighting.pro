@@ -21,7 +21,7 @@ INCLUDEPATH += ../
 DEPENDPATH += ../
 
 LIBS += -losg -losgDB -losgViewer -lOpenThreads -losgShadow -losgGA -losgText -losgUtil \
-        -lOpenIG-Engine -lOpenIG-Base -lOpenIG-PluginBase
+        -lOpenIG-Engine -lOpenIG-Base -lOpenIG-PluginBase -lOpenIG-Graphics -lOpenIG-Utils
 
 OTHER_FILES += libIgPlugin-SimpleLighting.so.xml
 
@@ -56,6 +56,8 @@
 
 #include <Core-OpenIG/RenderBins.h>
 
+#include <Core-Utils/ShaderUtils.h>
+
 namespace OpenIG {
     namespace Plugins {
 
@@ -141,63 +143,56 @@ namespace OpenIG {
                 osg::Node* sky = createSkyDome(context.getImageGenerator());
                 if (sky)
                 {
-                    osg::Shader* mainVertexShader = new osg::Shader(osg::Shader::VERTEX,
-                        "#version 120                                                       \n"
-                        "varying vec3 eyeVec;                                               \n"
+                    // The log Z and the fog are the snippets shared with the other plugins
+                    osg::ShaderProgramRegistry::Description description("skydome_program");
+                    description.addShader(osg::Shader::VERTEX)
+                        .addSource(
+                            "#version 120                                                       \n"
+                            "varying vec3 eyeVec;                                               \n"
 #ifdef FRAGMENT_LEVEL_DEPTH
-                        "varying float flogz;                                               \n"
+                            "varying float flogz;                                               \n"
 #endif
-                        "                                                                   \n"
-                        "uniform float Fcoef;							    	     		\n"
-
-                        "void main()                                                        \n"
-                        "{                                                                  \n"
-                        "   gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;         \n"
-                        "   if (Fcoef > 0) {                                                \n"
-                        "       gl_Position.z = (log2(max(1e-6, 1.0 + gl_Position.w)) * Fcoef - 1.0) * gl_Position.w;\n"
+                        )
+                        .addSnippet("log_depth_vs")
+                        .addSource(
+                            "void main()                                                        \n"
+                            "{                                                                  \n"
+                            "   gl_Position = logDepthPosition(gl_ModelViewProjectionMatrix * gl_Vertex);\n"
 #ifdef FRAGMENT_LEVEL_DEPTH
-                        "       flogz = 1.0 + gl_Position.w;						        \n"
+                            "   flogz = 1.0 + gl_Position.w;                                    \n"
 #endif
-                        "   }                                                               \n"
-                        "   gl_TexCoord[0] = gl_TextureMatrix[0] *gl_MultiTexCoord0;        \n"
-                        "                                                                   \n"
-                        "   eyeVec = -vec3(gl_ModelViewMatrix * gl_Vertex);                 \n"
-                        "                                                                   \n"
-                        "}                                                                  \n"
+                            "   gl_TexCoord[0] = gl_TextureMatrix[0] *gl_MultiTexCoord0;        \n"
+                            "                                                                   \n"
+                            "   eyeVec = -vec3(gl_ModelViewMatrix * gl_Vertex);                 \n"
+                            "                                                                   \n"
+                            "}                                                                  \n"
                         );
 
-                    osg::Shader* mainFragmentShader = new osg::Shader(osg::Shader::FRAGMENT,
-                        "#version 120                                                           \n"
-                        "#extension GL_ARB_texture_rectangle : enable                           \n"
-                        "varying vec3 eyeVec;                                                   \n"
-                        "uniform sampler2D baseTexture;                                         \n"
+                    description.addShader(osg::Shader::FRAGMENT)
+                        .addSource(
+                            "#version 120                                                           \n"
+                            "#extension GL_ARB_texture_rectangle : enable                           \n"
+                            "varying vec3 eyeVec;                                                   \n"
+                            "uniform sampler2D baseTexture;                                         \n"
 #ifdef FRAGMENT_LEVEL_DEPTH
-                        "varying float flogz;                                                   \n"
-                        "uniform float Fcoef;                                                   \n"
+                            "varying float flogz;                                                   \n"
+                            "uniform float Fcoef;                                                   \n"
 #endif
-                        "void computeFogColor(inout vec4 color)                                 \n"
-                        "{                                                                      \n"
-                        "   float fogExp = gl_Fog.density * length(eyeVec);                     \n"
-                        "   float fogFactor = exp(-(fogExp * fogExp));                          \n"
-                        "   fogFactor = clamp(fogFactor, 0.0, 1.0);                             \n"
-                        "   vec4 clr = color;                                                   \n"
-                        "   color = mix(gl_Fog.color, color, fogFactor);                        \n"
-                        "   color.a = clr.a;                                                    \n"
-                        "}                                                                      \n"
-                        "void main()                                                            \n"
-                        "{                                                                      \n"
-                        "   vec4 color = texture2D( baseTexture, gl_TexCoord[0].xy );           \n"
-                        "	computeFogColor(color);                                             \n"
-                        "   gl_FragColor = color * gl_LightSource[0].diffuse;                   \n"
+                        )
+                        .addSnippet("fog_exp2_ps")
+                        .addSource(
+                            "void main()                                                            \n"
+                            "{                                                                      \n"
+                            "   vec4 color = texture2D( baseTexture, gl_TexCoord[0].xy );           \n"
+                            "	computeFogColor(color);                                             \n"
+                            "   gl_FragColor = color * gl_LightSource[0].diffuse;                   \n"
 #ifdef FRAGMENT_LEVEL_DEPTH
-                        "   gl_FragDepth = log2(flogz) * Fcoef * 0.5;                           \n"
+                            "   gl_FragDepth = log2(flogz) * Fcoef * 0.5;                           \n"
 #endif
-                        "}                                                                      \n"
+                            "}                                                                      \n"
                         );
 
-                    osg::Program* program = new osg::Program;
-                    program->addShader(mainVertexShader);
-                    program->addShader(mainFragmentShader);
+                    osg::Program* program = osg::ShaderProgramRegistry::instance()->getOrCreateProgram(description);
 
                     osg::StateSet* ss = sky->getOrCreateStateSet();
                     ss->setAttributeAndModes(program, osg::StateAttribute::ON | osg::StateAttribute::PROTECTED);
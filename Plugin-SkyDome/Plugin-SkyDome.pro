@@ -21,7 +21,7 @@ INCLUDEPATH += ../
 DEPENDPATH += ../
 
 LIBS += -losg -losgDB -losgViewer -losgParticle -lOpenThreads\
-      -lOpenIG-Engine -lOpenIG-PluginBase -lOpenIG-Base
+      -lOpenIG-Engine -lOpenIG-PluginBase -lOpenIG-Base -lOpenIG-Utils
 
 OTHER_FILES += CMakeLists.txt
 DISTFILES += CMakeLists.txt
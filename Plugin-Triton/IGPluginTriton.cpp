@@ -37,6 +37,7 @@
 #include <Core-Base/Types.h>
 #include <Core-Base/Commands.h>
 #include <Core-Base/FileSystem.h>
+#include <Core-Base/FileWatcher.h>
 
 #include <Core-OpenIG/RenderBins.h>
 
@@ -55,6 +56,7 @@
 #include <osgShadow/MinimalShadowMap>
 
 #include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 
 #include "TritonDrawable.h"
@@ -131,6 +133,7 @@ namespace OpenIG {
                 , _environmentalMapping(false)
                 , _ig(0)
                 , _planarReflectionBlend(2.f)
+                , _xmlSubscription(0)
             {
 
             }
@@ -155,7 +158,9 @@ namespace OpenIG {
 
                 if (_reflectedSubGraph.valid() && _ig)
                 {
-                    OpenIG::Base::ImageGenerator::Entity& entity = _ig->getEntityMap()[id];
+                    OpenIG::Base::ImageGenerator::Entity entity = _ig->getEntityMap().get(id);
+                    if (!entity.valid()) return;
+
                     switch (on)
                     {
                     case true:
@@ -639,28 +644,12 @@ namespace OpenIG {
                 }
 
                 _tritonDrawable->setBelowWaterVisibiliy(_belowWaterVisibility);
-
-                // Here we check if the XML has changed. If so, reload and update
-                _xmlAccessMutex.lock();
-                if (_xmlLastCheckedTime != _xmlLastWriteTime)
-                {
-                    osg::notify(osg::NOTICE) << "SilverLining: XML updated: " << _xmlFileName << std::endl;
-                    readXML(_xmlFileName);
-                    _xmlLastCheckedTime = _xmlLastWriteTime;
-                }
-                _xmlAccessMutex.unlock();
-
             }
 
             virtual void clean(OpenIG::PluginBase::PluginContext& context)
             {
-                if (_xmlFileObserverThread.get())
-                {
-                    _xmlThreadRunningCondition = false;
-                    while (_xmlThreadIsRunning);
-                    _xmlFileObserverThread->join();
-                }
-                _xmlFileObserverThread.reset();
+                OpenIG::Base::FileWatcher::instance()->unsubscribe(_xmlSubscription);
+                _xmlSubscription = 0;
 
                 if (_tritonDrawable)
                 {
@@ -741,30 +730,12 @@ namespace OpenIG {
 #endif
             }
 
-            // Thread function to check the
-            // XML config file if changed
-            void xmlFileObserverThread()
+            // Called by the FileWatcher from the
+            // update when the XML config file has changed
+            void xmlFileChanged(const std::string& fileName)
             {
-                _xmlThreadRunningCondition = true;
-                _xmlThreadIsRunning = true;
-
-                while (_xmlThreadRunningCondition)
-                {
-                    try
-                    {
-                        _xmlAccessMutex.lock();
-                        _xmlLastWriteTime = OpenIG::Base::FileSystem::lastWriteTime(_xmlFileName);
-                        _xmlAccessMutex.unlock();
-                    }
-                    catch (const std::exception& e)
-                    {
-                        osg::notify(osg::NOTICE) << "SilverLining: File montoring exception: " << e.what() << std::endl;
-                        break;
-                    }
-
-                    OpenThreads::Thread::microSleep(10000);
-                }
-                _xmlThreadIsRunning = false;
+                osg::notify(osg::NOTICE) << "Triton: XML updated: " << fileName << std::endl;
+                readXML(fileName);
             }
 
             virtual void databaseRead(const std::string& fileName, osg::Node*, const osgDB::Options*)
@@ -772,8 +743,11 @@ namespace OpenIG {
                 std::string xmlFile = fileName + ".lighting.xml";
                 if (!osgDB::fileExists(xmlFile)) return;
 
-                _xmlFileObserverThread = boost::shared_ptr<boost::thread>(new boost::thread(&OpenIG::Plugins::TritonPlugin::xmlFileObserverThread, this));
-
+                OpenIG::Base::FileWatcher::instance()->unsubscribe(_xmlSubscription);
+                _xmlSubscription = OpenIG::Base::FileWatcher::instance()->subscribe(
+                    xmlFile,
+                    boost::bind(&OpenIG::Plugins::TritonPlugin::xmlFileChanged, this, _1)
+                    );
 
                 readXML(_xmlFileName = xmlFile);
             }
@@ -800,12 +774,7 @@ namespace OpenIG {
             typedef std::map<unsigned int, bool >			ReflectedGraphEntitiesMap;
             ReflectedGraphEntitiesMap		_reflectedGraphEntities;
 
-            boost::shared_ptr<boost::thread>	_xmlFileObserverThread;
-            volatile bool						_xmlThreadIsRunning;
-            volatile bool						_xmlThreadRunningCondition;
-            boost::mutex						_xmlAccessMutex;
-            std::time_t							_xmlLastWriteTime;
-            std::time_t							_xmlLastCheckedTime;
+            OpenIG::Base::FileWatcher::SubscriptionID	_xmlSubscription;
             std::string							_xmlFileName;
 
             osg::Node* createMirroredWorldGraph(const osg::Matrix & localToWorld)
@@ -42,6 +42,7 @@
 #include <OpenThreads/Mutex>
 #include <OpenThreads/ScopedLock>
 
+#include <osg/MatrixTransform>
 #include <osg/ValueObject>
 #include <osg/PolygonOffset>
 
@@ -141,98 +142,162 @@ namespace OpenIG {
             bool                _doOffset;
         };
 
+        // The offset is baked into the vertices once, when the database is
+        // read: on the loading thread for the database itself and on the
+        // pager thread for the tiles paged in later. Offsets set afterwards
+        // only move a double precision transform above the database by the
+        // difference to the baked one, so the loaded tiles are not touched
+        // and the database is not reloaded
         class VDBOffsetPlugin : public OpenIG::PluginBase::Plugin
         {
         public:
 
-            VDBOffsetPlugin() {}
+            VDBOffsetPlugin()
+                : _offsetTransformDirty(false)
+            {
+            }
 
             virtual std::string getName() { return "VDBOffset"; }
 
             virtual std::string getDescription() { return "Offsets a visual database by values passed as osg plugin options"; }
 
-            virtual std::string getVersion() { return "1.0.0"; }
+            virtual std::string getVersion() { return "1.1.0"; }
 
             virtual std::string getAuthor() { return "ComPro, Nick"; }
 
             virtual void databaseRead(const std::string&, osg::Node* node, const osgDB::Options* options)
             {
-                OpenThreads::ScopedLock<OpenThreads::Mutex>     lock(_mutex);
-
-                _options = options;
+                if (!options || !node) return;
 
-                if (_options.valid())
+                osg::Vec3d offset;
+                if (!parseOffset(options->getOptionString(), offset))
                 {
-                    std::string offsetStr = _options.valid() ? _options->getOptionString() : "";
-
-                    OpenIG::Base::StringUtils::Tokens tokensNewOffset = OpenIG::Base::StringUtils::instance()->tokenize(offsetStr, ",");
+                    // Paged tiles read without the offset string
+                    // get the offset the database was loaded with
+                    OpenThreads::ScopedLock<OpenThreads::Mutex>     lock(_mutex);
+                    offset = _bakedOffset;
+                }
+                else
+                {
+                    OpenThreads::ScopedLock<OpenThreads::Mutex>     lock(_mutex);
 
-                    if (tokensNewOffset.size() == 3)
+                    // A database (re)loaded against a new offset. Tiles
+                    // carrying the string of their database change nothing
+                    if (offset != _bakedOffset)
                     {
-                        _offset.x() = atof(tokensNewOffset.at(0).c_str());
-                        _offset.y() = atof(tokensNewOffset.at(1).c_str());
-                        _offset.z() = atof(tokensNewOffset.at(2).c_str());
+                        _bakedOffset = offset;
+                        _offset = offset;
+                        _offsetTransformDirty = true;
                     }
-
-                    ApplyOffsetNodeVisitor nv(_offset);
-                    node->accept(nv);
                 }
+
+                // Not under the lock, the update does not wait for the pager
+                ApplyOffsetNodeVisitor nv(offset);
+                node->accept(nv);
             }
 
 
             virtual void update(OpenIG::PluginBase::PluginContext& context)
             {
-                bool newOffset = false;
-
                 osg::ref_ptr<osg::Referenced> ref = context.getAttribute("VDBOffset");
                 const osgDB::Options *attr = dynamic_cast<const osgDB::Options *>(ref.get());
                 if (attr)
                 {
-                    std::string newOffsetStr = attr->getOptionString();
-
                     OpenThreads::ScopedLock<OpenThreads::Mutex>     lock(_mutex);
 
-                    OpenIG::Base::StringUtils::Tokens tokensNewOffset = OpenIG::Base::StringUtils::instance()->tokenize(newOffsetStr, ",");
-
-                    if (tokensNewOffset.size() == 3)
-                    {
-                        _offset.x() = atof(tokensNewOffset.at(0).c_str());
-                        _offset.y() = atof(tokensNewOffset.at(1).c_str());
-                        _offset.z() = atof(tokensNewOffset.at(2).c_str());
-                    }
-
+                    parseOffset(attr->getOptionString(), _offset);
+                    _offsetTransformDirty = true;
 
                     osg::notify(osg::NOTICE) << "new offset = " << _offset.x() << ", " << _offset.y() << ", " << _offset.z() << std::endl;
+                }
 
-                    std::ostringstream oss;
-                    oss << _offset.x() << "," << _offset.y() << "," << _offset.z() << std::endl;
+                osg::Vec3d delta;
+                bool dirty = false;
+                {
+                    OpenThreads::ScopedLock<OpenThreads::Mutex>     lock(_mutex);
+                    dirty = _offsetTransformDirty;
+                    delta = _offset - _bakedOffset;
+                }
 
-                    _options = new osgDB::Options(oss.str());
+                // Kept dirty until the database is there to take it
+                if (!context.getImageGenerator()->getEntityMap().count(0)) return;
 
-                    newOffset = true;
+                osg::ref_ptr<osg::MatrixTransform> entity = context.getImageGenerator()->getEntityMap().get(0);
+                if (!entity.valid()) return;
 
-                }
+                // A reload of the database replaces the transform along with
+                // the model, the current delta is then applied again
+                if (!dirty && (delta == osg::Vec3d() || hasOffsetTransform(*entity))) return;
+
+                setOffsetTransform(*entity, delta);
 
-                if (newOffset && context.getImageGenerator()->getEntityMap().count(0))
                 {
-                    osg::ref_ptr<osg::MatrixTransform> entity = context.getImageGenerator()->getEntityMap()[0];
-                    if (entity.valid())
-                    {
-                        std::string fileName;
-                        entity->getUserValue("fileName", fileName);
+                    OpenThreads::ScopedLock<OpenThreads::Mutex>     lock(_mutex);
 
-                        context.getImageGenerator()->reloadEntity(0, fileName, _options.get());
+                    // Unless a new offset came meanwhile
+                    if (_offset - _bakedOffset == delta)
+                    {
+                        _offsetTransformDirty = false;
                     }
                 }
             }
 
 
         protected:
-            osg::ref_ptr<const osgDB::Options>      _options;
             osg::Vec3d                              _offset;
+            osg::Vec3d                              _bakedOffset;
+            bool                                    _offsetTransformDirty;
             OpenThreads::Mutex                      _mutex;
 
+            bool parseOffset(const std::string& offsetStr, osg::Vec3d& offset)
+            {
+                OpenIG::Base::StringUtils::Tokens tokens = OpenIG::Base::StringUtils::instance()->tokenize(offsetStr, ",");
+                if (tokens.size() != 3) return false;
+
+                offset.x() = atof(tokens.at(0).c_str());
+                offset.y() = atof(tokens.at(1).c_str());
+                offset.z() = atof(tokens.at(2).c_str());
+                return true;
+            }
+
+            bool hasOffsetTransform(osg::MatrixTransform& entity)
+            {
+                if (entity.getNumChildren() == 0) return false;
+
+                osg::MatrixTransform* offsetTransform = dynamic_cast<osg::MatrixTransform*>(entity.getChild(0));
+                return offsetTransform && offsetTransform->getName() == s_OffsetTransformName;
+            }
+
+            // The transform sits between the entity and its model. A reload
+            // replaces it along with the model, and the new database bakes
+            // its own offset
+            void setOffsetTransform(osg::MatrixTransform& entity, const osg::Vec3d& delta)
+            {
+                if (entity.getNumChildren() == 0) return;
+
+                osg::MatrixTransform* offsetTransform = dynamic_cast<osg::MatrixTransform*>(entity.getChild(0));
+                if (!offsetTransform || offsetTransform->getName() != s_OffsetTransformName)
+                {
+                    if (delta == osg::Vec3d()) return;
+
+                    osg::ref_ptr<osg::Node> model = entity.getChild(0);
+
+                    offsetTransform = new osg::MatrixTransform;
+                    offsetTransform->setName(s_OffsetTransformName);
+                    offsetTransform->setDataVariance(osg::Object::DYNAMIC);
+                    offsetTransform->addChild(model.get());
+                    offsetTransform->setUserData(model->getUserData());
+
+                    entity.replaceChild(model.get(), offsetTransform);
+                }
+
+                offsetTransform->setMatrix(osg::Matrixd::translate(delta));
+            }
+
+            static const std::string                s_OffsetTransformName;
         };
+
+        const std::string VDBOffsetPlugin::s_OffsetTransformName = "VDBOffsetTransform";
     } // namespace
 } // namespace
 
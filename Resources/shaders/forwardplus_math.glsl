@@ -7,6 +7,8 @@ uniform ivec4 vTilingParams;
 uniform samplerBuffer  lightDataTBO;
 uniform isamplerBuffer lightIndexListTBO;
 uniform isamplerBuffer lightGridOffsetAndSizeTBO;
+// The light data is packed relative to an origin near the eye
+uniform mat4 lightDataToViewMatrix;
 
 uniform sampler2D rampTexture;
 
@@ -41,8 +43,8 @@ void UnpackLight(int lightIndex, inout Light light)
     light.cDiffuseColor  = vec3(FourFloat1s.w, FourFloat2s.x, FourFloat2s.y);
     light.cSpecularColor = vec3(FourFloat2s.z, FourFloat2s.w, FourFloat3s.x);
 
-    light.vPosition      = vec3(FourFloat3s.y, FourFloat3s.z, FourFloat3s.w);
-    light.vDirection     = vec3(FourFloat4s.x, FourFloat4s.y, FourFloat4s.z);
+    light.vPosition      = (lightDataToViewMatrix * vec4(FourFloat3s.y, FourFloat3s.z, FourFloat3s.w, 1.0)).xyz;
+    light.vDirection     = mat3(lightDataToViewMatrix) * vec3(FourFloat4s.x, FourFloat4s.y, FourFloat4s.z);
           
     light.spotparams     = vec3(FourFloat4s.w, FourFloat5s.x, FourFloat5s.y);
     light.rangesandtype  = vec3(FourFloat5s.z, FourFloat5s.w, FourFloat6s.x);
@@ -0,0 +1,59 @@
+#version 430 compatibility
+#extension GL_EXT_geometry_shader4 : enable
+
+#pragma import_defines(USE_LOG_DEPTH_BUFFER)
+
+layout (points) in;
+layout (triangle_strip) out;
+layout (max_vertices = 4) out;
+
+#ifdef USE_LOG_DEPTH_BUFFER
+uniform float Fcoef;
+out float flogz;
+
+void doLogZBufferXForm()
+{
+    gl_Position.z = (log2(max(1e-6, 1.0 + gl_Position.w)) * Fcoef - 1.0) * gl_Position.w;
+    flogz = 1.0 + gl_Position.w;
+}
+#else
+void doLogZBufferXForm()
+{
+}
+#endif
+
+in vec4 vsoutput_Color[];
+in float vsoutput_Size[];
+
+out vec4 gsoutput_Color;
+out vec3 gsoutput_eyeVec;
+out vec2 vTexCoords;
+
+void emitCorner(vec4 eyeCenter, vec2 corner, float halfSize)
+{
+    vec4 eye = eyeCenter + vec4(corner * halfSize, 0.0, 0.0);
+
+    gl_Position = gl_ProjectionMatrix * eye;
+    doLogZBufferXForm();
+
+    gsoutput_Color = vsoutput_Color[0];
+    gsoutput_eyeVec = -eye.xyz;
+    vTexCoords = corner * 0.5 + 0.5;
+
+    EmitVertex();
+}
+
+void main()
+{
+    // Particles are camera facing quads, built
+    // in eye space around the particle center
+    vec4 eyeCenter = gl_ModelViewMatrix * gl_in[0].gl_Position;
+    float halfSize = vsoutput_Size[0] * 0.5;
+
+    emitCorner(eyeCenter, vec2(-1.0, -1.0), halfSize);
+    emitCorner(eyeCenter, vec2( 1.0, -1.0), halfSize);
+    emitCorner(eyeCenter, vec2(-1.0,  1.0), halfSize);
+    emitCorner(eyeCenter, vec2( 1.0,  1.0), halfSize);
+
+    EndPrimitive();
+}
@@ -0,0 +1,36 @@
+#version 430 compatibility
+
+#pragma import_defines(USE_LOG_DEPTH_BUFFER)
+
+#ifdef USE_LOG_DEPTH_BUFFER
+in float flogz;
+uniform float Fcoef;
+#endif
+
+uniform sampler2D baseTexture;
+
+in vec4 gsoutput_Color;
+in vec3 gsoutput_eyeVec;
+in vec2 vTexCoords;
+
+void computeFogColor(inout vec4 color)
+{
+    float fogExp = gl_Fog.density * length(gsoutput_eyeVec);
+    float fogFactor = exp(-(fogExp * fogExp));
+    fogFactor = clamp(fogFactor, 0.0, 1.0);
+    vec4 clr = color;
+    color = mix(gl_Fog.color, color, fogFactor);
+    color.a = clr.a;
+}
+
+void main()
+{
+    vec4 color = texture2D(baseTexture, vTexCoords) * gsoutput_Color;
+
+    computeFogColor(color);
+    gl_FragColor = color;
+
+#ifdef USE_LOG_DEPTH_BUFFER
+    gl_FragDepth = log2(flogz) * Fcoef * 0.5;
+#endif
+}
@@ -0,0 +1,14 @@
+#version 430 compatibility
+
+in float inSize;
+
+out vec4 vsoutput_Color;
+out float vsoutput_Size;
+
+void main()
+{
+    gl_Position = gl_Vertex;
+
+    vsoutput_Color = gl_Color;
+    vsoutput_Size = inSize;
+}
@@ -54,12 +54,10 @@
 #include <OpenIG-Protocol/Command.h>
 #include <OpenIG-Protocol/LightState.h>
 #include <OpenIG-Protocol/DeadReckonEntityState.h>
+#include <OpenIG-Protocol/TerrainQueryClient.h>
 
 #include <OpenIG-Networking/UDPNetwork.h>
-#include <OpenIG-Networking/TCPClient.h>
 #include <OpenIG-Networking/Buffer.h>
-#include <OpenIG-Networking/Factory.h>
-#include <OpenIG-Networking/Parser.h>
 
 #include <OpenIG-Base/Mathematics.h>
 
@@ -76,10 +74,10 @@
 
 #include <map>
 
-typedef std::map<unsigned int, osg::Vec3d>		ResponsesMap;
-ResponsesMap									hotResponses;
-ResponsesMap									losResponsesPosition;
-ResponsesMap									losResponsesNormal;
+// The latest terrain height under the model. It lags the model
+// by the round trip to the Terrain Query Server, the host never
+// waits for it
+double											terrainHeight = 0.0;
 
 struct NotifyErrorHandler : public OpenIG::Library::Networking::ErrorHandler
 {
@@ -90,82 +88,30 @@ struct NotifyErrorHandler : public OpenIG::Library::Networking::ErrorHandler
     }
 };
 
-struct Parser : public OpenIG::Library::Networking::Parser
+struct HOTResponse
 {
-    Parser()
+    void operator()(const OpenIG::Library::Protocol::TerrainQueryClient::Result& result)
     {
-        OpenIG::Library::Networking::Factory::instance()->addTemplate(new OpenIG::Library::Protocol::Header);
-        OpenIG::Library::Networking::Factory::instance()->addTemplate(new OpenIG::Library::Protocol::HOTResponse);
-        OpenIG::Library::Networking::Factory::instance()->addTemplate(new OpenIG::Library::Protocol::LOSResponse);
-    }
-
-    virtual OpenIG::Library::Networking::Packet* parse(OpenIG::Library::Networking::Buffer& buffer)
-    {
-        const unsigned char* opcode = buffer.fetch();
-
-        OpenIG::Library::Networking::Packet* packet = OpenIG::Library::Networking::Factory::instance()->packet(*opcode);
-        if (packet)
+        if (result.status == OpenIG::Library::Protocol::TerrainQueryClient::Result::Done)
         {
-            packet->read(buffer);
-
-            OpenIG::Library::Protocol::Header* header = dynamic_cast<OpenIG::Library::Protocol::Header*>(packet);
-            if (header && header->magic != OpenIG::Library::Protocol::SWAP_BYTES_COMPARE)
-            {
-                buffer.setSwapBytes(true);
-            }
-        }
-        return packet;
-    }
-
-};
-
-struct HeaderCallback : public OpenIG::Library::Networking::Packet::Callback
-{
-    HeaderCallback() {}
+            std::cout << "Host TCP -- HOT response recieved. Request ID:" << result.id << ", " << result.position << std::endl;
 
-    void process(OpenIG::Library::Networking::Packet& packet)
-    {
-        OpenIG::Library::Protocol::Header* h = dynamic_cast<OpenIG::Library::Protocol::Header*>(&packet);
-        if (h)
-        {
-            std::cout << "Host TCP -- HeaderCallBack frame: " << h->frameNumber <<  std::endl;
+            terrainHeight = result.position.z();
         }
-    }
-};
-
-struct HOTResponse : public OpenIG::Library::Networking::Packet::Callback
-{
-    HOTResponse()
-    {
-    }
-
-    virtual void process(OpenIG::Library::Networking::Packet& packet)
-    {
-        OpenIG::Library::Protocol::HOTResponse* response = dynamic_cast<OpenIG::Library::Protocol::HOTResponse*>(&packet);
-        if (response)
+        else
         {
-            std::cout << "Host TCP -- HOT response recieved. Request ID:" << response->id << ", " << response->position << std::endl;
-
-            hotResponses[response->id] = response->position;
+            std::cout << "Host TCP -- HOT request " << result.id << (result.status == OpenIG::Library::Protocol::TerrainQueryClient::Result::TimedOut ? " timed out" : " failed") << std::endl;
         }
     }
 };
 
-struct LOSResponse : public OpenIG::Library::Networking::Packet::Callback
+struct LOSResponse
 {
-    LOSResponse()
-    {
-    }
-
-    virtual void process(OpenIG::Library::Networking::Packet& packet)
+    void operator()(const OpenIG::Library::Protocol::TerrainQueryClient::Result& result)
     {
-        OpenIG::Library::Protocol::LOSResponse* response = dynamic_cast<OpenIG::Library::Protocol::LOSResponse*>(&packet);
-        if (response)
+        if (result.status == OpenIG::Library::Protocol::TerrainQueryClient::Result::Done)
         {
-            std::cout << "HOST TCP -- LOS response recieved. Request ID:" << response->id << ", " << response->position << ", " << response->normal << std::endl;
-
-            losResponsesPosition[response->id] = response->position;
-            losResponsesNormal[response->id] = response->normal;
+            std::cout << "HOST TCP -- LOS response recieved. Request ID:" << result.id << ", " << result.position << ", " << result.normal << std::endl;
         }
     }
 };
@@ -191,6 +137,7 @@ int main(int argc, char** argv)
     arguments.getApplicationUsage()->addCommandLineOption("--port <port>", "The port to be used");
     arguments.getApplicationUsage()->addCommandLineOption("--server <server ip address>", "The IP of the Terrain Query Server");
     arguments.getApplicationUsage()->addCommandLineOption("--server_port <port>", "The port to be used for communication with the Terrain Query Server");
+    arguments.getApplicationUsage()->addCommandLineOption("--query_timeout <seconds>", "How long a HOT/LOS query waits for its response, 1.0 by default");
 
     unsigned int helpType = 0;
     if ((helpType = arguments.readHelpType()))
@@ -216,20 +163,18 @@ int main(int argc, char** argv)
     while (arguments.read("--server", server));
     while (arguments.read("--server_port", serverport));
 
+    double queryTimeout = 1.0;
+    while (arguments.read("--query_timeout", queryTimeout));
+
     //OpenIG::Library::Networking::Network::log = boost::shared_ptr<OpenIG::Library::Networking::ErrorHandler>(new NotifyErrorHandler);
 
     // This is the UDP network that drives the IG
     boost::shared_ptr<OpenIG::Library::Networking::Network>	network = boost::shared_ptr<OpenIG::Library::Networking::UDPNetwork>(new OpenIG::Library::Networking::UDPNetwork(host));
     network->setPort(atoi(port.c_str()));
 
-    // This is the TCP Client network that talks to the Terrain Query Server
-    boost::shared_ptr<OpenIG::Library::Networking::Network>	client = boost::shared_ptr<OpenIG::Library::Networking::TCPClient>(new OpenIG::Library::Networking::TCPClient(host,server));
-    client->setPort(atoi(serverport.c_str()));
-
-    client->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_HEADER, new HeaderCallback);
-    client->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_HOTRESPONSE, new HOTResponse);
-    client->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_LOSRESPONSE, new LOSResponse);
-    client->setParser(new Parser);
+    // This is the client that talks to the Terrain Query Server. The queries go
+    // out once per frame and are answered in a later frame, through the callbacks
+    OpenIG::Library::Protocol::TerrainQueryClient terrainQueries(host, server, atoi(serverport.c_str()), queryTimeout);
 
     // Initial values we are going to
     // change in runtime
@@ -245,53 +190,28 @@ int main(int argc, char** argv)
         static double dy = 0.0;
         dy += 1.5;
 
-        // The id of the HOT/LOS request/response
-        unsigned int HOTRequestID = 1;
-        unsigned int LOSRequestID = 1;
-
         // We create header packet with the frame number
         OpenIG::Library::Protocol::Header header(frameNumber++);
 
         // This is to talk to the Terrain Query Server
         //-----------------------------------------------------------------------------------------
-        OpenIG::Library::Networking::Buffer buffer_to_terrain_server(BUFFER_SIZE);
-
-        // Write the header to the buffer
-        header.write(buffer_to_terrain_server);
+        // The callbacks of the queries answered since the last frame
+        terrainQueries.dispatch();
 
         // write the entity update to the buffer
         // We create a packet for the entity update
         OpenIG::Library::Protocol::EntityState estate;
         estate.entityID = 1;
-        estate.mx = OpenIG::Base::Math::instance()->toMatrix(x, y + dy, hotResponses[HOTRequestID].z() + 1.35, 0.0, 0.0, 0.0);
-        estate.write(buffer_to_terrain_server);
+        estate.mx = OpenIG::Base::Math::instance()->toMatrix(x, y + dy, terrainHeight + 1.35, 0.0, 0.0, 0.0);
+        terrainQueries.add(estate);
 
         // Command - all from OpenIG are supported
         OpenIG::Library::Protocol::Camera camera;
 
-        //camera.mx = OpenIG::Base::Math::instance()->toMatrix(x, y + dy, hotResponses[HOTRequestID].z() + 1.35, 0.0, 0.0, 0.0);
-        //camera.bindToEntity = 0;
-        //camera.inverse = 0;
-        //camera.write(buffer_to_terrain_server);
-
-        // HOT packet
-        OpenIG::Library::Protocol::HOT hot;
-        hot.id = HOTRequestID;
-        hot.position = osg::Vec3d(x, y + dy, hotResponses[HOTRequestID].z());
-        hot.write(buffer_to_terrain_server);
-
-        // LOS packet
-        OpenIG::Library::Protocol::LOS los;
-        los.id = LOSRequestID;
-        los.start= osg::Vec3d(x, y + dy, hotResponses[HOTRequestID].z());
-        los.end = osg::Vec3d(x, y + dy + 500.0, hotResponses[HOTRequestID].z());
-        los.write(buffer_to_terrain_server);
-
-        // Send to the network
-        client->send(buffer_to_terrain_server);
-
-        // Process resonses
-        client->process();
+        // HOT and LOS queries, sent together without waiting for the answers
+        terrainQueries.hot(osg::Vec3d(x, y + dy, terrainHeight), HOTResponse());
+        terrainQueries.los(osg::Vec3d(x, y + dy, terrainHeight), osg::Vec3d(x, y + dy + 500.0, terrainHeight), LOSResponse());
+        terrainQueries.flush(header.frameNumber);
         //-----------------------------------------------------------------------------------------
 
         // This is to talk to the IG
@@ -305,7 +225,7 @@ int main(int argc, char** argv)
 
 		// write the entity update to the buffer
 		// We create a packet for the entity update
-		estate.mx = OpenIG::Base::Math::instance()->toMatrix(x, y + dy, hotResponses[HOTRequestID].z(), 0.0, 0.0, 0.0);
+		estate.mx = OpenIG::Base::Math::instance()->toMatrix(x, y + dy, terrainHeight, 0.0, 0.0, 0.0);
 
 		// For the dead reckon we need to set the initial position
 		// of the model, thus we send it only once
@@ -354,7 +274,7 @@ int main(int argc, char** argv)
 
 		entityStateMap[estate.entityID] = estate;		
 
-        camera.mx = OpenIG::Base::Math::instance()->toMatrix(x, (y + dy)-6, hotResponses[HOTRequestID].z()+2, 0.0, 90.0, 0.0);
+        camera.mx = OpenIG::Base::Math::instance()->toMatrix(x, (y + dy)-6, terrainHeight+2, 0.0, 90.0, 0.0);
         //camera.bindToEntity = 0;
         //camera.inverse = 0;
         camera.write(buffer_to_ig);
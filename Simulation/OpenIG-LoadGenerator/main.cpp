@@ -0,0 +1,869 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+//#*	author    Compro Computer Services openig@compro.net
+//#*	copyright(c)Compro Computer Services, Inc.
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+
+#include <OpenIG-Protocol/Header.h>
+#include <OpenIG-Protocol/EntityState.h>
+#include <OpenIG-Protocol/LightState.h>
+#include <OpenIG-Protocol/Command.h>
+#include <OpenIG-Protocol/FrameAck.h>
+#include <OpenIG-Protocol/TerrainQueryClient.h>
+
+#include <OpenIG-Networking/UDPNetwork.h>
+#include <OpenIG-Networking/TCPServer.h>
+#include <OpenIG-Networking/MulticastNetwork.h>
+#include <OpenIG-Networking/Buffer.h>
+#include <OpenIG-Networking/Factory.h>
+#include <OpenIG-Networking/Parser.h>
+
+#include <OpenIG-Base/Mathematics.h>
+
+#include <osg/ArgumentParser>
+#include <osg/Matrix>
+#include <osg/Vec3d>
+#include <osg/Timer>
+
+#include <OpenThreads/Thread>
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+// A small generator of our own, so that the
+// same seed gives the same load everywhere
+struct Random
+{
+    Random(unsigned int seed) : state(seed ? seed : 1) {}
+
+    // In [0,1)
+    double next()
+    {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / 16777216.0;
+    }
+
+    // In [-1,1)
+    double nextSigned()
+    {
+        return next() * 2.0 - 1.0;
+    }
+
+    unsigned int state;
+};
+
+enum Motion
+{
+    Straight,
+    Orbit,
+    RandomWalk
+};
+
+struct SyntheticEntity
+{
+    unsigned int	id;
+    osg::Vec3d		origin;
+    osg::Vec3d		position;
+    double			heading;		// degrees
+    double			speed;			// meters per second
+    double			angle;			// around the orbit, radians
+    double			nextUpdate;		// seconds
+};
+typedef std::vector<SyntheticEntity>	SyntheticEntities;
+
+struct SyntheticLight
+{
+    unsigned int	id;
+    osg::Vec3d		position;
+    bool			enabled;
+};
+typedef std::vector<SyntheticLight>		SyntheticLights;
+
+// Moves an entity by one step of its motion model. The
+// entities stay within the extent around their origin
+void move(SyntheticEntity& entity, Motion motion, double dt, double extent, Random& random)
+{
+    switch (motion)
+    {
+    case Orbit:
+        {
+            double radius = extent * 0.5;
+            entity.angle += entity.speed / radius * dt;
+            entity.position = entity.origin + osg::Vec3d(cos(entity.angle) * radius, sin(entity.angle) * radius, 0.0);
+            entity.heading = osg::RadiansToDegrees(entity.angle);
+        }
+        break;
+    case RandomWalk:
+        {
+            entity.heading += random.nextSigned() * 90.0 * dt;
+
+            // Heading back once out of the extent
+            osg::Vec3d toOrigin = entity.origin - entity.position;
+            if (toOrigin.length() > extent)
+            {
+                entity.heading = osg::RadiansToDegrees(atan2(-toOrigin.x(), toOrigin.y()));
+            }
+        }
+        // Moves on as a straight one
+    case Straight:
+        {
+            double heading = osg::DegreesToRadians(entity.heading);
+            entity.position += osg::Vec3d(-sin(heading), cos(heading), 0.0) * entity.speed * dt;
+
+            if (motion == Straight && (entity.position - entity.origin).length() > extent)
+            {
+                entity.position = entity.origin;
+            }
+        }
+        break;
+    }
+}
+
+// Packs the packets of a frame into as few sends as it can, each starting
+// with the Header of the frame. The datagrams are kept within the MTU,
+// over TCP all of the frame goes out as one
+struct FrameWriter
+{
+    FrameWriter(OpenIG::Library::Networking::Network& n, int size)
+        : network(n)
+        , maxSize(size)
+        , buffer(BUFFER_SIZE)
+        , scratch(BUFFER_SIZE)
+        , headerSize(0)
+        , numSends(0)
+        , numBytes(0)
+        , numPackets(0)
+    {
+    }
+
+    void begin(unsigned int frameNumber)
+    {
+        header.frameNumber = frameNumber;
+
+        buffer.rewrite();
+        headerSize = header.write(buffer);
+    }
+
+    void write(const OpenIG::Library::Networking::Packet& packet)
+    {
+        scratch.rewrite();
+        packet.write(scratch);
+
+        if (maxSize && buffer.getWritten() > headerSize && buffer.getWritten() + scratch.getWritten() > maxSize)
+        {
+            flush();
+        }
+
+        buffer.write(scratch.getData(), scratch.getWritten());
+        ++numPackets;
+    }
+
+    void end()
+    {
+        if (buffer.getWritten() > headerSize)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        network.send(buffer);
+
+        ++numSends;
+        numBytes += buffer.getWritten();
+
+        buffer.rewrite();
+        header.write(buffer);
+    }
+
+    OpenIG::Library::Networking::Network&	network;
+    int										maxSize;
+    OpenIG::Library::Networking::Buffer		buffer;
+    OpenIG::Library::Networking::Buffer		scratch;
+    OpenIG::Library::Protocol::Header		header;
+    int										headerSize;
+
+    unsigned long long						numSends;
+    unsigned long long						numBytes;
+    unsigned long long						numPackets;
+};
+
+struct Parser : public OpenIG::Library::Networking::Parser
+{
+    Parser()
+    {
+        OpenIG::Library::Networking::Factory::instance()->addTemplate(new OpenIG::Library::Protocol::Header);
+        OpenIG::Library::Networking::Factory::instance()->addTemplate(new OpenIG::Library::Protocol::FrameAck);
+    }
+
+    virtual OpenIG::Library::Networking::Packet* parse(OpenIG::Library::Networking::Buffer& buffer)
+    {
+        if (buffer.getRest() <= 0) return 0;
+
+        const unsigned char* opcode = buffer.fetch();
+
+        OpenIG::Library::Networking::Packet* packet = OpenIG::Library::Networking::Factory::instance()->packet(*opcode);
+        if (packet)
+        {
+            packet->read(buffer);
+
+            OpenIG::Library::Protocol::Header* header = dynamic_cast<OpenIG::Library::Protocol::Header*>(packet);
+            if (header && header->magic != OpenIG::Library::Protocol::SWAP_BYTES_COMPARE)
+            {
+                buffer.setSwapBytes(true);
+            }
+        }
+        return packet;
+    }
+};
+
+typedef std::vector<double>		Samples;
+
+double percentile(Samples samples, double p)
+{
+    if (samples.empty()) return 0.0;
+
+    std::sort(samples.begin(), samples.end());
+    return samples.at((size_t)(p * (samples.size() - 1) + 0.5));
+}
+
+std::string percentiles(const Samples& samples)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "p50 " << percentile(samples, 0.5)
+        << " p90 " << percentile(samples, 0.9)
+        << " p99 " << percentile(samples, 0.99)
+        << " max " << percentile(samples, 1.0) << " ms";
+    return oss.str();
+}
+
+// The send time of the recent frames, by frame number, for the
+// latency to the frame an IG acknowledged as applied
+struct FrameTimes
+{
+    FrameTimes()
+        : frameNumbers(4096, 0)
+        , times(4096, 0)
+        , acknowledged(4096, true)
+    {
+    }
+
+    void sent(unsigned int frameNumber, osg::Timer_t time)
+    {
+        size_t index = frameNumber % frameNumbers.size();
+        frameNumbers[index] = frameNumber;
+        times[index] = time;
+        acknowledged[index] = false;
+    }
+
+    std::vector<unsigned int>	frameNumbers;
+    std::vector<osg::Timer_t>	times;
+    std::vector<bool>			acknowledged;
+};
+
+struct FrameAckCallback : public OpenIG::Library::Networking::Packet::Callback
+{
+    FrameAckCallback(FrameTimes& times)
+        : frameTimes(times)
+        , received(false)
+        , numAcks(0)
+        , numUnknown(0)
+    {
+    }
+
+    virtual void process(OpenIG::Library::Networking::Packet& packet)
+    {
+        OpenIG::Library::Protocol::FrameAck* ack = dynamic_cast<OpenIG::Library::Protocol::FrameAck*>(&packet);
+        if (ack)
+        {
+            received = true;
+            ++numAcks;
+
+            // A frame sent in more than one datagram
+            // can be acknowledged more than once
+            size_t index = ack->frameNumber % frameTimes.frameNumbers.size();
+            if (frameTimes.frameNumbers[index] != ack->frameNumber || frameTimes.acknowledged[index])
+            {
+                ++numUnknown;
+                return;
+            }
+            frameTimes.acknowledged[index] = true;
+
+            double latency = osg::Timer::instance()->delta_m(frameTimes.times[index], osg::Timer::instance()->tick());
+            latencies.push_back(latency);
+            intervalLatencies.push_back(latency);
+        }
+    }
+
+    FrameTimes&		frameTimes;
+    bool			received;
+    unsigned int	numAcks;
+    unsigned int	numUnknown;
+    Samples			latencies;
+    Samples			intervalLatencies;
+};
+
+// Takes the acknowledgements that are in, if any
+void receiveAcks(OpenIG::Library::Networking::Network* network, FrameAckCallback* callback)
+{
+    if (network == 0) return;
+
+    for (unsigned int i = 0; i < 256; ++i)
+    {
+        callback->received = false;
+        network->process();
+        if (!callback->received) break;
+    }
+}
+
+// Sleeps until the given time, in seconds from the start, taking the
+// acknowledgements as they come so that their latency is not rounded
+// up to the frame of the host
+void waitUntil(double time, osg::Timer_t start, OpenIG::Library::Networking::Network* ackNetwork, FrameAckCallback* ackCallback)
+{
+    while (true)
+    {
+        receiveAcks(ackNetwork, ackCallback);
+
+        double now = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+        if (now >= time) break;
+
+        double sleep = time - now;
+        if (ackNetwork && sleep > 0.0005) sleep = 0.0005;
+
+        OpenThreads::Thread::microSleep((unsigned int)(sleep * 1000000.0));
+    }
+}
+
+struct QueryStats
+{
+    QueryStats() : numDone(0), numTimedOut(0), numFailed(0) {}
+
+    unsigned int	numDone;
+    unsigned int	numTimedOut;
+    unsigned int	numFailed;
+    Samples			roundTrips;
+};
+
+// Called by the terrain query client with the result of one query
+struct QueryCallback
+{
+    QueryCallback(QueryStats& s)
+        : stats(&s)
+        , issued(osg::Timer::instance()->tick())
+    {
+    }
+
+    void operator()(const OpenIG::Library::Protocol::TerrainQueryClient::Result& result)
+    {
+        switch (result.status)
+        {
+        case OpenIG::Library::Protocol::TerrainQueryClient::Result::Done:
+            ++stats->numDone;
+            stats->roundTrips.push_back(osg::Timer::instance()->delta_m(issued, osg::Timer::instance()->tick()));
+            break;
+        case OpenIG::Library::Protocol::TerrainQueryClient::Result::TimedOut:
+            ++stats->numTimedOut;
+            break;
+        default:
+            ++stats->numFailed;
+            break;
+        }
+    }
+
+    QueryStats*		stats;
+    osg::Timer_t	issued;
+};
+
+// How many times something happens in this tick,
+// at the given rate per second, carrying the rest over
+unsigned int due(double rate, double dt, double& carry)
+{
+    carry += rate * dt;
+
+    unsigned int count = (unsigned int)carry;
+    carry -= count;
+
+    return count;
+}
+
+int main(int argc, char** argv)
+{
+    osg::ArgumentParser arguments(&argc, argv);
+
+    arguments.getApplicationUsage()->setApplicationName(arguments.getApplicationName());
+    arguments.getApplicationUsage()->setDescription(arguments.getApplicationName() + " is a synthetic Host for OpenIG that drives many entities and lights, for finding how much one IG channel can take");
+    arguments.getApplicationUsage()->setCommandLineUsage(arguments.getApplicationName() + " [options]");
+    arguments.getApplicationUsage()->addCommandLineOption("--protocol <UDP|TCP|MULTICAST>", "How the IGs are reached. Over TCP this is the server the IGs connect to, UDP by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--host <host ip address>", "The IP of the host");
+    arguments.getApplicationUsage()->addCommandLineOption("--destination <ip address>", "The IP of the IG over UDP, broadcast by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--port <port>", "The port to be used, 8888 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--group <ip address>", "The multicast group, 239.255.42.99 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--ttl <hops>", "The multicast time to live, 1 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--rate <hz>", "The frame rate of the host, 60 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--duration <seconds>", "How long to run, 10 by default, 0 runs until killed");
+    arguments.getApplicationUsage()->addCommandLineOption("--report <seconds>", "How often the rates are printed, 1 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--seed <number>", "Seeds the random motion and churn, 1 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--entities <count>", "The number of entities, 100 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--entity_id <id>", "The id of the first entity, 1000 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--entity_rate <hz>", "How often each entity is updated, the frame rate by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--motion <straight|orbit|random>", "How the entities move, straight by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--speed <meters per second>", "The speed of the entities, 20 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--spacing <meters>", "The distance between the entities placed on a grid, 50 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--extent <meters>", "How far the entities move from where they are placed, 200 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--altitude <meters>", "The height of the entities, 0 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--model <file name>", "If given, the entities are added with this model on the IG first");
+    arguments.getApplicationUsage()->addCommandLineOption("--lights <count>", "The number of lights added on the IG over the grid, 0 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--light_id <id>", "The id of the first light, 20000 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--light_churn <per second>", "How many lights are turned on or off per second, 0 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--command_rate <per second>", "How many command bursts are sent per second, 0 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--command_burst <count>", "The number of commands in a burst, 10 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--command <command>", "The command sent in the bursts, \"wind 5 90\" by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--server <server ip address>", "The IP of the Terrain Query Server, for HOT/LOS queries");
+    arguments.getApplicationUsage()->addCommandLineOption("--server_port <port>", "The port of the Terrain Query Server, 8889 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--hot_rate <per second>", "How many HOT queries are sent per second, 0 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--los_rate <per second>", "How many LOS queries are sent per second, 0 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--query_timeout <seconds>", "How long a HOT/LOS query waits for its response, 1.0 by default");
+    arguments.getApplicationUsage()->addCommandLineOption("--ack_port <port>", "Where the IGs acknowledge the applied frames, for the end to end latency. 0, off, by default");
+
+    unsigned int helpType = 0;
+    if ((helpType = arguments.readHelpType()))
+    {
+        arguments.getApplicationUsage()->write(std::cout, helpType);
+        return 1;
+    }
+
+    std::string protocol = "UDP";
+    std::string host = "127.0.0.1";
+    std::string destination = "";
+    std::string port = "8888";
+    std::string group = "239.255.42.99";
+    int ttl = 1;
+
+    while (arguments.read("--protocol", protocol));
+    while (arguments.read("--host", host));
+    while (arguments.read("--destination", destination));
+    while (arguments.read("--port", port));
+    while (arguments.read("--group", group));
+    while (arguments.read("--ttl", ttl));
+
+    double rate = 60.0;
+    double duration = 10.0;
+    double reportInterval = 1.0;
+    unsigned int seed = 1;
+
+    while (arguments.read("--rate", rate));
+    while (arguments.read("--duration", duration));
+    while (arguments.read("--report", reportInterval));
+    while (arguments.read("--seed", seed));
+
+    unsigned int numEntities = 100;
+    unsigned int entityID = 1000;
+    double entityRate = 0.0;
+    std::string motionName = "straight";
+    double speed = 20.0;
+    double spacing = 50.0;
+    double extent = 200.0;
+    double altitude = 0.0;
+    std::string model;
+
+    while (arguments.read("--entities", numEntities));
+    while (arguments.read("--entity_id", entityID));
+    while (arguments.read("--entity_rate", entityRate));
+    while (arguments.read("--motion", motionName));
+    while (arguments.read("--speed", speed));
+    while (arguments.read("--spacing", spacing));
+    while (arguments.read("--extent", extent));
+    while (arguments.read("--altitude", altitude));
+    while (arguments.read("--model", model));
+
+    unsigned int numLights = 0;
+    unsigned int lightID = 20000;
+    double lightChurn = 0.0;
+
+    while (arguments.read("--lights", numLights));
+    while (arguments.read("--light_id", lightID));
+    while (arguments.read("--light_churn", lightChurn));
+
+    double commandRate = 0.0;
+    unsigned int commandBurst = 10;
+    std::string command = "wind 5 90";
+
+    while (arguments.read("--command_rate", commandRate));
+    while (arguments.read("--command_burst", commandBurst));
+    while (arguments.read("--command", command));
+
+    std::string server;
+    std::string serverport = "8889";
+    double hotRate = 0.0;
+    double losRate = 0.0;
+    double queryTimeout = 1.0;
+
+    while (arguments.read("--server", server));
+    while (arguments.read("--server_port", serverport));
+    while (arguments.read("--hot_rate", hotRate));
+    while (arguments.read("--los_rate", losRate));
+    while (arguments.read("--query_timeout", queryTimeout));
+
+    unsigned int ackPort = 0;
+    while (arguments.read("--ack_port", ackPort));
+
+    arguments.reportRemainingOptionsAsUnrecognized();
+    if (arguments.errors())
+    {
+        arguments.writeErrorMessages(std::cout);
+        return 1;
+    }
+
+    if (rate <= 0.0) rate = 60.0;
+    if (entityRate <= 0.0 || entityRate > rate) entityRate = rate;
+
+    Motion motion = Straight;
+    if (motionName == "orbit") motion = Orbit;
+    else if (motionName == "random") motion = RandomWalk;
+
+    // The network the IGs are driven with
+    boost::shared_ptr<OpenIG::Library::Networking::Network>	network;
+    int maxSendSize = BUFFER_SIZE;
+
+    if (protocol == "TCP")
+    {
+        network = boost::shared_ptr<OpenIG::Library::Networking::TCPServer>(new OpenIG::Library::Networking::TCPServer(host, atoi(port.c_str())));
+        maxSendSize = 0;
+    }
+    else if (protocol == "MULTICAST")
+    {
+        network = boost::shared_ptr<OpenIG::Library::Networking::MulticastNetwork>(new OpenIG::Library::Networking::MulticastNetwork(group, host, ttl));
+        network->setPort(atoi(port.c_str()));
+    }
+    else
+    {
+        protocol = "UDP";
+        network = boost::shared_ptr<OpenIG::Library::Networking::UDPNetwork>(new OpenIG::Library::Networking::UDPNetwork(host, destination, destination.empty()));
+        network->setPort(atoi(port.c_str()));
+    }
+
+    FrameWriter writer(*network, maxSendSize);
+
+    // The acknowledgements of the IGs, if any
+    FrameTimes frameTimes;
+    FrameAckCallback* ackCallback = 0;
+    boost::shared_ptr<OpenIG::Library::Networking::Network> ackNetwork;
+    if (ackPort != 0)
+    {
+        ackNetwork = boost::shared_ptr<OpenIG::Library::Networking::UDPNetwork>(new OpenIG::Library::Networking::UDPNetwork(host, "", false, true));
+        ackNetwork->setPort(ackPort);
+        ackNetwork->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_FRAMEACK, ackCallback = new FrameAckCallback(frameTimes));
+        ackNetwork->setParser(new Parser);
+    }
+
+    // The terrain queries, if any
+    QueryStats hotStats;
+    QueryStats losStats;
+    boost::shared_ptr<OpenIG::Library::Protocol::TerrainQueryClient> terrainQueries;
+    if (!server.empty() && (hotRate > 0.0 || losRate > 0.0))
+    {
+        terrainQueries = boost::shared_ptr<OpenIG::Library::Protocol::TerrainQueryClient>(
+            new OpenIG::Library::Protocol::TerrainQueryClient(host, server, atoi(serverport.c_str()), queryTimeout));
+    }
+
+    Random random(seed);
+
+    // The entities on a square grid around the origin, each
+    // updated at the entity rate, spread over the frames
+    SyntheticEntities entities(numEntities);
+    unsigned int columns = (unsigned int)ceil(sqrt((double)numEntities));
+    for (unsigned int i = 0; i < numEntities; ++i)
+    {
+        SyntheticEntity& entity = entities[i];
+        entity.id = entityID + i;
+        entity.origin = osg::Vec3d(
+            ((i % columns) - columns * 0.5) * spacing,
+            ((i / columns) - columns * 0.5) * spacing,
+            altitude);
+        entity.position = entity.origin;
+        entity.heading = random.next() * 360.0;
+        entity.speed = speed * (0.5 + random.next());
+        entity.angle = random.next() * osg::PI * 2.0;
+        entity.nextUpdate = (double)i / numEntities / entityRate;
+    }
+
+    SyntheticLights lights(numLights);
+    for (unsigned int i = 0; i < numLights; ++i)
+    {
+        SyntheticLight& light = lights[i];
+        light.id = lightID + i;
+        light.position = entities.empty() ? osg::Vec3d() : entities[i % entities.size()].origin;
+        light.position.z() += 5.0;
+        light.enabled = true;
+    }
+
+    std::cout << "Load: " << numEntities << " entities (" << motionName << ") at " << entityRate << " Hz, "
+        << numLights << " lights, " << lightChurn << " light changes/s, "
+        << commandRate << " command bursts/s of " << commandBurst << ", "
+        << hotRate << " HOT/s, " << losRate << " LOS/s, over " << protocol << " at " << rate << " Hz" << std::endl;
+
+    // The totals, and the totals at the last report
+    unsigned long long numFrames = 0;
+    unsigned long long numLateFrames = 0;
+    unsigned long long numEntityUpdates = 0;
+    unsigned long long numLightChanges = 0;
+    unsigned long long numCommands = 0;
+
+    unsigned long long lastFrames = 0;
+    unsigned long long lastSends = 0;
+    unsigned long long lastBytes = 0;
+    unsigned long long lastEntityUpdates = 0;
+    unsigned long long lastLightChanges = 0;
+    unsigned long long lastCommands = 0;
+
+    double lightCarry = 0.0;
+    double commandCarry = 0.0;
+    double hotCarry = 0.0;
+    double losCarry = 0.0;
+
+    const double frameTime = 1.0 / rate;
+
+    osg::Timer_t start = osg::Timer::instance()->tick();
+    osg::Timer_t lastReport = start;
+    double nextFrame = 0.0;
+    unsigned int frameNumber = 1;
+
+    while (duration <= 0.0 || nextFrame < duration)
+    {
+        // The frames are paced to the rate, and a late one
+        // is not made up for by sending the next ones sooner
+        double now = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+        if (now < nextFrame)
+        {
+            waitUntil(nextFrame, start, ackNetwork.get(), ackCallback);
+        }
+        else if (now > nextFrame + frameTime)
+        {
+            ++numLateFrames;
+            nextFrame = now;
+        }
+
+        double time = nextFrame;
+        nextFrame += frameTime;
+
+        writer.begin(frameNumber);
+
+        // Adding the entities and the lights on the IG goes out first
+        if (numFrames == 0)
+        {
+            OpenIG::Library::Protocol::Command add;
+            if (!model.empty())
+            {
+                for (SyntheticEntities::iterator itr = entities.begin(); itr != entities.end(); ++itr)
+                {
+                    std::ostringstream oss;
+                    oss << "addentity " << itr->id << " " << model << " " << itr->position.x() << " " << itr->position.y() << " " << itr->position.z() << " 0 0 0";
+                    add.command = oss.str();
+                    writer.write(add);
+                }
+            }
+            for (SyntheticLights::iterator itr = lights.begin(); itr != lights.end(); ++itr)
+            {
+                std::ostringstream oss;
+                oss << "addlight " << itr->id << " " << itr->position.x() << " " << itr->position.y() << " " << itr->position.z() << " 0 0 0 point";
+                add.command = oss.str();
+                writer.write(add);
+            }
+        }
+
+        // The entities that are due
+        OpenIG::Library::Protocol::EntityState estate;
+        for (SyntheticEntities::iterator itr = entities.begin(); itr != entities.end(); ++itr)
+        {
+            SyntheticEntity& entity = *itr;
+
+            move(entity, motion, frameTime, extent, random);
+
+            if (time < entity.nextUpdate) continue;
+            entity.nextUpdate += 1.0 / entityRate;
+            if (entity.nextUpdate < time) entity.nextUpdate = time + 1.0 / entityRate;
+
+            estate.entityID = entity.id;
+            estate.mx = OpenIG::Base::Math::instance()->toMatrix(entity.position.x(), entity.position.y(), entity.position.z(), entity.heading, 0.0, 0.0);
+            writer.write(estate);
+
+            ++numEntityUpdates;
+        }
+
+        // Turning random lights on and off
+        unsigned int numChanges = lights.empty() ? 0 : due(lightChurn, frameTime, lightCarry);
+        for (unsigned int i = 0; i < numChanges; ++i)
+        {
+            SyntheticLight& light = lights[(size_t)(random.next() * lights.size())];
+            light.enabled = !light.enabled;
+
+            OpenIG::Library::Protocol::LightState ls;
+            ls.id = light.id;
+            ls.enabled = light.enabled;
+            writer.write(ls);
+
+            ++numLightChanges;
+        }
+
+        // The command bursts
+        unsigned int numBursts = due(commandRate, frameTime, commandCarry);
+        for (unsigned int i = 0; i < numBursts * commandBurst; ++i)
+        {
+            OpenIG::Library::Protocol::Command cmd;
+            cmd.command = command;
+            writer.write(cmd);
+
+            ++numCommands;
+        }
+
+        writer.end();
+        frameTimes.sent(frameNumber, osg::Timer::instance()->tick());
+
+        // The terrain queries, under random entities, never waited for
+        if (terrainQueries.get())
+        {
+            terrainQueries->dispatch();
+
+            unsigned int numHOT = entities.empty() ? 0 : due(hotRate, frameTime, hotCarry);
+            for (unsigned int i = 0; i < numHOT; ++i)
+            {
+                const SyntheticEntity& entity = entities[(size_t)(random.next() * entities.size())];
+                terrainQueries->hot(entity.position, QueryCallback(hotStats));
+            }
+
+            unsigned int numLOS = entities.empty() ? 0 : due(losRate, frameTime, losCarry);
+            for (unsigned int i = 0; i < numLOS; ++i)
+            {
+                const SyntheticEntity& entity = entities[(size_t)(random.next() * entities.size())];
+                double heading = osg::DegreesToRadians(entity.heading);
+                osg::Vec3d end = entity.position + osg::Vec3d(-sin(heading), cos(heading), -0.1) * 500.0;
+                terrainQueries->los(entity.position, end, QueryCallback(losStats));
+            }
+
+            terrainQueries->flush(frameNumber);
+        }
+
+        ++numFrames;
+        ++frameNumber;
+
+        osg::Timer_t tick = osg::Timer::instance()->tick();
+        double sinceReport = osg::Timer::instance()->delta_s(lastReport, tick);
+        if (sinceReport >= reportInterval)
+        {
+            std::cout << std::fixed << std::setprecision(1)
+                << "[" << osg::Timer::instance()->delta_s(start, tick) << "s] "
+                << (numFrames - lastFrames) / sinceReport << " frames/s, "
+                << (writer.numSends - lastSends) / sinceReport << " sends/s, "
+                << (writer.numBytes - lastBytes) / sinceReport / 1024.0 << " KB/s, "
+                << (numEntityUpdates - lastEntityUpdates) / sinceReport << " entity updates/s, "
+                << (numLightChanges - lastLightChanges) / sinceReport << " light changes/s, "
+                << (numCommands - lastCommands) / sinceReport << " commands/s";
+            if (ackCallback)
+            {
+                std::cout << ", latency " << percentiles(ackCallback->intervalLatencies);
+                ackCallback->intervalLatencies.clear();
+            }
+            if (terrainQueries.get())
+            {
+                std::cout << ", queries in flight " << terrainQueries->getNumInFlight();
+            }
+            std::cout << std::endl;
+
+            OpenIG::Library::Networking::TCPServer* tcpServer = dynamic_cast<OpenIG::Library::Networking::TCPServer*>(network.get());
+            if (tcpServer)
+            {
+                OpenIG::Library::Networking::TCPServer::ClientStatsList clients;
+                tcpServer->getClientStats(clients);
+
+                for (OpenIG::Library::Networking::TCPServer::ClientStatsList::iterator itr = clients.begin(); itr != clients.end(); ++itr)
+                {
+                    std::cout << "    " << itr->address << ": queue " << itr->queueDepth << " (max " << itr->maxQueueDepth << "), dropped " << itr->numDropped << std::endl;
+                }
+            }
+
+            lastReport = tick;
+            lastFrames = numFrames;
+            lastSends = writer.numSends;
+            lastBytes = writer.numBytes;
+            lastEntityUpdates = numEntityUpdates;
+            lastLightChanges = numLightChanges;
+            lastCommands = numCommands;
+        }
+    }
+
+    double elapsed = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+
+    // The late acknowledgements and responses
+    waitUntil(elapsed + queryTimeout, start, ackNetwork.get(), ackCallback);
+    if (elapsed <= 0.0) elapsed = 1.0;
+    if (terrainQueries.get())
+    {
+        terrainQueries->dispatch();
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << std::endl;
+    std::cout << "Frames:         " << numFrames << " in " << elapsed << "s, " << numFrames / elapsed << " of " << rate << " Hz, " << numLateFrames << " late" << std::endl;
+    std::cout << "Sends:          " << writer.numSends << ", " << writer.numSends / elapsed << "/s, " << writer.numBytes / elapsed / 1024.0 << " KB/s, " << (double)writer.numSends / (numFrames ? numFrames : 1) << " per frame" << std::endl;
+    std::cout << "Entity updates: " << numEntityUpdates << ", " << numEntityUpdates / elapsed << "/s" << std::endl;
+    std::cout << "Light changes:  " << numLightChanges << ", " << numLightChanges / elapsed << "/s" << std::endl;
+    std::cout << "Commands:       " << numCommands << ", " << numCommands / elapsed << "/s" << std::endl;
+
+    if (ackCallback)
+    {
+        std::cout << "Acknowledged:   " << ackCallback->latencies.size() << " of " << numFrames << " frames, " << ackCallback->numUnknown << " repeated or unknown" << std::endl;
+        std::cout << "Apply latency:  " << percentiles(ackCallback->latencies) << std::endl;
+    }
+    if (terrainQueries.get())
+    {
+        std::cout << "HOT:            " << hotStats.numDone << " done, " << hotStats.numTimedOut << " timed out, " << hotStats.numFailed << " failed, round trip " << percentiles(hotStats.roundTrips) << std::endl;
+        std::cout << "LOS:            " << losStats.numDone << " done, " << losStats.numTimedOut << " timed out, " << losStats.numFailed << " failed, round trip " << percentiles(losStats.roundTrips) << std::endl;
+        std::cout << "Stale:          " << terrainQueries->getNumStale() << std::endl;
+    }
+
+    return 0;
+}
@@ -47,6 +47,7 @@
 #include <OpenIG-Protocol/LightState.h>
 #include <OpenIG-Protocol/Command.h>
 #include <OpenIG-Protocol/DeadReckonEntityState.h>
+#include <OpenIG-Protocol/FrameAck.h>
 
 #include <OpenIG-Base/Commands.h>
 #include <OpenIG-Base/Mathematics.h>
@@ -94,6 +95,8 @@ namespace OpenIG {
         {
             HeaderCallback(OpenIG::Base::ImageGenerator* ig)
                 : imageGenerator(ig)
+                , received(false)
+                , frameNumber(0)
             {
             }
 
@@ -103,10 +106,16 @@ namespace OpenIG {
                 if (h)
                 {
                     if (h->masterIsDead == 1) imageGenerator->getViewer()->setDone(true);
+
+                    // Every datagram from the host starts with one
+                    received = true;
+                    frameNumber = h->frameNumber;
                 }
             }
 
             OpenIG::Base::ImageGenerator*	imageGenerator;
+            bool							received;
+            unsigned int					frameNumber;
         };
 
 
@@ -156,7 +165,7 @@ namespace OpenIG {
 					int id = itr->first;
 					OpenIG::Library::Protocol::DeadReckonEntityState& dr = itr->second;
 
-					OpenIG::Base::ImageGenerator::Entity& entity = _imageGenerator->getEntityMap()[id];
+					OpenIG::Base::ImageGenerator::Entity entity = _imageGenerator->getEntityMap().get(id);
 					if (entity.valid())
 					{
 						osg::Matrixd mx = entity->getMatrix();
@@ -289,6 +298,9 @@ namespace OpenIG {
 				, _mode(None)
 				, _host("127.0.0.1")
 				, _port(8888)
+				, _headerCallback(0)
+				, _maxDatagramsPerFrame(1)
+				, _ackPort(0)
             {
             }
 
@@ -340,6 +352,19 @@ namespace OpenIG {
 					{
 						_port = atoi(child->contents.c_str());
 					}
+					if (child->name == "Max-Datagrams-Per-Frame")
+					{
+						int maxDatagrams = atoi(child->contents.c_str());
+						_maxDatagramsPerFrame = maxDatagrams > 1 ? maxDatagrams : 1;
+					}
+					if (child->name == "Ack-Host")
+					{
+						_ackHost = child->contents;
+					}
+					if (child->name == "Ack-Port")
+					{
+						_ackPort = atoi(child->contents.c_str());
+					}
 					if (child->name == "Mode")
 					{
 						_mode = None;
@@ -359,7 +384,7 @@ namespace OpenIG {
                 _network = boost::shared_ptr<OpenIG::Library::Networking::UDPNetwork>(new OpenIG::Library::Networking::UDPNetwork(_host,"",false,true));
                 _network->setPort(_port);
 
-                _network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_HEADER, new HeaderCallback(context.getImageGenerator()));
+                _network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_HEADER, _headerCallback = new HeaderCallback(context.getImageGenerator()));
                 _network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_ENTITYSTATE, new EntityStateCallback(context.getImageGenerator()));
                 _network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_CAMERA, new CameraCallback(context.getImageGenerator()));
                 _network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_TOD, new TODCallback(context.getImageGenerator()));
@@ -368,6 +393,14 @@ namespace OpenIG {
 				_network->addCallback((OpenIG::Library::Networking::Packet::Opcode)OPCODE_DEADRECKON_ENTITYSTATE, _drCallback = new DeadReckonEntityStateCallback(context.getImageGenerator(), _dt));
 
                 _network->setParser(new Parser);
+
+                // Acknowledge the applied frames to the host, for
+                // measuring the latency from the host to the scene
+                if (_ackPort != 0 && !_ackHost.empty())
+                {
+                    _ackNetwork = boost::shared_ptr<OpenIG::Library::Networking::UDPNetwork>(new OpenIG::Library::Networking::UDPNetwork(_host, _ackHost, false));
+                    _ackNetwork->setPort(_ackPort);
+                }
             }
 
             virtual void update(OpenIG::PluginBase::PluginContext&)
@@ -386,7 +419,32 @@ namespace OpenIG {
 
 					_dt = osg::Timer::instance()->delta_s(lastRecorededTime, now);
 
-                    _network->process();
+                    // More than one datagram per frame, if they are
+                    // already in. A busy host sends many per frame
+                    unsigned int numDatagrams = 0;
+                    while (numDatagrams < _maxDatagramsPerFrame)
+                    {
+                        _headerCallback->received = false;
+                        _network->process();
+
+                        if (!_headerCallback->received) break;
+                        ++numDatagrams;
+                    }
+
+                    if (_ackNetwork && numDatagrams)
+                    {
+                        OpenIG::Library::Networking::Buffer buffer(BUFFER_SIZE);
+
+                        OpenIG::Library::Protocol::Header header(_headerCallback->frameNumber);
+                        header.write(buffer);
+
+                        OpenIG::Library::Protocol::FrameAck ack;
+                        ack.frameNumber = _headerCallback->frameNumber;
+                        ack.numDatagrams = numDatagrams;
+                        ack.write(buffer);
+
+                        _ackNetwork->send(buffer);
+                    }
 
 					if (_drCallback != 0)
 					{
@@ -441,6 +499,14 @@ namespace OpenIG {
 
 			std::string													_host;
 			int															_port;
+
+			HeaderCallback*												_headerCallback;
+			unsigned int												_maxDatagramsPerFrame;
+
+			// Where the applied frames are acknowledged to, if set
+			boost::shared_ptr<OpenIG::Library::Networking::Network>		_ackNetwork;
+			std::string													_ackHost;
+			int															_ackPort;
         };
     } // namespace
 } // namespace
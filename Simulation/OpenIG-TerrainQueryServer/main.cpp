@@ -138,13 +138,18 @@ struct MyTCPServer : public OpenIG::Library::Networking::TCPServer
 
     virtual void process()
     {
+        // The receive does not block anymore, so reply
+        // only when the requests wrote their responses
+        // behind the header
+        int headerSize = buffer.getWritten();
+
         OpenIG::Library::Networking::TCPServer::process();
-        if (buffer.getWritten())
+        if (buffer.getWritten() > headerSize)
         {
             send(buffer);
-
-            buffer.rewrite();
         }
+
+        buffer.rewrite();
     }
 
     OpenIG::Library::Networking::Buffer& buffer;
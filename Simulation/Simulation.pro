@@ -3,7 +3,8 @@ TEMPLATE = subdirs
 SUBDIRS +=  OpenIG-Host \
             OpenIG-TerrainQueryServer \
             OpenIG-ImageGenerator \
-            OpenIG-Plugin
+            OpenIG-Plugin \
+            OpenIG-LoadGenerator
 
 OTHER_FILES +=  CMakeModules/*.* \
                 CMakeLists.txt
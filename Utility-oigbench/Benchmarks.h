@@ -0,0 +1,110 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <osg/Timer>
+
+namespace osgViewer { class View; }
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace OpenIG {
+	namespace Benchmarks {
+
+		typedef std::vector<std::string>	Arguments;
+
+		/*! Value of a --name value style argument, or the default */
+		inline double argument(const Arguments& args, const std::string& name, double defaultValue)
+		{
+			for (size_t i = 0; i + 1 < args.size(); ++i)
+			{
+				if (args.at(i) == name) return atof(args.at(i + 1).c_str());
+			}
+			return defaultValue;
+		}
+
+		/*! Value of a --name value style argument as a string, or the default */
+		inline std::string stringArgument(const Arguments& args, const std::string& name, const std::string& defaultValue)
+		{
+			for (size_t i = 0; i + 1 < args.size(); ++i)
+			{
+				if (args.at(i) == name) return args.at(i + 1);
+			}
+			return defaultValue;
+		}
+
+		inline bool hasArgument(const Arguments& args, const std::string& name)
+		{
+			for (size_t i = 0; i < args.size(); ++i)
+			{
+				if (args.at(i) == name) return true;
+			}
+			return false;
+		}
+
+		/*! A view rendering into a pbuffer, so the viewer does not open a window of its
+		 *  own. Without render nothing is culled into it. Without a pbuffer (no display,
+		 *  no Mesa) the view has no graphics context and only the update is run */
+		osgViewer::View* createHeadlessView(unsigned int width, unsigned int height, bool render);
+
+		/*! Headless benchmark of the particle simulation used by the OSGParticleEffects plugin */
+		int particles(const Arguments& args);
+
+		/*! Headless benchmark of the Forward+ tile light binning, no GL context needed */
+		int lightgrid(const Arguments& args);
+
+		/*! Frustum queries and refits of the LightManager light BVH against the octree it replaced */
+		int lightbvh(const Arguments& args);
+
+		/*! Headless cull of the entities under a flat osg::Group against the spatially partitioned EntityRoot */
+		int entitycull(const Arguments& args);
+
+		/*! Memory per light and update throughput of the light change journal against the per light signals it replaced */
+		int lightjournal(const Arguments& args);
+
+		/*! Replays a recorded session through the Networking plugin of a headless IG, reporting the throughput and latency */
+		int netreplay(const Arguments& args);
+
+		/*! One multicast master feeding several slave channels on loopback, as threads or with --master and --slave as processes */
+		int multicast(const Arguments& args);
+
+		/*! Engine::frame of a headless IG over a synthetic scene, with the per stage timings as JSON and an optional baseline check */
+		int frame(const Arguments& args);
+	}
+}
+
+#endif // BENCHMARKS_H
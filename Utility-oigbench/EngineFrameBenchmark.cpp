@@ -0,0 +1,396 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include "Benchmarks.h"
+
+#include <Core-OpenIG/Engine.h>
+
+#include <Core-Utils/ShaderUtils.h>
+
+#include <osg/Geode>
+#include <osg/ShapeDrawable>
+#include <osg/Stats>
+
+#include <osgViewer/CompositeViewer>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+	// The timings of one stage of the frame, in ms
+	struct Stage
+	{
+		Stage(const std::string& stageName) : name(stageName) {}
+
+		double mean() const
+		{
+			double sum = 0.0;
+			for (size_t i = 0; i < samples.size(); ++i) sum += samples[i];
+			return samples.empty() ? 0.0 : sum / samples.size();
+		}
+
+		// Of the sorted samples
+		double percentile(double p) const
+		{
+			if (samples.empty()) return 0.0;
+			return samples[std::min(samples.size() - 1, size_t(samples.size() * p))];
+		}
+
+		std::string			name;
+		std::vector<double>	samples;
+	};
+	typedef std::vector<Stage>	Stages;
+
+	// The osg::Stats attributes the viewer and the renderer record, in seconds.
+	// Event and update are on the viewer stats, cull and draw on the camera
+	struct StatsAttribute
+	{
+		const char*	stage;
+		const char*	attribute;
+		bool		camera;
+	};
+
+	const StatsAttribute statsAttributes[] =
+	{
+		{ "event",	"Event traversal time taken",	false },
+		{ "update",	"Update traversal time taken",	false },
+		{ "cull",	"Cull traversal time taken",	true },
+		{ "draw",	"Draw traversal time taken",	true },
+		{ "gpu",	"GPU draw time taken",			true }
+	};
+	const size_t numStatsAttributes = sizeof(statsAttributes) / sizeof(statsAttributes[0]);
+
+	// Entity positions on a square grid, circling around their cell
+	osg::Matrixd entityMatrix(unsigned int index, unsigned int gridSize, double spacing, double time)
+	{
+		double phase = index * 0.37;
+		double x = (index % gridSize) * spacing + std::cos(time + phase) * spacing * 0.25;
+		double y = (index / gridSize) * spacing + std::sin(time + phase) * spacing * 0.25;
+
+		return osg::Matrixd::rotate(time + phase, osg::Vec3d(0, 0, 1)) * osg::Matrixd::translate(x, y, 10.0);
+	}
+
+	// The mean of a stage from a JSON written by an earlier run,
+	// negative if the stage is not in there
+	double baselineMean(const std::string& json, const std::string& stage)
+	{
+		size_t pos = json.find("\"" + stage + "\": {");
+		if (pos == std::string::npos) return -1.0;
+
+		pos = json.find("\"mean_ms\":", pos);
+		if (pos == std::string::npos) return -1.0;
+
+		return atof(json.c_str() + pos + 10);
+	}
+}
+
+int OpenIG::Benchmarks::frame(const Arguments& args)
+{
+	if (hasArgument(args, "--help"))
+	{
+		std::cout << "usage: oigbench frame [--config igdata/openig.xml] [--entities N] [--lights N] [--light-updates N]" << std::endl;
+		std::cout << "                      [--effects N --effect SmokeEffect] [--model file [--animation name]]" << std::endl;
+		std::cout << "                      [--frames N] [--warmup N] [--width W --height H] [--no-render]" << std::endl;
+		std::cout << "                      [--json file] [--baseline file [--tolerance 0.25] [--min-delta 0.05] [--report-only]]" << std::endl;
+		std::cout << "On a machine without a GPU run it under Xvfb with Mesa (LIBGL_ALWAYS_SOFTWARE=1)" << std::endl;
+		return 0;
+	}
+
+	std::string config = stringArgument(args, "--config", "igdata/openig.xml");
+	std::string model = stringArgument(args, "--model", "");
+	std::string animation = stringArgument(args, "--animation", "");
+	std::string effect = stringArgument(args, "--effect", "SmokeEffect");
+	std::string jsonFile = stringArgument(args, "--json", "");
+	std::string baselineFile = stringArgument(args, "--baseline", "");
+	unsigned int numEntities = (unsigned int)argument(args, "--entities", 1000);
+	unsigned int numLights = (unsigned int)argument(args, "--lights", 200);
+	unsigned int numLightUpdates = (unsigned int)argument(args, "--light-updates", 20);
+	unsigned int numEffects = (unsigned int)argument(args, "--effects", 0);
+	unsigned int numFrames = (unsigned int)argument(args, "--frames", 300);
+	unsigned int numWarmup = (unsigned int)argument(args, "--warmup", 30);
+	unsigned int width = (unsigned int)argument(args, "--width", 1280);
+	unsigned int height = (unsigned int)argument(args, "--height", 720);
+	double tolerance = argument(args, "--tolerance", 0.25);
+	double minDelta = argument(args, "--min-delta", 0.05);
+	bool render = !hasArgument(args, "--no-render");
+	bool reportOnly = hasArgument(args, "--report-only");
+
+	std::cout << "frame: " << numEntities << " entities, " << numLights << " lights (" << numLightUpdates << " updated per frame), "
+		<< numEffects << " effects, " << numFrames << " frames" << (render ? "" : ", not rendering") << std::endl;
+
+	osg::ref_ptr<osgViewer::CompositeViewer> viewer = new osgViewer::CompositeViewer;
+	osg::ref_ptr<osgViewer::View> view = createHeadlessView(width, height, render);
+	viewer->addView(view.get());
+	viewer->setThreadingModel(osgViewer::ViewerBase::SingleThreaded);
+
+	bool hasContext = view->getCamera()->getGraphicsContext() != 0;
+
+	osg::ref_ptr<OpenIG::Engine> ig = new OpenIG::Engine;
+	ig->init(viewer.get(), config);
+
+	// The synthetic scene. One shared box unless a model is given
+	unsigned int gridSize = (unsigned int)std::ceil(std::sqrt(double(osg::maximum(numEntities, 1u))));
+	double spacing = 40.0;
+
+	osg::ref_ptr<osg::Geode> box = new osg::Geode;
+	box->addDrawable(new osg::ShapeDrawable(new osg::Box(osg::Vec3(0, 0, 0), 10.f)));
+
+	for (unsigned int i = 0; i < numEntities; ++i)
+	{
+		if (model.empty())
+			ig->addEntity(i + 1, box.get(), entityMatrix(i, gridSize, spacing, 0.0));
+		else
+			ig->addEntity(i + 1, model, entityMatrix(i, gridSize, spacing, 0.0));
+
+		if (!animation.empty()) ig->playAnimation(i + 1, animation);
+	}
+
+	OpenIG::Base::LightAttributes lightAttributes;
+	lightAttributes.lightType = OpenIG::Base::LT_POINT;
+	lightAttributes.diffuse = osg::Vec4(1.f, 0.9f, 0.7f, 1.f);
+	lightAttributes.ambient = osg::Vec4(0.f, 0.f, 0.f, 1.f);
+	lightAttributes.specular = osg::Vec4(1.f, 1.f, 1.f, 1.f);
+	lightAttributes.fStartRange = 5.f;
+	lightAttributes.fEndRange = 60.f;
+
+	for (unsigned int i = 0; i < numLights; ++i)
+	{
+		ig->addLight(i + 1, lightAttributes, osg::Matrixd::translate(0, 0, 8.0));
+		if (numEntities) ig->bindLightToEntity(i + 1, (i % numEntities) + 1);
+	}
+
+	for (unsigned int i = 0; i < numEffects; ++i)
+	{
+		ig->addEffect(i + 1, effect, entityMatrix(i, gridSize, spacing, 0.0), "");
+	}
+
+	// Looking down at the grid from a corner
+	double extent = gridSize * spacing;
+	view->getCamera()->setViewMatrixAsLookAt(
+		osg::Vec3d(-extent * 0.25, -extent * 0.25, extent * 0.5),
+		osg::Vec3d(extent * 0.5, extent * 0.5, 0.0),
+		osg::Vec3d(0, 0, 1));
+
+	viewer->getViewerStats()->collectStats("event", true);
+	viewer->getViewerStats()->collectStats("update", true);
+	osg::Stats* cameraStats = view->getCamera()->getStats();
+	if (cameraStats)
+	{
+		cameraStats->collectStats("rendering", true);
+		cameraStats->collectStats("gpu", true);
+	}
+
+	Stages stages;
+	stages.push_back(Stage("frame"));
+	for (size_t i = 0; i < numStatsAttributes; ++i)
+	{
+		stages.push_back(Stage(statsAttributes[i].stage));
+	}
+	stages.push_back(Stage("other"));
+
+	// The setup frames, as the image generator runs them
+	ig->frame(false);
+	ig->frame(false);
+
+	unsigned int lightToUpdate = 0;
+	double simulationTime = 0.0;
+
+	osg::Timer_t start = osg::Timer::instance()->tick();
+	for (unsigned int frameIndex = 0; frameIndex < numWarmup + numFrames; ++frameIndex)
+	{
+		simulationTime += 1.0 / 60.0;
+
+		for (unsigned int i = 0; i < numEntities; ++i)
+		{
+			ig->updateEntity(i + 1, entityMatrix(i, gridSize, spacing, simulationTime));
+		}
+
+		for (unsigned int i = 0; i < numLightUpdates && numLights; ++i)
+		{
+			lightAttributes.brightness = 0.5f + 0.5f * std::sin(simulationTime + lightToUpdate);
+			lightAttributes.dirtyMask = OpenIG::Base::LightAttributes::BRIGHTNESS;
+			ig->updateLightAttributes((lightToUpdate % numLights) + 1, lightAttributes);
+			++lightToUpdate;
+		}
+
+		if (frameIndex == numWarmup) start = osg::Timer::instance()->tick();
+
+		osg::Timer_t frameStart = osg::Timer::instance()->tick();
+		ig->frame();
+		double frameMs = osg::Timer::instance()->delta_m(frameStart, osg::Timer::instance()->tick());
+
+		if (frameIndex < numWarmup) continue;
+
+		stages[0].samples.push_back(frameMs);
+
+		unsigned int frameNumber = viewer->getFrameStamp()->getFrameNumber();
+		double accounted = 0.0;
+
+		for (size_t i = 0; i < numStatsAttributes; ++i)
+		{
+			osg::Stats* stats = statsAttributes[i].camera ? cameraStats : viewer->getViewerStats();
+			if (!stats) continue;
+
+			// The GPU timings come in a few frames late
+			unsigned int statsFrameNumber = frameNumber;
+			if (std::string(statsAttributes[i].stage) == "gpu") statsFrameNumber = stats->getLatestFrameNumber();
+
+			double seconds = 0.0;
+			if (!stats->getAttribute(statsFrameNumber, statsAttributes[i].attribute, seconds)) continue;
+
+			stages[i + 1].samples.push_back(seconds * 1000.0);
+			if (std::string(statsAttributes[i].stage) != "gpu") accounted += seconds * 1000.0;
+		}
+
+		// The plugins, the IG's own pre render and the entity root commit
+		stages.back().samples.push_back(osg::maximum(frameMs - accounted, 0.0));
+	}
+	double seconds = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+
+	for (size_t i = 0; i < stages.size(); ++i)
+	{
+		std::sort(stages[i].samples.begin(), stages[i].samples.end());
+	}
+
+	std::cout << "  " << numFrames << " frames in " << seconds << " s, " << numFrames / osg::maximum(seconds, 1e-9) << " fps"
+		<< (hasContext ? "" : ", no graphics context") << std::endl;
+	for (size_t i = 0; i < stages.size(); ++i)
+	{
+		const Stage& stage = stages[i];
+		if (stage.samples.empty()) continue;
+
+		std::cout << "  " << stage.name << ": avg " << stage.mean() << " ms, p50 " << stage.percentile(0.5)
+			<< " ms, p95 " << stage.percentile(0.95) << " ms, max " << stage.samples.back() << " ms" << std::endl;
+	}
+
+	// The programs the plugins asked for and their compiles over all the contexts
+	osg::ShaderProgramRegistry::Stats shaderStats = osg::ShaderProgramRegistry::instance()->getStats();
+	unsigned long numCompiles = 0;
+	double compileTime = 0.0;
+	for (osg::ShaderProgramRegistry::ContextStatsMap::const_iterator itr = shaderStats.contexts.begin(); itr != shaderStats.contexts.end(); ++itr)
+	{
+		numCompiles += itr->second.compiles;
+		compileTime += itr->second.compileTime;
+	}
+	std::cout << "  shader programs: " << shaderStats.numPrograms << " unique of " << shaderStats.requests << " requested, "
+		<< numCompiles << " compiles in " << compileTime * 1000.0 << " ms" << std::endl;
+
+	std::ostringstream json;
+	json << "{" << std::endl;
+	json << "  \"benchmark\": \"frame\"," << std::endl;
+	json << "  \"version\": \"" << ig->version() << "\"," << std::endl;
+	json << "  \"scene\": { \"entities\": " << numEntities << ", \"lights\": " << numLights
+		<< ", \"light_updates\": " << numLightUpdates << ", \"effects\": " << numEffects
+		<< ", \"model\": \"" << model << "\", \"animation\": \"" << animation << "\" }," << std::endl;
+	json << "  \"viewport\": { \"width\": " << width << ", \"height\": " << height
+		<< ", \"context\": " << (hasContext ? "true" : "false") << ", \"render\": " << (render ? "true" : "false") << " }," << std::endl;
+	json << "  \"frames\": " << numFrames << "," << std::endl;
+	json << "  \"seconds\": " << seconds << "," << std::endl;
+	json << "  \"shaders\": { \"requests\": " << shaderStats.requests << ", \"programs\": " << shaderStats.numPrograms
+		<< ", \"shaders\": " << shaderStats.numShaders << ", \"compiles\": " << numCompiles
+		<< ", \"compile_ms\": " << compileTime * 1000.0 << " }," << std::endl;
+	json << "  \"stages\": {" << std::endl;
+
+	bool first = true;
+	for (size_t i = 0; i < stages.size(); ++i)
+	{
+		const Stage& stage = stages[i];
+		if (stage.samples.empty()) continue;
+
+		if (!first) json << "," << std::endl;
+		first = false;
+
+		json << "    \"" << stage.name << "\": { \"samples\": " << stage.samples.size()
+			<< ", \"mean_ms\": " << stage.mean()
+			<< ", \"p50_ms\": " << stage.percentile(0.5)
+			<< ", \"p95_ms\": " << stage.percentile(0.95)
+			<< ", \"max_ms\": " << stage.samples.back() << " }";
+	}
+	json << std::endl << "  }" << std::endl << "}" << std::endl;
+
+	if (jsonFile == "-")
+	{
+		std::cout << json.str();
+	}
+	else if (!jsonFile.empty())
+	{
+		std::ofstream file(jsonFile.c_str());
+		file << json.str();
+		std::cout << "  timings written to " << jsonFile << std::endl;
+	}
+
+	ig->cleanup();
+	ig = NULL;
+
+	if (baselineFile.empty()) return 0;
+
+	// A stage regressed if it is slower than the baseline by more than the
+	// tolerance, and by more than the minimum delta to ignore the noise of
+	// the stages that take next to nothing
+	std::ifstream file(baselineFile.c_str());
+	if (!file.is_open())
+	{
+		std::cout << "  failed to read the baseline: " << baselineFile << std::endl;
+		return 1;
+	}
+	std::string baseline((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	unsigned int numRegressions = 0;
+	for (size_t i = 0; i < stages.size(); ++i)
+	{
+		const Stage& stage = stages[i];
+		if (stage.samples.empty()) continue;
+
+		double baselineMs = baselineMean(baseline, stage.name);
+		if (baselineMs < 0.0) continue;
+
+		double ms = stage.mean();
+		bool regressed = ms > baselineMs * (1.0 + tolerance) && ms - baselineMs > minDelta;
+		if (regressed) ++numRegressions;
+
+		std::cout << "  " << stage.name << ": " << ms << " ms against " << baselineMs << " ms"
+			<< (regressed ? ", REGRESSED" : "") << std::endl;
+	}
+
+	if (numRegressions)
+	{
+		std::cout << "  " << numRegressions << " stage(s) regressed more than " << tolerance * 100.0 << "%"
+			<< (reportOnly ? ", report only" : "") << std::endl;
+		return reportOnly ? 0 : 2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,252 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include "Benchmarks.h"
+
+#include <Core-Base/EntityRoot.h>
+
+#include <osg/Geode>
+#include <osg/MatrixTransform>
+#include <osg/ShapeDrawable>
+#include <osg/Viewport>
+
+#include <osgUtil/CullVisitor>
+#include <osgUtil/RenderStage>
+#include <osgUtil/StateGraph>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+	// Counts the entities that made it through the cull
+	struct VisibleCounter : public osg::NodeCallback
+	{
+		VisibleCounter() : count(0) {}
+
+		virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+		{
+			++count;
+			traverse(node, nv);
+		}
+
+		unsigned int count;
+	};
+
+	struct EntityCullBenchmarkScene
+	{
+		osg::ref_ptr<osg::Geode>			model;
+		osg::ref_ptr<VisibleCounter>		counter;
+		std::vector<osg::Matrixd>			views;
+		osg::Matrixd						projection;
+		osg::ref_ptr<osg::Viewport>			viewport;
+		osg::ref_ptr<osgUtil::CullVisitor>	cullVisitor;
+		osg::ref_ptr<osgUtil::StateGraph>	stateGraph;
+		osg::ref_ptr<osgUtil::RenderStage>	renderStage;
+		double								extent;
+		bool								farPlaneCulling;
+	};
+
+	// The same setup osgUtil::SceneView does for a camera, minus the draw
+	double cullView(EntityCullBenchmarkScene& scene, osg::Node* root, const osg::Matrixd& view)
+	{
+		osg::Timer_t start = osg::Timer::instance()->tick();
+
+		osgUtil::CullVisitor* cv = scene.cullVisitor.get();
+
+		scene.stateGraph->clean();
+		scene.renderStage->reset();
+
+		cv->reset();
+		cv->setStateGraph(scene.stateGraph.get());
+		cv->setRenderStage(scene.renderStage.get());
+		if (scene.farPlaneCulling)
+		{
+			cv->setComputeNearFarMode(osg::CullSettings::DO_NOT_COMPUTE_NEAR_FAR);
+			cv->setCullingMode(osg::CullSettings::VIEW_FRUSTUM_CULLING);
+		}
+
+		// The cull visitor clamps the projection in place
+		cv->pushViewport(scene.viewport.get());
+		cv->pushProjectionMatrix(new osg::RefMatrix(scene.projection));
+		cv->pushModelViewMatrix(new osg::RefMatrix(view), osg::Transform::ABSOLUTE_RF);
+
+		root->accept(*cv);
+
+		cv->popModelViewMatrix();
+		cv->popProjectionMatrix();
+		cv->popViewport();
+
+		return osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+	}
+
+	void run(const std::string& name, osg::Group* root, EntityCullBenchmarkScene& scene,
+		unsigned int numEntities, unsigned int numFrames, unsigned int numMoved)
+	{
+		OpenIG::Base::EntityRoot* entityRoot = dynamic_cast<OpenIG::Base::EntityRoot*>(root);
+
+		// Same entities for both roots
+		srand(1);
+
+		std::vector< osg::ref_ptr<osg::MatrixTransform> > entities;
+		entities.reserve(numEntities);
+
+		osg::Timer_t start = osg::Timer::instance()->tick();
+		for (unsigned int i = 0; i < numEntities; ++i)
+		{
+			osg::ref_ptr<osg::MatrixTransform> mxt = new osg::MatrixTransform;
+			mxt->setMatrix(osg::Matrixd::translate(
+				(double(rand()) / RAND_MAX * 2.0 - 1.0) * scene.extent,
+				(double(rand()) / RAND_MAX * 2.0 - 1.0) * scene.extent,
+				double(rand() % 50)));
+			mxt->addChild(scene.model.get());
+
+			root->addChild(mxt.get());
+			entities.push_back(mxt);
+		}
+		root->getBound();
+		if (entityRoot) entityRoot->commit();
+		double buildMs = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+		double updateMs = 0.0;
+		double cullMs = 0.0;
+		double visible = 0.0;
+
+		for (unsigned int f = 0; f < numFrames; ++f)
+		{
+			for (unsigned int i = 0; i < numMoved; ++i)
+			{
+				osg::MatrixTransform* mxt = entities[(f * numMoved + i) % entities.size()].get();
+				mxt->setMatrix(mxt->getMatrix() * osg::Matrixd::translate((f & 1) ? 20.0 : -20.0, 0.0, 0.0));
+			}
+
+			// What the engine does between the update and the cull
+			start = osg::Timer::instance()->tick();
+			root->getBound();
+			if (entityRoot) entityRoot->commit();
+			updateMs += osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+			for (size_t v = 0; v < scene.views.size(); ++v)
+			{
+				scene.counter->count = 0;
+				cullMs += cullView(scene, root, scene.views[v]);
+				visible += scene.counter->count;
+			}
+		}
+
+		// Remove them in random order, as entities come and go
+		std::random_shuffle(entities.begin(), entities.end());
+
+		start = osg::Timer::instance()->tick();
+		for (size_t i = 0; i < entities.size(); ++i)
+		{
+			root->removeChild(entities[i].get());
+		}
+		double removeMs = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+		const double numViews = double(scene.views.size()) * numFrames;
+
+		std::cout << "    " << name << " build " << buildMs << " ms, update " << updateMs / numFrames
+			<< " ms/frame, cull " << cullMs / numViews << " ms/view, "
+			<< visible / numViews << " visible/view, remove " << removeMs * 1000.0 / numEntities << " us/entity";
+		if (entityRoot) std::cout << ", " << entityRoot->getNumCells() << " cells left";
+		std::cout << std::endl;
+	}
+}
+
+int OpenIG::Benchmarks::entitycull(const Arguments& args)
+{
+	unsigned int numFrames = (unsigned int)argument(args, "--frames", 50);
+	double movedFraction = argument(args, "--moved", 0.05);
+	unsigned int numChannels = (unsigned int)argument(args, "--channels", 3);
+	double farPlane = argument(args, "--far", 0.0);
+
+	std::vector<unsigned int> counts;
+	if (hasArgument(args, "--entities"))
+	{
+		counts.push_back((unsigned int)argument(args, "--entities", 10000));
+	}
+	else
+	{
+		counts.push_back(1000);
+		counts.push_back(10000);
+		counts.push_back(50000);
+	}
+
+	EntityCullBenchmarkScene scene;
+
+	scene.counter = new VisibleCounter;
+	scene.model = new osg::Geode;
+	scene.model->addDrawable(new osg::ShapeDrawable(new osg::Box(osg::Vec3(0.f, 0.f, 5.f), 10.f)));
+	scene.model->setCullCallback(scene.counter.get());
+
+	// Without --far only the frustum sides cull, as
+	// with the default CullSettings the IG cameras use
+	scene.farPlaneCulling = farPlane > 0.0;
+	scene.projection = osg::Matrixd::perspective(45.0, 16.0 / 9.0, 1.0, scene.farPlaneCulling ? farPlane : 100000.0);
+	scene.viewport = new osg::Viewport(0, 0, 1920, 1080);
+	scene.cullVisitor = new osgUtil::CullVisitor;
+	scene.stateGraph = new osgUtil::StateGraph;
+	scene.renderStage = new osgUtil::RenderStage;
+	scene.renderStage->setViewport(scene.viewport.get());
+
+	for (unsigned int c = 0; c < numChannels; ++c)
+	{
+		double heading = (double(c) - double(numChannels - 1) * 0.5) * 45.0 * M_PI / 180.0;
+		scene.views.push_back(osg::Matrixd::lookAt(
+			osg::Vec3d(0, 0, 30), osg::Vec3d(sin(heading), cos(heading), 30), osg::Vec3d(0, 0, 1)));
+	}
+
+	std::cout << "entitycull: " << numChannels << " channels, " << numFrames << " frames, "
+		<< movedFraction * 100.0 << "% of the entities moving, ";
+	if (scene.farPlaneCulling) std::cout << "far plane at " << farPlane << " m" << std::endl;
+	else std::cout << "no far plane culling" << std::endl;
+
+	for (size_t n = 0; n < counts.size(); ++n)
+	{
+		// About one entity per 400 square meters
+		scene.extent = 10.0 * sqrt(double(counts[n]));
+
+		unsigned int numMoved = (unsigned int)(counts[n] * movedFraction);
+
+		std::cout << "  " << counts[n] << " entities over " << scene.extent * 2.0 / 1000.0 << " km, "
+			<< numMoved << " moving" << std::endl;
+
+		osg::ref_ptr<osg::Group> flat = new osg::Group;
+		run("group:      ", flat.get(), scene, counts[n], numFrames, numMoved);
+
+		osg::ref_ptr<OpenIG::Base::EntityRoot> spatial = new OpenIG::Base::EntityRoot;
+		run("entityroot: ", spatial.get(), scene, counts[n], numFrames, numMoved);
+	}
+
+	return 0;
+}
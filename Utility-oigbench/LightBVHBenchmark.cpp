@@ -0,0 +1,270 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include "Benchmarks.h"
+
+#include <Library-Graphics/Light.h>
+#include <Library-Graphics/LightBVH.h>
+#include <Library-Graphics/Camera.h>
+#include <Library-Graphics/Octree.h>
+#include <Library-Graphics/OctreeNode.h>
+
+#include <boost/any.hpp>
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace OpenIG::Library::Graphics;
+
+namespace {
+
+	const std::string s_StrLightKey = "Light";
+
+	struct LightBVHBenchmarkScene
+	{
+		VectorLights lights;
+		std::vector<Vector3_64> positions;
+		std::vector<Camera_64*> cameras;
+		double extent;
+	};
+
+	// Both structures start from the same positions
+	void resetLights(LightBVHBenchmarkScene& scene)
+	{
+		for (size_t i = 0; i < scene.lights.size(); ++i)
+		{
+			scene.lights[i]->SetPosition(scene.positions[i]);
+		}
+	}
+
+	void moveLights(LightBVHBenchmarkScene& scene, unsigned int numMoved, unsigned int frame)
+	{
+		for (unsigned int i = 0; i < numMoved; ++i)
+		{
+			Light* light = scene.lights[(frame * numMoved + i) % scene.lights.size()];
+			light->SetPosition(light->GetPosition() + Vector3_64((frame & 1) ? 5.0 : -5.0, 0, 0));
+		}
+	}
+
+	void runBVH(LightBVHBenchmarkScene& scene, unsigned int numFrames, unsigned int numMoved)
+	{
+		resetLights(scene);
+
+		LightBVH bvh;
+		std::vector<uint32> handles(scene.lights.size());
+
+		osg::Timer_t start = osg::Timer::instance()->tick();
+		for (size_t i = 0; i < scene.lights.size(); ++i)
+		{
+			handles[i] = bvh.Insert(scene.lights[i]);
+		}
+		bvh.Commit();
+		double buildMs = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+		double updateMs = 0.0;
+		double queryMs = 0.0;
+		double visible = 0.0;
+
+		VectorLights visibleLights;
+		for (unsigned int f = 0; f < numFrames; ++f)
+		{
+			moveLights(scene, numMoved, f);
+
+			start = osg::Timer::instance()->tick();
+			for (unsigned int i = 0; i < numMoved; ++i)
+			{
+				bvh.Update(handles[(f * numMoved + i) % handles.size()]);
+			}
+			bvh.Commit();
+			osg::Timer_t mid = osg::Timer::instance()->tick();
+
+			for (size_t c = 0; c < scene.cameras.size(); ++c)
+			{
+				visibleLights.clear();
+				bvh.FindVisibleLights(scene.cameras[c], visibleLights);
+				visible += visibleLights.size();
+			}
+			osg::Timer_t end = osg::Timer::instance()->tick();
+
+			updateMs += osg::Timer::instance()->delta_m(start, mid);
+			queryMs += osg::Timer::instance()->delta_m(mid, end);
+		}
+
+		std::cout << "    bvh:    build " << buildMs << " ms, update " << updateMs / numFrames
+			<< " ms/frame, query " << queryMs / numFrames << " ms/frame, "
+			<< visible / numFrames << " visible/frame, " << bvh.GetNumNodes() << " nodes" << std::endl;
+	}
+
+	void runOctree(LightBVHBenchmarkScene& scene, unsigned int numFrames, unsigned int numMoved)
+	{
+		resetLights(scene);
+
+		Octree_64 octree(0, 0, 8);
+		octree.m_Box.SetMinMax(Vector3_64(-scene.extent, -scene.extent, -scene.extent), Vector3_64(scene.extent, scene.extent, scene.extent));
+		octree.m_HalfSize = octree.m_Box.GetHalfSize();
+
+		std::vector<OctreeNode_64*> nodes(scene.lights.size());
+
+		// The bindings the LightManager used to go through
+		osg::Timer_t start = osg::Timer::instance()->tick();
+		for (size_t i = 0; i < scene.lights.size(); ++i)
+		{
+			nodes[i] = new OctreeNode_64();
+			nodes[i]->GetUserObjectBindings().SetUserAny(s_StrLightKey, scene.lights[i]);
+			nodes[i]->m_WorldAABB = scene.lights[i]->_GetWorldAABB();
+			octree.UpdateOctreeNode(nodes[i]);
+		}
+		double buildMs = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+		double updateMs = 0.0;
+		double queryMs = 0.0;
+		double visible = 0.0;
+
+		Octree_64::NodeList visibleNodes;
+		VectorLights visibleLights;
+		for (unsigned int f = 0; f < numFrames; ++f)
+		{
+			moveLights(scene, numMoved, f);
+
+			start = osg::Timer::instance()->tick();
+			for (unsigned int i = 0; i < numMoved; ++i)
+			{
+				size_t index = (f * numMoved + i) % nodes.size();
+				nodes[index]->m_WorldAABB = scene.lights[index]->_GetWorldAABB();
+				octree.UpdateOctreeNode(nodes[index]);
+			}
+			osg::Timer_t mid = osg::Timer::instance()->tick();
+
+			for (size_t c = 0; c < scene.cameras.size(); ++c)
+			{
+				visibleNodes.clear();
+				visibleLights.clear();
+				octree.FindVisibleObjects(visibleNodes, &octree, scene.cameras[c], false);
+
+				for (Octree_64::NodeList::iterator itr = visibleNodes.begin(); itr != visibleNodes.end(); ++itr)
+				{
+					Light* light = boost::any_cast<Light*>((*itr)->GetUserObjectBindings().GetUserAny(s_StrLightKey));
+					if (light->IsOn() && scene.cameras[c]->IsVisible(light->_GetWorldAABB()))
+					{
+						visibleLights.push_back(light);
+					}
+				}
+				visible += visibleLights.size();
+			}
+			osg::Timer_t end = osg::Timer::instance()->tick();
+
+			updateMs += osg::Timer::instance()->delta_m(start, mid);
+			queryMs += osg::Timer::instance()->delta_m(mid, end);
+		}
+
+		std::cout << "    octree: build " << buildMs << " ms, update " << updateMs / numFrames
+			<< " ms/frame, query " << queryMs / numFrames << " ms/frame, "
+			<< visible / numFrames << " visible/frame" << std::endl;
+
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			octree.RemoveOctreeNode(nodes[i]);
+			delete nodes[i];
+		}
+	}
+}
+
+int OpenIG::Benchmarks::lightbvh(const Arguments& args)
+{
+	unsigned int numFrames = (unsigned int)argument(args, "--frames", 100);
+	double movedFraction = argument(args, "--moved", 0.05);
+	unsigned int numChannels = (unsigned int)argument(args, "--channels", 3);
+
+	std::vector<unsigned int> counts;
+	if (hasArgument(args, "--lights"))
+	{
+		counts.push_back((unsigned int)argument(args, "--lights", 10000));
+	}
+	else
+	{
+		counts.push_back(1000);
+		counts.push_back(10000);
+		counts.push_back(100000);
+	}
+
+	std::cout << "lightbvh: " << numChannels << " channels, " << numFrames << " frames, "
+		<< movedFraction * 100.0 << "% of the lights moving" << std::endl;
+
+	for (size_t n = 0; n < counts.size(); ++n)
+	{
+		srand(1);
+
+		// Keep the density about the same as the count grows
+		LightBVHBenchmarkScene scene;
+		scene.extent = 50.0 * sqrt(double(counts[n]));
+
+		for (unsigned int i = 0; i < counts[n]; ++i)
+		{
+			Light* light = new Light();
+			light->SetLightType(LT_POINT);
+			light->SetPosition(Vector3_64(
+				(double(rand()) / RAND_MAX * 2.0 - 1.0) * scene.extent * 0.9,
+				(double(rand()) / RAND_MAX * 2.0 - 1.0) * scene.extent * 0.9,
+				double(rand() % 200)));
+			light->SetRanges(1.f, 10.f + float(rand() % 40));
+			scene.lights.push_back(light);
+			scene.positions.push_back(light->GetPosition());
+		}
+
+		for (unsigned int c = 0; c < numChannels; ++c)
+		{
+			double heading = (double(c) - double(numChannels - 1) * 0.5) * 60.0 * M_PI / 180.0;
+
+			Camera_64* camera = new Camera_64();
+			camera->SetPerspective(45.0, 16.0 / 9.0, 1.0, 2000.0);
+			camera->LookAt(Vector3_64(0, 0, 50), Vector3_64(sin(heading), cos(heading), 50), Vector3_64(0, 0, 1));
+			scene.cameras.push_back(camera);
+		}
+
+		unsigned int numMoved = (unsigned int)(counts[n] * movedFraction);
+
+		std::cout << "  " << counts[n] << " lights, " << numMoved << " moving" << std::endl;
+
+		runOctree(scene, numFrames, numMoved);
+		runBVH(scene, numFrames, numMoved);
+
+		for (size_t c = 0; c < scene.cameras.size(); ++c)
+		{
+			delete scene.cameras[c];
+		}
+		for (size_t i = 0; i < scene.lights.size(); ++i)
+		{
+			delete scene.lights[i];
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,187 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include "Benchmarks.h"
+
+#include <Core-Base/ThreadPool.h>
+
+#include <Library-Graphics/Light.h>
+#include <Library-Graphics/Camera.h>
+#include <Library-Graphics/TileSpaceLightGrid.h>
+#include <Library-Graphics/LightActivation.h>
+
+#include <boost/bind.hpp>
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace OpenIG::Library::Graphics;
+
+int OpenIG::Benchmarks::lightgrid(const Arguments& args)
+{
+	unsigned int numLights = (unsigned int)argument(args, "--lights", 4000);
+	unsigned int numChannels = (unsigned int)argument(args, "--channels", 3);
+	unsigned int numFrames = (unsigned int)argument(args, "--frames", 200);
+	unsigned int width = (unsigned int)argument(args, "--width", 1920);
+	unsigned int height = (unsigned int)argument(args, "--height", 1080);
+	unsigned int tile = (unsigned int)argument(args, "--tile", 32);
+
+	// Bins only the lights LightActivation keeps, and its proxies, as the Forward+ plugin does
+	bool activate = hasArgument(args, "--activate");
+	unsigned int maxActive = (unsigned int)argument(args, "--max-active", 1024);
+	unsigned int maxProxies = (unsigned int)argument(args, "--max-proxies", 32);
+
+	std::cout << "lightgrid: " << numLights << " lights, " << numChannels << " channels at "
+		<< width << "x" << height << ", " << tile << "x" << tile << " tiles, " << numFrames << " frames";
+	if (activate)
+	{
+		std::cout << ", at most " << maxActive << " active and " << maxProxies << " proxy lights";
+	}
+	std::cout << std::endl;
+
+	// Lights scattered around the eye, the same set every run
+	srand(1);
+
+	VectorLights lights;
+	for (unsigned int i = 0; i < numLights; ++i)
+	{
+		Light* light = new Light();
+		light->SetLightType(LT_POINT);
+		light->SetPosition(Vector3_64(
+			double(rand() % 4000) - 2000.0,
+			double(rand() % 4000) - 2000.0,
+			double(rand() % 200)));
+		light->SetRanges(1.f, 10.f + float(rand() % 90));
+		lights.push_back(light);
+	}
+
+	// The channels are side by side around the eye, as in a 3 channel dome
+	std::vector<Camera_64*> cameras;
+	for (unsigned int c = 0; c < numChannels; ++c)
+	{
+		double heading = (double(c) - double(numChannels - 1) * 0.5) * 60.0 * M_PI / 180.0;
+
+		Camera_64* camera = new Camera_64();
+		camera->SetPerspective(45.0, double(width) / double(height), 1.0, 10000.0);
+		camera->LookAt(Vector3_64(0, 0, 50), Vector3_64(sin(heading), cos(heading), 0) + Vector3_64(0, 0, 50), Vector3_64(0, 0, 1));
+		cameras.push_back(camera);
+	}
+
+	// What the LightManager would hand over per channel
+	std::vector<VectorLights> visibleLights(numChannels);
+	for (unsigned int c = 0; c < numChannels; ++c)
+	{
+		for (size_t i = 0; i < lights.size(); ++i)
+		{
+			if (cameras[c]->IsVisible(lights[i]->_GetWorldAABB()))
+			{
+				visibleLights[c].push_back(lights[i]);
+			}
+		}
+	}
+
+	Vector2_uint32 viewportSize(width, height);
+
+	for (int parallel = 0; parallel < 2; ++parallel)
+	{
+		std::vector<TileSpaceLightGrid*> grids;
+		std::vector<LightActivation*> activations;
+		std::vector<VectorLights> activeLights(numChannels);
+		for (unsigned int c = 0; c < numChannels; ++c)
+		{
+			LightActivation* activation = new LightActivation();
+			activation->SetMinScreenSize(float(tile / 2));
+			activation->SetMaxActiveLights(maxActive);
+			activation->SetMaxProxyLights(maxProxies);
+			activations.push_back(activation);
+
+			TileSpaceLightGrid* grid = new TileSpaceLightGrid(Vector2_uint32(tile, tile));
+			grid->SetScreenAreaCullSize(Vector2_uint32(tile, tile) / 2);
+			grid->SetParallelFor(parallel
+				? TileSpaceLightGrid::ParallelForFunc(boost::bind(&OpenIG::Base::ThreadPool::parallelFor, OpenIG::Base::ThreadPool::instance(), _1, _2, 1))
+				: TileSpaceLightGrid::ParallelForFunc());
+			grids.push_back(grid);
+		}
+
+		// warm up, sizes the buffers
+		for (unsigned int c = 0; c < numChannels; ++c)
+		{
+			activeLights[c] = visibleLights[c];
+			if (activate)
+			{
+				activations[c]->Apply(cameras[c], viewportSize, visibleLights[c], activeLights[c]);
+			}
+			grids[c]->Update(activeLights[c], cameras[c], viewportSize);
+		}
+
+		double binnedLights = 0.0;
+		double indices = 0.0;
+
+		osg::Timer_t start = osg::Timer::instance()->tick();
+		for (unsigned int f = 0; f < numFrames; ++f)
+		{
+			for (unsigned int c = 0; c < numChannels; ++c)
+			{
+				if (activate)
+				{
+					activations[c]->Apply(cameras[c], viewportSize, visibleLights[c], activeLights[c]);
+				}
+				grids[c]->Update(activeLights[c], cameras[c], viewportSize);
+				binnedLights += activeLights[c].size();
+				indices += grids[c]->GetTotalTileLightIndexListLength();
+			}
+		}
+		double ms = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+		std::cout << (parallel ? "  parallel: " : "  serial:   ")
+			<< ms / numFrames << " ms/frame, "
+			<< binnedLights / ms << " lights/ms, "
+			<< indices / numFrames << " tile indices/frame, "
+			<< binnedLights / numFrames << " binned lights/frame" << std::endl;
+
+		for (unsigned int c = 0; c < numChannels; ++c)
+		{
+			delete activations[c];
+			delete grids[c];
+		}
+	}
+
+	for (unsigned int c = 0; c < numChannels; ++c)
+	{
+		delete cameras[c];
+	}
+	for (size_t i = 0; i < lights.size(); ++i)
+	{
+		delete lights[i];
+	}
+
+	return 0;
+}
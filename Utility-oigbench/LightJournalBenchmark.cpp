@@ -0,0 +1,275 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include "Benchmarks.h"
+
+#include <Library-Graphics/Light.h>
+#include <Library-Graphics/LightJournal.h>
+#include <Library-Graphics/Signal.h>
+
+#include <boost/unordered_map.hpp>
+
+#include <cstdlib>
+
+using namespace OpenIG::Library::Graphics;
+
+namespace {
+
+	// The per light notification state the lights used to carry:
+	// updated, bounds updated and destroyed signals, each a std::set
+	typedef signal1<const Light*> LightSignal;
+	struct LightSignals
+	{
+		LightSignal updated;
+		LightSignal boundsUpdated;
+		LightSignal destroyed;
+	};
+
+	// Stands in for the LightManager or the LightData on the receiving
+	// side, both paths do the same work per notification
+	struct LightChangeSink
+	{
+		typedef boost::unordered_map<const Light*, uint32> LightSlots;
+		LightSlots slots;
+		std::vector<unsigned char> dirty;
+		std::vector<uint32> refits;
+
+		void LightUpdated(const Light* pLight)
+		{
+			LightSlots::iterator it = slots.find(pLight);
+			if (it != slots.end())
+			{
+				dirty[it->second] = 1;
+			}
+		}
+		void LightBoundsUpdated(const Light* pLight)
+		{
+			refits.push_back(pLight->_GetSpatialHandle());
+		}
+		void LightDestroyed(const Light* pLight)
+		{
+			slots.erase(pLight);
+		}
+	};
+
+	// A red-black tree node holds the delegate plus the color and three links
+	const size_t s_DelegateNodeBytes = sizeof(LightSignal::_Delegate) + 4 * sizeof(void*);
+
+	void resetSink(LightChangeSink& sink, const VectorLights& lights)
+	{
+		sink.slots.clear();
+		sink.refits.clear();
+		sink.dirty.assign(lights.size(), 0);
+		for (size_t i = 0; i < lights.size(); ++i)
+		{
+			sink.slots.insert(std::make_pair(lights[i], (uint32)i));
+		}
+	}
+
+	// A moved light gets a new position and a new color, as a
+	// light following an entity with a flickering lamp would
+	void changeLights(const VectorLights& lights, unsigned int numMoved, unsigned int frame, std::vector<LightSignals*>* signals)
+	{
+		for (unsigned int i = 0; i < numMoved; ++i)
+		{
+			size_t index = (frame * numMoved + i) % lights.size();
+			Light* light = lights[index];
+
+			light->SetPosition(light->GetPosition() + Vector3_64((frame & 1) ? 5.0 : -5.0, 0, 0));
+			if (signals)
+			{
+				(*signals)[index]->boundsUpdated(light);
+				(*signals)[index]->updated(light);
+			}
+
+			float32 intensity = (frame & 1) ? 0.5f : 1.f;
+			light->SetDiffuseColor(ColorValue(intensity, intensity, intensity, 1.f));
+			if (signals)
+			{
+				(*signals)[index]->updated(light);
+			}
+		}
+	}
+
+	void runSignals(const VectorLights& lights, unsigned int numFrames, unsigned int numMoved)
+	{
+		LightChangeSink managerSink;
+		LightChangeSink dataSink;
+		resetSink(managerSink, lights);
+		resetSink(dataSink, lights);
+
+		// The connections the LightManager and one LightData made per light
+		std::vector<LightSignals*> signals(lights.size());
+		for (size_t i = 0; i < lights.size(); ++i)
+		{
+			signals[i] = new LightSignals();
+			signals[i]->boundsUpdated.connect(&LightChangeSink::LightBoundsUpdated, &managerSink);
+			signals[i]->destroyed.connect(&LightChangeSink::LightDestroyed, &managerSink);
+			signals[i]->updated.connect(&LightChangeSink::LightUpdated, &dataSink);
+			signals[i]->destroyed.connect(&LightChangeSink::LightDestroyed, &dataSink);
+		}
+
+		double notifyMs = 0.0;
+		double notifications = 0.0;
+		for (unsigned int f = 0; f < numFrames; ++f)
+		{
+			managerSink.refits.clear();
+
+			osg::Timer_t start = osg::Timer::instance()->tick();
+			changeLights(lights, numMoved, f, &signals);
+			notifyMs += osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+			notifications += 3.0 * numMoved;
+		}
+
+		size_t numDelegates = 4;
+		size_t bytesPerLight = sizeof(LightSignals) + numDelegates * s_DelegateNodeBytes;
+
+		std::cout << "    signals: " << bytesPerLight << " bytes/light, setters+notify " << notifyMs / numFrames
+			<< " ms/frame, " << notifications / numFrames << " notifications/frame" << std::endl;
+
+		for (size_t i = 0; i < signals.size(); ++i)
+		{
+			delete signals[i];
+		}
+	}
+
+	void runJournal(const VectorLights& lights, unsigned int numFrames, unsigned int numMoved)
+	{
+		LightChangeSink managerSink;
+		LightChangeSink dataSink;
+		resetSink(managerSink, lights);
+		resetSink(dataSink, lights);
+
+		LightJournal journal;
+		for (size_t i = 0; i < lights.size(); ++i)
+		{
+			lights[i]->_SetJournal(&journal);
+		}
+
+		LightChanges changes;
+		double changeMs = 0.0;
+		double drainMs = 0.0;
+		double entries = 0.0;
+		for (unsigned int f = 0; f < numFrames; ++f)
+		{
+			managerSink.refits.clear();
+
+			osg::Timer_t start = osg::Timer::instance()->tick();
+			changeLights(lights, numMoved, f, 0);
+			osg::Timer_t mid = osg::Timer::instance()->tick();
+
+			// What LightManager::Commit and the LightData listener do with the entries
+			journal.Drain(changes);
+			for (LightChanges::const_iterator it = changes.begin(); it != changes.end(); ++it)
+			{
+				if (it->flags & LCF_BOUNDS)
+				{
+					managerSink.LightBoundsUpdated(it->pLight);
+				}
+				if (it->flags & LCF_DATA)
+				{
+					dataSink.LightUpdated(it->pLight);
+				}
+			}
+			osg::Timer_t end = osg::Timer::instance()->tick();
+
+			changeMs += osg::Timer::instance()->delta_m(start, mid);
+			drainMs += osg::Timer::instance()->delta_m(mid, end);
+			entries += changes.size();
+		}
+
+		// The light carries the journal pointer and its entry index, the
+		// journal keeps at most one entry per light changed in a frame
+		size_t capacity = changes.capacity() > journal.GetCapacity() ? changes.capacity() : journal.GetCapacity();
+		double bytesPerLight = double(sizeof(LightJournal*) + sizeof(uint32)) + double(2 * capacity * sizeof(LightChange)) / lights.size();
+
+		std::cout << "    journal: " << bytesPerLight << " bytes/light, setters " << changeMs / numFrames
+			<< " ms/frame, drain " << drainMs / numFrames << " ms/frame, setters+drain "
+			<< (changeMs + drainMs) / numFrames << " ms/frame, " << entries / numFrames << " entries/frame" << std::endl;
+
+		for (size_t i = 0; i < lights.size(); ++i)
+		{
+			lights[i]->_SetJournal(0);
+		}
+	}
+}
+
+int OpenIG::Benchmarks::lightjournal(const Arguments& args)
+{
+	unsigned int numFrames = (unsigned int)argument(args, "--frames", 100);
+	double movedFraction = argument(args, "--moved", 0.05);
+
+	std::vector<unsigned int> counts;
+	if (hasArgument(args, "--lights"))
+	{
+		counts.push_back((unsigned int)argument(args, "--lights", 10000));
+	}
+	else
+	{
+		counts.push_back(10000);
+		counts.push_back(50000);
+	}
+
+	std::cout << "lightjournal: " << numFrames << " frames, " << movedFraction * 100.0
+		<< "% of the lights changing position and color" << std::endl;
+	std::cout << "  sizeof(Light) " << sizeof(Light) << " bytes" << std::endl;
+
+	for (size_t n = 0; n < counts.size(); ++n)
+	{
+		srand(1);
+
+		VectorLights lights;
+		for (unsigned int i = 0; i < counts[n]; ++i)
+		{
+			Light* light = new Light();
+			light->SetLightType(LT_POINT);
+			light->SetPosition(Vector3_64(double(rand() % 10000), double(rand() % 10000), double(rand() % 200)));
+			light->SetRanges(1.f, 10.f + float(rand() % 40));
+			light->_SetSpatialHandle(i);
+			lights.push_back(light);
+		}
+
+		unsigned int numMoved = (unsigned int)(counts[n] * movedFraction);
+
+		std::cout << "  " << counts[n] << " lights, " << numMoved << " changing" << std::endl;
+
+		runSignals(lights, numFrames, numMoved);
+		runJournal(lights, numFrames, numMoved);
+
+		for (size_t i = 0; i < lights.size(); ++i)
+		{
+			delete lights[i];
+		}
+	}
+
+	return 0;
+}
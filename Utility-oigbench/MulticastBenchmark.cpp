@@ -0,0 +1,293 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include "Benchmarks.h"
+
+#include <Library-Networking/MulticastNetwork.h>
+#include <Library-Networking/Parser.h>
+#include <Library-Networking/Factory.h>
+
+#include <Library-Protocol/Header.h>
+#include <Library-Protocol/EntityState.h>
+#include <Library-Protocol/FrameLossDetector.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace {
+
+	using namespace OpenIG::Library;
+
+	struct MulticastSettings
+	{
+		std::string		group;
+		std::string		interfaceAddress;
+		unsigned int	port;
+		unsigned int	ttl;
+		unsigned int	numFrames;
+		unsigned int	numEntities;
+		double			rate;
+		double			timeout;
+	};
+
+	struct Parser : public Networking::Parser
+	{
+		Parser()
+		{
+			Networking::Factory::instance()->addTemplate(new Protocol::Header);
+			Networking::Factory::instance()->addTemplate(new Protocol::EntityState);
+		}
+
+		virtual Networking::Packet* parse(Networking::Buffer& buffer)
+		{
+			if (buffer.getRest() <= 0) return 0;
+
+			Networking::Packet* packet = Networking::Factory::instance()->packet(*buffer.fetch());
+			if (packet) packet->read(buffer);
+
+			return packet;
+		}
+	};
+
+	// What a slave channel does with the header of every frame
+	struct HeaderCallback : public Networking::Packet::Callback
+	{
+		HeaderCallback() : masterIsDead(false) {}
+
+		virtual void process(Networking::Packet& packet)
+		{
+			Protocol::Header* header = dynamic_cast<Protocol::Header*>(&packet);
+			if (header == 0) return;
+
+			if (header->masterIsDead)
+				masterIsDead = true;
+			else
+				lossDetector.process(header->frameNumber);
+		}
+
+		Protocol::FrameLossDetector	lossDetector;
+		bool						masterIsDead;
+	};
+
+	struct EntityStateCallback : public Networking::Packet::Callback
+	{
+		EntityStateCallback() : numUpdates(0) {}
+
+		virtual void process(Networking::Packet&)
+		{
+			++numUpdates;
+		}
+
+		unsigned int numUpdates;
+	};
+
+	struct Slave
+	{
+		Slave() : header(0), entities(0), numFramesExpected(0) {}
+
+		boost::shared_ptr<Networking::MulticastNetwork>	network;
+		HeaderCallback*									header;		// owned by the network
+		EntityStateCallback*							entities;
+		unsigned int									numFramesExpected;
+	};
+
+	void createSlave(Slave& slave, const MulticastSettings& settings)
+	{
+		slave.network.reset(new Networking::MulticastNetwork(settings.group, settings.interfaceAddress, settings.ttl, true));
+		slave.network->setPort(settings.port);
+		slave.network->setReusePort(true);
+		slave.network->setParser(new Parser);
+
+		slave.header = new HeaderCallback;
+		slave.entities = new EntityStateCallback;
+		slave.network->addCallback((Networking::Packet::Opcode)OPCODE_HEADER, slave.header);
+		slave.network->addCallback((Networking::Packet::Opcode)OPCODE_ENTITYSTATE, slave.entities);
+
+		// Joins the group before the master starts
+		slave.network->process();
+	}
+
+	// Until the master says it is done, or is quiet for too long
+	void runSlave(Slave* slave, double timeout)
+	{
+		osg::Timer_t last = osg::Timer::instance()->tick();
+		unsigned int received = 0;
+
+		while (!slave->header->masterIsDead)
+		{
+			slave->network->process();
+
+			if (slave->header->lossDetector.numReceived != received)
+			{
+				received = slave->header->lossDetector.numReceived;
+				last = osg::Timer::instance()->tick();
+			}
+			else if (osg::Timer::instance()->delta_s(last, osg::Timer::instance()->tick()) > timeout)
+			{
+				break;
+			}
+			else
+			{
+				boost::this_thread::sleep(boost::posix_time::microseconds(100));
+			}
+		}
+	}
+
+	void reportSlave(const std::string& name, const Slave& slave)
+	{
+		const Protocol::FrameLossDetector& detector = slave.header->lossDetector;
+
+		std::cout << "  " << name << ": " << detector.numReceived << " frames, " << detector.numLost << " lost, "
+			<< detector.numLate << " late, " << slave.entities->numUpdates << " entity updates" << std::endl;
+	}
+
+	void runMaster(const MulticastSettings& settings, unsigned int numSlaves)
+	{
+		Networking::MulticastNetwork network(settings.group, settings.interfaceAddress, settings.ttl);
+		network.setPort(settings.port);
+
+		double sendMs = 0.0;
+		double period = settings.rate > 0.0 ? 1.0 / settings.rate : 0.0;
+
+		osg::Timer_t start = osg::Timer::instance()->tick();
+		for (unsigned int f = 1; f <= settings.numFrames; ++f)
+		{
+			Networking::Buffer buffer(BUFFER_SIZE);
+
+			Protocol::Header header(f);
+			header.write(buffer);
+
+			for (unsigned int e = 0; e < settings.numEntities; ++e)
+			{
+				Protocol::EntityState entity;
+				entity.entityID = e;
+				entity.mx = osg::Matrixd::translate(double(f), double(e), 0.0);
+				entity.write(buffer);
+			}
+
+			osg::Timer_t sendStart = osg::Timer::instance()->tick();
+			network.send(buffer);
+			sendMs += osg::Timer::instance()->delta_m(sendStart, osg::Timer::instance()->tick());
+
+			// Paced like the master of an IG would be
+			double due = f * period;
+			double now = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+			if (due > now) boost::this_thread::sleep(boost::posix_time::microseconds((long long)((due - now) * 1000000.0)));
+		}
+
+		Protocol::Header header(settings.numFrames + 1);
+		header.masterIsDead = 1;
+		for (unsigned int i = 0; i < 10; ++i)
+		{
+			Networking::Buffer buffer(BUFFER_SIZE);
+			header.write(buffer);
+			network.send(buffer);
+		}
+
+		std::cout << "  master: " << settings.numFrames << " frames, one send each, "
+			<< sendMs / settings.numFrames * 1000.0 << " us/send";
+		if (numSlaves) std::cout << " for " << numSlaves << " slaves";
+		std::cout << std::endl;
+	}
+}
+
+int OpenIG::Benchmarks::multicast(const Arguments& args)
+{
+	MulticastSettings settings;
+	settings.group = "239.255.42.99";
+	settings.interfaceAddress = "0.0.0.0";
+	for (size_t i = 0; i + 1 < args.size(); ++i)
+	{
+		if (args.at(i) == "--group") settings.group = args.at(i + 1);
+		if (args.at(i) == "--interface") settings.interfaceAddress = args.at(i + 1);
+	}
+	settings.port = (unsigned int)argument(args, "--port", 8890);
+	settings.ttl = (unsigned int)argument(args, "--ttl", 1);
+	settings.numFrames = (unsigned int)argument(args, "--frames", 600);
+	settings.numEntities = (unsigned int)argument(args, "--entities", 8);
+	settings.rate = argument(args, "--rate", 60.0);
+	settings.timeout = argument(args, "--timeout", 5.0);
+
+	// A frame is one datagram, as the IG master sends it
+	unsigned int maxEntities = (BUFFER_SIZE - 11) / 133;
+	if (settings.numEntities > maxEntities)
+	{
+		std::cout << "multicast: no more than " << maxEntities << " entities fit a datagram" << std::endl;
+		settings.numEntities = maxEntities;
+	}
+
+	unsigned int numSlaves = (unsigned int)argument(args, "--slaves", 4);
+
+	std::cout << "multicast: " << settings.group << ":" << settings.port << " on " << settings.interfaceAddress
+		<< ", " << settings.numFrames << " frames at " << settings.rate << " Hz, " << settings.numEntities << " entities" << std::endl;
+
+	// Run the master and the slaves as separate processes with
+	// --master and --slave, by default they are threads of this one
+	if (hasArgument(args, "--master"))
+	{
+		runMaster(settings, 0);
+		return 0;
+	}
+
+	if (hasArgument(args, "--slave"))
+	{
+		Slave slave;
+		createSlave(slave, settings);
+		runSlave(&slave, settings.timeout);
+		reportSlave("slave", slave);
+
+		return slave.header->lossDetector.numReceived ? 0 : 1;
+	}
+
+	std::vector<Slave> slaves(numSlaves);
+	boost::thread_group threads;
+	for (unsigned int i = 0; i < numSlaves; ++i)
+	{
+		createSlave(slaves[i], settings);
+		threads.create_thread(boost::bind(&runSlave, &slaves[i], settings.timeout));
+	}
+
+	runMaster(settings, numSlaves);
+	threads.join_all();
+
+	bool allReceived = true;
+	for (unsigned int i = 0; i < numSlaves; ++i)
+	{
+		std::ostringstream name;
+		name << "slave " << i;
+		reportSlave(name.str(), slaves[i]);
+
+		allReceived = allReceived && slaves[i].header->lossDetector.numReceived != 0;
+	}
+
+	return allReceived ? 0 : 1;
+}
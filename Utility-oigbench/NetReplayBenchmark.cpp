@@ -0,0 +1,201 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+#include "Benchmarks.h"
+
+#include <Core-OpenIG/Engine.h>
+
+#include <osgViewer/CompositeViewer>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+	void setEnvironment(const char* name, const std::string& value)
+	{
+#if defined (__linux) || defined (__APPLE__)
+		setenv(name, value.c_str(), true);
+#elif   defined (_WIN32)
+		_putenv_s(name, value.c_str());
+#endif
+	}
+
+	// Over the entity IDs and transforms, equal across runs that applied the
+	// same updates. Summed per entity as the registry is not kept in ID order
+	unsigned long long entityChecksum(OpenIG::Engine* ig)
+	{
+		unsigned long long checksum = 0;
+
+		OpenIG::Base::ImageGenerator::EntityMapIterator itr = ig->getEntityMap().begin();
+		for (; itr != ig->getEntityMap().end(); ++itr)
+		{
+			if (!itr->second.valid()) continue;
+
+			unsigned long long hash = 1469598103934665603ULL ^ itr->first;
+
+			const osg::Matrixd& mx = itr->second->getMatrix();
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(mx.ptr());
+			for (size_t i = 0; i < sizeof(osg::Matrixd::value_type) * 16; ++i)
+			{
+				hash = (hash ^ bytes[i]) * 1099511628211ULL;
+			}
+			checksum += hash;
+		}
+		return checksum;
+	}
+}
+
+int OpenIG::Benchmarks::netreplay(const Arguments& args)
+{
+	std::string recording = stringArgument(args, "--recording", "");
+	if (recording.empty())
+	{
+		std::cout << "usage: oigbench netreplay --recording file [--config igdata/openig.xml] [--script file]" << std::endl;
+		std::cout << "                          [--entities N] [--frames N] [--fast] [--render] [--width W --height H]" << std::endl;
+		return 1;
+	}
+
+	std::string config = stringArgument(args, "--config", "igdata/openig.xml");
+	std::string script = stringArgument(args, "--script", "");
+	unsigned int numEntities = (unsigned int)argument(args, "--entities", 0);
+	unsigned int maxFrames = (unsigned int)argument(args, "--frames", 0);
+	unsigned int width = (unsigned int)argument(args, "--width", 1280);
+	unsigned int height = (unsigned int)argument(args, "--height", 720);
+	bool fast = hasArgument(args, "--fast");
+	bool render = hasArgument(args, "--render");
+
+	// The Networking plugin picks these up in place of its own network
+	setEnvironment("OPENIG_NETWORKING_REPLAY", recording);
+	setEnvironment("OPENIG_NETWORKING_REPLAY_PACING", fast ? "FAST" : "RECORDED");
+	setEnvironment("OPENIG_NETWORKING_RECORD", "");
+
+	std::cout << "netreplay: " << recording << (fast ? ", as fast as possible" : ", at the recorded speed")
+		<< (render ? ", rendering " : ", not rendering") << std::endl;
+
+	osg::ref_ptr<osgViewer::CompositeViewer> viewer = new osgViewer::CompositeViewer;
+	viewer->addView(createHeadlessView(width, height, render));
+	viewer->setThreadingModel(osgViewer::ViewerBase::SingleThreaded);
+
+	osg::ref_ptr<OpenIG::Engine> ig = new OpenIG::Engine;
+	ig->init(viewer.get(), config);
+
+	if (!script.empty())
+	{
+		ig->loadScript(script);
+	}
+
+	// Placeholders for the recorded entities, when the
+	// scene they were recorded against is not at hand
+	for (unsigned int i = 0; i < numEntities; ++i)
+	{
+		ig->addEntity(i, new osg::Group, osg::Matrixd::identity());
+	}
+
+	osg::ValueObject* values = ig->getPluginContext().getOrCreateValueObject();
+
+	// The setup frames, as the image generator runs them
+	ig->frame(false);
+	ig->frame(false);
+
+	std::vector<double> latencies;
+	double frameMs = 0.0;
+	double processMs = 0.0;
+	double maxProcessMs = 0.0;
+	unsigned int numFrames = 0;
+	unsigned int lastRecords = 0;
+
+	osg::Timer_t start = osg::Timer::instance()->tick();
+	while (maxFrames == 0 || numFrames < maxFrames)
+	{
+		osg::Timer_t frameStart = osg::Timer::instance()->tick();
+		ig->frame();
+		frameMs += osg::Timer::instance()->delta_m(frameStart, osg::Timer::instance()->tick());
+		++numFrames;
+
+		double processTime = 0.0;
+		values->getUserValue("Networking-Process-Time", processTime);
+		processMs += processTime * 1000.0;
+		maxProcessMs = osg::maximum(maxProcessMs, processTime * 1000.0);
+
+		unsigned int records = 0;
+		values->getUserValue("Networking-Replay-Records", records);
+		if (records != lastRecords)
+		{
+			double latency = 0.0;
+			values->getUserValue("Networking-Replay-Latency", latency);
+			latencies.push_back(latency * 1000.0);
+			lastRecords = records;
+		}
+
+		bool finished = false;
+		values->getUserValue("Networking-Replay-Finished", finished);
+		if (finished) break;
+	}
+	double seconds = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+
+	if (lastRecords == 0)
+	{
+		std::cout << "  nothing was replayed, is the Networking plugin loaded and the recording valid?" << std::endl;
+	}
+
+	unsigned int entityUpdates = 0;
+	values->getUserValue("Networking-Entity-Updates", entityUpdates);
+
+	double bytes = 0.0;
+	values->getUserValue("Networking-Replay-Bytes", bytes);
+
+	std::cout << "  " << numFrames << " frames in " << seconds << " s, " << frameMs / osg::maximum(numFrames, 1u) << " ms/frame" << std::endl;
+	std::cout << "  receives: " << lastRecords << ", " << lastRecords / seconds << "/s, "
+		<< bytes / seconds / 1024.0 << " KB/s" << std::endl;
+	std::cout << "  entity updates: " << entityUpdates << ", " << entityUpdates / seconds << "/s" << std::endl;
+	std::cout << "  process and apply: " << processMs / osg::maximum(numFrames, 1u) << " ms/frame, max " << maxProcessMs << " ms" << std::endl;
+
+	if (!latencies.empty())
+	{
+		std::sort(latencies.begin(), latencies.end());
+
+		double sum = 0.0;
+		for (size_t i = 0; i < latencies.size(); ++i) sum += latencies[i];
+
+		std::cout << "  latency: avg " << sum / latencies.size()
+			<< " ms, p50 " << latencies[latencies.size() / 2]
+			<< " ms, p99 " << latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)]
+			<< " ms, max " << latencies.back() << " ms" << std::endl;
+	}
+
+	std::cout << "  entity checksum: " << std::hex << entityChecksum(ig.get()) << std::dec << std::endl;
+
+	ig->cleanup();
+	ig = NULL;
+
+	return 0;
+}
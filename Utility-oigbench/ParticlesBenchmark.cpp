@@ -0,0 +1,89 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#include "Benchmarks.h"
+
+#include <Plugin-OSGParticleEffects/ParticleSimulation.h>
+
+using namespace OpenIG::Plugins::Particles;
+
+int OpenIG::Benchmarks::particles(const Arguments& args)
+{
+	unsigned int numEffects = (unsigned int)argument(args, "--effects", 200);
+	unsigned int numFrames = (unsigned int)argument(args, "--frames", 600);
+	float dt = 1.f / (float)argument(args, "--hz", 60);
+
+	const char* types[] = { "SmokeEffect", "SmokeTrailEffect", "FireEffect", "ExplosionEffect", "ExplosionDebrisEffect" };
+	const size_t numTypes = sizeof(types) / sizeof(types[0]);
+
+	std::cout << "particles: " << numEffects << " effects, " << numFrames << " frames at " << 1.f / dt << " Hz" << std::endl;
+
+	for (int parallel = 0; parallel < 2; ++parallel)
+	{
+		ParticleSimulation simulation;
+
+		for (unsigned int i = 0; i < numEffects; ++i)
+		{
+			EmitterParams params;
+			presetFor(types[i % numTypes], 10.f, 1.f, params);
+
+			// endless so the load stays steady
+			params.emitterDuration = 0.f;
+
+			ParticleSystem* system = simulation.create(i, types[i % numTypes], params);
+			system->setEmitterPosition(float(i % 100) * 10.f, float(i / 100) * 10.f, 0.f);
+		}
+
+		// warm up until the systems are populated
+		for (unsigned int f = 0; f < 120; ++f)
+		{
+			simulation.update(dt, parallel != 0);
+		}
+
+		double particleUpdates = 0.0;
+
+		osg::Timer_t start = osg::Timer::instance()->tick();
+		for (unsigned int f = 0; f < numFrames; ++f)
+		{
+			particleUpdates += simulation.getNumParticles();
+			simulation.update(dt, parallel != 0);
+		}
+		double ms = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+		std::cout << (parallel ? "  parallel: " : "  serial:   ")
+			<< simulation.getNumParticles() << " live particles, "
+			<< ms / numFrames << " ms/frame, "
+			<< particleUpdates / ms << " particles/ms" << std::endl;
+	}
+
+	return 0;
+}
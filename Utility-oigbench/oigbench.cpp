@@ -0,0 +1,127 @@
+//#******************************************************************************
+//#*
+//#*      Copyright (C) 2026  Compro Computer Services
+//#*      http://openig.compro.net
+//#*
+//#*      Source available at: https://github.com/CCSI-CSSI/MuseOpenIG
+//#*
+//#*      This software is released under the LGPL.
+//#*
+//#*   This software is free software; you can redistribute it and/or modify
+//#*   it under the terms of the GNU Lesser General Public License as published
+//#*   by the Free Software Foundation; either version 2.1 of the License, or
+//#*   (at your option) any later version.
+//#*
+//#*   This software is distributed in the hope that it will be useful,
+//#*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//#*   the GNU Lesser General Public License for more details.
+//#*
+//#*   You should have received a copy of the GNU Lesser General Public License
+//#*   along with this library; if not, write to the Free Software
+//#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*    Please direct any questions or comments to the OpenIG Forums
+//#*    Email address: openig@compro.net
+//#*
+//#*
+//#*****************************************************************************
+#include "Benchmarks.h"
+
+#include <osg/Viewport>
+
+#include <osgViewer/View>
+
+#include <map>
+
+namespace
+{
+	typedef int (*Benchmark)(const OpenIG::Benchmarks::Arguments&);
+	typedef std::map<std::string, Benchmark>	BenchmarkMap;
+
+	BenchmarkMap& benchmarks()
+	{
+		static BenchmarkMap s_benchmarks;
+		if (s_benchmarks.empty())
+		{
+			s_benchmarks["particles"] = &OpenIG::Benchmarks::particles;
+			s_benchmarks["lightgrid"] = &OpenIG::Benchmarks::lightgrid;
+			s_benchmarks["lightbvh"] = &OpenIG::Benchmarks::lightbvh;
+			s_benchmarks["entitycull"] = &OpenIG::Benchmarks::entitycull;
+			s_benchmarks["lightjournal"] = &OpenIG::Benchmarks::lightjournal;
+			s_benchmarks["netreplay"] = &OpenIG::Benchmarks::netreplay;
+			s_benchmarks["multicast"] = &OpenIG::Benchmarks::multicast;
+			s_benchmarks["frame"] = &OpenIG::Benchmarks::frame;
+		}
+		return s_benchmarks;
+	}
+
+	void usage()
+	{
+		std::cout << "usage: oigbench <benchmark> [--option value ...]" << std::endl;
+		std::cout << "benchmarks:" << std::endl;
+
+		BenchmarkMap::iterator itr = benchmarks().begin();
+		for (; itr != benchmarks().end(); ++itr)
+		{
+			std::cout << "\t" << itr->first << std::endl;
+		}
+	}
+}
+
+osgViewer::View* OpenIG::Benchmarks::createHeadlessView(unsigned int width, unsigned int height, bool render)
+{
+	osgViewer::View* view = new osgViewer::View;
+
+	osg::ref_ptr<osg::GraphicsContext::Traits> traits = new osg::GraphicsContext::Traits;
+	traits->width = width;
+	traits->height = height;
+	traits->pbuffer = true;
+	traits->doubleBuffer = false;
+	traits->sharedContext = 0;
+
+	osg::ref_ptr<osg::GraphicsContext> gc = osg::GraphicsContext::createGraphicsContext(traits.get());
+	if (gc.valid())
+	{
+		view->getCamera()->setGraphicsContext(gc.get());
+		view->getCamera()->setViewport(new osg::Viewport(0, 0, width, height));
+	}
+	else
+	{
+		std::cout << "  no pbuffer available, running without a graphics context" << std::endl;
+	}
+
+	view->getCamera()->setProjectionMatrixAsPerspective(45, double(width) / double(height), 1.0, 100000);
+	view->getCamera()->setComputeNearFarMode(osg::CullSettings::DO_NOT_COMPUTE_NEAR_FAR);
+	if (!render) view->getCamera()->setCullMask(0x0);
+
+	return view;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		usage();
+		return 1;
+	}
+
+	BenchmarkMap::iterator itr = benchmarks().find(argv[1]);
+	if (itr == benchmarks().end())
+	{
+		usage();
+		return 1;
+	}
+
+	OpenIG::Benchmarks::Arguments args;
+	for (int i = 2; i < argc; ++i)
+	{
+		args.push_back(argv[i]);
+	}
+
+	return itr->second(args);
+}